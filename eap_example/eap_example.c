@@ -17,31 +17,80 @@
 int eap_example_peer_init(void);
 void eap_example_peer_deinit(void);
 int eap_example_peer_step(void);
+int eap_example_peer_success(void);
+void eap_example_peer_restart(int fast_reauth);
 
 int eap_example_server_init(void);
 void eap_example_server_deinit(void);
 int eap_example_server_step(void);
+void eap_example_server_restart(void);
 
 
-int main(int argc, char *argv[])
+static int eap_example_run(void)
 {
 	int res_s, res_p;
 
-	wpa_debug_level = 0;
+	do {
+		wpa_printf(MSG_DEBUG,
+			   "---[ server ]--------------------------------");
+		res_s = eap_example_server_step();
+		wpa_printf(MSG_DEBUG,
+			   "---[ peer ]----------------------------------");
+		res_p = eap_example_peer_step();
+	} while (res_s || res_p);
+
+	return eap_example_peer_success() ? 0 : -1;
+}
+
+
+static int eap_example_perf(const char *title, int fast_reauth, int num)
+{
+	struct os_reltime start, now, diff;
+	int i;
+
+	os_get_reltime(&start);
+	for (i = 0; i < num; i++) {
+		eap_example_server_restart();
+		eap_example_peer_restart(fast_reauth);
+		if (eap_example_run() < 0) {
+			printf("%s: authentication failed\n", title);
+			return -1;
+		}
+	}
+	os_get_reltime(&now);
+	os_reltime_sub(&now, &start, &diff);
+	printf("%s: %.2f ms\n", title,
+	       (diff.sec * 1000.0 + diff.usec / 1000.0) / num);
+
+	return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+	int perf, ret = 0;
+
+	perf = argc >= 2 && os_strcmp(argv[1], "perf") == 0;
+	wpa_debug_level = perf ? MSG_ERROR : 0;
 
 	if (eap_example_peer_init() < 0 ||
 	    eap_example_server_init() < 0)
 		return -1;
 
-	do {
-		printf("---[ server ]--------------------------------\n");
-		res_s = eap_example_server_step();
-		printf("---[ peer ]----------------------------------\n");
-		res_p = eap_example_peer_step();
-	} while (res_s || res_p);
+	if (eap_example_run() < 0) {
+		printf("EAP authentication failed\n");
+		ret = -1;
+	} else if (perf) {
+		int num = argc >= 3 ? atoi(argv[2]) : 20;
+
+		if (num <= 0 ||
+		    eap_example_perf("EAP-PEAP full handshake", 0, num) < 0 ||
+		    eap_example_perf("EAP-PEAP session resumption", 1, num) < 0)
+			ret = -1;
+	}
 
 	eap_example_peer_deinit();
 	eap_example_server_deinit();
 
-	return 0;
+	return ret;
 }
@@ -299,6 +299,8 @@ int eap_example_peer_init(void)
 	eap_ctx.eap_config.password = (u8 *) os_strdup("password");
 	eap_ctx.eap_config.password_len = 8;
 	eap_ctx.eap_config.cert.ca_cert = os_strdup("ca.pem");
+	/* The example certificates have expired */
+	eap_ctx.eap_config.phase1 = os_strdup("tls_disable_time_checks=1");
 	eap_ctx.eap_config.fragment_size = 1398;
 
 	os_memset(&eap_cb, 0, sizeof(eap_cb));
@@ -332,6 +334,7 @@ void eap_example_peer_deinit(void)
 	os_free(eap_ctx.eap_config.identity);
 	os_free(eap_ctx.eap_config.password);
 	os_free(eap_ctx.eap_config.cert.ca_cert);
+	os_free(eap_ctx.eap_config.phase1);
 }
 
 
@@ -342,7 +345,7 @@ int eap_example_peer_step(void)
 
 	if (eap_ctx.eapResp) {
 		struct wpabuf *resp;
-		printf("==> Response\n");
+		wpa_printf(MSG_DEBUG, "==> Response");
 		eap_ctx.eapResp = false;
 		resp = eap_get_eapRespData(eap_ctx.eap);
 		if (resp) {
@@ -368,6 +371,20 @@ int eap_example_peer_step(void)
 }
 
 
+int eap_example_peer_success(void)
+{
+	return eap_ctx.eapSuccess;
+}
+
+
+void eap_example_peer_restart(int fast_reauth)
+{
+	/* Allow the previous TLS session to be resumed, if so requested */
+	eap_set_fast_reauth(eap_ctx.eap, fast_reauth);
+	eap_ctx.eapRestart = true;
+}
+
+
 void eap_example_peer_rx(const u8 *data, size_t data_len)
 {
 	/* Make received EAP message available to the EAP library */
@@ -71,6 +71,7 @@ static int eap_example_server_init_tls(void)
 	struct tls_connection_params tparams;
 
 	os_memset(&tconf, 0, sizeof(tconf));
+	tconf.tls_session_lifetime = 3600;
 	eap_ctx.tls_ctx = tls_init(&tconf);
 	if (eap_ctx.tls_ctx == NULL)
 		return -1;
@@ -224,6 +225,10 @@ int eap_example_server_init(void)
 	os_memset(&eap_conf, 0, sizeof(eap_conf));
 	eap_conf.eap_server = 1;
 	eap_conf.ssl_ctx = eap_ctx.tls_ctx;
+	eap_conf.max_auth_rounds = 100;
+	eap_conf.max_auth_rounds_short = 50;
+	/* Allow TLS sessions to be resumed on reauthentication */
+	eap_conf.tls_session_lifetime = 3600;
 
 	os_memset(&eap_sess, 0, sizeof(eap_sess));
 	eap_ctx.eap = eap_server_sm_init(&eap_ctx, &eap_cb, &eap_conf,
@@ -256,13 +261,13 @@ int eap_example_server_step(void)
 	res = eap_server_sm_step(eap_ctx.eap);
 
 	if (eap_ctx.eap_if->eapReq) {
-		printf("==> Request\n");
+		wpa_printf(MSG_DEBUG, "==> Request");
 		process = 1;
 		eap_ctx.eap_if->eapReq = 0;
 	}
 
 	if (eap_ctx.eap_if->eapSuccess) {
-		printf("==> Success\n");
+		wpa_printf(MSG_DEBUG, "==> Success");
 		process = 1;
 		res = 0;
 		eap_ctx.eap_if->eapSuccess = 0;
@@ -275,7 +280,7 @@ int eap_example_server_step(void)
 	}
 
 	if (eap_ctx.eap_if->eapFail) {
-		printf("==> Fail\n");
+		wpa_printf(MSG_DEBUG, "==> Fail");
 		process = 1;
 		eap_ctx.eap_if->eapFail = 0;
 	}
@@ -290,6 +295,13 @@ int eap_example_server_step(void)
 }
 
 
+void eap_example_server_restart(void)
+{
+	/* Request EAP to start a new authentication */
+	eap_ctx.eap_if->eapRestart = true;
+}
+
+
 void eap_example_server_rx(const u8 *data, size_t data_len)
 {
 	/* Make received EAP message available to the EAP library */
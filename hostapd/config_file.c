@@ -2906,11 +2906,11 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		os_free(bss->ssid.wpa_passphrase);
 		bss->ssid.wpa_passphrase = os_strdup(pos);
 		if (bss->ssid.wpa_passphrase) {
-			hostapd_config_clear_wpa_psk(&bss->ssid.wpa_psk);
+			hostapd_config_clear_wpa_psk(&bss->ssid);
 			bss->ssid.wpa_passphrase_set = 1;
 		}
 	} else if (os_strcmp(buf, "wpa_psk") == 0) {
-		hostapd_config_clear_wpa_psk(&bss->ssid.wpa_psk);
+		hostapd_config_clear_wpa_psk(&bss->ssid);
 		bss->ssid.wpa_psk = os_zalloc(sizeof(struct hostapd_wpa_psk));
 		if (bss->ssid.wpa_psk == NULL)
 			return 1;
@@ -2918,7 +2918,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		    pos[PMK_LEN * 2] != '\0') {
 			wpa_printf(MSG_ERROR, "Line %d: Invalid PSK '%s'.",
 				   line, pos);
-			hostapd_config_clear_wpa_psk(&bss->ssid.wpa_psk);
+			hostapd_config_clear_wpa_psk(&bss->ssid);
 			return 1;
 		}
 		bss->ssid.wpa_psk->group = 1;
@@ -2933,6 +2933,14 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line);
 			return 1;
 		}
+	} else if (os_strcmp(buf, "wpa_psk_cache") == 0) {
+		os_free(bss->ssid.wpa_psk_cache);
+		bss->ssid.wpa_psk_cache = os_strdup(pos);
+		if (!bss->ssid.wpa_psk_cache) {
+			wpa_printf(MSG_ERROR, "Line %d: allocation failed",
+				   line);
+			return 1;
+		}
 	} else if (os_strcmp(buf, "wpa_key_mgmt") == 0) {
 		bss->wpa_key_mgmt = hostapd_config_parse_key_mgmt(line, pos);
 		if (bss->wpa_key_mgmt == -1)
@@ -3368,12 +3376,41 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 	} else if (os_strcmp(buf, "vlan_tagged_interface") == 0) {
 		os_free(bss->ssid.vlan_tagged_interface);
 		bss->ssid.vlan_tagged_interface = os_strdup(pos);
+	} else if (os_strcmp(buf, "vlan_pool") == 0) {
+		unsigned int i;
+
+		if (freq_range_list_parse(&bss->ssid.vlan_pool, pos)) {
+			wpa_printf(MSG_ERROR, "Line %d: invalid vlan_pool '%s'",
+				   line, pos);
+			return 1;
+		}
+		for (i = 0; i < bss->ssid.vlan_pool.num; i++) {
+			struct wpa_freq_range *r = &bss->ssid.vlan_pool.range[i];
+
+			if (r->min < 1 || r->max > MAX_VLAN_ID ||
+			    r->min > r->max) {
+				wpa_printf(MSG_ERROR,
+					   "Line %d: invalid vlan_pool range %u-%u",
+					   line, r->min, r->max);
+				return 1;
+			}
+		}
 #endif /* CONFIG_FULL_DYNAMIC_VLAN */
 #endif /* CONFIG_NO_VLAN */
 	} else if (os_strcmp(buf, "ap_table_max_size") == 0) {
 		conf->ap_table_max_size = atoi(pos);
 	} else if (os_strcmp(buf, "ap_table_expiration_time") == 0) {
 		conf->ap_table_expiration_time = atoi(pos);
+	} else if (os_strcmp(buf, "housekeeping_timer_slack") == 0) {
+		int val = atoi(pos);
+
+		if (val < 0 || val > 60000) {
+			wpa_printf(MSG_ERROR,
+				   "Line %d: invalid housekeeping_timer_slack %d (expected 0..60000)",
+				   line, val);
+			return 1;
+		}
+		conf->housekeeping_timer_slack = val;
 	} else if (os_strncmp(buf, "tx_queue_", 9) == 0) {
 		if (hostapd_config_tx_queue(conf->tx_queue, buf, pos)) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid TX queue item",
@@ -3784,12 +3821,11 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		bss->multi_ap_backhaul_ssid.wpa_passphrase = os_strdup(pos);
 		if (bss->multi_ap_backhaul_ssid.wpa_passphrase) {
 			hostapd_config_clear_wpa_psk(
-				&bss->multi_ap_backhaul_ssid.wpa_psk);
+				&bss->multi_ap_backhaul_ssid);
 			bss->multi_ap_backhaul_ssid.wpa_passphrase_set = 1;
 		}
 	} else if (os_strcmp(buf, "multi_ap_backhaul_wpa_psk") == 0) {
-		hostapd_config_clear_wpa_psk(
-			&bss->multi_ap_backhaul_ssid.wpa_psk);
+		hostapd_config_clear_wpa_psk(&bss->multi_ap_backhaul_ssid);
 		bss->multi_ap_backhaul_ssid.wpa_psk =
 			os_zalloc(sizeof(struct hostapd_wpa_psk));
 		if (!bss->multi_ap_backhaul_ssid.wpa_psk)
@@ -3800,7 +3836,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			wpa_printf(MSG_ERROR, "Line %d: Invalid PSK '%s'.",
 				   line, pos);
 			hostapd_config_clear_wpa_psk(
-				&bss->multi_ap_backhaul_ssid.wpa_psk);
+				&bss->multi_ap_backhaul_ssid);
 			return 1;
 		}
 		bss->multi_ap_backhaul_ssid.wpa_psk->group = 1;
@@ -4048,6 +4084,8 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 #ifdef CONFIG_PROXYARP
 	} else if (os_strcmp(buf, "proxy_arp") == 0) {
 		bss->proxy_arp = atoi(pos);
+	} else if (os_strcmp(buf, "proxy_arp_mcast_to_ucast_limit") == 0) {
+		bss->proxy_arp_mcast_to_ucast_limit = atoi(pos);
 #endif /* CONFIG_PROXYARP */
 #ifdef CONFIG_HS20
 	} else if (os_strcmp(buf, "hs20") == 0) {
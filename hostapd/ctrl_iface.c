@@ -29,6 +29,7 @@
 
 #include "utils/common.h"
 #include "utils/eloop.h"
+#include "utils/obj_pool.h"
 #include "utils/module_tests.h"
 #include "common/version.h"
 #include "common/ieee802_11_defs.h"
@@ -62,6 +63,7 @@
 #include "ap/rrm.h"
 #include "ap/dpp_hostapd.h"
 #include "ap/dfs.h"
+#include "ap/x_snoop.h"
 #include "wps/wps_defs.h"
 #include "wps/wps.h"
 #include "fst/fst_ctrl_iface.h"
@@ -1445,7 +1447,7 @@ static int hostapd_ctrl_iface_reload_wpa_psk(struct hostapd_data *hapd)
 	struct hostapd_bss_config *conf = hapd->conf;
 	int err;
 
-	hostapd_config_clear_wpa_psk(&conf->ssid.wpa_psk);
+	hostapd_config_clear_wpa_psk(&conf->ssid);
 
 	err = hostapd_setup_wpa_psk(conf);
 	if (err < 0) {
@@ -2626,12 +2628,28 @@ static int hostapd_ctrl_iface_chan_switch(struct hostapd_iface *iface,
 static int hostapd_ctrl_iface_mib(struct hostapd_data *hapd, char *reply,
 				  int reply_size, const char *param)
 {
+	if (os_strcmp(param, "l2_packet") == 0) {
+		int len;
+
+		len = l2_packet_get_mib(hapd->l2, "eapol", reply, reply_size);
+#ifdef CONFIG_PROXYARP
+		len += l2_packet_get_mib(hapd->sock_dhcp, "dhcpSnoop",
+					 reply + len, reply_size - len);
+		len += l2_packet_get_mib(hapd->sock_ndisc, "ndiscSnoop",
+					 reply + len, reply_size - len);
+#endif /* CONFIG_PROXYARP */
+		return len;
+	}
 #ifdef RADIUS_SERVER
 	if (os_strcmp(param, "radius_server") == 0) {
 		return radius_server_get_mib(hapd->radius_srv, reply,
 					     reply_size);
 	}
 #endif /* RADIUS_SERVER */
+#ifdef CONFIG_PROXYARP
+	if (os_strcmp(param, "x_snoop") == 0)
+		return x_snoop_get_mib(hapd, reply, reply_size);
+#endif /* CONFIG_PROXYARP */
 	return -1;
 }
 
@@ -3217,6 +3235,16 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 		wpa_debug_stop_log();
 	} else if (os_strncmp(buf, "NOTE ", 5) == 0) {
 		wpa_printf(MSG_INFO, "NOTE: %s", buf + 5);
+#ifdef CONFIG_ELOOP_STATS
+	} else if (os_strcmp(buf, "ELOOP_STATS") == 0) {
+		reply_len = eloop_stats_dump(reply, reply_size);
+	} else if (os_strcmp(buf, "ELOOP_STATS RESET") == 0) {
+		eloop_stats_reset();
+#endif /* CONFIG_ELOOP_STATS */
+#ifdef CONFIG_OBJ_POOL
+	} else if (os_strcmp(buf, "POOL_STATS") == 0) {
+		reply_len = obj_pool_stats_dump(reply, reply_size);
+#endif /* CONFIG_OBJ_POOL */
 	} else if (os_strcmp(buf, "STATUS") == 0) {
 		reply_len = hostapd_ctrl_iface_status(hapd, reply,
 						      reply_size);
@@ -4587,6 +4615,16 @@ static void hostapd_global_ctrl_iface_receive(int sock, void *eloop_ctx,
 	} else if (os_strncmp(buf, "RELOG", 5) == 0) {
 		if (wpa_debug_reopen_file() < 0)
 			reply_len = -1;
+#ifdef CONFIG_ELOOP_STATS
+	} else if (os_strcmp(buf, "ELOOP_STATS") == 0) {
+		reply_len = eloop_stats_dump(reply, reply_size);
+	} else if (os_strcmp(buf, "ELOOP_STATS RESET") == 0) {
+		eloop_stats_reset();
+#endif /* CONFIG_ELOOP_STATS */
+#ifdef CONFIG_OBJ_POOL
+	} else if (os_strcmp(buf, "POOL_STATS") == 0) {
+		reply_len = obj_pool_stats_dump(reply, reply_size);
+#endif /* CONFIG_OBJ_POOL */
 	} else if (os_strcmp(buf, "FLUSH") == 0) {
 		hostapd_ctrl_iface_flush(interfaces);
 	} else if (os_strncmp(buf, "ADD ", 4) == 0) {
@@ -10,9 +10,467 @@
 
 #include "utils/common.h"
 #include "utils/module_tests.h"
+#include "crypto/crypto.h"
+#include "radius/radius.h"
+#include "common/eapol_common.h"
+#include "common/wpa_common.h"
+#include "ap/ap_config.h"
+#include "ap/wpa_auth.h"
+
+
+static int hapd_psk_iter_check(struct hostapd_bss_config *conf,
+			       const u8 *addr, const u8 *p2p_dev_addr,
+			       struct hostapd_wpa_psk *sta_psk,
+			       size_t num_group)
+{
+	struct hostapd_wpa_psk *psk = conf->ssid.wpa_psk;
+	const u8 *prev = NULL;
+	u8 other[PMK_LEN];
+	size_t trials = 0;
+	int vlan_id;
+
+	/* Station specific PSK first and then the group PSKs in list order */
+	prev = hostapd_get_psk(conf, addr, p2p_dev_addr, NULL, &vlan_id);
+	if (prev != sta_psk->psk || vlan_id != sta_psk->vlan_id)
+		return -1;
+	while ((prev = hostapd_get_psk(conf, addr, p2p_dev_addr, prev,
+				       NULL))) {
+		while (psk && !psk->group)
+			psk = psk->next;
+		if (!psk || prev != psk->psk)
+			return -1;
+		psk = psk->next;
+		trials++;
+	}
+	if (trials != num_group)
+		return -1;
+
+	/* Unknown prev_psk ends the iteration */
+	if (hostapd_get_psk(conf, addr, p2p_dev_addr, other, NULL))
+		return -1;
+
+	return 0;
+}
+
+
+static int hapd_psk_module_tests(void)
+{
+	struct hostapd_bss_config *conf;
+	struct hostapd_wpa_psk *psk, *sta_psk = NULL, *p2p_psk = NULL;
+	const u8 addr[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x01, 0x00 };
+	const u8 addr2[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x02, 0x00 };
+	const u8 p2p_dev_addr[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x03, 0x00 };
+	const u8 p2p_dev_addr2[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x04, 0x00 };
+	const size_t num_group = 1000;
+	const u8 *group_psk = NULL;
+	size_t i;
+	int ret = -1;
+
+	conf = os_zalloc(sizeof(*conf));
+	if (!conf)
+		return -1;
+
+	/*
+	 * Station specific PSKs at the end of the list of group PSKs. Entries
+	 * are added to the head of the list.
+	 */
+	for (i = 0; i < num_group + 3; i++) {
+		psk = os_zalloc(sizeof(*psk));
+		if (!psk)
+			goto fail;
+		WPA_PUT_BE32(psk->psk, i);
+		if (i == 0) {
+			os_memcpy(psk->addr, addr, ETH_ALEN);
+			psk->vlan_id = 10;
+			sta_psk = psk;
+		} else if (i == 1) {
+			os_memcpy(psk->addr, addr2, ETH_ALEN);
+		} else if (i == 2) {
+			os_memcpy(psk->addr, addr2, ETH_ALEN);
+			os_memcpy(psk->p2p_dev_addr, p2p_dev_addr, ETH_ALEN);
+			p2p_psk = psk;
+		} else {
+			psk->group = 1;
+			psk->vlan_id = i;
+			group_psk = psk->psk;
+		}
+		psk->next = conf->ssid.wpa_psk;
+		conf->ssid.wpa_psk = psk;
+	}
+
+	/* List walk without an index and the indexed lookup */
+	for (i = 0; i < 2; i++) {
+		if (i == 1) {
+			hostapd_wpa_psk_index_update(&conf->ssid);
+			if (!conf->ssid.wpa_psk_index)
+				goto fail;
+		}
+		if (hapd_psk_iter_check(conf, addr, NULL, sta_psk,
+					num_group) < 0 ||
+		    hapd_psk_iter_check(conf, addr, p2p_dev_addr, p2p_psk,
+					num_group) < 0)
+			goto fail;
+	}
+
+	/* Station specific PSKs added and removed after the index is built */
+	psk = os_zalloc(sizeof(*psk));
+	if (!psk)
+		goto fail;
+	WPA_PUT_BE32(psk->psk, num_group + 3);
+	os_memcpy(psk->p2p_dev_addr, p2p_dev_addr2, ETH_ALEN);
+	hostapd_wpa_psk_add(&conf->ssid, psk);
+	if (!conf->ssid.wpa_psk_index ||
+	    hapd_psk_iter_check(conf, addr2, p2p_dev_addr2, psk,
+				num_group) < 0)
+		goto fail;
+	if (hostapd_wpa_psk_remove_sta(&conf->ssid, NULL, p2p_dev_addr2) != 1 ||
+	    hostapd_get_psk(conf, addr2, p2p_dev_addr2, NULL, NULL) !=
+	    group_psk)
+		goto fail;
+	if (hostapd_wpa_psk_remove_sta(&conf->ssid, addr2, NULL) != 2 ||
+	    hostapd_get_psk(conf, addr2, NULL, NULL, NULL) != group_psk ||
+	    hostapd_get_psk(conf, addr, p2p_dev_addr, NULL, NULL) !=
+	    group_psk ||
+	    hapd_psk_iter_check(conf, addr, NULL, sta_psk, num_group) < 0)
+		goto fail;
+
+	ret = 0;
+fail:
+	if (ret)
+		wpa_printf(MSG_ERROR, "PSK lookup module test failure");
+	hostapd_config_clear_wpa_psk(&conf->ssid);
+	os_free(conf);
+	return ret;
+}
+
+
+#ifndef CONFIG_NO_RADIUS
+
+static int hapd_radius_round(struct radius_msg *req, const u8 *secret,
+			     size_t secret_len,
+			     struct crypto_hmac_key *hmac_key, u8 identifier)
+{
+	struct radius_hdr *hdr = radius_msg_get_hdr(req);
+	struct radius_msg *resp, *msg = NULL;
+	struct wpabuf *buf;
+	u8 eap[200];
+	int ret = -1;
+
+	/* Access-Challenge carrying an EAP-Request fragment */
+	resp = radius_msg_new(RADIUS_CODE_ACCESS_CHALLENGE, identifier);
+	if (!resp)
+		return -1;
+	os_memset(eap, identifier, sizeof(eap));
+	if (!radius_msg_add_attr(resp, RADIUS_ATTR_STATE, eap, 16) ||
+	    radius_msg_add_eap(resp, eap, sizeof(eap)) < 0 ||
+	    radius_msg_finish_srv_key(resp, secret, secret_len, hmac_key,
+				      hdr->authenticator) < 0)
+		goto fail;
+
+	buf = radius_msg_get_buf(resp);
+	msg = radius_msg_parse(wpabuf_head(buf), wpabuf_len(buf));
+	if (!msg ||
+	    radius_msg_verify_msg_auth_key(msg, secret, secret_len, hmac_key,
+					   hdr->authenticator))
+		goto fail;
+
+	/* Cross-check against the per-message shared secret processing */
+	if (radius_msg_verify(msg, secret, secret_len, req, 1))
+		goto fail;
+
+	ret = 0;
+fail:
+	radius_msg_free(resp);
+	radius_msg_free(msg);
+	return ret;
+}
+
+
+static int hapd_radius_module_tests(void)
+{
+	const u8 secret[] = "shared secret for the RADIUS module tests";
+	const size_t secret_len = sizeof(secret) - 1;
+	struct crypto_hmac_key *hmac_key;
+	struct radius_msg *req;
+	int ret = -1;
+
+	req = radius_msg_new(RADIUS_CODE_ACCESS_REQUEST, 1);
+	if (!req ||
+	    !radius_msg_add_attr(req, RADIUS_ATTR_USER_NAME, (u8 *) "user",
+				 4) ||
+	    radius_msg_finish(req, secret, secret_len) < 0) {
+		radius_msg_free(req);
+		return -1;
+	}
+
+	hmac_key = radius_hmac_key_init(secret, secret_len);
+	if (!hmac_key)
+		wpa_printf(MSG_INFO,
+			   "RADIUS: Precomputed HMAC key not supported by the crypto library");
+
+	if (hapd_radius_round(req, secret, secret_len, NULL, 1) < 0 ||
+	    hapd_radius_round(req, secret, secret_len, hmac_key, 2) < 0)
+		goto fail;
+
+	ret = 0;
+fail:
+	if (ret)
+		wpa_printf(MSG_ERROR, "RADIUS module test failure");
+	radius_hmac_key_deinit(hmac_key);
+	radius_msg_free(req);
+	return ret;
+}
+
+#endif /* CONFIG_NO_RADIUS */
+
+
+#ifdef WPA_TRACE
+#define HAPD_ALLOC_COUNT() wpa_trace_alloc_count
+/* Building EAPOL-Key msg 3/4; the received frames must not be copied */
+#ifdef CONFIG_CRYPTO_INTERNAL
+/* The internal AES key wrap allocates its key schedule */
+#define HAPD_4WAY_MAX_RX_ALLOCS 7
+#else /* CONFIG_CRYPTO_INTERNAL */
+#define HAPD_4WAY_MAX_RX_ALLOCS 6
+#endif /* CONFIG_CRYPTO_INTERNAL */
+#else /* WPA_TRACE */
+#define HAPD_ALLOC_COUNT() 0
+#endif /* WPA_TRACE */
+
+struct hapd_4way {
+	struct wpa_auth_callbacks cb;
+	struct wpa_authenticator *auth;
+	u8 auth_addr[ETH_ALEN];
+	u8 supp_addr[ETH_ALEN];
+	u8 psk[PMK_LEN];
+
+	/* Last EAPOL-Key frame from the Authenticator */
+	u8 rx[512];
+	size_t rx_len;
+
+	/* Allocations during wpa_receive() calls */
+	unsigned int rx_allocs;
+};
+
+
+static int hapd_4way_send_eapol(void *ctx, const u8 *addr, const u8 *data,
+				size_t data_len, int encrypt)
+{
+	struct hapd_4way *w = ctx;
+
+	if (data_len > sizeof(w->rx))
+		return -1;
+	os_memcpy(w->rx, data, data_len);
+	w->rx_len = data_len;
+	return 0;
+}
+
+
+static const u8 * hapd_4way_get_psk(void *ctx, const u8 *addr,
+				    const u8 *p2p_dev_addr,
+				    const u8 *prev_psk, size_t *psk_len,
+				    int *vlan_id)
+{
+	struct hapd_4way *w = ctx;
+
+	if (vlan_id)
+		*vlan_id = 0;
+	if (psk_len)
+		*psk_len = PMK_LEN;
+	return prev_psk ? NULL : w->psk;
+}
+
+
+static int hapd_4way_set_key(void *ctx, int vlan_id, enum wpa_alg alg,
+			     const u8 *addr, int idx, u8 *key, size_t key_len,
+			     enum key_flag key_flag)
+{
+	return 0;
+}
+
+
+/* Build an EAPOL-Key msg 2/4 or 4/4 as a reply to the last received frame */
+static int hapd_4way_reply(struct hapd_4way *w, const struct wpa_ptk *ptk,
+			   const u8 *snonce, const u8 *kde, size_t kde_len,
+			   u8 *buf, size_t *len)
+{
+	struct ieee802_1x_hdr *hdr = (struct ieee802_1x_hdr *) buf;
+	struct wpa_eapol_key *key = (struct wpa_eapol_key *) (hdr + 1);
+	const struct wpa_eapol_key *rx_key;
+	u8 *mic = (u8 *) (key + 1);
+	u16 key_info;
+
+	if (w->rx_len < sizeof(*hdr) + sizeof(*key) + 16 + 2)
+		return -1;
+	rx_key = (const struct wpa_eapol_key *) (w->rx + sizeof(*hdr));
+
+	*len = sizeof(*hdr) + sizeof(*key) + 16 + 2 + kde_len;
+	os_memset(buf, 0, *len);
+	hdr->version = 2;
+	hdr->type = IEEE802_1X_TYPE_EAPOL_KEY;
+	hdr->length = host_to_be16(*len - sizeof(*hdr));
+	key->type = EAPOL_KEY_TYPE_RSN;
+	key_info = WPA_KEY_INFO_TYPE_HMAC_SHA1_AES | WPA_KEY_INFO_KEY_TYPE |
+		WPA_KEY_INFO_MIC;
+	if (!snonce)
+		key_info |= WPA_KEY_INFO_SECURE;
+	WPA_PUT_BE16(key->key_info, key_info);
+	os_memcpy(key->replay_counter, rx_key->replay_counter,
+		  WPA_REPLAY_COUNTER_LEN);
+	if (snonce)
+		os_memcpy(key->key_nonce, snonce, WPA_NONCE_LEN);
+	WPA_PUT_BE16(mic + 16, kde_len);
+	if (kde_len)
+		os_memcpy(mic + 16 + 2, kde, kde_len);
+
+	return wpa_eapol_key_mic(ptk->kck, ptk->kck_len, WPA_KEY_MGMT_PSK,
+				 WPA_KEY_INFO_TYPE_HMAC_SHA1_AES, buf, *len,
+				 mic);
+}
+
+
+static int hapd_4way_handshake(struct hapd_4way *w, unsigned int idx)
+{
+	static const u8 rsn_ie[] = {
+		0x30, 0x14, 0x01, 0x00, 0x00, 0x0f, 0xac, 0x04,
+		0x01, 0x00, 0x00, 0x0f, 0xac, 0x04, 0x01, 0x00,
+		0x00, 0x0f, 0xac, 0x02, 0x00, 0x00
+	};
+	struct wpa_state_machine *sm;
+	struct wpa_ptk ptk;
+	u8 snonce[WPA_NONCE_LEN], buf[200];
+	size_t len;
+	unsigned int allocs;
+	int ret = -1;
+
+	sm = wpa_auth_sta_init(w->auth, w->supp_addr, NULL);
+	if (!sm)
+		return -1;
+	if (wpa_validate_wpa_ie(w->auth, sm, 2412, rsn_ie, sizeof(rsn_ie),
+				NULL, 0, NULL, 0, NULL, 0) != WPA_IE_OK)
+		goto fail;
+
+	/* EAPOL-Key msg 1/4 */
+	w->rx_len = 0;
+	wpa_auth_sm_event(sm, WPA_ASSOC);
+	wpa_auth_sta_associated(w->auth, sm);
+	if (w->rx_len < sizeof(struct ieee802_1x_hdr) +
+	    sizeof(struct wpa_eapol_key))
+		goto fail;
+
+	os_memset(snonce, 0x55, sizeof(snonce));
+	WPA_PUT_BE32(snonce, idx);
+	if (wpa_pmk_to_ptk(w->psk, PMK_LEN, "Pairwise key expansion",
+			   w->auth_addr, w->supp_addr,
+			   ((struct wpa_eapol_key *)
+			    (w->rx + sizeof(struct ieee802_1x_hdr)))->key_nonce,
+			   snonce, &ptk, WPA_KEY_MGMT_PSK, WPA_CIPHER_CCMP,
+			   NULL, 0, 0) < 0)
+		goto fail;
+
+	/* EAPOL-Key msg 2/4 -> msg 3/4 */
+	if (hapd_4way_reply(w, &ptk, snonce, rsn_ie, sizeof(rsn_ie), buf,
+			    &len) < 0)
+		goto fail;
+	w->rx_len = 0;
+	allocs = HAPD_ALLOC_COUNT();
+	wpa_receive(w->auth, sm, buf, len);
+	w->rx_allocs += HAPD_ALLOC_COUNT() - allocs;
+	if (!w->rx_len)
+		goto fail;
+
+	/* EAPOL-Key msg 4/4 */
+	if (hapd_4way_reply(w, &ptk, NULL, NULL, 0, buf, &len) < 0)
+		goto fail;
+	allocs = HAPD_ALLOC_COUNT();
+	wpa_receive(w->auth, sm, buf, len);
+	w->rx_allocs += HAPD_ALLOC_COUNT() - allocs;
+	if (!wpa_auth_pairwise_set(sm))
+		goto fail;
+
+	ret = 0;
+fail:
+	wpa_auth_sta_deinit(sm);
+	forced_memzero(&ptk, sizeof(ptk));
+	return ret;
+}
+
+
+static int hapd_4way_module_tests(void)
+{
+	struct hapd_4way w;
+	struct wpa_auth_config conf;
+	int level = wpa_debug_level;
+	unsigned int i;
+	int ret = -1;
+
+	os_memset(&w, 0, sizeof(w));
+	os_memset(w.auth_addr, 0x02, ETH_ALEN);
+	os_memset(w.supp_addr, 0x12, ETH_ALEN);
+	os_memset(w.psk, 0x44, PMK_LEN);
+	w.cb.send_eapol = hapd_4way_send_eapol;
+	w.cb.get_psk = hapd_4way_get_psk;
+	w.cb.set_key = hapd_4way_set_key;
+
+	os_memset(&conf, 0, sizeof(conf));
+	conf.wpa = WPA_PROTO_RSN;
+	conf.wpa_key_mgmt = WPA_KEY_MGMT_PSK;
+	conf.wpa_pairwise = WPA_CIPHER_CCMP;
+	conf.rsn_pairwise = WPA_CIPHER_CCMP;
+	conf.wpa_group = WPA_CIPHER_CCMP;
+	conf.eapol_version = 2;
+	conf.wpa_group_update_count = 4;
+	conf.wpa_pairwise_update_count = 4;
+
+	w.auth = wpa_init(w.auth_addr, &conf, &w.cb, &w);
+	if (!w.auth)
+		goto fail;
+
+	/* Debug logging allocates, so keep it out of the allocation count */
+	if (wpa_debug_level < MSG_INFO)
+		wpa_debug_level = MSG_INFO;
+
+	for (i = 0; i < 3; i++) {
+		w.rx_allocs = 0;
+		if (hapd_4way_handshake(&w, i) < 0)
+			goto fail;
+#ifdef WPA_TRACE
+		if (w.rx_allocs > HAPD_4WAY_MAX_RX_ALLOCS) {
+			wpa_printf(MSG_ERROR,
+				   "4-way handshake: %u allocations in wpa_receive() (max %u)",
+				   w.rx_allocs, HAPD_4WAY_MAX_RX_ALLOCS);
+			goto fail;
+		}
+#endif /* WPA_TRACE */
+	}
+
+	ret = 0;
+fail:
+	wpa_debug_level = level;
+	if (ret)
+		wpa_printf(MSG_ERROR, "4-way handshake module test failure");
+	if (w.auth)
+		wpa_deinit(w.auth);
+	return ret;
+}
+
 
 int hapd_module_tests(void)
 {
+	int ret = 0;
+
 	wpa_printf(MSG_INFO, "hostapd module tests");
-	return 0;
+
+	if (hapd_psk_module_tests() < 0)
+		ret = -1;
+
+	if (hapd_4way_module_tests() < 0)
+		ret = -1;
+
+#ifndef CONFIG_NO_RADIUS
+	if (hapd_radius_module_tests() < 0)
+		ret = -1;
+#endif /* CONFIG_NO_RADIUS */
+
+	return ret;
 }
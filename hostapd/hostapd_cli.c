@@ -252,6 +252,20 @@ static int hostapd_cli_cmd_relog(struct wpa_ctrl *ctrl, int argc, char *argv[])
 }
 
 
+static int hostapd_cli_cmd_eloop_stats(struct wpa_ctrl *ctrl, int argc,
+				       char *argv[])
+{
+	return hostapd_cli_cmd(ctrl, "ELOOP_STATS", 0, argc, argv);
+}
+
+
+static int hostapd_cli_cmd_pool_stats(struct wpa_ctrl *ctrl, int argc,
+				      char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "POOL_STATS");
+}
+
+
 static int hostapd_cli_cmd_close_log(struct wpa_ctrl *ctrl, int argc,
 				     char *argv[])
 {
@@ -1583,11 +1597,16 @@ static const struct hostapd_cli_cmd hostapd_cli_commands[] = {
 	{ "ping", hostapd_cli_cmd_ping, NULL,
 	  "= pings hostapd" },
 	{ "mib", hostapd_cli_cmd_mib, NULL,
-	  "= get MIB variables (dot1x, dot11, radius)" },
+	  "[radius_server|x_snoop|l2_packet] = get MIB variables (dot1x, dot11,\n"
+	  "  radius) or the selected MIB group" },
 	{ "relog", hostapd_cli_cmd_relog, NULL,
 	  "= reload/truncate debug log output file" },
 	{ "close_log", hostapd_cli_cmd_close_log, NULL,
 	  "= disable debug log output file" },
+	{ "eloop_stats", hostapd_cli_cmd_eloop_stats, NULL,
+	  "[RESET] = show or clear event loop statistics" },
+	{ "pool_stats", hostapd_cli_cmd_pool_stats, NULL,
+	  "= show object pool statistics" },
 	{ "status", hostapd_cli_cmd_status, NULL,
 	  "= show interface status info" },
 	{ "sta", hostapd_cli_cmd_sta, hostapd_complete_stations,
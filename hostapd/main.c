@@ -14,6 +14,7 @@
 
 #include "utils/common.h"
 #include "utils/eloop.h"
+#include "utils/obj_pool.h"
 #include "utils/uuid.h"
 #include "crypto/crypto.h"
 #include "crypto/random.h"
@@ -330,7 +331,22 @@ static void handle_reload(int sig, void *signal_ctx)
 
 static void handle_dump_state(int sig, void *signal_ctx)
 {
-	/* Not used anymore - ignore signal */
+#if defined(CONFIG_ELOOP_STATS) || defined(CONFIG_OBJ_POOL)
+	char *buf;
+
+	buf = os_malloc(16384);
+	if (!buf)
+		return;
+#ifdef CONFIG_ELOOP_STATS
+	eloop_stats_dump(buf, 16384);
+	wpa_printf(MSG_INFO, "eloop statistics:\n%s", buf);
+#endif /* CONFIG_ELOOP_STATS */
+#ifdef CONFIG_OBJ_POOL
+	obj_pool_stats_dump(buf, 16384);
+	wpa_printf(MSG_INFO, "Object pool statistics:\n%s", buf);
+#endif /* CONFIG_OBJ_POOL */
+	os_free(buf);
+#endif /* CONFIG_ELOOP_STATS || CONFIG_OBJ_POOL */
 }
 #endif /* CONFIG_NATIVE_WINDOWS */
 
@@ -628,13 +644,35 @@ static int hostapd_periodic_call(struct hostapd_iface *iface, void *ctx)
 }
 
 
+/* The periodic cleanup is shared; use the smallest slack of all interfaces */
+static unsigned int hostapd_periodic_slack(struct hapd_interfaces *interfaces)
+{
+	unsigned int slack = 0;
+	int found = 0;
+	size_t i;
+
+	for (i = 0; i < interfaces->count; i++) {
+		struct hostapd_iface *iface = interfaces->iface[i];
+
+		if (!iface || !iface->conf)
+			continue;
+		if (!found || iface->conf->housekeeping_timer_slack < slack)
+			slack = iface->conf->housekeeping_timer_slack;
+		found = 1;
+	}
+
+	return slack * 1000;
+}
+
+
 /* Periodic cleanup tasks */
 static void hostapd_periodic(void *eloop_ctx, void *timeout_ctx)
 {
 	struct hapd_interfaces *interfaces = eloop_ctx;
 
-	eloop_register_timeout(HOSTAPD_CLEANUP_INTERVAL, 0,
-			       hostapd_periodic, interfaces, NULL);
+	eloop_register_timeout_slack(HOSTAPD_CLEANUP_INTERVAL, 0,
+				     hostapd_periodic_slack(interfaces),
+				     hostapd_periodic, interfaces, NULL);
 	hostapd_for_each_interface(interfaces, hostapd_periodic_call, NULL);
 }
 
@@ -941,6 +979,9 @@ int main(int argc, char *argv[])
 
 	fst_global_deinit();
 
+#ifdef CONFIG_OBJ_POOL
+	obj_pool_deinit_all();
+#endif /* CONFIG_OBJ_POOL */
 	crypto_unload();
 	os_program_deinit();
 
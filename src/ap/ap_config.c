@@ -7,9 +7,18 @@
  */
 
 #include "utils/includes.h"
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif /* _WIN32 */
+#ifdef CONFIG_WPA_PSK_THREADS
+#include <pthread.h>
+#endif /* CONFIG_WPA_PSK_THREADS */
 
 #include "utils/common.h"
 #include "crypto/sha1.h"
+#include "crypto/crypto.h"
+#include "crypto/sha256.h"
 #include "crypto/tls.h"
 #include "radius/radius_client.h"
 #include "common/ieee802_11_defs.h"
@@ -303,8 +312,461 @@ int hostapd_mac_comp(const void *a, const void *b)
 }
 
 
+struct hostapd_psk_cache_entry {
+	u8 key[SHA256_MAC_LEN];
+	u8 psk[PMK_LEN];
+	bool used;
+};
+
+struct hostapd_psk_cache {
+	struct hostapd_psk_cache_entry *entry;
+	size_t num, alloc;
+	size_t num_sorted; /* entries loaded from the file, sorted by key */
+	bool modified;
+};
+
+#define HOSTAPD_PSK_CACHE_HEADER "hostapd-wpa-psk-cache"
+
+
+static int hostapd_psk_cache_compar(const void *a, const void *b)
+{
+	const struct hostapd_psk_cache_entry *ea = a, *eb = b;
+
+	return os_memcmp(ea->key, eb->key, SHA256_MAC_LEN);
+}
+
+
+static void hostapd_psk_cache_free(struct hostapd_psk_cache *cache)
+{
+	if (!cache)
+		return;
+	bin_clear_free(cache->entry, cache->alloc * sizeof(cache->entry[0]));
+	os_free(cache);
+}
+
+
+static struct hostapd_psk_cache_entry *
+hostapd_psk_cache_add(struct hostapd_psk_cache *cache)
+{
+	struct hostapd_psk_cache_entry *n;
+	size_t alloc;
+
+	if (cache->num == cache->alloc) {
+		alloc = cache->alloc ? 2 * cache->alloc : 16;
+		n = os_calloc(alloc, sizeof(*n));
+		if (!n)
+			return NULL;
+		if (cache->entry)
+			os_memcpy(n, cache->entry,
+				  cache->num * sizeof(cache->entry[0]));
+		bin_clear_free(cache->entry,
+			       cache->alloc * sizeof(cache->entry[0]));
+		cache->entry = n;
+		cache->alloc = alloc;
+	}
+
+	n = &cache->entry[cache->num++];
+	os_memset(n, 0, sizeof(*n));
+	return n;
+}
+
+
+static struct hostapd_psk_cache * hostapd_psk_cache_load(const char *fname)
+{
+	struct hostapd_psk_cache *cache;
+	struct hostapd_psk_cache_entry *e;
+	FILE *f;
+	char buf[2 * SHA256_MAC_LEN + 1 + 2 * PMK_LEN + 3];
+	int line = 0;
+
+	cache = os_zalloc(sizeof(*cache));
+	if (!cache)
+		return NULL;
+
+	f = fopen(fname, "r");
+	if (!f) {
+		wpa_printf(MSG_DEBUG, "WPA PSK cache '%s' not available",
+			   fname);
+		return cache;
+	}
+
+	while (fgets(buf, sizeof(buf), f)) {
+		line++;
+		if (line == 1) {
+			if (os_strncmp(buf, HOSTAPD_PSK_CACHE_HEADER,
+				       os_strlen(HOSTAPD_PSK_CACHE_HEADER)) != 0)
+				break;
+			continue;
+		}
+
+		e = hostapd_psk_cache_add(cache);
+		if (!e)
+			break;
+		if (os_strlen(buf) < 2 * SHA256_MAC_LEN + 1 + 2 * PMK_LEN ||
+		    buf[2 * SHA256_MAC_LEN] != ' ' ||
+		    hexstr2bin(buf, e->key, SHA256_MAC_LEN) ||
+		    hexstr2bin(&buf[2 * SHA256_MAC_LEN + 1], e->psk,
+			       PMK_LEN)) {
+			wpa_printf(MSG_INFO,
+				   "Invalid entry on line %d in WPA PSK cache '%s' - ignore the cache",
+				   line, fname);
+			cache->num = 0;
+			cache->modified = true;
+			break;
+		}
+	}
+
+	forced_memzero(buf, sizeof(buf));
+	fclose(f);
+
+	qsort(cache->entry, cache->num, sizeof(cache->entry[0]),
+	      hostapd_psk_cache_compar);
+	cache->num_sorted = cache->num;
+	wpa_printf(MSG_DEBUG, "Loaded %zu entries from WPA PSK cache '%s'",
+		   cache->num, fname);
+
+	return cache;
+}
+
+
+static void hostapd_psk_cache_save(struct hostapd_psk_cache *cache,
+				   const char *fname)
+{
+	struct hostapd_psk_cache_entry *e, *prev = NULL;
+	char *tmp;
+	size_t i, len, count = 0;
+	FILE *f;
+	int ret;
+#ifndef _WIN32
+	int fd;
+#endif /* _WIN32 */
+
+	for (i = 0; i < cache->num_sorted; i++) {
+		if (!cache->entry[i].used)
+			cache->modified = true;
+	}
+	if (!cache->modified)
+		return;
+
+	qsort(cache->entry, cache->num, sizeof(cache->entry[0]),
+	      hostapd_psk_cache_compar);
+
+	len = os_strlen(fname) + 5;
+	tmp = os_malloc(len);
+	if (!tmp)
+		return;
+	os_snprintf(tmp, len, "%s.tmp", fname);
+
+#ifndef _WIN32
+	/*
+	 * Create the file with restrictive permissions and do not follow a
+	 * symlink left at the temporary file name. A stale file from an earlier
+	 * failure is removed first.
+	 */
+	unlink(tmp);
+	fd = open(tmp, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW,
+		  S_IRUSR | S_IWUSR);
+	f = fd >= 0 ? fdopen(fd, "w") : NULL;
+	if (!f && fd >= 0)
+		close(fd);
+#else /* _WIN32 */
+	f = fopen(tmp, "w");
+#endif /* _WIN32 */
+	if (!f) {
+		wpa_printf(MSG_INFO, "Could not write WPA PSK cache '%s'",
+			   tmp);
+		os_free(tmp);
+		return;
+	}
+
+	fprintf(f, HOSTAPD_PSK_CACHE_HEADER "\n");
+	for (i = 0; i < cache->num; i++) {
+		e = &cache->entry[i];
+		if (!e->used ||
+		    (prev && os_memcmp(prev->key, e->key, SHA256_MAC_LEN) == 0))
+			continue;
+		prev = e;
+		count++;
+		for (len = 0; len < SHA256_MAC_LEN; len++)
+			fprintf(f, "%02x", e->key[len]);
+		fprintf(f, " ");
+		for (len = 0; len < PMK_LEN; len++)
+			fprintf(f, "%02x", e->psk[len]);
+		fprintf(f, "\n");
+	}
+
+	ret = fclose(f);
+	if (ret == 0 && rename(tmp, fname) == 0) {
+		wpa_printf(MSG_DEBUG, "Wrote %zu entries to WPA PSK cache '%s'",
+			   count, fname);
+	} else {
+		wpa_printf(MSG_INFO, "Could not update WPA PSK cache '%s'",
+			   fname);
+		unlink(tmp);
+	}
+	os_free(tmp);
+}
+
+
+/* Returns 1 if found from the cache, 0 if not, or -1 on failure */
+static int hostapd_psk_cache_lookup(struct hostapd_psk_cache *cache,
+				    const struct hostapd_ssid *ssid,
+				    const char *passphrase, u8 *key, u8 *psk)
+{
+	struct hostapd_psk_cache_entry *e;
+	const u8 *addr[3];
+	size_t len[3];
+	u8 ssid_len = ssid->ssid_len;
+
+	addr[0] = &ssid_len;
+	len[0] = 1;
+	addr[1] = ssid->ssid;
+	len[1] = ssid->ssid_len;
+	addr[2] = (const u8 *) passphrase;
+	len[2] = os_strlen(passphrase);
+	if (sha256_vector(3, addr, len, key) < 0)
+		return -1;
+	e = bsearch(key, cache->entry, cache->num_sorted,
+		    sizeof(cache->entry[0]), hostapd_psk_cache_compar);
+	if (!e)
+		return 0;
+	e->used = true;
+	os_memcpy(psk, e->psk, PMK_LEN);
+	return 1;
+}
+
+
+static void hostapd_psk_cache_store(struct hostapd_psk_cache *cache,
+				    const u8 *key, const u8 *psk)
+{
+	struct hostapd_psk_cache_entry *e;
+
+	e = hostapd_psk_cache_add(cache);
+	if (!e)
+		return;
+	os_memcpy(e->key, key, SHA256_MAC_LEN);
+	os_memcpy(e->psk, psk, PMK_LEN);
+	e->used = true;
+	cache->modified = true;
+}
+
+
+static int hostapd_psk_from_passphrase(struct hostapd_psk_cache *cache,
+				       const struct hostapd_ssid *ssid,
+				       const char *passphrase, u8 *psk)
+{
+	u8 key[SHA256_MAC_LEN];
+	int res;
+
+	if (cache) {
+		res = hostapd_psk_cache_lookup(cache, ssid, passphrase, key,
+					       psk);
+		if (res < 0)
+			return -1;
+		if (res > 0) {
+			forced_memzero(key, sizeof(key));
+			return 0;
+		}
+	}
+
+	if (pbkdf2_sha1(passphrase, ssid->ssid, ssid->ssid_len, 4096,
+			psk, PMK_LEN) < 0) {
+		forced_memzero(key, sizeof(key));
+		return -1;
+	}
+
+	if (cache)
+		hostapd_psk_cache_store(cache, key, psk);
+	forced_memzero(key, sizeof(key));
+
+	return 0;
+}
+
+
+#if defined(CONFIG_WPA_PSK_THREADS) && !defined(WPA_TRACE)
+/*
+ * WPA_TRACE builds derive the PSKs in the main thread since the allocation
+ * tracking and failure testing there are not thread safe.
+ */
+#define HOSTAPD_PSK_THREADS
+#define HOSTAPD_PSK_MAX_THREADS 8
+#endif /* CONFIG_WPA_PSK_THREADS && !WPA_TRACE */
+
+/* Passphrase from wpa_psk_file waiting for PBKDF2 */
+struct hostapd_psk_derive {
+	struct hostapd_wpa_psk *psk;
+	char *passphrase;
+	u8 key[SHA256_MAC_LEN]; /* PSK cache key */
+	int line;
+	int res;
+};
+
+struct hostapd_psk_derive_list {
+	const struct hostapd_ssid *ssid;
+	struct hostapd_psk_derive *job;
+	size_t num, alloc;
+#ifdef HOSTAPD_PSK_THREADS
+	pthread_mutex_t lock;
+	size_t next;
+#endif /* HOSTAPD_PSK_THREADS */
+};
+
+
+static int hostapd_psk_queue(struct hostapd_psk_derive_list *list,
+			     struct hostapd_psk_cache *cache,
+			     const char *passphrase,
+			     struct hostapd_wpa_psk *psk, int line)
+{
+	struct hostapd_psk_derive *job, tmp;
+	size_t alloc;
+	int res;
+
+	os_memset(&tmp, 0, sizeof(tmp));
+	if (cache) {
+		res = hostapd_psk_cache_lookup(cache, list->ssid, passphrase,
+					       tmp.key, psk->psk);
+		if (res < 0)
+			return -1;
+		if (res > 0) {
+			forced_memzero(tmp.key, sizeof(tmp.key));
+			return 0;
+		}
+	}
+
+	if (list->num == list->alloc) {
+		alloc = list->alloc ? 2 * list->alloc : 16;
+		job = os_realloc_array(list->job, alloc, sizeof(*job));
+		if (!job)
+			return -1;
+		list->job = job;
+		list->alloc = alloc;
+	}
+
+	tmp.passphrase = os_strdup(passphrase);
+	if (!tmp.passphrase)
+		return -1;
+	tmp.psk = psk;
+	tmp.line = line;
+	list->job[list->num++] = tmp;
+	forced_memzero(&tmp, sizeof(tmp));
+	return 0;
+}
+
+
+static void hostapd_psk_derive_job(const struct hostapd_ssid *ssid,
+				   struct hostapd_psk_derive *job)
+{
+	job->res = pbkdf2_sha1(job->passphrase, ssid->ssid, ssid->ssid_len,
+			       4096, job->psk->psk, PMK_LEN);
+}
+
+
+#ifdef HOSTAPD_PSK_THREADS
+static void * hostapd_psk_derive_thread(void *ctx)
+{
+	struct hostapd_psk_derive_list *list = ctx;
+	size_t i;
+
+	for (;;) {
+		pthread_mutex_lock(&list->lock);
+		i = list->next++;
+		pthread_mutex_unlock(&list->lock);
+		if (i >= list->num)
+			break;
+		hostapd_psk_derive_job(list->ssid, &list->job[i]);
+	}
+
+	return NULL;
+}
+#endif /* HOSTAPD_PSK_THREADS */
+
+
+static void hostapd_psk_derive_all(struct hostapd_psk_derive_list *list)
+{
+	size_t i;
+#ifdef HOSTAPD_PSK_THREADS
+	pthread_t tid[HOSTAPD_PSK_MAX_THREADS - 1];
+	size_t num_threads;
+	long cpus;
+
+	/*
+	 * The main thread processes the list together with up to
+	 * HOSTAPD_PSK_MAX_THREADS - 1 worker threads. If a thread cannot be
+	 * created, the already running threads process the whole list.
+	 */
+	cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if (list->num > 1 && cpus > 1 &&
+	    pthread_mutex_init(&list->lock, NULL) == 0) {
+		num_threads = cpus < HOSTAPD_PSK_MAX_THREADS ?
+			(size_t) cpus : HOSTAPD_PSK_MAX_THREADS;
+		if (num_threads > list->num)
+			num_threads = list->num;
+		list->next = 0;
+		for (i = 0; i + 1 < num_threads; i++) {
+			if (pthread_create(&tid[i], NULL,
+					   hostapd_psk_derive_thread, list))
+				break;
+		}
+		wpa_printf(MSG_DEBUG,
+			   "Deriving %zu PSKs from passphrases in %zu threads",
+			   list->num, i + 1);
+		hostapd_psk_derive_thread(list);
+		while (i > 0)
+			pthread_join(tid[--i], NULL);
+		pthread_mutex_destroy(&list->lock);
+		return;
+	}
+#endif /* HOSTAPD_PSK_THREADS */
+
+	for (i = 0; i < list->num; i++)
+		hostapd_psk_derive_job(list->ssid, &list->job[i]);
+}
+
+
+/* Derive the queued PSKs and remove the entries for which that failed */
+static int hostapd_psk_derive_finish(struct hostapd_psk_derive_list *list,
+				     struct hostapd_psk_cache *cache,
+				     struct hostapd_ssid *ssid,
+				     const char *fname)
+{
+	struct hostapd_psk_derive *job;
+	struct hostapd_wpa_psk **pos;
+	size_t i;
+	int ret = 0;
+
+	hostapd_psk_derive_all(list);
+
+	for (i = 0; i < list->num; i++) {
+		job = &list->job[i];
+		if (job->res == 0) {
+			if (cache)
+				hostapd_psk_cache_store(cache, job->key,
+							job->psk->psk);
+		} else {
+			wpa_printf(MSG_ERROR,
+				   "Invalid PSK '%s' on line %d in '%s'",
+				   job->passphrase, job->line, fname);
+			for (pos = &ssid->wpa_psk; *pos; pos = &(*pos)->next) {
+				if (*pos == job->psk) {
+					*pos = job->psk->next;
+					bin_clear_free(job->psk,
+						       sizeof(*job->psk));
+					break;
+				}
+			}
+			ret = -1;
+		}
+		str_clear_free(job->passphrase);
+	}
+
+	bin_clear_free(list->job, list->alloc * sizeof(list->job[0]));
+	return ret;
+}
+
+
 static int hostapd_config_read_wpa_psk(const char *fname,
-				       struct hostapd_ssid *ssid)
+				       struct hostapd_ssid *ssid,
+				       struct hostapd_psk_cache *cache)
 {
 	FILE *f;
 	char buf[128], *pos;
@@ -317,10 +779,14 @@ static int hostapd_config_read_wpa_psk(const char *fname,
 	int line = 0, ret = 0, len, ok;
 	u8 addr[ETH_ALEN];
 	struct hostapd_wpa_psk *psk;
+	struct hostapd_psk_derive_list list;
 
 	if (!fname)
 		return 0;
 
+	os_memset(&list, 0, sizeof(list));
+	list.ssid = ssid;
+
 	f = fopen(fname, "r");
 	if (!f) {
 		wpa_printf(MSG_ERROR, "WPA PSK file '%s' not found.", fname);
@@ -407,14 +873,26 @@ static int hostapd_config_read_wpa_psk(const char *fname,
 			break;
 		}
 
+		if (keyid) {
+			len = os_strlcpy(psk->keyid, keyid, sizeof(psk->keyid));
+			if ((size_t) len >= sizeof(psk->keyid)) {
+				wpa_printf(MSG_ERROR,
+					   "PSK keyid too long on line %d in '%s'",
+					   line, fname);
+				os_free(psk);
+				ret = -1;
+				break;
+			}
+		}
+
+		/* PSKs from passphrases are derived after reading the file */
 		ok = 0;
 		len = os_strlen(pos);
 		if (len == 2 * PMK_LEN &&
 		    hexstr2bin(pos, psk->psk, PMK_LEN) == 0)
 			ok = 1;
 		else if (len >= 8 && len < 64 &&
-			 pbkdf2_sha1(pos, ssid->ssid, ssid->ssid_len,
-				     4096, psk->psk, PMK_LEN) == 0)
+			 hostapd_psk_queue(&list, cache, pos, psk, line) == 0)
 			ok = 1;
 		if (!ok) {
 			wpa_printf(MSG_ERROR,
@@ -425,18 +903,6 @@ static int hostapd_config_read_wpa_psk(const char *fname,
 			break;
 		}
 
-		if (keyid) {
-			len = os_strlcpy(psk->keyid, keyid, sizeof(psk->keyid));
-			if ((size_t) len >= sizeof(psk->keyid)) {
-				wpa_printf(MSG_ERROR,
-					   "PSK keyid too long on line %d in '%s'",
-					   line, fname);
-				os_free(psk);
-				ret = -1;
-				break;
-			}
-		}
-
 		psk->wps = wps;
 
 		psk->next = ssid->wpa_psk;
@@ -445,11 +911,15 @@ static int hostapd_config_read_wpa_psk(const char *fname,
 
 	fclose(f);
 
+	if (hostapd_psk_derive_finish(&list, cache, ssid, fname) < 0)
+		ret = -1;
+
 	return ret;
 }
 
 
-static int hostapd_derive_psk(struct hostapd_ssid *ssid)
+static int hostapd_derive_psk(struct hostapd_ssid *ssid,
+			      struct hostapd_psk_cache *cache)
 {
 	ssid->wpa_psk = os_zalloc(sizeof(struct hostapd_wpa_psk));
 	if (ssid->wpa_psk == NULL) {
@@ -461,9 +931,8 @@ static int hostapd_derive_psk(struct hostapd_ssid *ssid)
 	wpa_hexdump_ascii_key(MSG_DEBUG, "PSK (ASCII passphrase)",
 			      (u8 *) ssid->wpa_passphrase,
 			      os_strlen(ssid->wpa_passphrase));
-	if (pbkdf2_sha1(ssid->wpa_passphrase,
-			ssid->ssid, ssid->ssid_len,
-			4096, ssid->wpa_psk->psk, PMK_LEN) != 0) {
+	if (hostapd_psk_from_passphrase(cache, ssid, ssid->wpa_passphrase,
+					ssid->wpa_psk->psk) < 0) {
 		wpa_printf(MSG_ERROR, "Error in pbkdf2_sha1()");
 		return -1;
 	}
@@ -497,6 +966,7 @@ int hostapd_setup_sae_pt(struct hostapd_bss_config *conf)
 					 NULL);
 		if (!ssid->pt)
 			return -1;
+		sae_pt_precompute(ssid->pt);
 	}
 
 	for (pw = conf->sae_passwords; pw; pw = pw->next) {
@@ -508,6 +978,7 @@ int hostapd_setup_sae_pt(struct hostapd_bss_config *conf)
 				       pw->identifier);
 		if (!pw->pt)
 			return -1;
+		sae_pt_precompute(pw->pt);
 	}
 #endif /* CONFIG_SAE */
 
@@ -518,10 +989,20 @@ int hostapd_setup_sae_pt(struct hostapd_bss_config *conf)
 int hostapd_setup_wpa_psk(struct hostapd_bss_config *conf)
 {
 	struct hostapd_ssid *ssid = &conf->ssid;
+	struct hostapd_psk_cache *cache = NULL;
+	int ret = -1;
+
+	hostapd_wpa_psk_index_free(ssid);
 
 	if (hostapd_setup_sae_pt(conf) < 0)
 		return -1;
 
+	if (ssid->wpa_psk_cache && ssid->wpa_psk_file) {
+		cache = hostapd_psk_cache_load(ssid->wpa_psk_cache);
+		if (!cache)
+			return -1;
+	}
+
 	if (ssid->wpa_passphrase != NULL) {
 		if (ssid->wpa_psk != NULL) {
 			wpa_printf(MSG_DEBUG, "Using pre-configured WPA PSK "
@@ -529,13 +1010,21 @@ int hostapd_setup_wpa_psk(struct hostapd_bss_config *conf)
 		} else {
 			wpa_printf(MSG_DEBUG, "Deriving WPA PSK based on "
 				   "passphrase");
-			if (hostapd_derive_psk(ssid) < 0)
-				return -1;
+			if (hostapd_derive_psk(ssid, cache) < 0)
+				goto out;
 		}
 		ssid->wpa_psk->group = 1;
 	}
 
-	return hostapd_config_read_wpa_psk(ssid->wpa_psk_file, &conf->ssid);
+	ret = hostapd_config_read_wpa_psk(ssid->wpa_psk_file, &conf->ssid,
+					  cache);
+	if (ret == 0 && cache)
+		hostapd_psk_cache_save(cache, ssid->wpa_psk_cache);
+	if (ret == 0)
+		hostapd_wpa_psk_index_update(ssid);
+out:
+	hostapd_psk_cache_free(cache);
+	return ret;
 }
 
 
@@ -678,16 +1167,17 @@ static void hostapd_config_free_wep(struct hostapd_wep_keys *keys)
 #endif /* CONFIG_WEP */
 
 
-void hostapd_config_clear_wpa_psk(struct hostapd_wpa_psk **l)
+void hostapd_config_clear_wpa_psk(struct hostapd_ssid *ssid)
 {
 	struct hostapd_wpa_psk *psk, *tmp;
 
-	for (psk = *l; psk;) {
+	hostapd_wpa_psk_index_free(ssid);
+	for (psk = ssid->wpa_psk; psk;) {
 		tmp = psk;
 		psk = psk->next;
 		bin_clear_free(tmp, sizeof(*tmp));
 	}
-	*l = NULL;
+	ssid->wpa_psk = NULL;
 }
 
 
@@ -763,15 +1253,17 @@ void hostapd_config_free_bss(struct hostapd_bss_config *conf)
 	if (conf == NULL)
 		return;
 
-	hostapd_config_clear_wpa_psk(&conf->ssid.wpa_psk);
+	hostapd_config_clear_wpa_psk(&conf->ssid);
 
 	str_clear_free(conf->ssid.wpa_passphrase);
 	os_free(conf->ssid.wpa_psk_file);
+	os_free(conf->ssid.wpa_psk_cache);
 #ifdef CONFIG_WEP
 	hostapd_config_free_wep(&conf->ssid.wep);
 #endif /* CONFIG_WEP */
 #ifdef CONFIG_FULL_DYNAMIC_VLAN
 	os_free(conf->ssid.vlan_tagged_interface);
+	os_free(conf->ssid.vlan_pool.range);
 #endif /* CONFIG_FULL_DYNAMIC_VLAN */
 #ifdef CONFIG_SAE
 	sae_deinit_pt(conf->ssid.pt);
@@ -856,7 +1348,7 @@ void hostapd_config_free_bss(struct hostapd_bss_config *conf)
 	os_free(conf->ap_pin);
 	os_free(conf->extra_cred);
 	os_free(conf->ap_settings);
-	hostapd_config_clear_wpa_psk(&conf->multi_ap_backhaul_ssid.wpa_psk);
+	hostapd_config_clear_wpa_psk(&conf->multi_ap_backhaul_ssid);
 	str_clear_free(conf->multi_ap_backhaul_ssid.wpa_passphrase);
 	os_free(conf->upnp_iface);
 	os_free(conf->friendly_name);
@@ -1103,12 +1595,277 @@ const char * hostapd_get_vlan_id_ifname(struct hostapd_vlan *vlan, int vlan_id)
 }
 
 
+#define WPA_PSK_HASH_SIZE 256
+#define WPA_PSK_HASH(addr) ((addr)[5])
+
+/*
+ * Lookup index for the wpa_psk list. Station specific entries are hashed by
+ * the station address and the P2P Device Address and the group PSKs are
+ * stored in list order. A second copy of the group PSK array is sorted by entry
+ * address to find the position of prev_psk in hostapd_get_psk() without
+ * walking the list.
+ */
+struct hostapd_wpa_psk_index {
+	struct hostapd_wpa_psk *addr_hash[WPA_PSK_HASH_SIZE];
+	struct hostapd_wpa_psk *p2p_hash[WPA_PSK_HASH_SIZE];
+	struct hostapd_wpa_psk **group;
+	struct hostapd_wpa_psk **group_sorted;
+	size_t num_group;
+};
+
+
+void hostapd_wpa_psk_index_free(struct hostapd_ssid *ssid)
+{
+	struct hostapd_wpa_psk_index *idx = ssid->wpa_psk_index;
+
+	if (!idx)
+		return;
+	os_free(idx->group);
+	os_free(idx->group_sorted);
+	os_free(idx);
+	ssid->wpa_psk_index = NULL;
+}
+
+
+static int hostapd_wpa_psk_addr_cmp(const void *a, const void *b)
+{
+	uintptr_t pa = (uintptr_t) *(struct hostapd_wpa_psk * const *) a;
+	uintptr_t pb = (uintptr_t) *(struct hostapd_wpa_psk * const *) b;
+
+	if (pa < pb)
+		return -1;
+	return pa > pb;
+}
+
+
+/**
+ * hostapd_wpa_psk_index_update - Rebuild the lookup index for wpa_psk
+ * @ssid: SSID configuration
+ *
+ * This needs to be called after ssid->wpa_psk is modified other than with
+ * hostapd_wpa_psk_add(), hostapd_wpa_psk_remove_sta(), or
+ * hostapd_config_clear_wpa_psk(). If the index cannot be allocated,
+ * hostapd_get_psk() falls back to walking the list.
+ */
+void hostapd_wpa_psk_index_update(struct hostapd_ssid *ssid)
+{
+	struct hostapd_wpa_psk_index *idx;
+	struct hostapd_wpa_psk *psk, **pos;
+	size_t num_group = 0;
+
+	hostapd_wpa_psk_index_free(ssid);
+
+	for (psk = ssid->wpa_psk; psk; psk = psk->next) {
+		if (psk->group)
+			num_group++;
+	}
+
+	idx = os_zalloc(sizeof(*idx));
+	if (!idx)
+		return;
+	if (num_group) {
+		idx->group = os_calloc(num_group, sizeof(*idx->group));
+		idx->group_sorted = os_calloc(num_group,
+					      sizeof(*idx->group_sorted));
+		if (!idx->group || !idx->group_sorted) {
+			os_free(idx->group);
+			os_free(idx->group_sorted);
+			os_free(idx);
+			return;
+		}
+	}
+
+	for (psk = ssid->wpa_psk; psk; psk = psk->next) {
+		psk->hnext = NULL;
+		psk->p2p_hnext = NULL;
+		if (psk->group) {
+			psk->group_pos = idx->num_group;
+			idx->group[idx->num_group++] = psk;
+			continue;
+		}
+
+		/* Keep the list order within each hash bucket */
+		if (!is_zero_ether_addr(psk->addr)) {
+			pos = &idx->addr_hash[WPA_PSK_HASH(psk->addr)];
+			while (*pos)
+				pos = &(*pos)->hnext;
+			*pos = psk;
+		}
+		if (!is_zero_ether_addr(psk->p2p_dev_addr)) {
+			pos = &idx->p2p_hash[WPA_PSK_HASH(psk->p2p_dev_addr)];
+			while (*pos)
+				pos = &(*pos)->p2p_hnext;
+			*pos = psk;
+		}
+	}
+
+	if (num_group) {
+		os_memcpy(idx->group_sorted, idx->group,
+			  num_group * sizeof(*idx->group));
+		qsort(idx->group_sorted, num_group, sizeof(*idx->group_sorted),
+		      hostapd_wpa_psk_addr_cmp);
+	}
+
+	ssid->wpa_psk_index = idx;
+}
+
+
+static bool hostapd_wpa_psk_sta_match(const struct hostapd_wpa_psk *psk,
+				      const u8 *addr, const u8 *p2p_dev_addr)
+{
+	if (psk->group)
+		return false;
+	if (addr)
+		return os_memcmp(psk->addr, addr, ETH_ALEN) == 0;
+	if (!p2p_dev_addr)
+		return false;
+	return os_memcmp(psk->p2p_dev_addr, p2p_dev_addr, ETH_ALEN) == 0;
+}
+
+
+/**
+ * hostapd_wpa_psk_add - Add an entry to the wpa_psk list
+ * @ssid: SSID configuration
+ * @psk: Entry to add; the list takes ownership of it
+ *
+ * The entry is added to the head of the list and the lookup index is rebuilt.
+ */
+void hostapd_wpa_psk_add(struct hostapd_ssid *ssid, struct hostapd_wpa_psk *psk)
+{
+	psk->next = ssid->wpa_psk;
+	ssid->wpa_psk = psk;
+	hostapd_wpa_psk_index_update(ssid);
+}
+
+
+/**
+ * hostapd_wpa_psk_remove_sta - Remove station specific wpa_psk entries
+ * @ssid: SSID configuration
+ * @addr: Station address or %NULL to match by @p2p_dev_addr
+ * @p2p_dev_addr: P2P Device Address (used if @addr is %NULL)
+ * Returns: Number of removed entries
+ *
+ * The lookup index is rebuilt before the removed entries are freed.
+ */
+int hostapd_wpa_psk_remove_sta(struct hostapd_ssid *ssid, const u8 *addr,
+			       const u8 *p2p_dev_addr)
+{
+	struct hostapd_wpa_psk *psk, **prev, *removed = NULL;
+	int num = 0;
+
+	prev = &ssid->wpa_psk;
+	while ((psk = *prev)) {
+		if (!hostapd_wpa_psk_sta_match(psk, addr, p2p_dev_addr)) {
+			prev = &psk->next;
+			continue;
+		}
+		*prev = psk->next;
+		psk->next = removed;
+		removed = psk;
+		num++;
+	}
+
+	if (!num)
+		return 0;
+
+	hostapd_wpa_psk_index_update(ssid);
+	while (removed) {
+		psk = removed;
+		removed = removed->next;
+		bin_clear_free(psk, sizeof(*psk));
+	}
+
+	return num;
+}
+
+
+/* Next station specific entry from the index after @psk (or the first one) */
+static struct hostapd_wpa_psk *
+hostapd_wpa_psk_sta_next(const struct hostapd_wpa_psk_index *idx,
+			 struct hostapd_wpa_psk *psk, const u8 *addr,
+			 const u8 *p2p_dev_addr)
+{
+	if (addr)
+		psk = psk ? psk->hnext : idx->addr_hash[WPA_PSK_HASH(addr)];
+	else
+		psk = psk ? psk->p2p_hnext :
+			idx->p2p_hash[WPA_PSK_HASH(p2p_dev_addr)];
+
+	while (psk && !hostapd_wpa_psk_sta_match(psk, addr, p2p_dev_addr))
+		psk = addr ? psk->hnext : psk->p2p_hnext;
+
+	return psk;
+}
+
+
+static struct hostapd_wpa_psk *
+hostapd_get_psk_indexed(const struct hostapd_wpa_psk_index *idx,
+			const u8 *addr, const u8 *p2p_dev_addr,
+			const u8 *prev_psk)
+{
+	struct hostapd_wpa_psk *psk;
+	size_t lo, hi, mid;
+
+	psk = hostapd_wpa_psk_sta_next(idx, NULL, addr, p2p_dev_addr);
+	if (!prev_psk) {
+		if (psk)
+			return psk;
+		goto first_group;
+	}
+
+	for (; psk; psk = hostapd_wpa_psk_sta_next(idx, psk, addr,
+						   p2p_dev_addr)) {
+		if (psk->psk != prev_psk)
+			continue;
+		psk = hostapd_wpa_psk_sta_next(idx, psk, addr, p2p_dev_addr);
+		if (psk)
+			return psk;
+		goto first_group;
+	}
+
+	/* prev_psk may not be from this list, so do not dereference it */
+	lo = 0;
+	hi = idx->num_group;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		psk = idx->group_sorted[mid];
+		if ((uintptr_t) psk->psk == (uintptr_t) prev_psk) {
+			if (psk->group_pos + 1 < idx->num_group)
+				return idx->group[psk->group_pos + 1];
+			return NULL;
+		}
+		if ((uintptr_t) psk->psk < (uintptr_t) prev_psk)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return NULL;
+
+first_group:
+	return idx->num_group ? idx->group[0] : NULL;
+}
+
+
+/**
+ * hostapd_get_psk - Get the next PSK that a station may be using
+ * @conf: BSS configuration
+ * @addr: Station address
+ * @p2p_dev_addr: P2P Device Address of the station or %NULL
+ * @prev_psk: Previously returned PSK or %NULL to get the first one
+ * @vlan_id: Buffer for returning the VLAN ID of the entry or %NULL
+ * Returns: Pointer to the PSK or %NULL if no more PSKs are available
+ *
+ * Entries configured for the station address (or the P2P Device Address) are
+ * returned first, followed by the group PSKs, both in list order.
+ */
 const u8 * hostapd_get_psk(const struct hostapd_bss_config *conf,
 			   const u8 *addr, const u8 *p2p_dev_addr,
 			   const u8 *prev_psk, int *vlan_id)
 {
-	struct hostapd_wpa_psk *psk;
+	struct hostapd_wpa_psk *psk = NULL;
 	int next_ok = prev_psk == NULL;
+	int pass;
 
 	if (vlan_id)
 		*vlan_id = 0;
@@ -1124,23 +1881,33 @@ const u8 * hostapd_get_psk(const struct hostapd_bss_config *conf,
 			   MAC2STR(addr), prev_psk);
 	}
 
-	for (psk = conf->ssid.wpa_psk; psk != NULL; psk = psk->next) {
-		if (next_ok &&
-		    (psk->group ||
-		     (addr && os_memcmp(psk->addr, addr, ETH_ALEN) == 0) ||
-		     (!addr && p2p_dev_addr &&
-		      os_memcmp(psk->p2p_dev_addr, p2p_dev_addr, ETH_ALEN) ==
-		      0))) {
-			if (vlan_id)
-				*vlan_id = psk->vlan_id;
-			return psk->psk;
+	if (conf->ssid.wpa_psk_index) {
+		psk = hostapd_get_psk_indexed(conf->ssid.wpa_psk_index, addr,
+					      p2p_dev_addr, prev_psk);
+		goto out;
+	}
+
+	/* No index available; station specific entries first, then groups */
+	for (pass = 0; pass < 2; pass++) {
+		for (psk = conf->ssid.wpa_psk; psk; psk = psk->next) {
+			if (pass == 0 ?
+			    !hostapd_wpa_psk_sta_match(psk, addr,
+						       p2p_dev_addr) :
+			    !psk->group)
+				continue;
+			if (next_ok)
+				goto out;
+			if (psk->psk == prev_psk)
+				next_ok = 1;
 		}
-
-		if (psk->psk == prev_psk)
-			next_ok = 1;
 	}
 
-	return NULL;
+out:
+	if (!psk)
+		return NULL;
+	if (vlan_id)
+		*vlan_id = psk->vlan_id;
+	return psk->psk;
 }
 
 
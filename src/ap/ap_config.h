@@ -109,8 +109,10 @@ struct hostapd_ssid {
 	secpolicy security_policy;
 
 	struct hostapd_wpa_psk *wpa_psk;
+	struct hostapd_wpa_psk_index *wpa_psk_index;
 	char *wpa_passphrase;
 	char *wpa_psk_file;
+	char *wpa_psk_cache;
 	struct sae_pt *pt;
 
 #ifdef CONFIG_WEP
@@ -128,6 +130,7 @@ struct hostapd_ssid {
 	int per_sta_vif;
 #ifdef CONFIG_FULL_DYNAMIC_VLAN
 	char *vlan_tagged_interface;
+	struct wpa_freq_range_list vlan_pool; /* pre-provisioned VLAN IDs */
 #endif /* CONFIG_FULL_DYNAMIC_VLAN */
 };
 
@@ -170,6 +173,11 @@ struct hostapd_wpa_psk {
 	u8 addr[ETH_ALEN];
 	u8 p2p_dev_addr[ETH_ALEN];
 	int vlan_id;
+
+	/* Lookup index (struct hostapd_wpa_psk_index) linkage */
+	struct hostapd_wpa_psk *hnext;
+	struct hostapd_wpa_psk *p2p_hnext;
+	size_t group_pos;
 };
 
 struct hostapd_eap_user {
@@ -609,6 +617,7 @@ struct hostapd_bss_config {
 	int osen;
 	int proxy_arp;
 	int na_mcast_to_ucast;
+	unsigned int proxy_arp_mcast_to_ucast_limit;
 
 #ifdef CONFIG_HS20
 	int hs20;
@@ -1006,6 +1015,8 @@ struct hostapd_config {
 	int ap_table_max_size;
 	int ap_table_expiration_time;
 
+	unsigned int housekeeping_timer_slack; /* msec */
+
 	unsigned int track_sta_max_num;
 	unsigned int track_sta_max_age;
 
@@ -1247,7 +1258,7 @@ void hostapd_config_defaults_bss(struct hostapd_bss_config *bss);
 void hostapd_config_free_radius_attr(struct hostapd_radius_attr *attr);
 void hostapd_config_free_eap_user(struct hostapd_eap_user *user);
 void hostapd_config_free_eap_users(struct hostapd_eap_user *user);
-void hostapd_config_clear_wpa_psk(struct hostapd_wpa_psk **p);
+void hostapd_config_clear_wpa_psk(struct hostapd_ssid *ssid);
 void hostapd_config_free_bss(struct hostapd_bss_config *conf);
 void hostapd_config_free(struct hostapd_config *conf);
 int hostapd_maclist_found(struct mac_acl_entry *list, int num_entries,
@@ -1256,6 +1267,11 @@ int hostapd_rate_found(int *list, int rate);
 const u8 * hostapd_get_psk(const struct hostapd_bss_config *conf,
 			   const u8 *addr, const u8 *p2p_dev_addr,
 			   const u8 *prev_psk, int *vlan_id);
+void hostapd_wpa_psk_index_update(struct hostapd_ssid *ssid);
+void hostapd_wpa_psk_index_free(struct hostapd_ssid *ssid);
+void hostapd_wpa_psk_add(struct hostapd_ssid *ssid, struct hostapd_wpa_psk *psk);
+int hostapd_wpa_psk_remove_sta(struct hostapd_ssid *ssid, const u8 *addr,
+			       const u8 *p2p_dev_addr);
 int hostapd_setup_wpa_psk(struct hostapd_bss_config *conf);
 int hostapd_vlan_valid(struct hostapd_vlan *vlan,
 		       struct vlan_description *vlan_desc);
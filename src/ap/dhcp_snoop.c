@@ -10,6 +10,7 @@
 
 #include "utils/common.h"
 #include "common/dhcp.h"
+#include "common/wpa_ctrl.h"
 #include "l2_packet/l2_packet.h"
 #include "hostapd.h"
 #include "sta_info.h"
@@ -29,12 +30,57 @@ static const char * ipaddr_str(u32 addr)
 }
 
 
+static struct sta_info * ipaddr_get_sta(struct hostapd_data *hapd,
+					be32 ipaddr)
+{
+	struct sta_info *s;
+
+	s = hapd->ipv4_hash[IPV4_HASH(&ipaddr)];
+	while (s && s->ipaddr != ipaddr)
+		s = s->ipaddr_hnext;
+	return s;
+}
+
+
+static void ipaddr_hash_add(struct hostapd_data *hapd, struct sta_info *sta)
+{
+	sta->ipaddr_hnext = hapd->ipv4_hash[IPV4_HASH(&sta->ipaddr)];
+	hapd->ipv4_hash[IPV4_HASH(&sta->ipaddr)] = sta;
+}
+
+
+static void ipaddr_hash_del(struct hostapd_data *hapd, struct sta_info *sta)
+{
+	struct sta_info **s;
+
+	for (s = &hapd->ipv4_hash[IPV4_HASH(&sta->ipaddr)]; *s;
+	     s = &(*s)->ipaddr_hnext) {
+		if (*s == sta) {
+			*s = sta->ipaddr_hnext;
+			break;
+		}
+	}
+	sta->ipaddr_hnext = NULL;
+}
+
+
+void sta_ipaddr_del(struct hostapd_data *hapd, struct sta_info *sta)
+{
+	if (!sta->ipaddr)
+		return;
+
+	hostapd_drv_br_delete_ip_neigh(hapd, 4, (u8 *) &sta->ipaddr);
+	ipaddr_hash_del(hapd, sta);
+	sta->ipaddr = 0;
+}
+
+
 static void handle_dhcp(void *ctx, const u8 *src_addr, const u8 *buf,
 			size_t len)
 {
 	struct hostapd_data *hapd = ctx;
 	const struct bootp_pkt *b;
-	struct sta_info *sta;
+	struct sta_info *sta, *owner;
 	int exten_len;
 	const u8 *end, *pos;
 	int res, msgtype = 0, prefixlen = 32;
@@ -89,14 +135,8 @@ static void handle_dhcp(void *ctx, const u8 *src_addr, const u8 *buf,
 	}
 
 #ifdef CONFIG_HS20
-	if (hapd->conf->disable_dgaf && is_broadcast_ether_addr(buf)) {
-		for (sta = hapd->sta_list; sta; sta = sta->next) {
-			if (!(sta->flags & WLAN_STA_AUTHORIZED))
-				continue;
-			x_snoop_mcast_to_ucast_convert_send(hapd, sta,
-							    (u8 *) buf, len);
-		}
-	}
+	if (hapd->conf->disable_dgaf && is_broadcast_ether_addr(buf))
+		x_snoop_mcast_to_ucast_fanout(hapd, (u8 *) buf, len);
 #endif /* CONFIG_HS20 */
 
 	if (msgtype == DHCPACK) {
@@ -114,15 +154,28 @@ static void handle_dhcp(void *ctx, const u8 *src_addr, const u8 *buf,
 			   ipaddr_str(be_to_host32(b->your_ip)),
 			   prefixlen);
 
-		if (sta->ipaddr == b->your_ip)
+		owner = ipaddr_get_sta(hapd, b->your_ip);
+		if (owner == sta)
 			return;
 
+		if (owner) {
+			wpa_msg(hapd->msg_ctx, MSG_INFO, AP_STA_IP_CONFLICT
+				MACSTR " ip=%s prev_sta=" MACSTR,
+				MAC2STR(sta->addr),
+				ipaddr_str(be_to_host32(b->your_ip)),
+				MAC2STR(owner->addr));
+			sta_ipaddr_del(hapd, owner);
+		} else {
+			/* Replace a possibly stale entry from an earlier run */
+			hostapd_drv_br_delete_ip_neigh(hapd, 4,
+						       (u8 *) &b->your_ip);
+		}
+
 		if (sta->ipaddr != 0) {
 			wpa_printf(MSG_DEBUG,
 				   "dhcp_snoop: Removing IPv4 address %s from the ip neigh table",
 				   ipaddr_str(be_to_host32(sta->ipaddr)));
-			hostapd_drv_br_delete_ip_neigh(hapd, 4,
-						       (u8 *) &sta->ipaddr);
+			sta_ipaddr_del(hapd, sta);
 		}
 
 		res = hostapd_drv_br_add_ip_neigh(hapd, 4, (u8 *) &b->your_ip,
@@ -134,6 +187,7 @@ static void handle_dhcp(void *ctx, const u8 *src_addr, const u8 *buf,
 			return;
 		}
 		sta->ipaddr = b->your_ip;
+		ipaddr_hash_add(hapd, sta);
 	}
 }
 
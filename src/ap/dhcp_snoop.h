@@ -11,8 +11,12 @@
 
 #ifdef CONFIG_PROXYARP
 
+/* hapd->ipv4_hash index for an IPv4 address in network byte order */
+#define IPV4_HASH(addr) (((const u8 *) (addr))[3])
+
 int dhcp_snoop_init(struct hostapd_data *hapd);
 void dhcp_snoop_deinit(struct hostapd_data *hapd);
+void sta_ipaddr_del(struct hostapd_data *hapd, struct sta_info *sta);
 
 #else /* CONFIG_PROXYARP */
 
@@ -25,6 +29,11 @@ static inline void dhcp_snoop_deinit(struct hostapd_data *hapd)
 {
 }
 
+static inline void sta_ipaddr_del(struct hostapd_data *hapd,
+				  struct sta_info *sta)
+{
+}
+
 #endif /* CONFIG_PROXYARP */
 
 #endif /* DHCP_SNOOP_H */
@@ -26,6 +26,9 @@
 	((hapd->conf->oce & OCE_AP) && \
 	 (hapd->iface->drv_flags & WPA_DRIVER_FLAGS_OCE_AP))
 
+/* Size of the Proxy ARP hash tables for snooped IPv4 and IPv6 addresses */
+#define IP_HASH_SIZE 256
+
 struct wpa_ctrl_dst;
 struct radius_server_data;
 struct upnp_wps_device_sm;
@@ -336,6 +339,12 @@ struct hostapd_data {
 	struct l2_packet_data *sock_dhcp;
 	struct l2_packet_data *sock_ndisc;
 	bool x_snoop_initialized;
+	struct x_snoop_fanout *x_snoop_fanout;
+	/* STAs by snooped IP address for ownership and conflict checks */
+	struct sta_info *ipv4_hash[IP_HASH_SIZE];
+#ifdef CONFIG_IPV6
+	struct ip6addr *ipv6_hash[IP_HASH_SIZE];
+#endif /* CONFIG_IPV6 */
 #endif /* CONFIG_PROXYARP */
 #ifdef CONFIG_MESH
 	int num_plinks;
@@ -11,6 +11,7 @@
 #include <netinet/icmp6.h>
 
 #include "utils/common.h"
+#include "common/wpa_ctrl.h"
 #include "l2_packet/l2_packet.h"
 #include "hostapd.h"
 #include "sta_info.h"
@@ -22,6 +23,8 @@
 struct ip6addr {
 	struct in6_addr addr;
 	struct dl_list list;
+	struct ip6addr *hnext; /* next entry in hapd->ipv6_hash list */
+	struct sta_info *sta;
 };
 
 struct icmpv6_ndmsg {
@@ -38,7 +41,8 @@ struct icmpv6_ndmsg {
 #define NEIGHBOR_ADVERTISEMENT	136
 #define SOURCE_LL_ADDR		1
 
-static int sta_ip6addr_add(struct sta_info *sta, struct in6_addr *addr)
+static int sta_ip6addr_add(struct hostapd_data *hapd, struct sta_info *sta,
+			   struct in6_addr *addr)
 {
 	struct ip6addr *ip6addr;
 
@@ -47,50 +51,57 @@ static int sta_ip6addr_add(struct sta_info *sta, struct in6_addr *addr)
 		return -1;
 
 	os_memcpy(&ip6addr->addr, addr, sizeof(*addr));
+	ip6addr->sta = sta;
 
 	dl_list_add_tail(&sta->ip6addr, &ip6addr->list);
+	ip6addr->hnext = hapd->ipv6_hash[IPV6_HASH(addr)];
+	hapd->ipv6_hash[IPV6_HASH(addr)] = ip6addr;
 
 	return 0;
 }
 
 
-void sta_ip6addr_del(struct hostapd_data *hapd, struct sta_info *sta)
+static void ip6addr_free(struct hostapd_data *hapd, struct ip6addr *ip6addr)
 {
-	struct ip6addr *ip6addr, *prev;
+	struct ip6addr **s;
 
-	dl_list_for_each_safe(ip6addr, prev, &sta->ip6addr, struct ip6addr,
-			      list) {
-		hostapd_drv_br_delete_ip_neigh(hapd, 6, (u8 *) &ip6addr->addr);
-		os_free(ip6addr);
+	for (s = &hapd->ipv6_hash[IPV6_HASH(&ip6addr->addr)]; *s;
+	     s = &(*s)->hnext) {
+		if (*s == ip6addr) {
+			*s = ip6addr->hnext;
+			break;
+		}
 	}
+	dl_list_del(&ip6addr->list);
+	os_free(ip6addr);
 }
 
 
-static int sta_has_ip6addr(struct sta_info *sta, struct in6_addr *addr)
+void sta_ip6addr_del(struct hostapd_data *hapd, struct sta_info *sta)
 {
-	struct ip6addr *ip6addr;
+	struct ip6addr *ip6addr, *prev;
 
-	dl_list_for_each(ip6addr, &sta->ip6addr, struct ip6addr, list) {
-		if (ip6addr->addr.s6_addr32[0] == addr->s6_addr32[0] &&
-		    ip6addr->addr.s6_addr32[1] == addr->s6_addr32[1] &&
-		    ip6addr->addr.s6_addr32[2] == addr->s6_addr32[2] &&
-		    ip6addr->addr.s6_addr32[3] == addr->s6_addr32[3])
-			return 1;
+	dl_list_for_each_safe(ip6addr, prev, &sta->ip6addr, struct ip6addr,
+			      list) {
+		hostapd_drv_br_delete_ip_neigh(hapd, 6, (u8 *) &ip6addr->addr);
+		ip6addr_free(hapd, ip6addr);
 	}
-
-	return 0;
 }
 
 
-static void ucast_to_stas(struct hostapd_data *hapd, const u8 *buf, size_t len)
+static struct ip6addr * ip6addr_get(struct hostapd_data *hapd,
+				    const struct in6_addr *addr)
 {
-	struct sta_info *sta;
+	struct ip6addr *ip6addr;
 
-	for (sta = hapd->sta_list; sta; sta = sta->next) {
-		if (!(sta->flags & WLAN_STA_AUTHORIZED))
-			continue;
-		x_snoop_mcast_to_ucast_convert_send(hapd, sta, (u8 *) buf, len);
-	}
+	ip6addr = hapd->ipv6_hash[IPV6_HASH(addr)];
+	while (ip6addr &&
+	       (ip6addr->addr.s6_addr32[0] != addr->s6_addr32[0] ||
+		ip6addr->addr.s6_addr32[1] != addr->s6_addr32[1] ||
+		ip6addr->addr.s6_addr32[2] != addr->s6_addr32[2] ||
+		ip6addr->addr.s6_addr32[3] != addr->s6_addr32[3]))
+		ip6addr = ip6addr->hnext;
+	return ip6addr;
 }
 
 
@@ -101,6 +112,7 @@ static void handle_ndisc(void *ctx, const u8 *src_addr, const u8 *buf,
 	struct icmpv6_ndmsg *msg;
 	struct in6_addr saddr;
 	struct sta_info *sta;
+	struct ip6addr *owner;
 	int res;
 	char addrtxt[INET6_ADDRSTRLEN + 1];
 
@@ -127,12 +139,21 @@ static void handle_ndisc(void *ctx, const u8 *src_addr, const u8 *buf,
 			if (!sta)
 				return;
 
-			if (sta_has_ip6addr(sta, &saddr))
+			owner = ip6addr_get(hapd, &saddr);
+			if (owner && owner->sta == sta)
 				return;
 
 			if (inet_ntop(AF_INET6, &saddr, addrtxt,
 				      sizeof(addrtxt)) == NULL)
 				addrtxt[0] = '\0';
+			if (owner) {
+				wpa_msg(hapd->msg_ctx, MSG_INFO,
+					AP_STA_IP_CONFLICT MACSTR
+					" ip=%s prev_sta=" MACSTR,
+					MAC2STR(sta->addr), addrtxt,
+					MAC2STR(owner->sta->addr));
+				ip6addr_free(hapd, owner);
+			}
 			wpa_printf(MSG_DEBUG, "ndisc_snoop: Learned new IPv6 address %s for "
 				   MACSTR, addrtxt, MAC2STR(sta->addr));
 			hostapd_drv_br_delete_ip_neigh(hapd, 6, (u8 *) &saddr);
@@ -146,19 +167,19 @@ static void handle_ndisc(void *ctx, const u8 *src_addr, const u8 *buf,
 				return;
 			}
 
-			if (sta_ip6addr_add(sta, &saddr))
+			if (sta_ip6addr_add(hapd, sta, &saddr))
 				return;
 		}
 		break;
 #ifdef CONFIG_HS20
 	case ROUTER_ADVERTISEMENT:
 		if (hapd->conf->disable_dgaf)
-			ucast_to_stas(hapd, buf, len);
+			x_snoop_mcast_to_ucast_fanout(hapd, (u8 *) buf, len);
 		break;
 #endif /* CONFIG_HS20 */
 	case NEIGHBOR_ADVERTISEMENT:
 		if (hapd->conf->na_mcast_to_ucast)
-			ucast_to_stas(hapd, buf, len);
+			x_snoop_mcast_to_ucast_fanout(hapd, (u8 *) buf, len);
 		break;
 	default:
 		break;
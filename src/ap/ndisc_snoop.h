@@ -11,6 +11,9 @@
 
 #if defined(CONFIG_PROXYARP) && defined(CONFIG_IPV6)
 
+/* hapd->ipv6_hash index for an IPv6 address */
+#define IPV6_HASH(addr) (((const u8 *) (addr))[15])
+
 int ndisc_snoop_init(struct hostapd_data *hapd);
 void ndisc_snoop_deinit(struct hostapd_data *hapd);
 void sta_ip6addr_del(struct hostapd_data *hapd, struct sta_info *sta);
@@ -10,6 +10,7 @@
 
 #include "utils/common.h"
 #include "utils/eloop.h"
+#include "utils/obj_pool.h"
 #include "common/ieee802_11_defs.h"
 #include "common/wpa_ctrl.h"
 #include "common/sae.h"
@@ -35,7 +36,9 @@
 #include "gas_serv.h"
 #include "wnm_ap.h"
 #include "mbo_ap.h"
+#include "dhcp_snoop.h"
 #include "ndisc_snoop.h"
+#include "x_snoop.h"
 #include "sta_info.h"
 #include "vlan.h"
 #include "wps_hostapd.h"
@@ -50,6 +53,10 @@ static void ap_sa_query_timer(void *eloop_ctx, void *timeout_ctx);
 static int ap_sta_remove(struct hostapd_data *hapd, struct sta_info *sta);
 static void ap_sta_delayed_1x_auth_fail_cb(void *eloop_ctx, void *timeout_ctx);
 
+/* Station entries may include key material, e.g., mesh group keys */
+static struct obj_pool sta_pool =
+	OBJ_POOL_INIT("sta_info", sizeof(struct sta_info), OBJ_POOL_CLEAR);
+
 int ap_for_each_sta(struct hostapd_data *hapd,
 		    int (*cb)(struct hostapd_data *hapd, struct sta_info *sta,
 			      void *ctx),
@@ -150,6 +157,12 @@ static void ap_sta_hash_del(struct hostapd_data *hapd, struct sta_info *sta)
 }
 
 
+void ap_sta_ipaddr_del(struct hostapd_data *hapd, struct sta_info *sta)
+{
+	sta_ipaddr_del(hapd, sta);
+}
+
+
 void ap_sta_ip6addr_del(struct hostapd_data *hapd, struct sta_info *sta)
 {
 	sta_ip6addr_del(hapd, sta);
@@ -200,8 +213,7 @@ void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 	if (sta->flags & (WLAN_STA_WDS | WLAN_STA_MULTI_AP))
 		hostapd_set_wds_sta(hapd, NULL, sta->addr, sta->aid, 0);
 
-	if (sta->ipaddr)
-		hostapd_drv_br_delete_ip_neigh(hapd, 4, (u8 *) &sta->ipaddr);
+	ap_sta_ipaddr_del(hapd, sta);
 	ap_sta_ip6addr_del(hapd, sta);
 
 	if (!hapd->iface->driver_ap_teardown &&
@@ -414,7 +426,7 @@ void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 	forced_memzero(sta->last_tk, WPA_TK_MAX_LEN);
 #endif /* CONFIG_TESTING_OPTIONS */
 
-	os_free(sta);
+	obj_pool_free(&sta_pool, sta);
 }
 
 
@@ -531,8 +543,10 @@ skip_poll:
 		wpa_printf(MSG_DEBUG, "%s: register ap_handle_timer timeout "
 			   "for " MACSTR " (%lu seconds)",
 			   __func__, MAC2STR(sta->addr), next_time);
-		eloop_register_timeout(next_time, 0, ap_handle_timer, hapd,
-				       sta);
+		eloop_register_timeout_slack(
+			next_time, 0,
+			hapd->iconf->housekeeping_timer_slack * 1000,
+			ap_handle_timer, hapd, sta);
 		return;
 	}
 
@@ -724,14 +738,14 @@ struct sta_info * ap_sta_add(struct hostapd_data *hapd, const u8 *addr)
 		return NULL;
 	}
 
-	sta = os_zalloc(sizeof(struct sta_info));
+	sta = obj_pool_zalloc(&sta_pool);
 	if (sta == NULL) {
 		wpa_printf(MSG_ERROR, "malloc failed");
 		return NULL;
 	}
 	sta->acct_interim_interval = hapd->conf->acct_interim_interval;
 	if (accounting_sta_get_id(hapd, sta) < 0) {
-		os_free(sta);
+		obj_pool_free(&sta_pool, sta);
 		return NULL;
 	}
 
@@ -749,8 +763,10 @@ struct sta_info * ap_sta_add(struct hostapd_data *hapd, const u8 *addr)
 			   "for " MACSTR " (%d seconds - ap_max_inactivity)",
 			   __func__, MAC2STR(addr),
 			   hapd->conf->ap_max_inactivity);
-		eloop_register_timeout(hapd->conf->ap_max_inactivity, 0,
-				       ap_handle_timer, hapd, sta);
+		eloop_register_timeout_slack(
+			hapd->conf->ap_max_inactivity, 0,
+			hapd->iconf->housekeeping_timer_slack * 1000,
+			ap_handle_timer, hapd, sta);
 	}
 
 	/* initialize STA info data */
@@ -776,8 +792,7 @@ static int ap_sta_remove(struct hostapd_data *hapd, struct sta_info *sta)
 {
 	ieee802_1x_notify_port_enabled(sta->eapol_sm, 0);
 
-	if (sta->ipaddr)
-		hostapd_drv_br_delete_ip_neigh(hapd, 4, (u8 *) &sta->ipaddr);
+	ap_sta_ipaddr_del(hapd, sta);
 	ap_sta_ip6addr_del(hapd, sta);
 
 	wpa_printf(MSG_DEBUG, "%s: Removing STA " MACSTR " from kernel driver",
@@ -1284,6 +1299,7 @@ void ap_sta_set_authorized(struct hostapd_data *hapd, struct sta_info *sta,
 		sta->flags |= WLAN_STA_AUTHORIZED;
 	else
 		sta->flags &= ~WLAN_STA_AUTHORIZED;
+	x_snoop_sta_authorized_changed(hapd);
 
 #ifdef CONFIG_P2P
 	if (hapd->p2p_group == NULL) {
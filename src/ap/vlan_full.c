@@ -26,16 +26,35 @@
 #include "wpa_auth.h"
 #include "vlan_init.h"
 #include "vlan_util.h"
+#include "vlan_rtnl.h"
 
 
+struct vlan_rtnl_br {
+	char name[IFNAMSIZ];
+	int vid;
+	int ifindex;
+	int res; /* result of creating the bridge */
+	int clean;
+};
+
 struct full_dynamic_vlan {
 	int s; /* socket on which to listen for new/removed interfaces. */
+	struct hostapd_data *hapd;
+	/* rtnetlink batches for link configuration; NULL to use ioctl() */
+	struct vlan_rtnl *rtnl;
+	struct vlan_rtnl_batch *batch;
+	/* Pre-provisioned bridges (vlan_pool) */
+	struct vlan_rtnl_br *pool;
+	size_t num_pool;
 };
 
 #define DVLAN_CLEAN_BR         0x1
 #define DVLAN_CLEAN_VLAN       0x2
 #define DVLAN_CLEAN_VLAN_PORT  0x4
 
+/* Decrease forwarding delay to avoid EAPOL timeouts. */
+#define DVLAN_BR_FORWARD_DELAY 1
+
 struct dynamic_iface {
 	char ifname[IFNAMSIZ + 1];
 	int usage;
@@ -321,11 +340,10 @@ static int br_addbr(const char *br_name)
 	}
 
 done:
-	/* Decrease forwarding delay to avoid EAPOL timeouts. */
 	os_memset(&ifr, 0, sizeof(ifr));
 	os_strlcpy(ifr.ifr_name, br_name, IFNAMSIZ);
 	arg[0] = BRCTL_SET_BRIDGE_FORWARD_DELAY;
-	arg[1] = 1;
+	arg[1] = DVLAN_BR_FORWARD_DELAY;
 	arg[2] = 0;
 	arg[3] = 0;
 	ifr.ifr_data = (char *) &arg;
@@ -384,24 +402,31 @@ static int br_getnumports(const char *br_name)
 }
 
 
-static void vlan_newlink_tagged(int vlan_naming, const char *tagged_interface,
-				const char *br_name, int vid,
-				struct hostapd_data *hapd)
+static void vlan_tagged_ifname(char *vlan_ifname, int vlan_naming,
+			       const char *tagged_interface, int vid)
 {
-	char vlan_ifname[IFNAMSIZ];
-	int clean;
 	int ret;
 
 	if (vlan_naming == DYNAMIC_VLAN_NAMING_WITH_DEVICE)
-		ret = os_snprintf(vlan_ifname, sizeof(vlan_ifname), "%s.%d",
+		ret = os_snprintf(vlan_ifname, IFNAMSIZ, "%s.%d",
 				  tagged_interface, vid);
 	else
-		ret = os_snprintf(vlan_ifname, sizeof(vlan_ifname), "vlan%d",
-				  vid);
-	if (ret >= (int) sizeof(vlan_ifname))
+		ret = os_snprintf(vlan_ifname, IFNAMSIZ, "vlan%d", vid);
+	if (ret >= IFNAMSIZ)
 		wpa_printf(MSG_WARNING,
 			   "VLAN: Interface name was truncated to %s",
 			   vlan_ifname);
+}
+
+
+static void vlan_newlink_tagged(int vlan_naming, const char *tagged_interface,
+				const char *br_name, int vid,
+				struct hostapd_data *hapd)
+{
+	char vlan_ifname[IFNAMSIZ];
+	int clean;
+
+	vlan_tagged_ifname(vlan_ifname, vlan_naming, tagged_interface, vid);
 
 	clean = 0;
 	ifconfig_up(tagged_interface);
@@ -417,13 +442,14 @@ static void vlan_newlink_tagged(int vlan_naming, const char *tagged_interface,
 }
 
 
+/* vlan may be NULL when the bridge is not for a specific VLAN entry */
 static void vlan_bridge_name(char *br_name, struct hostapd_data *hapd,
 			     struct hostapd_vlan *vlan, int vid)
 {
 	char *tagged_interface = hapd->conf->ssid.vlan_tagged_interface;
 	int ret;
 
-	if (vlan->bridge[0]) {
+	if (vlan && vlan->bridge[0]) {
 		os_strlcpy(br_name, vlan->bridge, IFNAMSIZ);
 		ret = 0;
 	} else if (hapd->conf->vlan_bridge[0]) {
@@ -458,6 +484,193 @@ static void vlan_get_bridge(const char *br_name, struct hostapd_data *hapd,
 }
 
 
+/*
+ * rtnetlink variants of the operations above. The missing bridges for a VLAN
+ * interface are created with one batch of requests and the VLAN interfaces
+ * and bridge ports with another one, so only a single batch is needed when the
+ * bridges already exist (e.g., VLANs in vlan_pool).
+ */
+
+struct vlan_rtnl_port {
+	char ifname[IFNAMSIZ];
+	int br_ifindex;
+	int created; /* result of creating the VLAN interface */
+	int master; /* master before the interface was added to the bridge */
+	int res; /* result of adding the interface to the bridge */
+};
+
+
+/* Untagged bridge first (if any), followed by one for each tagged VLAN */
+static size_t vlan_rtnl_bridges(struct hostapd_data *hapd,
+				struct hostapd_vlan *vlan,
+				struct vlan_rtnl_br *br, size_t *first_tagged)
+{
+	int untagged = vlan->vlan_desc.untagged;
+	int *tagged = vlan->vlan_desc.tagged;
+	size_t num = 0;
+	int i;
+
+	if (vlan->vlan_desc.notempty &&
+	    untagged > 0 && untagged <= MAX_VLAN_ID) {
+		vlan_bridge_name(br[num].name, hapd, vlan, untagged);
+		br[num++].vid = untagged;
+	}
+	*first_tagged = num;
+
+	for (i = 0; i < MAX_NUM_TAGGED_VLAN && tagged[i]; i++) {
+		if (tagged[i] == untagged ||
+		    tagged[i] <= 0 || tagged[i] > MAX_VLAN_ID ||
+		    (i > 0 && tagged[i] == tagged[i - 1]))
+			continue;
+		vlan_bridge_name(br[num].name, hapd, vlan, tagged[i]);
+		br[num++].vid = tagged[i];
+	}
+
+	return num;
+}
+
+
+/* Create the missing bridges and take a reference to each bridge */
+static void vlan_rtnl_get_bridges(struct full_dynamic_vlan *priv,
+				  struct hostapd_data *hapd,
+				  struct vlan_rtnl_br *br, size_t num)
+{
+	size_t i;
+
+	for (i = 0; i < num; i++) {
+		br[i].res = -EEXIST;
+		br[i].ifindex = if_nametoindex(br[i].name);
+		if (!br[i].ifindex)
+			vlan_rtnl_add_bridge(priv->batch, br[i].name,
+					     DVLAN_BR_FORWARD_DELAY,
+					     &br[i].res);
+	}
+	if (vlan_rtnl_batch_len(priv->batch))
+		vlan_rtnl_commit(priv->rtnl, priv->batch);
+
+	for (i = 0; i < num; i++) {
+		if (br[i].res && br[i].res != -EEXIST)
+			wpa_printf(MSG_ERROR, "VLAN: Failed to add bridge %s: %s",
+				   br[i].name, strerror(-br[i].res));
+		if (!br[i].ifindex)
+			br[i].ifindex = if_nametoindex(br[i].name);
+		dyn_iface_get(hapd, br[i].name,
+			      br[i].res == 0 ? DVLAN_CLEAN_BR : 0);
+	}
+}
+
+
+/*
+ * Queue adding an interface to a bridge. The interface is first created as a
+ * VLAN interface on link_ifindex if that is given. The previous master is
+ * needed to find out whether the interface was already in the bridge.
+ */
+static void vlan_rtnl_queue_port(struct vlan_rtnl_batch *batch,
+				 struct vlan_rtnl_port *port,
+				 int link_ifindex, int vid, int up)
+{
+	port->created = -EEXIST;
+	if (link_ifindex > 0)
+		vlan_rtnl_add_vlan(batch, port->ifname, link_ifindex, vid,
+				   &port->created);
+	vlan_rtnl_get_master(batch, port->ifname, &port->master);
+	vlan_rtnl_set_link(batch, port->ifname,
+			   port->br_ifindex > 0 ? port->br_ifindex : -1, up,
+			   &port->res);
+}
+
+
+static int vlan_rtnl_port_clean(const struct vlan_rtnl_port *port)
+{
+	int clean = 0;
+
+	if (port->created && port->created != -EEXIST)
+		wpa_printf(MSG_ERROR, "VLAN: Failed to add VLAN interface %s: %s",
+			   port->ifname, strerror(-port->created));
+	if (port->br_ifindex > 0 && port->res)
+		wpa_printf(MSG_ERROR, "VLAN: Failed to add %s to bridge: %s",
+			   port->ifname, strerror(-port->res));
+
+	if (port->created == 0)
+		clean |= DVLAN_CLEAN_VLAN;
+	if (port->br_ifindex > 0 && port->res == 0 &&
+	    port->master != port->br_ifindex)
+		clean |= DVLAN_CLEAN_VLAN_PORT;
+	return clean;
+}
+
+
+static void vlan_newlink_rtnl(struct full_dynamic_vlan *priv,
+			      struct hostapd_vlan *vlan,
+			      struct hostapd_data *hapd)
+{
+	char *tagged_interface = hapd->conf->ssid.vlan_tagged_interface;
+	int vlan_naming = hapd->conf->ssid.vlan_naming;
+	struct vlan_rtnl_br br[1 + MAX_NUM_TAGGED_VLAN];
+	struct vlan_rtnl_port tport[1 + MAX_NUM_TAGGED_VLAN];
+	struct vlan_rtnl_port wport[1 + MAX_NUM_TAGGED_VLAN];
+	struct vlan_rtnl_port wlan;
+	size_t i, num, first_tagged;
+	int tagged_link = 0, wlan_link = 0;
+
+	num = vlan_rtnl_bridges(hapd, vlan, br, &first_tagged);
+	vlan_rtnl_get_bridges(priv, hapd, br, num);
+
+	if (tagged_interface) {
+		tagged_link = if_nametoindex(tagged_interface);
+		vlan_rtnl_set_link(priv->batch, tagged_interface, -1, 1, NULL);
+	}
+	if (first_tagged < num)
+		wlan_link = if_nametoindex(vlan->ifname);
+
+	for (i = 0; i < num; i++) {
+		if (br[i].res)
+			vlan_rtnl_set_link(priv->batch, br[i].name, -1, 1,
+					   NULL);
+		if (tagged_interface) {
+			vlan_tagged_ifname(tport[i].ifname, vlan_naming,
+					   tagged_interface, br[i].vid);
+			tport[i].br_ifindex = br[i].ifindex;
+			vlan_rtnl_queue_port(priv->batch, &tport[i],
+					     tagged_link, br[i].vid, 1);
+		}
+		if (i < first_tagged)
+			continue;
+		vlan_tagged_ifname(wport[i].ifname,
+				   DYNAMIC_VLAN_NAMING_WITH_DEVICE,
+				   vlan->ifname, br[i].vid);
+		wport[i].br_ifindex = br[i].ifindex;
+		vlan_rtnl_queue_port(priv->batch, &wport[i], wlan_link,
+				     br[i].vid, 1);
+	}
+
+	os_memset(&wlan, 0, sizeof(wlan));
+	os_strlcpy(wlan.ifname, vlan->ifname, sizeof(wlan.ifname));
+	if (first_tagged)
+		wlan.br_ifindex = br[0].ifindex;
+	else if (!vlan->vlan_desc.notempty && hapd->conf->bridge[0])
+		wlan.br_ifindex = if_nametoindex(hapd->conf->bridge);
+	if (wlan.br_ifindex)
+		vlan_rtnl_queue_port(priv->batch, &wlan, 0, 0, 1);
+	else
+		vlan_rtnl_set_link(priv->batch, vlan->ifname, -1, 1, NULL);
+
+	vlan_rtnl_commit(priv->rtnl, priv->batch);
+
+	for (i = 0; i < num; i++) {
+		if (tagged_interface)
+			dyn_iface_get(hapd, tport[i].ifname,
+				      vlan_rtnl_port_clean(&tport[i]));
+		if (i >= first_tagged)
+			dyn_iface_get(hapd, wport[i].ifname,
+				      vlan_rtnl_port_clean(&wport[i]));
+	}
+	if (wlan.br_ifindex &&
+	    (vlan_rtnl_port_clean(&wlan) & DVLAN_CLEAN_VLAN_PORT))
+		vlan->clean |= DVLAN_CLEAN_WLAN_PORT;
+}
+
+
 void vlan_newlink(const char *ifname, struct hostapd_data *hapd)
 {
 	char br_name[IFNAMSIZ];
@@ -477,6 +690,11 @@ void vlan_newlink(const char *ifname, struct hostapd_data *hapd)
 
 	vlan->configured = 1;
 
+	if (hapd->full_dynamic_vlan && hapd->full_dynamic_vlan->rtnl) {
+		vlan_newlink_rtnl(hapd->full_dynamic_vlan, vlan, hapd);
+		return;
+	}
+
 	notempty = vlan->vlan_desc.notempty;
 	untagged = vlan->vlan_desc.untagged;
 	tagged = vlan->vlan_desc.tagged;
@@ -516,19 +734,8 @@ static void vlan_dellink_tagged(int vlan_naming, const char *tagged_interface,
 {
 	char vlan_ifname[IFNAMSIZ];
 	int clean;
-	int ret;
-
-	if (vlan_naming == DYNAMIC_VLAN_NAMING_WITH_DEVICE)
-		ret = os_snprintf(vlan_ifname, sizeof(vlan_ifname), "%s.%d",
-				  tagged_interface, vid);
-	else
-		ret = os_snprintf(vlan_ifname, sizeof(vlan_ifname), "vlan%d",
-				  vid);
-	if (ret >= (int) sizeof(vlan_ifname))
-		wpa_printf(MSG_WARNING,
-			   "VLAN: Interface name was truncated to %s",
-			   vlan_ifname);
 
+	vlan_tagged_ifname(vlan_ifname, vlan_naming, tagged_interface, vid);
 
 	clean = dyn_iface_put(hapd, vlan_ifname);
 
@@ -561,6 +768,86 @@ static void vlan_put_bridge(const char *br_name, struct hostapd_data *hapd,
 }
 
 
+static void vlan_rtnl_queue_port_del(struct vlan_rtnl_batch *batch,
+				     const char *ifname, int clean)
+{
+	if (clean & DVLAN_CLEAN_VLAN_PORT)
+		vlan_rtnl_set_link(batch, ifname, 0, -1, NULL);
+
+	if (clean & DVLAN_CLEAN_VLAN) {
+		vlan_rtnl_set_link(batch, ifname, -1, 0, NULL);
+		vlan_rtnl_del_link(batch, ifname, NULL);
+	}
+}
+
+
+/*
+ * Release the bridges and the VLAN interfaces on vlan_tagged_interface in
+ * them, and remove the bridges that are not needed anymore. The removal of
+ * any other ports the caller has queued is committed first.
+ */
+static void vlan_rtnl_put_bridges(struct full_dynamic_vlan *priv,
+				  struct hostapd_data *hapd,
+				  struct vlan_rtnl_br *br, size_t num)
+{
+	char *tagged_interface = hapd->conf->ssid.vlan_tagged_interface;
+	int vlan_naming = hapd->conf->ssid.vlan_naming;
+	char vlan_ifname[IFNAMSIZ];
+	size_t i;
+	int ifindex;
+
+	for (i = 0; i < num; i++) {
+		if (tagged_interface) {
+			vlan_tagged_ifname(vlan_ifname, vlan_naming,
+					   tagged_interface, br[i].vid);
+			vlan_rtnl_queue_port_del(
+				priv->batch, vlan_ifname,
+				dyn_iface_put(hapd, vlan_ifname));
+		}
+		br[i].clean = dyn_iface_put(hapd, br[i].name);
+	}
+	if (vlan_rtnl_batch_len(priv->batch))
+		vlan_rtnl_commit(priv->rtnl, priv->batch);
+
+	for (i = 0; i < num; i++) {
+		if (!(br[i].clean & DVLAN_CLEAN_BR))
+			continue;
+		ifindex = if_nametoindex(br[i].name);
+		if (!ifindex || vlan_rtnl_bridge_ports(priv->rtnl, ifindex))
+			continue;
+		vlan_rtnl_set_link(priv->batch, br[i].name, -1, 0, NULL);
+		vlan_rtnl_del_link(priv->batch, br[i].name, NULL);
+	}
+	if (vlan_rtnl_batch_len(priv->batch))
+		vlan_rtnl_commit(priv->rtnl, priv->batch);
+}
+
+
+static void vlan_dellink_rtnl(struct full_dynamic_vlan *priv,
+			      struct hostapd_vlan *vlan,
+			      struct hostapd_data *hapd)
+{
+	struct vlan_rtnl_br br[1 + MAX_NUM_TAGGED_VLAN];
+	char vlan_ifname[IFNAMSIZ];
+	size_t i, num, first_tagged;
+
+	num = vlan_rtnl_bridges(hapd, vlan, br, &first_tagged);
+
+	for (i = first_tagged; i < num; i++) {
+		vlan_tagged_ifname(vlan_ifname,
+				   DYNAMIC_VLAN_NAMING_WITH_DEVICE,
+				   vlan->ifname, br[i].vid);
+		vlan_rtnl_queue_port_del(priv->batch, vlan_ifname,
+					 dyn_iface_put(hapd, vlan_ifname));
+	}
+
+	if (vlan->clean & DVLAN_CLEAN_WLAN_PORT)
+		vlan_rtnl_set_link(priv->batch, vlan->ifname, 0, -1, NULL);
+
+	vlan_rtnl_put_bridges(priv, hapd, br, num);
+}
+
+
 void vlan_dellink(const char *ifname, struct hostapd_data *hapd)
 {
 	struct hostapd_vlan *first, *prev, *vlan = hapd->conf->vlan;
@@ -580,7 +867,10 @@ void vlan_dellink(const char *ifname, struct hostapd_data *hapd)
 	if (!vlan)
 		return;
 
-	if (vlan->configured) {
+	if (vlan->configured && hapd->full_dynamic_vlan &&
+	    hapd->full_dynamic_vlan->rtnl) {
+		vlan_dellink_rtnl(hapd->full_dynamic_vlan, vlan, hapd);
+	} else if (vlan->configured) {
 		int notempty = vlan->vlan_desc.notempty;
 		int untagged = vlan->vlan_desc.untagged;
 		int *tagged = vlan->vlan_desc.tagged;
@@ -745,6 +1035,98 @@ static void vlan_event_receive(int sock, void *eloop_ctx, void *sock_ctx)
 }
 
 
+static void vlan_pool_init(struct full_dynamic_vlan *priv,
+			   struct hostapd_data *hapd)
+{
+	struct wpa_freq_range_list *list = &hapd->conf->ssid.vlan_pool;
+	char *tagged_interface = hapd->conf->ssid.vlan_tagged_interface;
+	int vlan_naming = hapd->conf->ssid.vlan_naming;
+	struct vlan_rtnl_port *port;
+	unsigned int i, vid;
+	size_t num = 0;
+	int tagged_link;
+
+	for (i = 0; i < list->num; i++) {
+		if (list->range[i].min >= 1 &&
+		    list->range[i].min <= list->range[i].max &&
+		    list->range[i].max <= MAX_VLAN_ID)
+			num += list->range[i].max - list->range[i].min + 1;
+	}
+	if (!num)
+		return;
+
+	priv->pool = os_calloc(num, sizeof(*priv->pool));
+	if (!priv->pool)
+		return;
+	for (i = 0; i < list->num; i++) {
+		if (list->range[i].min < 1 ||
+		    list->range[i].min > list->range[i].max ||
+		    list->range[i].max > MAX_VLAN_ID)
+			continue;
+		for (vid = list->range[i].min; vid <= list->range[i].max;
+		     vid++) {
+			vlan_bridge_name(priv->pool[priv->num_pool].name, hapd,
+					 NULL, vid);
+			priv->pool[priv->num_pool++].vid = vid;
+		}
+	}
+
+	wpa_printf(MSG_DEBUG, "VLAN: Pre-provisioning %u VLAN(s)",
+		   (unsigned int) priv->num_pool);
+
+	if (!priv->rtnl) {
+		for (i = 0; i < priv->num_pool; i++)
+			vlan_get_bridge(priv->pool[i].name, hapd,
+					priv->pool[i].vid);
+		return;
+	}
+
+	vlan_rtnl_get_bridges(priv, hapd, priv->pool, priv->num_pool);
+	if (!tagged_interface)
+		return;
+
+	port = os_calloc(priv->num_pool, sizeof(*port));
+	if (!port)
+		return;
+	tagged_link = if_nametoindex(tagged_interface);
+	vlan_rtnl_set_link(priv->batch, tagged_interface, -1, 1, NULL);
+	for (i = 0; i < priv->num_pool; i++) {
+		vlan_tagged_ifname(port[i].ifname, vlan_naming,
+				   tagged_interface, priv->pool[i].vid);
+		port[i].br_ifindex = priv->pool[i].ifindex;
+		vlan_rtnl_queue_port(priv->batch, &port[i], tagged_link,
+				     priv->pool[i].vid, 1);
+	}
+	vlan_rtnl_commit(priv->rtnl, priv->batch);
+	for (i = 0; i < priv->num_pool; i++)
+		dyn_iface_get(hapd, port[i].ifname,
+			      vlan_rtnl_port_clean(&port[i]));
+	os_free(port);
+}
+
+
+static void vlan_pool_deinit(struct full_dynamic_vlan *priv)
+{
+	size_t i;
+
+	if (!priv->pool)
+		return;
+
+	if (priv->rtnl) {
+		vlan_rtnl_put_bridges(priv, priv->hapd, priv->pool,
+				      priv->num_pool);
+	} else {
+		for (i = 0; i < priv->num_pool; i++)
+			vlan_put_bridge(priv->pool[i].name, priv->hapd,
+					priv->pool[i].vid);
+	}
+
+	os_free(priv->pool);
+	priv->pool = NULL;
+	priv->num_pool = 0;
+}
+
+
 struct full_dynamic_vlan *
 full_dynamic_vlan_init(struct hostapd_data *hapd)
 {
@@ -787,6 +1169,20 @@ full_dynamic_vlan_init(struct hostapd_data *hapd)
 		return NULL;
 	}
 
+	priv->hapd = hapd;
+	priv->rtnl = vlan_rtnl_init();
+	priv->batch = vlan_rtnl_batch_alloc();
+	if (!priv->rtnl || !priv->batch) {
+		wpa_printf(MSG_INFO,
+			   "VLAN: Using ioctl() for bridge configuration");
+		vlan_rtnl_deinit(priv->rtnl);
+		priv->rtnl = NULL;
+		vlan_rtnl_batch_free(priv->batch);
+		priv->batch = NULL;
+	}
+
+	vlan_pool_init(priv, hapd);
+
 	return priv;
 }
 
@@ -795,7 +1191,10 @@ void full_dynamic_vlan_deinit(struct full_dynamic_vlan *priv)
 {
 	if (priv == NULL)
 		return;
+	vlan_pool_deinit(priv);
 	eloop_unregister_read_sock(priv->s);
 	close(priv->s);
+	vlan_rtnl_deinit(priv->rtnl);
+	vlan_rtnl_batch_free(priv->batch);
 	os_free(priv);
 }
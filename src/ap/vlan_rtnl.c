@@ -0,0 +1,593 @@
+/*
+ * hostapd / VLAN rtnetlink batch operations
+ * Copyright (c) 2026, The hostapd contributors
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+#include <net/if.h>
+/* Avoid conflicts due to NetBSD net/if.h if_type define with driver.h */
+#undef if_type
+
+#include "utils/common.h"
+#include "drivers/priv_netlink.h"
+#include "vlan_rtnl.h"
+
+/*
+ * Link operations are queued into a batch and sent to the kernel as a single
+ * netlink message sequence. Each request asks for an acknowledgement and the
+ * kernel processes the requests in order, so later requests in the same batch
+ * can depend on the earlier ones (e.g., add a VLAN interface, then add it to a
+ * bridge). The per-request results are stored through the pointers given when
+ * queuing the request once the batch has been committed.
+ */
+
+/* Room reserved for a single request; enough for the attributes used here */
+#define VLAN_RTNL_MAX_MSG 256
+/*
+ * Maximum number of requests per send(). The acknowledgements and RTM_GETLINK
+ * responses of a full send() need to fit in the socket receive buffer, so it
+ * is enlarged to VLAN_RTNL_SOCK_RCVBUF.
+ */
+#define VLAN_RTNL_MAX_SEND 100
+#define VLAN_RTNL_SOCK_RCVBUF (256 * 1024)
+#define VLAN_RTNL_RECV_BUF 16384
+
+
+struct vlan_rtnl {
+	int sock;
+	u32 seq;
+	u8 *buf;
+};
+
+struct vlan_rtnl_op {
+	int *res;
+	u32 seq;
+	unsigned int get_master:1;
+	unsigned int done:1;
+};
+
+struct vlan_rtnl_batch {
+	struct wpabuf *buf;
+	struct vlan_rtnl_op *ops;
+	size_t num_ops;
+	size_t max_ops;
+	size_t msg_start;
+};
+
+
+struct vlan_rtnl * vlan_rtnl_init(void)
+{
+	struct vlan_rtnl *rtnl;
+	struct sockaddr_nl local;
+	int bufsize = VLAN_RTNL_SOCK_RCVBUF;
+
+	rtnl = os_zalloc(sizeof(*rtnl));
+	if (!rtnl)
+		return NULL;
+	rtnl->buf = os_malloc(VLAN_RTNL_RECV_BUF);
+	if (!rtnl->buf) {
+		os_free(rtnl);
+		return NULL;
+	}
+
+	rtnl->sock = socket(PF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+	if (rtnl->sock < 0) {
+		wpa_printf(MSG_ERROR, "VLAN: %s: socket(PF_NETLINK,SOCK_RAW,"
+			   "NETLINK_ROUTE) failed: %s",
+			   __func__, strerror(errno));
+		os_free(rtnl->buf);
+		os_free(rtnl);
+		return NULL;
+	}
+
+	/*
+	 * SO_RCVBUFFORCE requires CAP_NET_ADMIN, which is needed for dynamic
+	 * VLAN in any case; SO_RCVBUF is limited by net.core.rmem_max.
+	 */
+	if (setsockopt(rtnl->sock, SOL_SOCKET, SO_RCVBUFFORCE, &bufsize,
+		       sizeof(bufsize)) < 0 &&
+	    setsockopt(rtnl->sock, SOL_SOCKET, SO_RCVBUF, &bufsize,
+		       sizeof(bufsize)) < 0)
+		wpa_printf(MSG_DEBUG,
+			   "VLAN: Failed to set rtnl receive buffer size: %s",
+			   strerror(errno));
+
+	os_memset(&local, 0, sizeof(local));
+	local.nl_family = AF_NETLINK;
+	if (bind(rtnl->sock, (struct sockaddr *) &local, sizeof(local)) < 0) {
+		wpa_printf(MSG_ERROR, "VLAN: %s: bind(netlink) failed: %s",
+			   __func__, strerror(errno));
+		vlan_rtnl_deinit(rtnl);
+		return NULL;
+	}
+
+	rtnl->seq = os_random();
+
+	return rtnl;
+}
+
+
+void vlan_rtnl_deinit(struct vlan_rtnl *rtnl)
+{
+	if (!rtnl)
+		return;
+	close(rtnl->sock);
+	os_free(rtnl->buf);
+	os_free(rtnl);
+}
+
+
+struct vlan_rtnl_batch * vlan_rtnl_batch_alloc(void)
+{
+	struct vlan_rtnl_batch *batch;
+
+	batch = os_zalloc(sizeof(*batch));
+	if (!batch)
+		return NULL;
+	batch->buf = wpabuf_alloc(VLAN_RTNL_MAX_MSG * 4);
+	if (!batch->buf) {
+		os_free(batch);
+		return NULL;
+	}
+	return batch;
+}
+
+
+void vlan_rtnl_batch_free(struct vlan_rtnl_batch *batch)
+{
+	if (!batch)
+		return;
+	wpabuf_free(batch->buf);
+	os_free(batch->ops);
+	os_free(batch);
+}
+
+
+size_t vlan_rtnl_batch_len(struct vlan_rtnl_batch *batch)
+{
+	return batch->num_ops;
+}
+
+
+static void vlan_rtnl_batch_reset(struct vlan_rtnl_batch *batch)
+{
+	batch->buf->used = 0;
+	batch->num_ops = 0;
+}
+
+
+static struct nlmsghdr * vlan_rtnl_hdr(struct vlan_rtnl_batch *batch)
+{
+	return (struct nlmsghdr *) (wpabuf_mhead_u8(batch->buf) +
+				    batch->msg_start);
+}
+
+
+static struct rtattr * vlan_rtnl_attr(struct vlan_rtnl_batch *batch,
+				      u16 type, const void *data, size_t len)
+{
+	struct rtattr *rta;
+
+	rta = wpabuf_put(batch->buf, RTA_SPACE(len));
+	os_memset(rta, 0, RTA_SPACE(len));
+	rta->rta_type = type;
+	rta->rta_len = RTA_LENGTH(len);
+	if (data)
+		os_memcpy(RTA_DATA(rta), data, len);
+	return rta;
+}
+
+
+static void vlan_rtnl_nest_end(struct vlan_rtnl_batch *batch,
+			       struct rtattr *nest)
+{
+	nest->rta_len = (u8 *) wpabuf_put(batch->buf, 0) - (u8 *) nest;
+}
+
+
+/* Start a new link request; attributes can be added until the next request */
+static int vlan_rtnl_msg(struct vlan_rtnl_batch *batch, u16 type, u16 flags,
+			 const char *ifname, int up, int *res, int get_master)
+{
+	struct nlmsghdr *hdr;
+	struct ifinfomsg *ifi;
+	struct vlan_rtnl_op *op;
+
+	if (os_strlen(ifname) >= IFNAMSIZ) {
+		wpa_printf(MSG_ERROR, "VLAN: Interface name too long: '%s'",
+			   ifname);
+		goto fail;
+	}
+
+	if (batch->num_ops == batch->max_ops) {
+		size_t max = batch->max_ops ? 2 * batch->max_ops : 8;
+
+		op = os_realloc_array(batch->ops, max, sizeof(*op));
+		if (!op)
+			goto fail;
+		batch->ops = op;
+		batch->max_ops = max;
+	}
+
+	if (wpabuf_resize(&batch->buf, VLAN_RTNL_MAX_MSG) < 0)
+		goto fail;
+
+	batch->msg_start = wpabuf_len(batch->buf);
+	hdr = wpabuf_put(batch->buf, NLMSG_ALIGN(sizeof(*hdr)));
+	os_memset(hdr, 0, NLMSG_ALIGN(sizeof(*hdr)));
+	hdr->nlmsg_type = type;
+	hdr->nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK | flags;
+
+	ifi = wpabuf_put(batch->buf, NLMSG_ALIGN(sizeof(*ifi)));
+	os_memset(ifi, 0, NLMSG_ALIGN(sizeof(*ifi)));
+	ifi->ifi_family = AF_UNSPEC;
+	if (up >= 0) {
+		ifi->ifi_change = IFF_UP;
+		ifi->ifi_flags = up ? IFF_UP : 0;
+	}
+
+	vlan_rtnl_attr(batch, IFLA_IFNAME, ifname, os_strlen(ifname) + 1);
+
+	op = &batch->ops[batch->num_ops++];
+	os_memset(op, 0, sizeof(*op));
+	op->res = res;
+	op->get_master = !!get_master;
+	if (res)
+		*res = -ETIMEDOUT;
+
+	return 0;
+fail:
+	if (res)
+		*res = -ENOMEM;
+	return -1;
+}
+
+
+static void vlan_rtnl_msg_end(struct vlan_rtnl_batch *batch)
+{
+	struct nlmsghdr *hdr = vlan_rtnl_hdr(batch);
+
+	hdr->nlmsg_len = wpabuf_len(batch->buf) - batch->msg_start;
+}
+
+
+/**
+ * vlan_rtnl_add_bridge - Queue creation of a bridge interface
+ * @batch: Batch from vlan_rtnl_batch_alloc()
+ * @br_name: Bridge interface name
+ * @forward_delay: Forward delay in USER_HZ units
+ * @res: Result: 0 on success, -EEXIST if the bridge already exists, or other
+ *	negative errno value
+ * Returns: 0 on success, -1 if the request could not be queued
+ *
+ * The bridge is set up when created.
+ */
+int vlan_rtnl_add_bridge(struct vlan_rtnl_batch *batch, const char *br_name,
+			 unsigned int forward_delay, int *res)
+{
+	struct rtattr *linkinfo, *data;
+	u32 val = forward_delay;
+
+	wpa_printf(MSG_DEBUG, "VLAN: rtnl add bridge %s", br_name);
+	if (vlan_rtnl_msg(batch, RTM_NEWLINK, NLM_F_CREATE | NLM_F_EXCL,
+			  br_name, 1, res, 0) < 0)
+		return -1;
+	linkinfo = vlan_rtnl_attr(batch, IFLA_LINKINFO, NULL, 0);
+	vlan_rtnl_attr(batch, IFLA_INFO_KIND, "bridge", 7);
+	data = vlan_rtnl_attr(batch, IFLA_INFO_DATA, NULL, 0);
+	vlan_rtnl_attr(batch, IFLA_BR_FORWARD_DELAY, &val, sizeof(val));
+	vlan_rtnl_nest_end(batch, data);
+	vlan_rtnl_nest_end(batch, linkinfo);
+	vlan_rtnl_msg_end(batch);
+	return 0;
+}
+
+
+/**
+ * vlan_rtnl_add_vlan - Queue creation of an 802.1Q VLAN interface
+ * @batch: Batch from vlan_rtnl_batch_alloc()
+ * @ifname: VLAN interface name
+ * @link_ifindex: Interface index of the tagged interface
+ * @vid: VLAN ID
+ * @res: Result: 0 on success, -EEXIST if the interface already exists, or
+ *	other negative errno value
+ * Returns: 0 on success, -1 if the request could not be queued
+ */
+int vlan_rtnl_add_vlan(struct vlan_rtnl_batch *batch, const char *ifname,
+		       int link_ifindex, int vid, int *res)
+{
+	struct rtattr *linkinfo, *data;
+	u32 link = link_ifindex;
+	u16 id = vid;
+
+	wpa_printf(MSG_DEBUG, "VLAN: rtnl add vlan %s (link=%d vid=%d)",
+		   ifname, link_ifindex, vid);
+	if (vlan_rtnl_msg(batch, RTM_NEWLINK, NLM_F_CREATE | NLM_F_EXCL,
+			  ifname, -1, res, 0) < 0)
+		return -1;
+	vlan_rtnl_attr(batch, IFLA_LINK, &link, sizeof(link));
+	linkinfo = vlan_rtnl_attr(batch, IFLA_LINKINFO, NULL, 0);
+	vlan_rtnl_attr(batch, IFLA_INFO_KIND, "vlan", 5);
+	data = vlan_rtnl_attr(batch, IFLA_INFO_DATA, NULL, 0);
+	vlan_rtnl_attr(batch, IFLA_VLAN_ID, &id, sizeof(id));
+	vlan_rtnl_nest_end(batch, data);
+	vlan_rtnl_nest_end(batch, linkinfo);
+	vlan_rtnl_msg_end(batch);
+	return 0;
+}
+
+
+/**
+ * vlan_rtnl_set_link - Queue change of the master and/or up state of a link
+ * @batch: Batch from vlan_rtnl_batch_alloc()
+ * @ifname: Interface name
+ * @master: Interface index of the bridge to add the interface to, 0 to remove
+ *	the interface from its bridge, or -1 to not change the master
+ * @up: 1 to set the interface up, 0 to set it down, or -1 to not change
+ * @res: Result: 0 on success or negative errno value; %NULL if not needed
+ * Returns: 0 on success, -1 if the request could not be queued
+ */
+int vlan_rtnl_set_link(struct vlan_rtnl_batch *batch, const char *ifname,
+		       int master, int up, int *res)
+{
+	u32 val = master;
+
+	wpa_printf(MSG_DEBUG, "VLAN: rtnl set link %s (master=%d up=%d)",
+		   ifname, master, up);
+	if (vlan_rtnl_msg(batch, RTM_NEWLINK, 0, ifname, up, res, 0) < 0)
+		return -1;
+	if (master >= 0)
+		vlan_rtnl_attr(batch, IFLA_MASTER, &val, sizeof(val));
+	vlan_rtnl_msg_end(batch);
+	return 0;
+}
+
+
+/**
+ * vlan_rtnl_del_link - Queue removal of an interface
+ * @batch: Batch from vlan_rtnl_batch_alloc()
+ * @ifname: Interface name
+ * @res: Result: 0 on success or negative errno value; %NULL if not needed
+ * Returns: 0 on success, -1 if the request could not be queued
+ */
+int vlan_rtnl_del_link(struct vlan_rtnl_batch *batch, const char *ifname,
+		       int *res)
+{
+	wpa_printf(MSG_DEBUG, "VLAN: rtnl del link %s", ifname);
+	if (vlan_rtnl_msg(batch, RTM_DELLINK, 0, ifname, -1, res, 0) < 0)
+		return -1;
+	vlan_rtnl_msg_end(batch);
+	return 0;
+}
+
+
+/**
+ * vlan_rtnl_get_master - Queue a query for the current master of a link
+ * @batch: Batch from vlan_rtnl_batch_alloc()
+ * @ifname: Interface name
+ * @master: Result: Interface index of the master at the point the request is
+ *	processed in the batch, 0 if the interface has no master, or negative
+ *	errno value
+ * Returns: 0 on success, -1 if the request could not be queued
+ */
+int vlan_rtnl_get_master(struct vlan_rtnl_batch *batch, const char *ifname,
+			 int *master)
+{
+	if (vlan_rtnl_msg(batch, RTM_GETLINK, 0, ifname, -1, master, 1) < 0)
+		return -1;
+	vlan_rtnl_msg_end(batch);
+	return 0;
+}
+
+
+static int vlan_rtnl_link_master(struct nlmsghdr *h, int *ifindex)
+{
+	struct ifinfomsg *ifi;
+	struct rtattr *attr;
+	int attrlen;
+	u32 master;
+
+	if (h->nlmsg_len < NLMSG_LENGTH(sizeof(*ifi)))
+		return -EINVAL;
+	ifi = NLMSG_DATA(h);
+	if (ifindex)
+		*ifindex = ifi->ifi_index;
+
+	attrlen = h->nlmsg_len - NLMSG_LENGTH(NLMSG_ALIGN(sizeof(*ifi)));
+	attr = (struct rtattr *) ((u8 *) ifi + NLMSG_ALIGN(sizeof(*ifi)));
+	while (RTA_OK(attr, attrlen)) {
+		if (attr->rta_type == IFLA_MASTER &&
+		    RTA_PAYLOAD(attr) >= (int) sizeof(master)) {
+			os_memcpy(&master, RTA_DATA(attr), sizeof(master));
+			return master;
+		}
+		attr = RTA_NEXT(attr, attrlen);
+	}
+
+	return 0;
+}
+
+
+static int vlan_rtnl_exchange(struct vlan_rtnl *rtnl,
+			      struct vlan_rtnl_batch *batch,
+			      const u8 *msgs, size_t len,
+			      size_t first, size_t last)
+{
+	size_t i, pending = last - first;
+	u32 base = batch->ops[first].seq;
+	int ret = 0;
+
+	if (send(rtnl->sock, msgs, len, 0) < 0) {
+		int err = errno;
+
+		wpa_printf(MSG_ERROR, "VLAN: rtnl send failed: %s",
+			   strerror(err));
+		for (i = first; i < last; i++) {
+			if (batch->ops[i].res)
+				*batch->ops[i].res = -err;
+		}
+		return -1;
+	}
+
+	/*
+	 * rtnetlink requests are processed synchronously within send(), so all
+	 * responses are already queued and there is no need to wait here.
+	 */
+	while (pending) {
+		struct nlmsghdr *h;
+		int left;
+
+		left = recv(rtnl->sock, rtnl->buf, VLAN_RTNL_RECV_BUF,
+			    MSG_DONTWAIT);
+		if (left < 0) {
+			if (errno == EINTR)
+				continue;
+			wpa_printf(MSG_ERROR,
+				   "VLAN: rtnl recv failed with %u response(s) pending: %s",
+				   (unsigned int) pending, strerror(errno));
+			break;
+		}
+
+		h = (struct nlmsghdr *) rtnl->buf;
+		while (NLMSG_OK(h, left)) {
+			u32 idx = h->nlmsg_seq - base;
+			struct vlan_rtnl_op *op;
+
+			if (idx >= last - first)
+				goto next;
+			op = &batch->ops[first + idx];
+
+			if (h->nlmsg_type == NLMSG_ERROR && !op->done) {
+				struct nlmsgerr *e = NLMSG_DATA(h);
+
+				if (h->nlmsg_len < NLMSG_LENGTH(sizeof(int)))
+					goto next;
+				op->done = 1;
+				pending--;
+				if (e->error)
+					ret = -1;
+				if (op->res && (e->error || !op->get_master))
+					*op->res = e->error;
+			} else if (h->nlmsg_type == RTM_NEWLINK &&
+				   op->get_master && op->res) {
+				*op->res = vlan_rtnl_link_master(h, NULL);
+			}
+		next:
+			h = NLMSG_NEXT(h, left);
+		}
+	}
+
+	return pending ? -1 : ret;
+}
+
+
+/**
+ * vlan_rtnl_commit - Send the queued requests and collect the results
+ * @rtnl: Context from vlan_rtnl_init()
+ * @batch: Batch of requests
+ * Returns: 0 if all requests succeeded, -1 if any of them failed
+ *
+ * The batch is empty and can be reused after this call.
+ */
+int vlan_rtnl_commit(struct vlan_rtnl *rtnl, struct vlan_rtnl_batch *batch)
+{
+	u8 *pos = wpabuf_mhead_u8(batch->buf);
+	u8 *end = pos + wpabuf_len(batch->buf);
+	size_t i = 0;
+	int ret = 0;
+
+	while (pos < end) {
+		u8 *start = pos;
+		size_t first = i;
+
+		while (pos < end && i - first < VLAN_RTNL_MAX_SEND) {
+			struct nlmsghdr *h = (struct nlmsghdr *) pos;
+
+			h->nlmsg_seq = ++rtnl->seq;
+			batch->ops[i++].seq = h->nlmsg_seq;
+			pos += NLMSG_ALIGN(h->nlmsg_len);
+		}
+
+		if (vlan_rtnl_exchange(rtnl, batch, start, pos - start,
+				       first, i) < 0)
+			ret = -1;
+	}
+
+	vlan_rtnl_batch_reset(batch);
+	return ret;
+}
+
+
+/**
+ * vlan_rtnl_bridge_ports - Get the number of ports in a bridge
+ * @rtnl: Context from vlan_rtnl_init()
+ * @br_ifindex: Interface index of the bridge
+ * Returns: Number of interfaces with the bridge as their master or -1 on
+ *	failure
+ */
+int vlan_rtnl_bridge_ports(struct vlan_rtnl *rtnl, int br_ifindex)
+{
+	struct {
+		struct nlmsghdr hdr;
+		struct ifinfomsg ifi;
+		struct rtattr rta;
+		u32 master;
+	} req;
+	int ports = 0;
+	u32 seq;
+
+	os_memset(&req, 0, sizeof(req));
+	req.hdr.nlmsg_len = sizeof(req);
+	req.hdr.nlmsg_type = RTM_GETLINK;
+	req.hdr.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+	req.hdr.nlmsg_seq = seq = ++rtnl->seq;
+	req.ifi.ifi_family = AF_UNSPEC;
+	/* Filtered by the kernel when supported; checked below in any case */
+	req.rta.rta_type = IFLA_MASTER;
+	req.rta.rta_len = RTA_LENGTH(sizeof(req.master));
+	req.master = br_ifindex;
+
+	if (send(rtnl->sock, &req, sizeof(req), 0) < 0) {
+		wpa_printf(MSG_ERROR, "VLAN: rtnl link dump failed: %s",
+			   strerror(errno));
+		return -1;
+	}
+
+	for (;;) {
+		struct nlmsghdr *h;
+		int left;
+
+		left = recv(rtnl->sock, rtnl->buf, VLAN_RTNL_RECV_BUF, 0);
+		if (left < 0) {
+			if (errno == EINTR)
+				continue;
+			wpa_printf(MSG_ERROR, "VLAN: rtnl link dump failed: %s",
+				   strerror(errno));
+			return -1;
+		}
+
+		h = (struct nlmsghdr *) rtnl->buf;
+		while (NLMSG_OK(h, left)) {
+			int ifindex = 0;
+
+			if (h->nlmsg_seq != seq)
+				goto next;
+			if (h->nlmsg_type == NLMSG_DONE)
+				return ports;
+			if (h->nlmsg_type == NLMSG_ERROR) {
+				wpa_printf(MSG_ERROR,
+					   "VLAN: rtnl link dump failed");
+				return -1;
+			}
+			if (h->nlmsg_type == RTM_NEWLINK &&
+			    vlan_rtnl_link_master(h, &ifindex) == br_ifindex &&
+			    ifindex != br_ifindex)
+				ports++;
+		next:
+			h = NLMSG_NEXT(h, left);
+		}
+	}
+}
@@ -0,0 +1,36 @@
+/*
+ * hostapd / VLAN rtnetlink batch operations
+ * Copyright (c) 2026, The hostapd contributors
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef VLAN_RTNL_H
+#define VLAN_RTNL_H
+
+struct vlan_rtnl;
+struct vlan_rtnl_batch;
+
+struct vlan_rtnl * vlan_rtnl_init(void);
+void vlan_rtnl_deinit(struct vlan_rtnl *rtnl);
+
+struct vlan_rtnl_batch * vlan_rtnl_batch_alloc(void);
+void vlan_rtnl_batch_free(struct vlan_rtnl_batch *batch);
+size_t vlan_rtnl_batch_len(struct vlan_rtnl_batch *batch);
+
+int vlan_rtnl_add_bridge(struct vlan_rtnl_batch *batch, const char *br_name,
+			 unsigned int forward_delay, int *res);
+int vlan_rtnl_add_vlan(struct vlan_rtnl_batch *batch, const char *ifname,
+		       int link_ifindex, int vid, int *res);
+int vlan_rtnl_set_link(struct vlan_rtnl_batch *batch, const char *ifname,
+		       int master, int up, int *res);
+int vlan_rtnl_del_link(struct vlan_rtnl_batch *batch, const char *ifname,
+		       int *res);
+int vlan_rtnl_get_master(struct vlan_rtnl_batch *batch, const char *ifname,
+			 int *master);
+int vlan_rtnl_commit(struct vlan_rtnl *rtnl, struct vlan_rtnl_batch *batch);
+
+int vlan_rtnl_bridge_ports(struct vlan_rtnl *rtnl, int br_ifindex);
+
+#endif /* VLAN_RTNL_H */
@@ -12,6 +12,7 @@
 #include "utils/eloop.h"
 #include "utils/state_machine.h"
 #include "utils/bitfield.h"
+#include "utils/obj_pool.h"
 #include "common/ieee802_11_defs.h"
 #include "common/ocv.h"
 #include "common/dpp.h"
@@ -79,6 +80,10 @@ static const int dot11RSNAConfigPMKLifetime = 43200;
 static const int dot11RSNAConfigPMKReauthThreshold = 70;
 static const int dot11RSNAConfigSATimeout = 60;
 
+static struct obj_pool wpa_sm_pool =
+	OBJ_POOL_INIT("wpa_state_machine", sizeof(struct wpa_state_machine),
+		      OBJ_POOL_CLEAR);
+
 
 static inline int wpa_auth_mic_failure_report(
 	struct wpa_authenticator *wpa_auth, const u8 *addr)
@@ -668,7 +673,7 @@ wpa_auth_sta_init(struct wpa_authenticator *wpa_auth, const u8 *addr,
 	if (wpa_auth->group->wpa_group_state == WPA_GROUP_FATAL_FAILURE)
 		return NULL;
 
-	sm = os_zalloc(sizeof(struct wpa_state_machine));
+	sm = obj_pool_zalloc(&wpa_sm_pool);
 	if (!sm)
 		return NULL;
 	os_memcpy(sm->addr, addr, ETH_ALEN);
@@ -742,6 +747,46 @@ void wpa_auth_sta_no_wpa(struct wpa_state_machine *sm)
 }
 
 
+static void wpa_clear_last_rx_eapol_key(struct wpa_state_machine *sm)
+{
+	if (!sm->last_rx_eapol_key_borrowed)
+		os_free(sm->last_rx_eapol_key);
+	sm->last_rx_eapol_key = NULL;
+	sm->last_rx_eapol_key_len = 0;
+	sm->last_rx_eapol_key_borrowed = 0;
+}
+
+
+/*
+ * wpa_receive() lets the state machine refer to the caller's buffer while the
+ * frame is processed in wpa_sm_step(). A private copy is needed only if the
+ * frame was not consumed during that step, e.g., when PSK is waited for from
+ * a RADIUS server.
+ */
+static void wpa_keep_last_rx_eapol_key(struct wpa_state_machine *sm)
+{
+	u8 *copy;
+
+	if (!sm->last_rx_eapol_key_borrowed)
+		return;
+
+	if (!sm->EAPOLKeyReceived && !sm->waiting_radius_psk) {
+		wpa_clear_last_rx_eapol_key(sm);
+		return;
+	}
+
+	copy = os_memdup(sm->last_rx_eapol_key, sm->last_rx_eapol_key_len);
+	if (!copy) {
+		wpa_clear_last_rx_eapol_key(sm);
+		sm->EAPOLKeyReceived = false;
+		sm->waiting_radius_psk = 0;
+		return;
+	}
+	sm->last_rx_eapol_key = copy;
+	sm->last_rx_eapol_key_borrowed = 0;
+}
+
+
 static void wpa_free_sta_sm(struct wpa_state_machine *sm)
 {
 #ifdef CONFIG_P2P
@@ -763,14 +808,14 @@ static void wpa_free_sta_sm(struct wpa_state_machine *sm)
 	os_free(sm->assoc_resp_ftie);
 	wpabuf_free(sm->ft_pending_req_ies);
 #endif /* CONFIG_IEEE80211R_AP */
-	os_free(sm->last_rx_eapol_key);
+	wpa_clear_last_rx_eapol_key(sm);
 	os_free(sm->wpa_ie);
 	os_free(sm->rsnxe);
 	wpa_group_put(sm->wpa_auth, sm->group);
 #ifdef CONFIG_DPP2
 	wpabuf_clear_free(sm->dpp_z);
 #endif /* CONFIG_DPP2 */
-	bin_clear_free(sm, sizeof(*sm));
+	obj_pool_free(&wpa_sm_pool, sm);
 }
 
 
@@ -1425,18 +1470,19 @@ continue_processing:
 		wpa_replay_counter_mark_invalid(sm->key_replay, NULL);
 	}
 
-	os_free(sm->last_rx_eapol_key);
-	sm->last_rx_eapol_key = os_memdup(data, data_len);
-	if (!sm->last_rx_eapol_key)
-		return;
+	wpa_clear_last_rx_eapol_key(sm);
+	sm->last_rx_eapol_key = data;
 	sm->last_rx_eapol_key_len = data_len;
+	sm->last_rx_eapol_key_borrowed = 1;
 
 	sm->rx_eapol_key_secure = !!(key_info & WPA_KEY_INFO_SECURE);
 	sm->EAPOLKeyReceived = true;
 	sm->EAPOLKeyPairwise = !!(key_info & WPA_KEY_INFO_KEY_TYPE);
 	sm->EAPOLKeyRequest = !!(key_info & WPA_KEY_INFO_REQUEST);
 	os_memcpy(sm->SNonce, key->key_nonce, WPA_NONCE_LEN);
-	wpa_sm_step(sm);
+	if (wpa_sm_step(sm) == 1)
+		return; /* STA entry was removed */
+	wpa_keep_last_rx_eapol_key(sm);
 }
 
 
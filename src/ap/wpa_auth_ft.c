@@ -19,6 +19,7 @@
 #include "crypto/aes.h"
 #include "crypto/aes_siv.h"
 #include "crypto/aes_wrap.h"
+#include "crypto/crypto.h"
 #include "crypto/sha384.h"
 #include "crypto/sha512.h"
 #include "crypto/random.h"
@@ -2974,14 +2975,20 @@ static int wpa_ft_psk_pmk_r1(struct wpa_state_machine *sm,
 		if (pmk == NULL)
 			break;
 
+		/*
+		 * PMKR1Name depends only on PMKR0Name, so PMK-R1 itself needs
+		 * to be derived only for the PSK that matches.
+		 */
 		if (wpa_derive_pmk_r0(pmk, PMK_LEN, ssid, ssid_len, mdid, r0kh,
 				      r0kh_len, sm->addr,
 				      pmk_r0, pmk_r0_name,
 				      WPA_KEY_MGMT_FT_PSK) < 0 ||
-		    wpa_derive_pmk_r1(pmk_r0, PMK_LEN, pmk_r0_name, r1kh,
-				      sm->addr, pmk_r1, pmk_r1_name) < 0 ||
+		    wpa_derive_pmk_r1_name(pmk_r0_name, r1kh, sm->addr,
+					   pmk_r1_name, PMK_LEN) < 0 ||
 		    os_memcmp_const(pmk_r1_name, req_pmk_r1_name,
-				    WPA_PMK_NAME_LEN) != 0)
+				    WPA_PMK_NAME_LEN) != 0 ||
+		    wpa_derive_pmk_r1(pmk_r0, PMK_LEN, pmk_r0_name, r1kh,
+				      sm->addr, pmk_r1, pmk_r1_name) < 0)
 			continue;
 
 		/* We found a PSK that matches the requested pmk_r1_name */
@@ -3857,6 +3864,7 @@ static int wpa_ft_send_rrb_auth_resp(struct wpa_state_machine *sm,
 static int wpa_ft_rrb_build_r0(const u8 *key, const size_t key_len,
 			       const struct tlv_list *tlvs,
 			       const struct wpa_ft_pmk_r0_sa *pmk_r0,
+			       struct crypto_hmac_key *pmk_r0_key,
 			       const u8 *r1kh_id, const u8 *s1kh_id,
 			       const struct tlv_list *tlv_auth,
 			       const u8 *src_addr, u8 type,
@@ -3892,9 +3900,9 @@ static int wpa_ft_rrb_build_r0(const u8 *key, const size_t key_len,
 	};
 
 	wpa_printf(MSG_DEBUG, "FT: Derive PMK-R1 for peer AP");
-	if (wpa_derive_pmk_r1(pmk_r0->pmk_r0, pmk_r0->pmk_r0_len,
-			      pmk_r0->pmk_r0_name, r1kh_id,
-			      s1kh_id, pmk_r1, pmk_r1_name) < 0)
+	if (wpa_derive_pmk_r1_key(pmk_r0_key, pmk_r0->pmk_r0,
+				  pmk_r0->pmk_r0_len, pmk_r0->pmk_r0_name,
+				  r1kh_id, s1kh_id, pmk_r1, pmk_r1_name) < 0)
 		return -1;
 	WPA_PUT_LE16(f_pairwise, pmk_r0->pairwise);
 
@@ -4059,8 +4067,9 @@ static int wpa_ft_rrb_rx_pull(struct wpa_authenticator *wpa_auth,
 				       FT_PACKET_R0KH_R1KH_RESP,
 				       &packet, &packet_len);
 	} else {
-		ret = wpa_ft_rrb_build_r0(key, key_len, resp, r0, f_r1kh_id,
-					  f_s1kh_id, resp_auth, wpa_auth->addr,
+		ret = wpa_ft_rrb_build_r0(key, key_len, resp, r0, NULL,
+					  f_r1kh_id, f_s1kh_id, resp_auth,
+					  wpa_auth->addr,
 					  FT_PACKET_R0KH_R1KH_RESP,
 					  &packet, &packet_len);
 	}
@@ -4854,6 +4863,7 @@ void wpa_ft_rrb_oui_rx(struct wpa_authenticator *wpa_auth, const u8 *src_addr,
 
 static int wpa_ft_generate_pmk_r1(struct wpa_authenticator *wpa_auth,
 				  struct wpa_ft_pmk_r0_sa *pmk_r0,
+				  struct crypto_hmac_key *pmk_r0_key,
 				  struct ft_remote_r1kh *r1kh,
 				  const u8 *s1kh_id)
 {
@@ -4888,7 +4898,8 @@ static int wpa_ft_generate_pmk_r1(struct wpa_authenticator *wpa_auth,
 		   MAC2STR(wpa_auth->addr), MAC2STR(r1kh->addr));
 
 	if (wpa_ft_rrb_build_r0(r1kh->key, sizeof(r1kh->key), push, pmk_r0,
-				r1kh->id, s1kh_id, push_auth, wpa_auth->addr,
+				pmk_r0_key, r1kh->id, s1kh_id, push_auth,
+				wpa_auth->addr,
 				FT_PACKET_R0KH_R1KH_PUSH,
 				&packet, &packet_len) < 0)
 		return -1;
@@ -4906,6 +4917,7 @@ void wpa_ft_push_pmk_r1(struct wpa_authenticator *wpa_auth, const u8 *addr)
 	struct wpa_ft_pmk_cache *cache = wpa_auth->ft_pmk_cache;
 	struct wpa_ft_pmk_r0_sa *r0, *r0found = NULL;
 	struct ft_remote_r1kh *r1kh;
+	struct crypto_hmac_key *pmk_r0_key;
 
 	if (!wpa_auth->conf.pmk_r1_push)
 		return;
@@ -4927,14 +4939,19 @@ void wpa_ft_push_pmk_r1(struct wpa_authenticator *wpa_auth, const u8 *addr)
 	wpa_printf(MSG_DEBUG, "FT: Deriving and pushing PMK-R1 keys to R1KHs "
 		   "for STA " MACSTR, MAC2STR(addr));
 
+	/* All PMK-R1s are derived from the same PMK-R0 */
+	pmk_r0_key = wpa_pmk_r0_key_init(r0->pmk_r0, r0->pmk_r0_len);
+
 	for (r1kh = *wpa_auth->conf.r1kh_list; r1kh; r1kh = r1kh->next) {
 		if (is_zero_ether_addr(r1kh->addr) ||
 		    is_zero_ether_addr(r1kh->id))
 			continue;
 		if (wpa_ft_rrb_init_r1kh_seq(r1kh) < 0)
 			continue;
-		wpa_ft_generate_pmk_r1(wpa_auth, r0, r1kh, addr);
+		wpa_ft_generate_pmk_r1(wpa_auth, r0, pmk_r0_key, r1kh, addr);
 	}
+
+	crypto_hmac_key_deinit(pmk_r0_key);
 }
 
 #endif /* CONFIG_IEEE80211R_AP */
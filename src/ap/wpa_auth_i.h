@@ -97,6 +97,7 @@ struct wpa_state_machine {
 #endif /* CONFIG_IEEE80211R_AP */
 	unsigned int is_wnmsleep:1;
 	unsigned int pmkid_set:1;
+	unsigned int last_rx_eapol_key_borrowed:1;
 
 	unsigned int ptkstart_without_success;
 
@@ -15,6 +15,26 @@
 #include "x_snoop.h"
 
 
+struct x_snoop_fanout {
+	/* Addresses of the authorized STAs; rebuilt when marked invalid */
+	u8 *addrs;
+	size_t num_addrs;
+	size_t alloc_addrs;
+	bool addrs_valid;
+
+	/* Rate limiting of multicast-to-unicast conversion */
+	struct os_reltime limit_start;
+	unsigned int limit_count;
+
+	/* Statistics */
+	unsigned long mcast_frames; /* converted multicast frames */
+	unsigned long ucast_frames; /* unicast frames sent */
+	unsigned long ucast_failures; /* unicast frames that could not be sent */
+	unsigned long rate_limited; /* multicast frames dropped */
+	unsigned long batched; /* unicast frames sent in batches */
+};
+
+
 int x_snoop_init(struct hostapd_data *hapd)
 {
 	struct hostapd_bss_config *conf = hapd->conf;
@@ -31,6 +51,10 @@ int x_snoop_init(struct hostapd_data *hapd)
 		return -1;
 	}
 
+	hapd->x_snoop_fanout = os_zalloc(sizeof(*hapd->x_snoop_fanout));
+	if (!hapd->x_snoop_fanout)
+		return -1;
+
 	hapd->x_snoop_initialized = true;
 
 	if (hostapd_drv_br_port_set_attr(hapd, DRV_BR_PORT_ATTR_HAIRPIN_MODE,
@@ -94,34 +118,176 @@ x_snoop_get_l2_packet(struct hostapd_data *hapd,
 }
 
 
-void x_snoop_mcast_to_ucast_convert_send(struct hostapd_data *hapd,
-					 struct sta_info *sta, u8 *buf,
-					 size_t len)
+static int x_snoop_ucast_send(struct hostapd_data *hapd, const u8 *sta_addr,
+			      u8 *buf, size_t len)
 {
 	int res;
 	u8 addr[ETH_ALEN];
-	u8 *dst_addr = buf;
-
-	if (!(dst_addr[0] & 0x01))
-		return;
 
 	wpa_printf(MSG_EXCESSIVE, "x_snoop: Multicast-to-unicast conversion "
 		   MACSTR " -> " MACSTR " (len %u)",
-		   MAC2STR(dst_addr), MAC2STR(sta->addr), (unsigned int) len);
+		   MAC2STR(buf), MAC2STR(sta_addr), (unsigned int) len);
 
 	/* save the multicast destination address for restoring it later */
 	os_memcpy(addr, buf, ETH_ALEN);
 
-	os_memcpy(buf, sta->addr, ETH_ALEN);
+	os_memcpy(buf, sta_addr, ETH_ALEN);
 	res = l2_packet_send(hapd->sock_dhcp, NULL, 0, buf, len);
 	if (res < 0) {
 		wpa_printf(MSG_DEBUG,
 			   "x_snoop: Failed to send mcast to ucast converted packet to "
-			   MACSTR, MAC2STR(sta->addr));
+			   MACSTR, MAC2STR(sta_addr));
 	}
 
 	/* restore the multicast destination address */
 	os_memcpy(buf, addr, ETH_ALEN);
+
+	return res;
+}
+
+
+static int x_snoop_update_sta_addrs(struct hostapd_data *hapd,
+				    struct x_snoop_fanout *fanout)
+{
+	struct sta_info *sta;
+	size_t num = 0;
+	u8 *addrs;
+
+	if (fanout->addrs_valid)
+		return 0;
+
+	for (sta = hapd->sta_list; sta; sta = sta->next) {
+		if (sta->flags & WLAN_STA_AUTHORIZED)
+			num++;
+	}
+
+	if (num > fanout->alloc_addrs) {
+		addrs = os_realloc_array(fanout->addrs, num, ETH_ALEN);
+		if (!addrs)
+			return -1;
+		fanout->addrs = addrs;
+		fanout->alloc_addrs = num;
+	}
+
+	fanout->num_addrs = 0;
+	for (sta = hapd->sta_list; sta; sta = sta->next) {
+		if (!(sta->flags & WLAN_STA_AUTHORIZED))
+			continue;
+		os_memcpy(&fanout->addrs[fanout->num_addrs * ETH_ALEN],
+			  sta->addr, ETH_ALEN);
+		fanout->num_addrs++;
+	}
+	fanout->addrs_valid = true;
+
+	return 0;
+}
+
+
+static bool x_snoop_rate_limited(struct hostapd_data *hapd,
+				 struct x_snoop_fanout *fanout)
+{
+	unsigned int limit = hapd->conf->proxy_arp_mcast_to_ucast_limit;
+	struct os_reltime now;
+
+	if (!limit)
+		return false;
+
+	os_get_reltime(&now);
+	if (os_reltime_expired(&now, &fanout->limit_start, 1)) {
+		fanout->limit_start = now;
+		fanout->limit_count = 0;
+	}
+	if (fanout->limit_count >= limit) {
+		/* Log once for each one-second window in which frames are
+		 * dropped */
+		if (fanout->limit_count++ == limit)
+			wpa_printf(MSG_DEBUG,
+				   "x_snoop: Multicast-to-unicast conversion rate limit (%u frames per second) reached",
+				   limit);
+		return true;
+	}
+	fanout->limit_count++;
+	return false;
+}
+
+
+void x_snoop_mcast_to_ucast_fanout(struct hostapd_data *hapd, u8 *buf,
+				   size_t len)
+{
+	struct x_snoop_fanout *fanout = hapd->x_snoop_fanout;
+	size_t i;
+	int res;
+
+	if (!fanout || len < ETH_HLEN || !(buf[0] & 0x01))
+		return;
+
+	if (x_snoop_update_sta_addrs(hapd, fanout) < 0 ||
+	    fanout->num_addrs == 0)
+		return;
+
+	if (x_snoop_rate_limited(hapd, fanout)) {
+		fanout->rate_limited++;
+		return;
+	}
+
+	wpa_printf(MSG_EXCESSIVE, "x_snoop: Multicast-to-unicast conversion "
+		   MACSTR " to %u STA(s) (len %u)",
+		   MAC2STR(buf), (unsigned int) fanout->num_addrs,
+		   (unsigned int) len);
+	fanout->mcast_frames++;
+
+	/*
+	 * Copies of the frame with only the destination address replaced. A
+	 * single frame is sent directly since a batch would not save anything.
+	 */
+	res = 0;
+	if (fanout->num_addrs > 1) {
+		res = l2_packet_send_multi(hapd->sock_dhcp, fanout->addrs,
+					   fanout->num_addrs, buf, len);
+		if (res < 0)
+			res = 0;
+		fanout->ucast_frames += res;
+		fanout->batched += res;
+	}
+
+	/* Send the remaining frames one by one */
+	for (i = res; i < fanout->num_addrs; i++) {
+		if (x_snoop_ucast_send(hapd, &fanout->addrs[i * ETH_ALEN],
+				       buf, len) < 0)
+			fanout->ucast_failures++;
+		else
+			fanout->ucast_frames++;
+	}
+}
+
+
+void x_snoop_sta_authorized_changed(struct hostapd_data *hapd)
+{
+	if (hapd->x_snoop_fanout)
+		hapd->x_snoop_fanout->addrs_valid = false;
+}
+
+
+int x_snoop_get_mib(struct hostapd_data *hapd, char *buf, size_t buflen)
+{
+	struct x_snoop_fanout *fanout = hapd->x_snoop_fanout;
+	int ret;
+
+	if (!fanout)
+		return 0;
+
+	ret = os_snprintf(buf, buflen,
+			  "mcastToUcastFrames=%lu\n"
+			  "mcastToUcastRateLimited=%lu\n"
+			  "mcastToUcastUnicastFrames=%lu\n"
+			  "mcastToUcastUnicastBatched=%lu\n"
+			  "mcastToUcastUnicastFailures=%lu\n",
+			  fanout->mcast_frames, fanout->rate_limited,
+			  fanout->ucast_frames, fanout->batched,
+			  fanout->ucast_failures);
+	if (os_snprintf_error(buflen, ret))
+		return 0;
+	return ret;
 }
 
 
@@ -132,5 +298,10 @@ void x_snoop_deinit(struct hostapd_data *hapd)
 	hostapd_drv_br_set_net_param(hapd, DRV_BR_NET_PARAM_GARP_ACCEPT, 0);
 	hostapd_drv_br_port_set_attr(hapd, DRV_BR_PORT_ATTR_PROXYARP, 0);
 	hostapd_drv_br_port_set_attr(hapd, DRV_BR_PORT_ATTR_HAIRPIN_MODE, 0);
+	if (hapd->x_snoop_fanout) {
+		os_free(hapd->x_snoop_fanout->addrs);
+		os_free(hapd->x_snoop_fanout);
+		hapd->x_snoop_fanout = NULL;
+	}
 	hapd->x_snoop_initialized = false;
 }
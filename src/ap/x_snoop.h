@@ -19,9 +19,10 @@ x_snoop_get_l2_packet(struct hostapd_data *hapd,
 		      void (*handler)(void *ctx, const u8 *src_addr,
 				      const u8 *buf, size_t len),
 		      enum l2_packet_filter_type type);
-void x_snoop_mcast_to_ucast_convert_send(struct hostapd_data *hapd,
-					 struct sta_info *sta, u8 *buf,
-					 size_t len);
+void x_snoop_mcast_to_ucast_fanout(struct hostapd_data *hapd, u8 *buf,
+				   size_t len);
+void x_snoop_sta_authorized_changed(struct hostapd_data *hapd);
+int x_snoop_get_mib(struct hostapd_data *hapd, char *buf, size_t buflen);
 void x_snoop_deinit(struct hostapd_data *hapd);
 
 #else /* CONFIG_PROXYARP */
@@ -40,13 +41,21 @@ x_snoop_get_l2_packet(struct hostapd_data *hapd,
 	return NULL;
 }
 
-static inline void
-x_snoop_mcast_to_ucast_convert_send(struct hostapd_data *hapd,
-				    struct sta_info *sta, void *buf,
-				    size_t len)
+static inline void x_snoop_mcast_to_ucast_fanout(struct hostapd_data *hapd,
+						 u8 *buf, size_t len)
 {
 }
 
+static inline void x_snoop_sta_authorized_changed(struct hostapd_data *hapd)
+{
+}
+
+static inline int x_snoop_get_mib(struct hostapd_data *hapd, char *buf,
+				  size_t buflen)
+{
+	return 0;
+}
+
 static inline void x_snoop_deinit(struct hostapd_data *hapd)
 {
 }
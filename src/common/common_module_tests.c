@@ -251,6 +251,66 @@ static int gas_tests(void)
 }
 
 
+#ifdef CONFIG_SAE
+
+static int sae_handshake(const struct sae_pt *pt, const char *pw)
+{
+	const u8 addr[2][ETH_ALEN] = {
+		{ 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 },
+		{ 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 }
+	};
+	struct sae_data sae[2];
+	struct wpabuf *commit[2] = { NULL, NULL }, *confirm[2] = { NULL, NULL };
+	int i, ret = -1;
+
+	os_memset(sae, 0, sizeof(sae));
+
+	for (i = 0; i < 2; i++) {
+		commit[i] = wpabuf_alloc(1000);
+		confirm[i] = wpabuf_alloc(100);
+		if (!commit[i] || !confirm[i] ||
+		    sae_set_group(&sae[i], 19) < 0 ||
+		    (pt && sae_prepare_commit_pt(&sae[i], pt, addr[i],
+						 addr[!i], NULL, NULL) < 0) ||
+		    (!pt && sae_prepare_commit(addr[i], addr[!i],
+					       (const u8 *) pw, os_strlen(pw),
+					       &sae[i]) < 0) ||
+		    sae_write_commit(&sae[i], commit[i], NULL, NULL) < 0)
+			goto fail;
+	}
+
+	for (i = 0; i < 2; i++) {
+		if (sae_parse_commit(&sae[i], wpabuf_head(commit[!i]),
+				     wpabuf_len(commit[!i]), NULL, NULL, NULL,
+				     !!pt, NULL) != WLAN_STATUS_SUCCESS ||
+		    sae_process_commit(&sae[i]) < 0 ||
+		    sae_write_confirm(&sae[i], confirm[i]) < 0)
+			goto fail;
+	}
+
+	for (i = 0; i < 2; i++) {
+		if (sae_check_confirm(&sae[i], wpabuf_head(confirm[!i]),
+				      wpabuf_len(confirm[!i]), NULL) < 0)
+			goto fail;
+	}
+
+	if (sae[0].pmk_len != sae[1].pmk_len ||
+	    os_memcmp(sae[0].pmk, sae[1].pmk, sae[0].pmk_len) != 0)
+		goto fail;
+
+	ret = 0;
+fail:
+	for (i = 0; i < 2; i++) {
+		sae_clear_data(&sae[i]);
+		wpabuf_free(commit[i]);
+		wpabuf_free(confirm[i]);
+	}
+	return ret;
+}
+
+#endif /* CONFIG_SAE */
+
+
 static int sae_tests(void)
 {
 #ifdef CONFIG_SAE
@@ -501,6 +561,40 @@ static int sae_tests(void)
 		}
 	}
 
+	/* PWE from the precomputed PT tables must match the generic result */
+	sae_pt_precompute(pt_info);
+	for (pt = pt_info; pt; pt = pt->next) {
+		struct crypto_ec_point_table *table;
+		struct crypto_ec_point *pwe[2];
+		int j, res;
+
+		if (!pt->ec)
+			continue;
+		table = pt->ecc_pt_table;
+		for (j = 0; j < 2; j++) {
+			pt->ecc_pt_table = j ? table : NULL;
+			pwe[j] = sae_derive_pwe_from_pt_ecc(pt, addr1b, addr2b);
+		}
+		res = !pwe[0] || !pwe[1] || !table ||
+			crypto_ec_point_cmp(pt->ec, pwe[0], pwe[1]) != 0;
+		crypto_ec_point_deinit(pwe[0], 1);
+		crypto_ec_point_deinit(pwe[1], 1);
+		if (res) {
+			wpa_printf(MSG_ERROR,
+				   "SAE: PWE mismatch with PT table for group %d",
+				   pt->group);
+			sae_deinit_pt(pt_info);
+			goto fail;
+		}
+	}
+
+	/* Full commit/confirm exchanges between two instances */
+	if (sae_handshake(NULL, pw) < 0 || sae_handshake(pt_info, pw) < 0) {
+		wpa_printf(MSG_ERROR, "SAE: Handshake failed");
+		sae_deinit_pt(pt_info);
+		goto fail;
+	}
+
 	sae_deinit_pt(pt_info);
 
 	ret = 0;
@@ -776,6 +870,146 @@ static int pasn_tests(void)
 }
 
 
+static int ptk_derivation_check(const char *title, size_t pmk_len, int akmp,
+				int cipher, const u8 *expected,
+				size_t expected_len)
+{
+	u8 pmk[PMK_LEN_MAX], nonce1[WPA_NONCE_LEN], nonce2[WPA_NONCE_LEN];
+	const u8 addr1[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+	const u8 addr2[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 };
+	u8 buf[WPA_KCK_MAX_LEN + WPA_KEK_MAX_LEN + WPA_TK_MAX_LEN];
+	struct wpa_ptk ptk;
+	int ret = -1;
+
+	os_memset(pmk, 0x11, sizeof(pmk));
+	os_memset(nonce1, 0x22, sizeof(nonce1));
+	os_memset(nonce2, 0x33, sizeof(nonce2));
+
+	if (wpa_pmk_to_ptk(pmk, pmk_len, "Pairwise key expansion",
+			   addr1, addr2, nonce1, nonce2, &ptk, akmp,
+			   cipher, NULL, 0, 0) < 0 ||
+	    ptk.kck_len + ptk.kek_len + ptk.tk_len != expected_len)
+		goto fail;
+	os_memcpy(buf, ptk.kck, ptk.kck_len);
+	os_memcpy(buf + ptk.kck_len, ptk.kek, ptk.kek_len);
+	os_memcpy(buf + ptk.kck_len + ptk.kek_len, ptk.tk, ptk.tk_len);
+	if (os_memcmp(buf, expected, expected_len) != 0)
+		goto fail;
+
+	ret = 0;
+fail:
+	if (ret)
+		wpa_printf(MSG_ERROR, "PTK derivation (%s) mismatch", title);
+	forced_memzero(&ptk, sizeof(ptk));
+	forced_memzero(buf, sizeof(buf));
+	return ret;
+}
+
+
+#ifdef CONFIG_IEEE80211R
+static int ft_pmk_r1_tests(void)
+{
+	u8 pmk_r0[PMK_LEN], pmk_r0_name[WPA_PMK_NAME_LEN];
+	u8 r1kh_id[FT_R1KH_ID_LEN];
+	const u8 s1kh_id[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+	u8 pmk_r1[PMK_LEN], pmk_r1_key[PMK_LEN];
+	u8 pmk_r1_name[WPA_PMK_NAME_LEN];
+	const u8 pmk_r1_expected[PMK_LEN] = {
+		0x05, 0x30, 0x81, 0x24, 0x7b, 0x3b, 0x87, 0xf0,
+		0x9e, 0xdd, 0x12, 0x19, 0xf7, 0x87, 0xa3, 0xcb,
+		0xa8, 0x3e, 0x75, 0xa4, 0x7d, 0xf6, 0xef, 0xd1,
+		0xb7, 0x66, 0x01, 0x83, 0xfd, 0xa1, 0xd0, 0xfd,
+	};
+	struct crypto_hmac_key *hkey;
+	int ret = -1;
+
+	os_memset(pmk_r0, 0x44, sizeof(pmk_r0));
+	os_memset(pmk_r0_name, 0x55, sizeof(pmk_r0_name));
+	os_memset(r1kh_id, 0x66, sizeof(r1kh_id));
+
+	/* Precomputed PMK-R0 key must give the same PMK-R1 */
+	hkey = wpa_pmk_r0_key_init(pmk_r0, sizeof(pmk_r0));
+	if (wpa_derive_pmk_r1(pmk_r0, sizeof(pmk_r0), pmk_r0_name, r1kh_id,
+			      s1kh_id, pmk_r1, pmk_r1_name) < 0 ||
+	    os_memcmp(pmk_r1, pmk_r1_expected, sizeof(pmk_r1)) != 0 ||
+	    wpa_derive_pmk_r1_key(hkey, pmk_r0, sizeof(pmk_r0), pmk_r0_name,
+				  r1kh_id, s1kh_id, pmk_r1_key,
+				  pmk_r1_name) < 0 ||
+	    os_memcmp(pmk_r1_key, pmk_r1_expected, sizeof(pmk_r1_key)) != 0) {
+		wpa_printf(MSG_ERROR, "FT: PMK-R1 derivation mismatch");
+		goto fail;
+	}
+
+	ret = 0;
+fail:
+	crypto_hmac_key_deinit(hkey);
+	forced_memzero(pmk_r1, sizeof(pmk_r1));
+	forced_memzero(pmk_r1_key, sizeof(pmk_r1_key));
+	return ret;
+}
+#endif /* CONFIG_IEEE80211R */
+
+
+static int ptk_derivation_tests(void)
+{
+	/* PRF-SHA1 over three blocks */
+	const u8 ptk_psk[] = {
+		0x24, 0x1c, 0x37, 0xa1, 0x8c, 0x64, 0x8b, 0xe0,
+		0x3f, 0xed, 0xd1, 0xa1, 0x0c, 0xd0, 0xa0, 0x34,
+		0xb6, 0xbe, 0x15, 0x62, 0xfd, 0x03, 0x1d, 0x5b,
+		0x23, 0x90, 0x73, 0x33, 0x90, 0x31, 0x15, 0xc4,
+		0xbf, 0x48, 0x62, 0x78, 0x28, 0xe4, 0x00, 0xa4,
+		0x8e, 0x06, 0xa6, 0x92, 0xb8, 0xc3, 0x43, 0xfc,
+	};
+	/* KDF-SHA256 over two blocks */
+	const u8 ptk_psk_sha256[] = {
+		0xd3, 0xb9, 0x00, 0x41, 0xf0, 0xad, 0xfb, 0x69,
+		0xe0, 0xb5, 0x6f, 0xef, 0x77, 0xc1, 0x90, 0x5d,
+		0xd1, 0x8b, 0x1d, 0x4b, 0x02, 0x4a, 0xf2, 0x91,
+		0xb7, 0xd2, 0x22, 0xaf, 0x0c, 0xf8, 0xfb, 0x55,
+		0xdd, 0x1c, 0xea, 0xa5, 0xe8, 0xd4, 0xf4, 0xcc,
+		0x7a, 0x31, 0xc0, 0x53, 0x69, 0x8d, 0xc6, 0xd7,
+	};
+#if defined(CONFIG_SAE) && defined(CONFIG_SHA384)
+	/* KDF-SHA384 over two blocks */
+	const u8 ptk_sae_ext_key[] = {
+		0x3d, 0x05, 0xa4, 0x84, 0x89, 0x4c, 0xce, 0xe4,
+		0x67, 0xe8, 0x7b, 0xe8, 0xd2, 0x43, 0x57, 0xbc,
+		0xb6, 0x59, 0x6d, 0x01, 0x34, 0x8e, 0x01, 0xad,
+		0x8b, 0x1d, 0x93, 0xe0, 0x5c, 0x36, 0xbd, 0x5b,
+		0x5e, 0x40, 0xf6, 0x0e, 0x40, 0xdd, 0x2f, 0xc9,
+		0x15, 0x45, 0xe9, 0x20, 0x60, 0xae, 0x02, 0xe7,
+		0x2a, 0xcd, 0xfa, 0x42, 0xb5, 0x7b, 0x6f, 0x08,
+		0x5c, 0xd4, 0x62, 0xb9, 0xbd, 0x77, 0xee, 0x5a,
+		0xc4, 0x46, 0x54, 0xd4, 0xb1, 0x1d, 0x4f, 0xea,
+		0x9e, 0xf5, 0x6c, 0x20, 0xb0, 0x1a, 0xda, 0x44,
+		0xcd, 0x54, 0xfa, 0xd4, 0x13, 0xe3, 0xc7, 0xc9,
+	};
+#endif /* CONFIG_SAE && CONFIG_SHA384 */
+
+	if (ptk_derivation_check("PSK", PMK_LEN, WPA_KEY_MGMT_PSK,
+				 WPA_CIPHER_CCMP, ptk_psk,
+				 sizeof(ptk_psk)) < 0 ||
+	    ptk_derivation_check("PSK-SHA256", PMK_LEN,
+				 WPA_KEY_MGMT_PSK_SHA256, WPA_CIPHER_CCMP,
+				 ptk_psk_sha256, sizeof(ptk_psk_sha256)) < 0)
+		return -1;
+#if defined(CONFIG_SAE) && defined(CONFIG_SHA384)
+	if (ptk_derivation_check("SAE-EXT-KEY/SHA384", 48,
+				 WPA_KEY_MGMT_SAE_EXT_KEY, WPA_CIPHER_GCMP_256,
+				 ptk_sae_ext_key, sizeof(ptk_sae_ext_key)) < 0)
+		return -1;
+#endif /* CONFIG_SAE && CONFIG_SHA384 */
+
+#ifdef CONFIG_IEEE80211R
+	if (ft_pmk_r1_tests() < 0)
+		return -1;
+#endif /* CONFIG_IEEE80211R */
+
+	return 0;
+}
+
+
 int common_module_tests(void)
 {
 	int ret = 0;
@@ -787,7 +1021,8 @@ int common_module_tests(void)
 	    sae_tests() < 0 ||
 	    sae_pk_tests() < 0 ||
 	    pasn_tests() < 0 ||
-	    rsn_ie_parse_tests() < 0)
+	    rsn_ie_parse_tests() < 0 ||
+	    ptk_derivation_tests() < 0)
 		ret = -1;
 
 	return ret;
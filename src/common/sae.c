@@ -1180,10 +1180,13 @@ sae_derive_pwe_from_pt_ecc(const struct sae_pt *pt,
 		goto fail;
 	debug_print_bignum("SAE: val(reduced to 1..q-1)", val, prime_len);
 
-	/* PWE = scalar-op(val, PT) */
+	/* PWE = scalar-op(val, PT); val is derived from the MAC addresses and
+	 * is not secret, so the precomputed PT table can be used. */
 	pwe = crypto_ec_point_init(pt->ec);
 	if (!pwe ||
-	    crypto_ec_point_mul(pt->ec, pt->ecc_pt, val, pwe) < 0 ||
+	    (pt->ecc_pt_table ?
+	     crypto_ec_point_table_mul(pt->ec, pt->ecc_pt_table, val, pwe) :
+	     crypto_ec_point_mul(pt->ec, pt->ecc_pt, val, pwe)) < 0 ||
 	    crypto_ec_point_to_bin(pt->ec, pwe, bin, bin + prime_len) < 0) {
 		crypto_ec_point_deinit(pwe, 1);
 		pwe = NULL;
@@ -1260,11 +1263,35 @@ fail:
 }
 
 
+/**
+ * sae_pt_precompute - Precompute multiples of PT for faster PWE derivation
+ * @pt: List of PT entries from sae_derive_pt()
+ *
+ * This is useful when the same PT is used for a large number of SAE
+ * instances, e.g., on an AP. Failures are not fatal; PWE derivation falls
+ * back to the generic scalar multiplication for entries without a table.
+ */
+void sae_pt_precompute(struct sae_pt *pt)
+{
+	for (; pt; pt = pt->next) {
+		if (!pt->ec || !pt->ecc_pt || pt->ecc_pt_table)
+			continue;
+		pt->ecc_pt_table = crypto_ec_point_table_init(pt->ec,
+							      pt->ecc_pt);
+		if (!pt->ecc_pt_table)
+			wpa_printf(MSG_DEBUG,
+				   "SAE: Could not precompute PT table for group %d",
+				   pt->group);
+	}
+}
+
+
 void sae_deinit_pt(struct sae_pt *pt)
 {
 	struct sae_pt *prev;
 
 	while (pt) {
+		crypto_ec_point_table_deinit(pt->ecc_pt_table);
 		crypto_ec_point_deinit(pt->ecc_pt, 1);
 		crypto_bignum_deinit(pt->ffc_pt, 1);
 		crypto_ec_deinit(pt->ec);
@@ -1321,12 +1348,13 @@ static int sae_derive_commit_element_ffc(struct sae_data *sae,
 }
 
 
-static int sae_derive_commit(struct sae_data *sae)
+static int sae_derive_commit(struct sae_data *sae,
+			     struct crypto_scratch *scratch)
 {
 	struct crypto_bignum *mask;
 	int ret;
 
-	mask = crypto_bignum_init();
+	mask = crypto_scratch_bignum(scratch);
 	if (!sae->tmp->sae_rand)
 		sae->tmp->sae_rand = crypto_bignum_init();
 	if (!sae->tmp->own_commit_scalar)
@@ -1339,7 +1367,6 @@ static int sae_derive_commit(struct sae_data *sae)
 		 sae_derive_commit_element_ecc(sae, mask) < 0) ||
 		(sae->tmp->dh &&
 		 sae_derive_commit_element_ffc(sae, mask) < 0);
-	crypto_bignum_deinit(mask, 1);
 	return ret ? -1 : 0;
 }
 
@@ -1348,16 +1375,26 @@ int sae_prepare_commit(const u8 *addr1, const u8 *addr2,
 		       const u8 *password, size_t password_len,
 		       struct sae_data *sae)
 {
-	if (sae->tmp == NULL ||
+	struct crypto_scratch *scratch;
+	int ret = -1;
+
+	if (sae->tmp == NULL)
+		return -1;
+
+	scratch = crypto_scratch_init();
+	if (!scratch ||
 	    (sae->tmp->ec && sae_derive_pwe_ecc(sae, addr1, addr2, password,
 						password_len) < 0) ||
 	    (sae->tmp->dh && sae_derive_pwe_ffc(sae, addr1, addr2, password,
 						password_len) < 0))
-		return -1;
+		goto fail;
 
 	sae->h2e = 0;
 	sae->pk = 0;
-	return sae_derive_commit(sae);
+	ret = sae_derive_commit(sae, scratch);
+fail:
+	crypto_scratch_deinit(scratch);
+	return ret;
 }
 
 
@@ -1365,6 +1402,9 @@ int sae_prepare_commit_pt(struct sae_data *sae, const struct sae_pt *pt,
 			  const u8 *addr1, const u8 *addr2,
 			  int *rejected_groups, const struct sae_pk *pk)
 {
+	struct crypto_scratch *scratch;
+	int ret = -1;
+
 	if (!sae->tmp)
 		return -1;
 
@@ -1400,12 +1440,16 @@ int sae_prepare_commit_pt(struct sae_data *sae, const struct sae_pt *pt,
 		sae->tmp->own_rejected_groups = groups;
 	}
 
+	scratch = crypto_scratch_init();
+	if (!scratch)
+		return -1;
+
 	if (pt->ec) {
 		crypto_ec_point_deinit(sae->tmp->pwe_ecc, 1);
 		sae->tmp->pwe_ecc = sae_derive_pwe_from_pt_ecc(pt, addr1,
 							       addr2);
 		if (!sae->tmp->pwe_ecc)
-			return -1;
+			goto fail;
 	}
 
 	if (pt->dh) {
@@ -1413,22 +1457,25 @@ int sae_prepare_commit_pt(struct sae_data *sae, const struct sae_pt *pt,
 		sae->tmp->pwe_ffc = sae_derive_pwe_from_pt_ffc(pt, addr1,
 							       addr2);
 		if (!sae->tmp->pwe_ffc)
-			return -1;
+			goto fail;
 	}
 
 	sae->h2e = 1;
-	return sae_derive_commit(sae);
+	ret = sae_derive_commit(sae, scratch);
+fail:
+	crypto_scratch_deinit(scratch);
+	return ret;
 }
 
 
-static int sae_derive_k_ecc(struct sae_data *sae, u8 *k)
+static int sae_derive_k_ecc(struct sae_data *sae, u8 *k,
+			    struct crypto_scratch *scratch)
 {
 	struct crypto_ec_point *K;
-	int ret = -1;
 
-	K = crypto_ec_point_init(sae->tmp->ec);
+	K = crypto_scratch_point(scratch, sae->tmp->ec);
 	if (K == NULL)
-		goto fail;
+		return -1;
 
 	/*
 	 * K = scalar-op(rand, (elem-op(scalar-op(peer-commit-scalar, PWE),
@@ -1445,26 +1492,23 @@ static int sae_derive_k_ecc(struct sae_data *sae, u8 *k)
 	    crypto_ec_point_is_at_infinity(sae->tmp->ec, K) ||
 	    crypto_ec_point_to_bin(sae->tmp->ec, K, k, NULL) < 0) {
 		wpa_printf(MSG_DEBUG, "SAE: Failed to calculate K and k");
-		goto fail;
+		return -1;
 	}
 
 	wpa_hexdump_key(MSG_DEBUG, "SAE: k", k, sae->tmp->prime_len);
 
-	ret = 0;
-fail:
-	crypto_ec_point_deinit(K, 1);
-	return ret;
+	return 0;
 }
 
 
-static int sae_derive_k_ffc(struct sae_data *sae, u8 *k)
+static int sae_derive_k_ffc(struct sae_data *sae, u8 *k,
+			    struct crypto_scratch *scratch)
 {
 	struct crypto_bignum *K;
-	int ret = -1;
 
-	K = crypto_bignum_init();
+	K = crypto_scratch_bignum(scratch);
 	if (K == NULL)
-		goto fail;
+		return -1;
 
 	/*
 	 * K = scalar-op(rand, (elem-op(scalar-op(peer-commit-scalar, PWE),
@@ -1483,15 +1527,12 @@ static int sae_derive_k_ffc(struct sae_data *sae, u8 *k)
 	    crypto_bignum_to_bin(K, k, SAE_MAX_PRIME_LEN, sae->tmp->prime_len) <
 	    0) {
 		wpa_printf(MSG_DEBUG, "SAE: Failed to calculate K and k");
-		goto fail;
+		return -1;
 	}
 
 	wpa_hexdump_key(MSG_DEBUG, "SAE: k", k, sae->tmp->prime_len);
 
-	ret = 0;
-fail:
-	crypto_bignum_deinit(K, 1);
-	return ret;
+	return 0;
 }
 
 
@@ -1516,7 +1557,8 @@ static int sae_kdf_hash(size_t hash_len, const u8 *k, const char *label,
 }
 
 
-static int sae_derive_keys(struct sae_data *sae, const u8 *k)
+static int sae_derive_keys(struct sae_data *sae, const u8 *k,
+			   struct crypto_scratch *scratch)
 {
 	u8 zero[SAE_MAX_HASH_LEN], val[SAE_MAX_PRIME_LEN];
 	const u8 *salt;
@@ -1530,7 +1572,7 @@ static int sae_derive_keys(struct sae_data *sae, const u8 *k)
 	const u8 *addr[1];
 	size_t len[1];
 
-	tmp = crypto_bignum_init();
+	tmp = crypto_scratch_bignum(scratch);
 	if (tmp == NULL)
 		goto fail;
 
@@ -1653,7 +1695,6 @@ static int sae_derive_keys(struct sae_data *sae, const u8 *k)
 	ret = 0;
 fail:
 	wpabuf_free(rejected_groups);
-	crypto_bignum_deinit(tmp, 0);
 	return ret;
 }
 
@@ -1661,12 +1702,19 @@ fail:
 int sae_process_commit(struct sae_data *sae)
 {
 	u8 k[SAE_MAX_PRIME_LEN];
-	if (sae->tmp == NULL ||
-	    (sae->tmp->ec && sae_derive_k_ecc(sae, k) < 0) ||
-	    (sae->tmp->dh && sae_derive_k_ffc(sae, k) < 0) ||
-	    sae_derive_keys(sae, k) < 0)
+	struct crypto_scratch *scratch;
+	int ret;
+
+	if (sae->tmp == NULL)
 		return -1;
-	return 0;
+
+	scratch = crypto_scratch_init();
+	ret = !scratch ||
+		(sae->tmp->ec && sae_derive_k_ecc(sae, k, scratch) < 0) ||
+		(sae->tmp->dh && sae_derive_k_ffc(sae, k, scratch) < 0) ||
+		sae_derive_keys(sae, k, scratch) < 0;
+	crypto_scratch_deinit(scratch);
+	return ret ? -1 : 0;
 }
 
 
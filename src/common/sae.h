@@ -89,6 +89,7 @@ struct sae_pt {
 	int group;
 	struct crypto_ec *ec;
 	struct crypto_ec_point *ecc_pt;
+	struct crypto_ec_point_table *ecc_pt_table;
 
 	const struct dh_group *dh;
 	struct crypto_bignum *ffc_pt;
@@ -153,6 +154,7 @@ sae_derive_pwe_from_pt_ecc(const struct sae_pt *pt,
 struct crypto_bignum *
 sae_derive_pwe_from_pt_ffc(const struct sae_pt *pt,
 			   const u8 *addr1, const u8 *addr2);
+void sae_pt_precompute(struct sae_pt *pt);
 void sae_deinit_pt(struct sae_pt *pt);
 
 /* sae_pk.c */
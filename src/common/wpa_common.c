@@ -2233,6 +2233,48 @@ int wpa_derive_pmk_r1(const u8 *pmk_r0, size_t pmk_r0_len,
 		      const u8 *pmk_r0_name,
 		      const u8 *r1kh_id, const u8 *s1kh_id,
 		      u8 *pmk_r1, u8 *pmk_r1_name)
+{
+	return wpa_derive_pmk_r1_key(NULL, pmk_r0, pmk_r0_len, pmk_r0_name,
+				     r1kh_id, s1kh_id, pmk_r1, pmk_r1_name);
+}
+
+
+/**
+ * wpa_pmk_r0_key_init - Precompute the HMAC key for PMK-R1 derivation
+ * @pmk_r0: PMK-R0
+ * @pmk_r0_len: Length of PMK-R0 in octets
+ * Returns: Key for wpa_derive_pmk_r1_key() or %NULL if not available
+ *
+ * This can be used by an R0KH that derives PMK-R1s for multiple R1KHs from
+ * the same PMK-R0. The key is freed with crypto_hmac_key_deinit().
+ */
+struct crypto_hmac_key * wpa_pmk_r0_key_init(const u8 *pmk_r0,
+					     size_t pmk_r0_len)
+{
+	enum crypto_hash_alg alg;
+
+	if (pmk_r0_len == SHA512_MAC_LEN)
+		alg = CRYPTO_HASH_ALG_HMAC_SHA512;
+	else if (pmk_r0_len == SHA384_MAC_LEN)
+		alg = CRYPTO_HASH_ALG_HMAC_SHA384;
+	else
+		alg = CRYPTO_HASH_ALG_HMAC_SHA256;
+
+	return crypto_hmac_key_init(alg, pmk_r0, pmk_r0_len);
+}
+
+
+/**
+ * wpa_derive_pmk_r1_key - Derive PMK-R1 using a precomputed PMK-R0 key
+ * @pmk_r0_key: Key from wpa_pmk_r0_key_init() for pmk_r0 or %NULL
+ *
+ * This is otherwise identical to wpa_derive_pmk_r1().
+ */
+int wpa_derive_pmk_r1_key(struct crypto_hmac_key *pmk_r0_key,
+			  const u8 *pmk_r0, size_t pmk_r0_len,
+			  const u8 *pmk_r0_name,
+			  const u8 *r1kh_id, const u8 *s1kh_id,
+			  u8 *pmk_r1, u8 *pmk_r1_name)
 {
 	u8 buf[FT_R1KH_ID_LEN + ETH_ALEN];
 	u8 *pos;
@@ -2253,17 +2295,20 @@ int wpa_derive_pmk_r1(const u8 *pmk_r0, size_t pmk_r0_len,
 	res = -1;
 #ifdef CONFIG_SHA512
 	if (pmk_r0_len == SHA512_MAC_LEN)
-		res = sha512_prf(pmk_r0, pmk_r0_len, "FT-R1",
-				 buf, pos - buf, pmk_r1, pmk_r0_len);
+		res = sha512_prf_key(pmk_r0_key, pmk_r0, pmk_r0_len,
+				     "FT-R1", buf, pos - buf, pmk_r1,
+				     pmk_r0_len);
 #endif /* CONFIG_SHA512 */
 #ifdef CONFIG_SHA384
 	if (pmk_r0_len == SHA384_MAC_LEN)
-		res = sha384_prf(pmk_r0, pmk_r0_len, "FT-R1",
-				 buf, pos - buf, pmk_r1, pmk_r0_len);
+		res = sha384_prf_key(pmk_r0_key, pmk_r0, pmk_r0_len,
+				     "FT-R1", buf, pos - buf, pmk_r1,
+				     pmk_r0_len);
 #endif /* CONFIG_SHA384 */
 	if (pmk_r0_len == SHA256_MAC_LEN)
-		res = sha256_prf(pmk_r0, pmk_r0_len, "FT-R1",
-				 buf, pos - buf, pmk_r1, pmk_r0_len);
+		res = sha256_prf_key(pmk_r0_key, pmk_r0, pmk_r0_len,
+				     "FT-R1", buf, pos - buf, pmk_r1,
+				     pmk_r0_len);
 	if (res < 0) {
 		wpa_printf(MSG_ERROR, "FT: Failed to derive PMK-R1");
 		return res;
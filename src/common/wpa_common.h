@@ -9,6 +9,8 @@
 #ifndef WPA_COMMON_H
 #define WPA_COMMON_H
 
+struct crypto_hmac_key;
+
 /* IEEE 802.11i */
 #define PMKID_LEN 16
 #define PMK_LEN 32
@@ -495,6 +497,13 @@ int wpa_derive_pmk_r1(const u8 *pmk_r0, size_t pmk_r0_len,
 		      const u8 *pmk_r0_name,
 		      const u8 *r1kh_id, const u8 *s1kh_id,
 		      u8 *pmk_r1, u8 *pmk_r1_name);
+struct crypto_hmac_key * wpa_pmk_r0_key_init(const u8 *pmk_r0,
+					     size_t pmk_r0_len);
+int wpa_derive_pmk_r1_key(struct crypto_hmac_key *pmk_r0_key,
+			  const u8 *pmk_r0, size_t pmk_r0_len,
+			  const u8 *pmk_r0_name,
+			  const u8 *r1kh_id, const u8 *s1kh_id,
+			  u8 *pmk_r1, u8 *pmk_r1_name);
 int wpa_pmk_r1_to_ptk(const u8 *pmk_r1, size_t pmk_r1_len, const u8 *snonce,
 		      const u8 *anonce, const u8 *sta_addr, const u8 *bssid,
 		      const u8 *pmk_r1_name,
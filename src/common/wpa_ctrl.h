@@ -346,6 +346,8 @@ extern "C" {
 #define AP_STA_DISCONNECTED "AP-STA-DISCONNECTED "
 #define AP_STA_POSSIBLE_PSK_MISMATCH "AP-STA-POSSIBLE-PSK-MISMATCH "
 #define AP_STA_POLL_OK "AP-STA-POLL-OK "
+/* Proxy ARP: IP address learned for a STA was owned by another STA */
+#define AP_STA_IP_CONFLICT "AP-STA-IP-CONFLICT "
 
 #define AP_REJECTED_MAX_STA "AP-REJECTED-MAX-STA "
 #define AP_REJECTED_BLOCKED_STA "AP-REJECTED-BLOCKED-STA "
@@ -12,6 +12,9 @@
 #include "common.h"
 #include "aes.h"
 #include "aes_wrap.h"
+#ifdef CONFIG_INTERNAL_AES_NI
+#include "aes_i.h"
+#endif /* CONFIG_INTERNAL_AES_NI */
 
 /**
  * aes_ctr_encrypt - AES-128/192/256 CTR mode encryption
@@ -36,6 +39,14 @@ int aes_ctr_encrypt(const u8 *key, size_t key_len, const u8 *nonce,
 		return -1;
 	os_memcpy(counter, nonce, AES_BLOCK_SIZE);
 
+#ifdef CONFIG_INTERNAL_AES_NI
+	len = left & ~(AES_BLOCK_SIZE - 1);
+	if (aes_ni_ctr(ctx, counter, 0, pos, pos, len) == 0) {
+		pos += len;
+		left -= len;
+	}
+#endif /* CONFIG_INTERNAL_AES_NI */
+
 	while (left > 0) {
 		aes_encrypt(ctx, counter, buf);
 
@@ -12,6 +12,9 @@
 #include "common.h"
 #include "aes.h"
 #include "aes_wrap.h"
+#ifdef CONFIG_INTERNAL_AES_NI
+#include "aes_i.h"
+#endif /* CONFIG_INTERNAL_AES_NI */
 
 static void inc32(u8 *block)
 {
@@ -106,6 +109,11 @@ static void ghash(const u8 *h, const u8 *x, size_t xlen, u8 *y)
 	const u8 *xpos = x;
 	u8 tmp[16];
 
+#ifdef CONFIG_INTERNAL_AES_NI
+	if (aes_ni_ghash(h, x, xlen, y) == 0)
+		return;
+#endif /* CONFIG_INTERNAL_AES_NI */
+
 	m = xlen / 16;
 
 	for (i = 0; i < m; i++) {
@@ -153,6 +161,13 @@ static void aes_gctr(void *aes, const u8 *icb, const u8 *x, size_t xlen, u8 *y)
 	n = xlen / 16;
 
 	os_memcpy(cb, icb, AES_BLOCK_SIZE);
+#ifdef CONFIG_INTERNAL_AES_NI
+	if (aes_ni_ctr(aes, cb, 1, xpos, ypos, n * AES_BLOCK_SIZE) == 0) {
+		xpos += n * AES_BLOCK_SIZE;
+		ypos += n * AES_BLOCK_SIZE;
+		n = 0;
+	}
+#endif /* CONFIG_INTERNAL_AES_NI */
 	/* Full blocks */
 	for (i = 0; i < n; i++) {
 		aes_encrypt(aes, cb, ypos);
@@ -68,6 +68,9 @@ void * aes_decrypt_init(const u8 *key, size_t len)
 		os_free(rk);
 		return NULL;
 	}
+#ifdef CONFIG_INTERNAL_AES_NI
+	res = aes_ni_key_setup(rk, res);
+#endif /* CONFIG_INTERNAL_AES_NI */
 	rk[AES_PRIV_NR_POS] = res;
 	return rk;
 }
@@ -151,6 +154,13 @@ d##3 = TD0(s##3) ^ TD1(s##2) ^ TD2(s##1) ^ TD3(s##0) ^ rk[4 * i + 3]
 int aes_decrypt(void *ctx, const u8 *crypt, u8 *plain)
 {
 	u32 *rk = ctx;
+#ifdef CONFIG_INTERNAL_AES_NI
+	if (rk[AES_PRIV_NR_POS] & AES_PRIV_NI) {
+		aes_ni_decrypt(rk, rk[AES_PRIV_NR_POS] & ~AES_PRIV_NI, crypt,
+			       plain);
+		return 0;
+	}
+#endif /* CONFIG_INTERNAL_AES_NI */
 	rijndaelDecrypt(ctx, rk[AES_PRIV_NR_POS], crypt, plain);
 	return 0;
 }
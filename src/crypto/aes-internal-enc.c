@@ -111,6 +111,9 @@ void * aes_encrypt_init(const u8 *key, size_t len)
 		os_free(rk);
 		return NULL;
 	}
+#ifdef CONFIG_INTERNAL_AES_NI
+	res = aes_ni_key_setup(rk, res);
+#endif /* CONFIG_INTERNAL_AES_NI */
 	rk[AES_PRIV_NR_POS] = res;
 	return rk;
 }
@@ -119,6 +122,13 @@ void * aes_encrypt_init(const u8 *key, size_t len)
 int aes_encrypt(void *ctx, const u8 *plain, u8 *crypt)
 {
 	u32 *rk = ctx;
+#ifdef CONFIG_INTERNAL_AES_NI
+	if (rk[AES_PRIV_NR_POS] & AES_PRIV_NI) {
+		aes_ni_encrypt(rk, rk[AES_PRIV_NR_POS] & ~AES_PRIV_NI, plain,
+			       crypt);
+		return 0;
+	}
+#endif /* CONFIG_INTERNAL_AES_NI */
 	rijndaelEncrypt(ctx, rk[AES_PRIV_NR_POS], plain, crypt);
 	return 0;
 }
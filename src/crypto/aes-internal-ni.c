@@ -0,0 +1,320 @@
+/*
+ * AES (Rijndael) cipher - AES-NI and PCLMULQDQ
+ * Copyright (c) 2026, The hostapd contributors
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * This file uses the x86 AES and carry-less multiplication instructions when
+ * the CPU supports them. The round keys are the ones generated by
+ * rijndaelKeySetupEnc()/rijndaelKeySetupDec(). They are converted into byte
+ * order at initialization time so that they can be loaded directly into the
+ * SSE registers. The equivalent inverse cipher key schedule of the table
+ * based implementation is exactly what AESDEC expects, so no separate
+ * decryption key expansion is needed.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "crypto.h"
+#include "aes_i.h"
+
+#ifdef CONFIG_INTERNAL_AES_NI
+
+int aes_ni_disabled = 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+#define AES_NI_TARGET __attribute__((target("sse2,ssse3,aes,pclmul")))
+
+
+static int aes_ni_available(void)
+{
+	static int available = -1;
+	unsigned int a, b, c, d;
+
+	if (available < 0) {
+		available = __get_cpuid(1, &a, &b, &c, &d) &&
+			(c & bit_SSSE3) && (c & bit_AES) && (c & bit_PCLMUL);
+	}
+
+	return available && !aes_ni_disabled;
+}
+
+
+int aes_ni_key_setup(u32 rk[], int Nr)
+{
+	int i;
+
+	if (!aes_ni_available())
+		return Nr;
+
+	for (i = 0; i < 4 * (Nr + 1); i++)
+		WPA_PUT_BE32((u8 *) &rk[i], rk[i]);
+
+	return Nr | AES_PRIV_NI;
+}
+
+
+AES_NI_TARGET
+static inline __m128i aes_ni_enc_block(const u32 rk[], int Nr, __m128i b)
+{
+	const __m128i *k = (const __m128i *) rk;
+	int i;
+
+	b = _mm_xor_si128(b, _mm_loadu_si128(&k[0]));
+	for (i = 1; i < Nr; i++)
+		b = _mm_aesenc_si128(b, _mm_loadu_si128(&k[i]));
+	return _mm_aesenclast_si128(b, _mm_loadu_si128(&k[Nr]));
+}
+
+
+AES_NI_TARGET
+void aes_ni_encrypt(const u32 rk[], int Nr, const u8 *in, u8 *out)
+{
+	__m128i b;
+
+	b = aes_ni_enc_block(rk, Nr, _mm_loadu_si128((const __m128i *) in));
+	_mm_storeu_si128((__m128i *) out, b);
+}
+
+
+AES_NI_TARGET
+void aes_ni_decrypt(const u32 rk[], int Nr, const u8 *in, u8 *out)
+{
+	const __m128i *k = (const __m128i *) rk;
+	__m128i b;
+	int i;
+
+	b = _mm_xor_si128(_mm_loadu_si128((const __m128i *) in),
+			  _mm_loadu_si128(&k[0]));
+	for (i = 1; i < Nr; i++)
+		b = _mm_aesdec_si128(b, _mm_loadu_si128(&k[i]));
+	b = _mm_aesdeclast_si128(b, _mm_loadu_si128(&k[Nr]));
+	_mm_storeu_si128((__m128i *) out, b);
+}
+
+
+static void aes_ni_inc(u8 *counter, int inc32)
+{
+	int i;
+
+	if (inc32) {
+		WPA_PUT_BE32(counter + AES_BLOCK_SIZE - 4,
+			     WPA_GET_BE32(counter + AES_BLOCK_SIZE - 4) + 1);
+		return;
+	}
+
+	for (i = AES_BLOCK_SIZE - 1; i >= 0; i--) {
+		counter[i]++;
+		if (counter[i])
+			break;
+	}
+}
+
+
+AES_NI_TARGET
+int aes_ni_ctr(void *ctx, u8 *counter, int inc32, const u8 *in, u8 *out,
+	       size_t len)
+{
+	const u32 *rk = ctx;
+	const __m128i *k = (const __m128i *) rk;
+	int Nr = rk[AES_PRIV_NR_POS];
+	__m128i b0, b1, b2, b3, rkey;
+	int i;
+
+	if (!(Nr & AES_PRIV_NI))
+		return -1;
+	Nr &= ~AES_PRIV_NI;
+
+	/* Four independent blocks to keep the AES pipeline busy */
+	while (len >= 4 * AES_BLOCK_SIZE) {
+		b0 = _mm_loadu_si128((const __m128i *) counter);
+		aes_ni_inc(counter, inc32);
+		b1 = _mm_loadu_si128((const __m128i *) counter);
+		aes_ni_inc(counter, inc32);
+		b2 = _mm_loadu_si128((const __m128i *) counter);
+		aes_ni_inc(counter, inc32);
+		b3 = _mm_loadu_si128((const __m128i *) counter);
+		aes_ni_inc(counter, inc32);
+
+		rkey = _mm_loadu_si128(&k[0]);
+		b0 = _mm_xor_si128(b0, rkey);
+		b1 = _mm_xor_si128(b1, rkey);
+		b2 = _mm_xor_si128(b2, rkey);
+		b3 = _mm_xor_si128(b3, rkey);
+		for (i = 1; i < Nr; i++) {
+			rkey = _mm_loadu_si128(&k[i]);
+			b0 = _mm_aesenc_si128(b0, rkey);
+			b1 = _mm_aesenc_si128(b1, rkey);
+			b2 = _mm_aesenc_si128(b2, rkey);
+			b3 = _mm_aesenc_si128(b3, rkey);
+		}
+		rkey = _mm_loadu_si128(&k[Nr]);
+		b0 = _mm_aesenclast_si128(b0, rkey);
+		b1 = _mm_aesenclast_si128(b1, rkey);
+		b2 = _mm_aesenclast_si128(b2, rkey);
+		b3 = _mm_aesenclast_si128(b3, rkey);
+
+		b0 = _mm_xor_si128(b0, _mm_loadu_si128((const __m128i *) in));
+		b1 = _mm_xor_si128(b1,
+				   _mm_loadu_si128((const __m128i *) (in + 16)));
+		b2 = _mm_xor_si128(b2,
+				   _mm_loadu_si128((const __m128i *) (in + 32)));
+		b3 = _mm_xor_si128(b3,
+				   _mm_loadu_si128((const __m128i *) (in + 48)));
+		_mm_storeu_si128((__m128i *) out, b0);
+		_mm_storeu_si128((__m128i *) (out + 16), b1);
+		_mm_storeu_si128((__m128i *) (out + 32), b2);
+		_mm_storeu_si128((__m128i *) (out + 48), b3);
+
+		in += 4 * AES_BLOCK_SIZE;
+		out += 4 * AES_BLOCK_SIZE;
+		len -= 4 * AES_BLOCK_SIZE;
+	}
+
+	while (len >= AES_BLOCK_SIZE) {
+		b0 = aes_ni_enc_block(rk, Nr,
+				      _mm_loadu_si128((const __m128i *) counter));
+		aes_ni_inc(counter, inc32);
+		b0 = _mm_xor_si128(b0, _mm_loadu_si128((const __m128i *) in));
+		_mm_storeu_si128((__m128i *) out, b0);
+		in += AES_BLOCK_SIZE;
+		out += AES_BLOCK_SIZE;
+		len -= AES_BLOCK_SIZE;
+	}
+
+	return 0;
+}
+
+
+/*
+ * Multiplication in GF(2^128) on byte reflected values using PCLMULQDQ with
+ * the shift and reduction steps from the Intel carry-less multiplication
+ * white paper.
+ */
+AES_NI_TARGET
+static __m128i aes_ni_gf_mult(__m128i a, __m128i b)
+{
+	__m128i t2, t3, t4, t5, t6, t7, t8, t9;
+
+	t3 = _mm_clmulepi64_si128(a, b, 0x00);
+	t4 = _mm_clmulepi64_si128(a, b, 0x10);
+	t5 = _mm_clmulepi64_si128(a, b, 0x01);
+	t6 = _mm_clmulepi64_si128(a, b, 0x11);
+
+	t4 = _mm_xor_si128(t4, t5);
+	t5 = _mm_slli_si128(t4, 8);
+	t4 = _mm_srli_si128(t4, 8);
+	t3 = _mm_xor_si128(t3, t5);
+	t6 = _mm_xor_si128(t6, t4);
+
+	/* Shift the 256-bit product left by one bit */
+	t7 = _mm_srli_epi32(t3, 31);
+	t8 = _mm_srli_epi32(t6, 31);
+	t3 = _mm_slli_epi32(t3, 1);
+	t6 = _mm_slli_epi32(t6, 1);
+	t9 = _mm_srli_si128(t7, 12);
+	t8 = _mm_slli_si128(t8, 4);
+	t7 = _mm_slli_si128(t7, 4);
+	t3 = _mm_or_si128(t3, t7);
+	t6 = _mm_or_si128(t6, t8);
+	t6 = _mm_or_si128(t6, t9);
+
+	/* Reduce modulo x^128 + x^7 + x^2 + x + 1 */
+	t7 = _mm_slli_epi32(t3, 31);
+	t8 = _mm_slli_epi32(t3, 30);
+	t9 = _mm_slli_epi32(t3, 25);
+	t7 = _mm_xor_si128(t7, t8);
+	t7 = _mm_xor_si128(t7, t9);
+	t8 = _mm_srli_si128(t7, 4);
+	t7 = _mm_slli_si128(t7, 12);
+	t3 = _mm_xor_si128(t3, t7);
+
+	t2 = _mm_srli_epi32(t3, 1);
+	t4 = _mm_srli_epi32(t3, 2);
+	t5 = _mm_srli_epi32(t3, 7);
+	t2 = _mm_xor_si128(t2, t4);
+	t2 = _mm_xor_si128(t2, t5);
+	t2 = _mm_xor_si128(t2, t8);
+	t3 = _mm_xor_si128(t3, t2);
+
+	return _mm_xor_si128(t6, t3);
+}
+
+
+AES_NI_TARGET
+int aes_ni_ghash(const u8 *h, const u8 *x, size_t xlen, u8 *y)
+{
+	const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+					   8, 9, 10, 11, 12, 13, 14, 15);
+	__m128i hh, yy;
+
+	if (!aes_ni_available())
+		return -1;
+
+	hh = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) h), bswap);
+	yy = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) y), bswap);
+
+	while (xlen >= 16) {
+		yy = _mm_xor_si128(
+			yy, _mm_shuffle_epi8(
+				_mm_loadu_si128((const __m128i *) x), bswap));
+		yy = aes_ni_gf_mult(yy, hh);
+		x += 16;
+		xlen -= 16;
+	}
+
+	if (xlen) {
+		u8 tmp[16];
+
+		/* Add zero padded last block */
+		os_memcpy(tmp, x, xlen);
+		os_memset(tmp + xlen, 0, sizeof(tmp) - xlen);
+		yy = _mm_xor_si128(
+			yy, _mm_shuffle_epi8(
+				_mm_loadu_si128((const __m128i *) tmp), bswap));
+		yy = aes_ni_gf_mult(yy, hh);
+	}
+
+	_mm_storeu_si128((__m128i *) y, _mm_shuffle_epi8(yy, bswap));
+	return 0;
+}
+
+#else /* __x86_64__ || __i386__ */
+
+int aes_ni_key_setup(u32 rk[], int Nr)
+{
+	return Nr;
+}
+
+
+void aes_ni_encrypt(const u32 rk[], int Nr, const u8 *in, u8 *out)
+{
+}
+
+
+void aes_ni_decrypt(const u32 rk[], int Nr, const u8 *in, u8 *out)
+{
+}
+
+
+int aes_ni_ctr(void *ctx, u8 *counter, int inc32, const u8 *in, u8 *out,
+	       size_t len)
+{
+	return -1;
+}
+
+
+int aes_ni_ghash(const u8 *h, const u8 *x, size_t xlen, u8 *y)
+{
+	return -1;
+}
+
+#endif /* __x86_64__ || __i386__ */
+
+#endif /* CONFIG_INTERNAL_AES_NI */
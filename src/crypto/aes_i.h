@@ -122,4 +122,18 @@ static inline u32 rotr(u32 val, int bits)
 
 int rijndaelKeySetupEnc(u32 rk[], const u8 cipherKey[], int keyBits);
 
+#ifdef CONFIG_INTERNAL_AES_NI
+/* Flag in rk[AES_PRIV_NR_POS] for round keys converted for AES-NI */
+#define AES_PRIV_NI BIT(8)
+
+extern int aes_ni_disabled;
+
+int aes_ni_key_setup(u32 rk[], int Nr);
+void aes_ni_encrypt(const u32 rk[], int Nr, const u8 *in, u8 *out);
+void aes_ni_decrypt(const u32 rk[], int Nr, const u8 *in, u8 *out);
+int aes_ni_ctr(void *ctx, u8 *counter, int inc32, const u8 *in, u8 *out,
+	       size_t len);
+int aes_ni_ghash(const u8 *h, const u8 *x, size_t xlen, u8 *y);
+#endif /* CONFIG_INTERNAL_AES_NI */
+
 #endif /* AES_I_H */
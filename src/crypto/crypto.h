@@ -161,7 +161,8 @@ enum crypto_hash_alg {
 	CRYPTO_HASH_ALG_MD5, CRYPTO_HASH_ALG_SHA1,
 	CRYPTO_HASH_ALG_HMAC_MD5, CRYPTO_HASH_ALG_HMAC_SHA1,
 	CRYPTO_HASH_ALG_SHA256, CRYPTO_HASH_ALG_HMAC_SHA256,
-	CRYPTO_HASH_ALG_SHA384, CRYPTO_HASH_ALG_SHA512
+	CRYPTO_HASH_ALG_SHA384, CRYPTO_HASH_ALG_SHA512,
+	CRYPTO_HASH_ALG_HMAC_SHA384, CRYPTO_HASH_ALG_HMAC_SHA512
 };
 
 struct crypto_hash;
@@ -212,6 +213,42 @@ void crypto_hash_update(struct crypto_hash *ctx, const u8 *data, size_t len);
  */
 int crypto_hash_finish(struct crypto_hash *ctx, u8 *hash, size_t *len);
 
+struct crypto_hmac_key;
+
+/**
+ * crypto_hmac_key_init - Precompute an HMAC key for repeated use
+ * @alg: HMAC algorithm (CRYPTO_HASH_ALG_HMAC_*)
+ * @key: HMAC key
+ * @key_len: Length of the key in bytes
+ * Returns: Pointer to the key context or %NULL if not supported
+ *
+ * This function processes the inner and outer padded key blocks once so that
+ * they do not need to be recomputed for each message when the same key is
+ * used for a large number of HMAC operations. The crypto wrapper does not
+ * need to implement this; callers are expected to fall back to the
+ * hmac_*_vector() functions if %NULL is returned.
+ */
+struct crypto_hmac_key * crypto_hmac_key_init(enum crypto_hash_alg alg,
+					      const u8 *key, size_t key_len);
+
+/**
+ * crypto_hmac_key_vector - HMAC over data vector with a precomputed key
+ * @key: Key context from crypto_hmac_key_init()
+ * @num_elem: Number of elements in the data vector
+ * @addr: Pointers to the data areas
+ * @len: Lengths of the data blocks
+ * @mac: Buffer for the hash (digest length of the algorithm)
+ * Returns: 0 on success, -1 on failure
+ */
+int crypto_hmac_key_vector(struct crypto_hmac_key *key, size_t num_elem,
+			   const u8 *addr[], const size_t *len, u8 *mac);
+
+/**
+ * crypto_hmac_key_deinit - Free a precomputed HMAC key
+ * @key: Key context from crypto_hmac_key_init() or %NULL
+ */
+void crypto_hmac_key_deinit(struct crypto_hmac_key *key);
+
 
 enum crypto_cipher_alg {
 	CRYPTO_CIPHER_NULL = 0, CRYPTO_CIPHER_ALG_AES, CRYPTO_CIPHER_ALG_3DES,
@@ -932,6 +969,94 @@ void crypto_ec_point_debug_print(const struct crypto_ec *e,
 				 const struct crypto_ec_point *p,
 				 const char *title);
 
+/**
+ * struct crypto_ec_point_table - Precomputed multiples of a fixed EC point
+ */
+struct crypto_ec_point_table;
+
+/**
+ * crypto_ec_point_table_init - Precompute multiples of a fixed EC point
+ * @e: EC context from crypto_ec_init()
+ * @p: EC point that is going to be multiplied with many scalars
+ * Returns: Pointer to the table or %NULL on failure
+ *
+ * The table is used with crypto_ec_point_table_mul() to speed up scalar
+ * multiplication of a point that is used repeatedly. The execution time of
+ * crypto_ec_point_table_mul() depends on the scalar, so this is to be used
+ * only with scalars that are not secret.
+ */
+struct crypto_ec_point_table *
+crypto_ec_point_table_init(struct crypto_ec *e,
+			   const struct crypto_ec_point *p);
+
+/**
+ * crypto_ec_point_table_deinit - Free a table of precomputed EC points
+ * @t: Table from crypto_ec_point_table_init() or %NULL
+ */
+void crypto_ec_point_table_deinit(struct crypto_ec_point_table *t);
+
+/**
+ * crypto_ec_point_table_mul - res = b * p using precomputed multiples of p
+ * @e: EC context from crypto_ec_init()
+ * @t: Table from crypto_ec_point_table_init() for point p
+ * @b: Bignum (a public value)
+ * @res: EC point; used to store the result of b * p
+ * Returns: 0 on success, -1 on failure
+ */
+int crypto_ec_point_table_mul(struct crypto_ec *e,
+			      const struct crypto_ec_point_table *t,
+			      const struct crypto_bignum *b,
+			      struct crypto_ec_point *res);
+
+/**
+ * struct crypto_scratch - Scratch arena for temporary bignums and EC points
+ *
+ * A scratch arena holds the temporary values of a single operation, e.g.,
+ * processing of an SAE Commit message. While an arena is active, the bignum
+ * operations can use its working memory instead of allocating their own for
+ * each call. Arenas can be nested; the most recently initialized one is the
+ * active one.
+ */
+struct crypto_scratch;
+
+/**
+ * crypto_scratch_init - Initialize and activate a scratch arena
+ * Returns: Pointer to the arena or %NULL on failure
+ */
+struct crypto_scratch * crypto_scratch_init(void);
+
+/**
+ * crypto_scratch_deinit - Clear and free a scratch arena
+ * @s: Arena from crypto_scratch_init() or %NULL
+ *
+ * All values from crypto_scratch_bignum() and crypto_scratch_point() are
+ * cleared and freed.
+ */
+void crypto_scratch_deinit(struct crypto_scratch *s);
+
+/**
+ * crypto_scratch_bignum - Get a temporary bignum from a scratch arena
+ * @s: Arena from crypto_scratch_init() or %NULL
+ * Returns: Pointer to a bignum with value 0 or %NULL on failure
+ *
+ * The returned bignum is owned by the arena and must not be freed with
+ * crypto_bignum_deinit(). It is valid until crypto_scratch_deinit().
+ */
+struct crypto_bignum * crypto_scratch_bignum(struct crypto_scratch *s);
+
+/**
+ * crypto_scratch_point - Get a temporary EC point from a scratch arena
+ * @s: Arena from crypto_scratch_init() or %NULL
+ * @e: EC context from crypto_ec_init()
+ * Returns: Pointer to an EC point or %NULL on failure
+ *
+ * The returned point is owned by the arena and must not be freed with
+ * crypto_ec_point_deinit(). It is valid until crypto_scratch_deinit(). An
+ * arena can hold at most eight EC points.
+ */
+struct crypto_ec_point * crypto_scratch_point(struct crypto_scratch *s,
+					      struct crypto_ec *e);
+
 /**
  * struct crypto_ec_key - Elliptic curve key pair
  *
@@ -506,6 +506,25 @@ void crypto_cipher_deinit(struct crypto_cipher *ctx)
 }
 
 
+struct crypto_hmac_key * crypto_hmac_key_init(enum crypto_hash_alg alg,
+					      const u8 *key, size_t key_len)
+{
+	return NULL;
+}
+
+
+int crypto_hmac_key_vector(struct crypto_hmac_key *key, size_t num_elem,
+			   const u8 *addr[], const size_t *len, u8 *mac)
+{
+	return -1;
+}
+
+
+void crypto_hmac_key_deinit(struct crypto_hmac_key *key)
+{
+}
+
+
 void crypto_unload(void)
 {
 }
@@ -13,6 +13,44 @@
 #include "crypto.h"
 
 
+/* crypto_mod_exp() for a secret exponent, e.g., a DH private key */
+static int crypto_mod_exp_secret(const u8 *base, size_t base_len,
+				 const u8 *power, size_t power_len,
+				 const u8 *modulus, size_t modulus_len,
+				 u8 *result, size_t *result_len)
+{
+	struct bignum *bn_base, *bn_exp, *bn_modulus, *bn_result;
+	struct bignum_mont *mont = NULL;
+	int ret = -1;
+
+	bn_base = bignum_init();
+	bn_exp = bignum_init();
+	bn_modulus = bignum_init();
+	bn_result = bignum_init();
+
+	if (!bn_base || !bn_exp || !bn_modulus || !bn_result ||
+	    bignum_set_unsigned_bin(bn_base, base, base_len) < 0 ||
+	    bignum_set_unsigned_bin(bn_exp, power, power_len) < 0 ||
+	    bignum_set_unsigned_bin(bn_modulus, modulus, modulus_len) < 0)
+		goto error;
+
+	mont = bignum_mont_init(bn_modulus);
+	if ((mont ? bignum_exptmod_mont(bn_base, bn_exp, mont, bn_result) :
+	     bignum_exptmod(bn_base, bn_exp, bn_modulus, bn_result)) < 0)
+		goto error;
+
+	ret = bignum_get_unsigned_bin(bn_result, result, result_len);
+
+error:
+	bignum_mont_deinit(mont);
+	bignum_deinit(bn_base);
+	bignum_deinit(bn_exp);
+	bignum_deinit(bn_modulus);
+	bignum_deinit(bn_result);
+	return ret;
+}
+
+
 int crypto_dh_init(u8 generator, const u8 *prime, size_t prime_len, u8 *privkey,
 		   u8 *pubkey)
 {
@@ -26,8 +64,8 @@ int crypto_dh_init(u8 generator, const u8 *prime, size_t prime_len, u8 *privkey,
 	}
 
 	pubkey_len = prime_len;
-	if (crypto_mod_exp(&generator, 1, privkey, prime_len, prime, prime_len,
-			   pubkey, &pubkey_len) < 0)
+	if (crypto_mod_exp_secret(&generator, 1, privkey, prime_len,
+				  prime, prime_len, pubkey, &pubkey_len) < 0)
 		return -1;
 	if (pubkey_len < prime_len) {
 		pad = prime_len - pubkey_len;
@@ -78,8 +116,8 @@ int crypto_dh_derive_secret(u8 generator, const u8 *prime, size_t prime_len,
 			goto fail;
 	}
 
-	res = crypto_mod_exp(pubkey, pubkey_len, privkey, privkey_len,
-			     prime, prime_len, secret, len);
+	res = crypto_mod_exp_secret(pubkey, pubkey_len, privkey, privkey_len,
+				    prime, prime_len, secret, len);
 fail:
 	bignum_deinit(pub);
 	return res;
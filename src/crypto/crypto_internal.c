@@ -10,6 +10,11 @@
 
 #include "common.h"
 #include "crypto.h"
+#include "md5.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "sha384.h"
+#include "sha512.h"
 #include "sha256_i.h"
 #include "sha384_i.h"
 #include "sha512_i.h"
@@ -317,6 +322,198 @@ int crypto_hash_finish(struct crypto_hash *ctx, u8 *mac, size_t *len)
 }
 
 
+struct crypto_hmac_key {
+	struct crypto_hash inner;
+	struct crypto_hash outer;
+	size_t mdlen;
+};
+
+
+static void crypto_hmac_hash_init(struct crypto_hash *ctx)
+{
+	switch (ctx->alg) {
+	case CRYPTO_HASH_ALG_HMAC_MD5:
+		MD5Init(&ctx->u.md5);
+		break;
+	case CRYPTO_HASH_ALG_HMAC_SHA1:
+		SHA1Init(&ctx->u.sha1);
+		break;
+#ifdef CONFIG_SHA256
+	case CRYPTO_HASH_ALG_HMAC_SHA256:
+		sha256_init(&ctx->u.sha256);
+		break;
+#endif /* CONFIG_SHA256 */
+#ifdef CONFIG_INTERNAL_SHA384
+	case CRYPTO_HASH_ALG_HMAC_SHA384:
+		sha384_init(&ctx->u.sha384);
+		break;
+#endif /* CONFIG_INTERNAL_SHA384 */
+#ifdef CONFIG_INTERNAL_SHA512
+	case CRYPTO_HASH_ALG_HMAC_SHA512:
+		sha512_init(&ctx->u.sha512);
+		break;
+#endif /* CONFIG_INTERNAL_SHA512 */
+	default:
+		break;
+	}
+}
+
+
+static void crypto_hmac_hash_update(struct crypto_hash *ctx, const u8 *data,
+				    size_t len)
+{
+	switch (ctx->alg) {
+#ifdef CONFIG_INTERNAL_SHA384
+	case CRYPTO_HASH_ALG_HMAC_SHA384:
+		sha384_process(&ctx->u.sha384, data, len);
+		break;
+#endif /* CONFIG_INTERNAL_SHA384 */
+#ifdef CONFIG_INTERNAL_SHA512
+	case CRYPTO_HASH_ALG_HMAC_SHA512:
+		sha512_process(&ctx->u.sha512, data, len);
+		break;
+#endif /* CONFIG_INTERNAL_SHA512 */
+	default:
+		crypto_hash_update(ctx, data, len);
+		break;
+	}
+}
+
+
+static void crypto_hmac_hash_final(struct crypto_hash *ctx, u8 *mac)
+{
+	switch (ctx->alg) {
+	case CRYPTO_HASH_ALG_HMAC_MD5:
+		MD5Final(mac, &ctx->u.md5);
+		break;
+	case CRYPTO_HASH_ALG_HMAC_SHA1:
+		SHA1Final(mac, &ctx->u.sha1);
+		break;
+#ifdef CONFIG_SHA256
+	case CRYPTO_HASH_ALG_HMAC_SHA256:
+		sha256_done(&ctx->u.sha256, mac);
+		break;
+#endif /* CONFIG_SHA256 */
+#ifdef CONFIG_INTERNAL_SHA384
+	case CRYPTO_HASH_ALG_HMAC_SHA384:
+		sha384_done(&ctx->u.sha384, mac);
+		break;
+#endif /* CONFIG_INTERNAL_SHA384 */
+#ifdef CONFIG_INTERNAL_SHA512
+	case CRYPTO_HASH_ALG_HMAC_SHA512:
+		sha512_done(&ctx->u.sha512, mac);
+		break;
+#endif /* CONFIG_INTERNAL_SHA512 */
+	default:
+		break;
+	}
+}
+
+
+struct crypto_hmac_key * crypto_hmac_key_init(enum crypto_hash_alg alg,
+					      const u8 *key, size_t key_len)
+{
+	struct crypto_hmac_key *hkey;
+	u8 k_pad[128], tk[64];
+	size_t i, block_size, mdlen;
+
+	switch (alg) {
+	case CRYPTO_HASH_ALG_HMAC_MD5:
+		block_size = 64;
+		mdlen = MD5_MAC_LEN;
+		break;
+	case CRYPTO_HASH_ALG_HMAC_SHA1:
+		block_size = 64;
+		mdlen = SHA1_MAC_LEN;
+		break;
+#ifdef CONFIG_SHA256
+	case CRYPTO_HASH_ALG_HMAC_SHA256:
+		block_size = 64;
+		mdlen = SHA256_MAC_LEN;
+		break;
+#endif /* CONFIG_SHA256 */
+#ifdef CONFIG_INTERNAL_SHA384
+	case CRYPTO_HASH_ALG_HMAC_SHA384:
+		block_size = 128;
+		mdlen = SHA384_MAC_LEN;
+		break;
+#endif /* CONFIG_INTERNAL_SHA384 */
+#ifdef CONFIG_INTERNAL_SHA512
+	case CRYPTO_HASH_ALG_HMAC_SHA512:
+		block_size = 128;
+		mdlen = SHA512_MAC_LEN;
+		break;
+#endif /* CONFIG_INTERNAL_SHA512 */
+	default:
+		return NULL;
+	}
+
+	hkey = os_zalloc(sizeof(*hkey));
+	if (!hkey)
+		return NULL;
+	hkey->inner.alg = alg;
+	hkey->outer.alg = alg;
+	hkey->mdlen = mdlen;
+
+	/* Keys longer than the block size are replaced with their hash */
+	if (key_len > block_size) {
+		crypto_hmac_hash_init(&hkey->inner);
+		crypto_hmac_hash_update(&hkey->inner, key, key_len);
+		crypto_hmac_hash_final(&hkey->inner, tk);
+		key = tk;
+		key_len = mdlen;
+	}
+
+	os_memcpy(k_pad, key, key_len);
+	os_memset(k_pad + key_len, 0, block_size - key_len);
+	for (i = 0; i < block_size; i++)
+		k_pad[i] ^= 0x36;
+	crypto_hmac_hash_init(&hkey->inner);
+	crypto_hmac_hash_update(&hkey->inner, k_pad, block_size);
+
+	for (i = 0; i < block_size; i++)
+		k_pad[i] ^= 0x36 ^ 0x5c;
+	crypto_hmac_hash_init(&hkey->outer);
+	crypto_hmac_hash_update(&hkey->outer, k_pad, block_size);
+
+	forced_memzero(k_pad, sizeof(k_pad));
+	forced_memzero(tk, sizeof(tk));
+
+	return hkey;
+}
+
+
+int crypto_hmac_key_vector(struct crypto_hmac_key *key, size_t num_elem,
+			   const u8 *addr[], const size_t *len, u8 *mac)
+{
+	struct crypto_hash ctx;
+	size_t i;
+
+	if (TEST_FAIL())
+		return -1;
+
+	/* Inner hash starts from the precomputed K XOR ipad state */
+	ctx = key->inner;
+	for (i = 0; i < num_elem; i++)
+		crypto_hmac_hash_update(&ctx, addr[i], len[i]);
+	crypto_hmac_hash_final(&ctx, mac);
+
+	/* Outer hash starts from the precomputed K XOR opad state */
+	ctx = key->outer;
+	crypto_hmac_hash_update(&ctx, mac, key->mdlen);
+	crypto_hmac_hash_final(&ctx, mac);
+
+	forced_memzero(&ctx, sizeof(ctx));
+	return 0;
+}
+
+
+void crypto_hmac_key_deinit(struct crypto_hmac_key *key)
+{
+	bin_clear_free(key, sizeof(*key));
+}
+
+
 int crypto_global_init(void)
 {
 	return 0;
@@ -24,6 +24,25 @@ int des_encrypt(const u8 *clear, const u8 *key, u8 *cypher)
 }
 
 
+struct crypto_hmac_key * crypto_hmac_key_init(enum crypto_hash_alg alg,
+					      const u8 *key, size_t key_len)
+{
+	return NULL;
+}
+
+
+int crypto_hmac_key_vector(struct crypto_hmac_key *key, size_t num_elem,
+			   const u8 *addr[], const size_t *len, u8 *mac)
+{
+	return -1;
+}
+
+
+void crypto_hmac_key_deinit(struct crypto_hmac_key *key)
+{
+}
+
+
 void crypto_unload(void)
 {
 }
@@ -1497,6 +1497,173 @@ int crypto_hash_finish(struct crypto_hash *ctx, u8 *mac, size_t *len)
 }
 
 
+struct crypto_hmac_key {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+	EVP_MAC_CTX *ctx;
+#else /* OpenSSL version >= 3.0 */
+	HMAC_CTX *ctx;
+#endif /* OpenSSL version >= 3.0 */
+	size_t mdlen;
+};
+
+
+void crypto_hmac_key_deinit(struct crypto_hmac_key *key)
+{
+	if (!key)
+		return;
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+	EVP_MAC_CTX_free(key->ctx);
+#else /* OpenSSL version >= 3.0 */
+	HMAC_CTX_free(key->ctx);
+#endif /* OpenSSL version >= 3.0 */
+	os_free(key);
+}
+
+
+struct crypto_hmac_key * crypto_hmac_key_init(enum crypto_hash_alg alg,
+					      const u8 *key, size_t key_len)
+{
+	struct crypto_hmac_key *hkey;
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+	EVP_MAC *mac;
+	OSSL_PARAM params[2];
+	char *a;
+#else /* OpenSSL version >= 3.0 */
+	const EVP_MD *md;
+#endif /* OpenSSL version >= 3.0 */
+	size_t mdlen;
+
+	switch (alg) {
+#ifndef OPENSSL_NO_MD5
+	case CRYPTO_HASH_ALG_HMAC_MD5:
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+		a = "MD5";
+#else /* OpenSSL version >= 3.0 */
+		md = EVP_md5();
+#endif /* OpenSSL version >= 3.0 */
+		mdlen = MD5_MAC_LEN;
+		break;
+#endif /* OPENSSL_NO_MD5 */
+	case CRYPTO_HASH_ALG_HMAC_SHA1:
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+		a = "SHA1";
+#else /* OpenSSL version >= 3.0 */
+		md = EVP_sha1();
+#endif /* OpenSSL version >= 3.0 */
+		mdlen = SHA1_MAC_LEN;
+		break;
+	case CRYPTO_HASH_ALG_HMAC_SHA256:
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+		a = "SHA256";
+#else /* OpenSSL version >= 3.0 */
+		md = EVP_sha256();
+#endif /* OpenSSL version >= 3.0 */
+		mdlen = SHA256_MAC_LEN;
+		break;
+	case CRYPTO_HASH_ALG_HMAC_SHA384:
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+		a = "SHA384";
+#else /* OpenSSL version >= 3.0 */
+		md = EVP_sha384();
+#endif /* OpenSSL version >= 3.0 */
+		mdlen = SHA384_MAC_LEN;
+		break;
+	case CRYPTO_HASH_ALG_HMAC_SHA512:
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+		a = "SHA512";
+#else /* OpenSSL version >= 3.0 */
+		md = EVP_sha512();
+#endif /* OpenSSL version >= 3.0 */
+		mdlen = SHA512_MAC_LEN;
+		break;
+	default:
+		return NULL;
+	}
+
+	hkey = os_zalloc(sizeof(*hkey));
+	if (!hkey)
+		return NULL;
+	hkey->mdlen = mdlen;
+
+	/* The keyed context is kept as the template for each message */
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+	mac = EVP_MAC_fetch(NULL, "HMAC", NULL);
+	if (mac) {
+		params[0] = OSSL_PARAM_construct_utf8_string("digest", a, 0);
+		params[1] = OSSL_PARAM_construct_end();
+		hkey->ctx = EVP_MAC_CTX_new(mac);
+		EVP_MAC_free(mac);
+	}
+	if (!hkey->ctx ||
+	    EVP_MAC_init(hkey->ctx, key, key_len, params) != 1) {
+		crypto_hmac_key_deinit(hkey);
+		return NULL;
+	}
+#else /* OpenSSL version >= 3.0 */
+	hkey->ctx = HMAC_CTX_new();
+	if (!hkey->ctx ||
+	    HMAC_Init_ex(hkey->ctx, key, key_len, md, NULL) != 1) {
+		crypto_hmac_key_deinit(hkey);
+		return NULL;
+	}
+#endif /* OpenSSL version >= 3.0 */
+
+	return hkey;
+}
+
+
+int crypto_hmac_key_vector(struct crypto_hmac_key *key, size_t num_elem,
+			   const u8 *addr[], const size_t *len, u8 *mac)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+	EVP_MAC_CTX *ctx;
+	size_t i, mlen;
+	int res = -1;
+
+	if (TEST_FAIL())
+		return -1;
+
+	ctx = EVP_MAC_CTX_dup(key->ctx);
+	if (!ctx)
+		return -1;
+
+	for (i = 0; i < num_elem; i++) {
+		if (EVP_MAC_update(ctx, addr[i], len[i]) != 1)
+			goto fail;
+	}
+
+	res = EVP_MAC_final(ctx, mac, &mlen, key->mdlen);
+fail:
+	EVP_MAC_CTX_free(ctx);
+	return res == 1 ? 0 : -1;
+#else /* OpenSSL version >= 3.0 */
+	HMAC_CTX *ctx;
+	unsigned int mdlen = key->mdlen;
+	size_t i;
+	int res;
+
+	if (TEST_FAIL())
+		return -1;
+
+	ctx = HMAC_CTX_new();
+	if (!ctx)
+		return -1;
+	res = HMAC_CTX_copy(ctx, key->ctx);
+	if (res != 1)
+		goto done;
+
+	for (i = 0; i < num_elem; i++)
+		HMAC_Update(ctx, addr[i], len[i]);
+
+	res = HMAC_Final(ctx, mac, &mdlen);
+done:
+	HMAC_CTX_free(ctx);
+
+	return res == 1 ? 0 : -1;
+#endif /* OpenSSL version >= 3.0 */
+}
+
+
 #if OPENSSL_VERSION_NUMBER >= 0x30000000L
 
 static int openssl_hmac_vector(char *digest, const u8 *key,
@@ -1876,6 +2043,94 @@ int omac1_aes_256(const u8 *key, const u8 *data, size_t data_len, u8 *mac)
 }
 
 
+#define CRYPTO_SCRATCH_MAX_POINTS 8
+
+struct crypto_scratch {
+	struct crypto_scratch *prev;
+	BN_CTX *bnctx;
+#ifdef CONFIG_ECC
+	EC_POINT *points[CRYPTO_SCRATCH_MAX_POINTS];
+	unsigned int num_points;
+#endif /* CONFIG_ECC */
+};
+
+/* The innermost scratch arena provides the BN_CTX for bignum operations */
+static struct crypto_scratch *crypto_scratch_active = NULL;
+
+
+static BN_CTX * crypto_bnctx_get(void)
+{
+	if (crypto_scratch_active)
+		return crypto_scratch_active->bnctx;
+	return BN_CTX_new();
+}
+
+
+static void crypto_bnctx_put(BN_CTX *bnctx)
+{
+	if (!crypto_scratch_active || crypto_scratch_active->bnctx != bnctx)
+		BN_CTX_free(bnctx);
+}
+
+
+struct crypto_scratch * crypto_scratch_init(void)
+{
+	struct crypto_scratch *s;
+
+	if (TEST_FAIL())
+		return NULL;
+
+	s = os_zalloc(sizeof(*s));
+	if (!s)
+		return NULL;
+	s->bnctx = BN_CTX_new();
+	if (!s->bnctx) {
+		os_free(s);
+		return NULL;
+	}
+
+	/* Frame for the values from crypto_scratch_bignum() */
+	BN_CTX_start(s->bnctx);
+	s->prev = crypto_scratch_active;
+	crypto_scratch_active = s;
+	return s;
+}
+
+
+void crypto_scratch_deinit(struct crypto_scratch *s)
+{
+	struct crypto_scratch **pos;
+
+	if (!s)
+		return;
+
+	for (pos = &crypto_scratch_active; *pos; pos = &(*pos)->prev) {
+		if (*pos == s) {
+			*pos = s->prev;
+			break;
+		}
+	}
+
+#ifdef CONFIG_ECC
+	while (s->num_points)
+		EC_POINT_clear_free(s->points[--s->num_points]);
+#endif /* CONFIG_ECC */
+	/* BN_CTX_free() clears all bignums in the pool, including the
+	 * temporary values of the operations that used this context. */
+	BN_CTX_end(s->bnctx);
+	BN_CTX_free(s->bnctx);
+	os_free(s);
+}
+
+
+struct crypto_bignum * crypto_scratch_bignum(struct crypto_scratch *s)
+{
+	if (TEST_FAIL() || !s)
+		return NULL;
+	return (struct crypto_bignum *) BN_CTX_get(s->bnctx);
+}
+
+
 struct crypto_bignum * crypto_bignum_init(void)
 {
 	if (TEST_FAIL())
@@ -1985,12 +2240,12 @@ int crypto_bignum_mod(const struct crypto_bignum *a,
 	int res;
 	BN_CTX *bnctx;
 
-	bnctx = BN_CTX_new();
+	bnctx = crypto_bnctx_get();
 	if (bnctx == NULL)
 		return -1;
 	res = BN_mod((BIGNUM *) c, (const BIGNUM *) a, (const BIGNUM *) b,
 		     bnctx);
-	BN_CTX_free(bnctx);
+	crypto_bnctx_put(bnctx);
 
 	return res ? 0 : -1;
 }
@@ -2007,13 +2262,13 @@ int crypto_bignum_exptmod(const struct crypto_bignum *a,
 	if (TEST_FAIL())
 		return -1;
 
-	bnctx = BN_CTX_new();
+	bnctx = crypto_bnctx_get();
 	if (bnctx == NULL)
 		return -1;
 	res = BN_mod_exp_mont_consttime((BIGNUM *) d, (const BIGNUM *) a,
 					(const BIGNUM *) b, (const BIGNUM *) c,
 					bnctx, NULL);
-	BN_CTX_free(bnctx);
+	crypto_bnctx_put(bnctx);
 
 	return res ? 0 : -1;
 }
@@ -2028,7 +2283,7 @@ int crypto_bignum_inverse(const struct crypto_bignum *a,
 
 	if (TEST_FAIL())
 		return -1;
-	bnctx = BN_CTX_new();
+	bnctx = crypto_bnctx_get();
 	if (bnctx == NULL)
 		return -1;
 #ifdef OPENSSL_IS_BORINGSSL
@@ -2038,7 +2293,7 @@ int crypto_bignum_inverse(const struct crypto_bignum *a,
 #endif /* OPENSSL_IS_BORINGSSL */
 	res = BN_mod_inverse((BIGNUM *) c, (const BIGNUM *) a,
 			     (const BIGNUM *) b, bnctx);
-	BN_CTX_free(bnctx);
+	crypto_bnctx_put(bnctx);
 
 	return res ? 0 : -1;
 }
@@ -2066,7 +2321,7 @@ int crypto_bignum_div(const struct crypto_bignum *a,
 	if (TEST_FAIL())
 		return -1;
 
-	bnctx = BN_CTX_new();
+	bnctx = crypto_bnctx_get();
 	if (bnctx == NULL)
 		return -1;
 #ifndef OPENSSL_IS_BORINGSSL
@@ -2074,7 +2329,7 @@ int crypto_bignum_div(const struct crypto_bignum *a,
 #endif /* OPENSSL_IS_BORINGSSL */
 	res = BN_div((BIGNUM *) c, NULL, (const BIGNUM *) a,
 		     (const BIGNUM *) b, bnctx);
-	BN_CTX_free(bnctx);
+	crypto_bnctx_put(bnctx);
 
 	return res ? 0 : -1;
 }
@@ -2091,12 +2346,12 @@ int crypto_bignum_addmod(const struct crypto_bignum *a,
 	if (TEST_FAIL())
 		return -1;
 
-	bnctx = BN_CTX_new();
+	bnctx = crypto_bnctx_get();
 	if (!bnctx)
 		return -1;
 	res = BN_mod_add((BIGNUM *) d, (const BIGNUM *) a, (const BIGNUM *) b,
 			 (const BIGNUM *) c, bnctx);
-	BN_CTX_free(bnctx);
+	crypto_bnctx_put(bnctx);
 
 	return res ? 0 : -1;
 }
@@ -2114,12 +2369,12 @@ int crypto_bignum_mulmod(const struct crypto_bignum *a,
 	if (TEST_FAIL())
 		return -1;
 
-	bnctx = BN_CTX_new();
+	bnctx = crypto_bnctx_get();
 	if (bnctx == NULL)
 		return -1;
 	res = BN_mod_mul((BIGNUM *) d, (const BIGNUM *) a, (const BIGNUM *) b,
 			 (const BIGNUM *) c, bnctx);
-	BN_CTX_free(bnctx);
+	crypto_bnctx_put(bnctx);
 
 	return res ? 0 : -1;
 }
@@ -2135,12 +2390,12 @@ int crypto_bignum_sqrmod(const struct crypto_bignum *a,
 	if (TEST_FAIL())
 		return -1;
 
-	bnctx = BN_CTX_new();
+	bnctx = crypto_bnctx_get();
 	if (!bnctx)
 		return -1;
 	res = BN_mod_sqr((BIGNUM *) c, (const BIGNUM *) a, (const BIGNUM *) b,
 			 bnctx);
-	BN_CTX_free(bnctx);
+	crypto_bnctx_put(bnctx);
 
 	return res ? 0 : -1;
 }
@@ -2189,12 +2444,13 @@ int crypto_bignum_legendre(const struct crypto_bignum *a,
 	if (TEST_FAIL())
 		return -2;
 
-	bnctx = BN_CTX_new();
+	bnctx = crypto_bnctx_get();
 	if (bnctx == NULL)
 		return -2;
 
-	exp = BN_new();
-	tmp = BN_new();
+	BN_CTX_start(bnctx);
+	exp = BN_CTX_get(bnctx);
+	tmp = BN_CTX_get(bnctx);
 	if (!exp || !tmp ||
 	    /* exp = (p-1) / 2 */
 	    !BN_sub(exp, (const BIGNUM *) p, BN_value_one()) ||
@@ -2212,9 +2468,12 @@ int crypto_bignum_legendre(const struct crypto_bignum *a,
 	res = const_time_select_int(mask, 0, res);
 
 fail:
-	BN_clear_free(tmp);
-	BN_clear_free(exp);
-	BN_CTX_free(bnctx);
+	if (tmp)
+		BN_clear(tmp);
+	if (exp)
+		BN_clear(exp);
+	BN_CTX_end(bnctx);
+	crypto_bnctx_put(bnctx);
 	return res;
 }
 
@@ -2364,6 +2623,21 @@ struct crypto_ec_point * crypto_ec_point_init(struct crypto_ec *e)
 }
 
 
+struct crypto_ec_point * crypto_scratch_point(struct crypto_scratch *s,
+					      struct crypto_ec *e)
+{
+	EC_POINT *p;
+
+	if (TEST_FAIL() || !s || !e ||
+	    s->num_points == CRYPTO_SCRATCH_MAX_POINTS)
+		return NULL;
+	p = EC_POINT_new(e->group);
+	if (p)
+		s->points[s->num_points++] = p;
+	return (struct crypto_ec_point *) p;
+}
+
+
 size_t crypto_ec_prime_len(struct crypto_ec *e)
 {
 	return BN_num_bytes(e->prime);
@@ -2442,8 +2716,9 @@ int crypto_ec_point_to_bin(struct crypto_ec *e,
 	if (TEST_FAIL())
 		return -1;
 
-	x_bn = BN_new();
-	y_bn = BN_new();
+	BN_CTX_start(e->bnctx);
+	x_bn = BN_CTX_get(e->bnctx);
+	y_bn = BN_CTX_get(e->bnctx);
 
 	if (x_bn && y_bn &&
 	    EC_POINT_get_affine_coordinates(e->group, (EC_POINT *) point,
@@ -2461,8 +2736,11 @@ int crypto_ec_point_to_bin(struct crypto_ec *e,
 			ret = 0;
 	}
 
-	BN_clear_free(x_bn);
-	BN_clear_free(y_bn);
+	if (x_bn)
+		BN_clear(x_bn);
+	if (y_bn)
+		BN_clear(y_bn);
+	BN_CTX_end(e->bnctx);
 	return ret;
 }
 
@@ -2477,23 +2755,22 @@ struct crypto_ec_point * crypto_ec_point_from_bin(struct crypto_ec *e,
 	if (TEST_FAIL())
 		return NULL;
 
-	x = BN_bin2bn(val, len, NULL);
-	y = BN_bin2bn(val + len, len, NULL);
+	BN_CTX_start(e->bnctx);
+	x = BN_CTX_get(e->bnctx);
+	y = BN_CTX_get(e->bnctx);
 	elem = EC_POINT_new(e->group);
-	if (x == NULL || y == NULL || elem == NULL) {
-		BN_clear_free(x);
-		BN_clear_free(y);
-		EC_POINT_clear_free(elem);
-		return NULL;
-	}
-
-	if (!EC_POINT_set_affine_coordinates(e->group, elem, x, y, e->bnctx)) {
+	if (!x || !y || !elem ||
+	    !BN_bin2bn(val, len, x) || !BN_bin2bn(val + len, len, y) ||
+	    !EC_POINT_set_affine_coordinates(e->group, elem, x, y, e->bnctx)) {
 		EC_POINT_clear_free(elem);
 		elem = NULL;
 	}
 
-	BN_clear_free(x);
-	BN_clear_free(y);
+	if (x)
+		BN_clear(x);
+	if (y)
+		BN_clear(y);
+	BN_CTX_end(e->bnctx);
 
 	return (struct crypto_ec_point *) elem;
 }
@@ -2607,6 +2884,139 @@ fail:
 }
 
 
+/*
+ * Fixed-base comb: comb[m] = sum of 2^(i * spacing) * P over the bits i set in
+ * m, so that b * P needs only spacing doublings and at most spacing additions.
+ */
+#define CRYPTO_EC_COMB_TEETH 6
+
+struct crypto_ec_point_table {
+	EC_POINT *base;
+	EC_POINT *comb[1 << CRYPTO_EC_COMB_TEETH];
+	int spacing;
+};
+
+
+struct crypto_ec_point_table *
+crypto_ec_point_table_init(struct crypto_ec *e, const struct crypto_ec_point *p)
+{
+	struct crypto_ec_point_table *t;
+	EC_POINT *tooth[CRYPTO_EC_COMB_TEETH];
+	BIGNUM *x = NULL, *y = NULL;
+	int i, j, m;
+
+	t = os_zalloc(sizeof(*t));
+	if (!t)
+		return NULL;
+	os_memset(tooth, 0, sizeof(tooth));
+	t->base = EC_POINT_dup((const EC_POINT *) p, e->group);
+	if (!t->base)
+		goto fail;
+
+	/* OpenSSL has dedicated P-256 and P-521 implementations that are
+	 * faster than the generic point operations used for the comb. */
+	if (e->nid == NID_X9_62_prime256v1 || e->nid == NID_secp521r1)
+		return t;
+
+	t->spacing = (BN_num_bits(e->order) + CRYPTO_EC_COMB_TEETH - 1) /
+		CRYPTO_EC_COMB_TEETH;
+	x = BN_new();
+	y = BN_new();
+	if (!x || !y)
+		goto fail;
+
+	for (i = 0; i < CRYPTO_EC_COMB_TEETH; i++) {
+		tooth[i] = EC_POINT_dup(i ? tooth[i - 1] : t->base, e->group);
+		if (!tooth[i])
+			goto fail;
+		for (j = 0; i && j < t->spacing; j++) {
+			if (!EC_POINT_dbl(e->group, tooth[i], tooth[i],
+					  e->bnctx))
+				goto fail;
+		}
+	}
+
+	for (m = 1; m < (1 << CRYPTO_EC_COMB_TEETH); m++) {
+		t->comb[m] = EC_POINT_new(e->group);
+		if (!t->comb[m] ||
+		    !EC_POINT_set_to_infinity(e->group, t->comb[m]))
+			goto fail;
+		for (i = 0; i < CRYPTO_EC_COMB_TEETH; i++) {
+			if ((m & BIT(i)) &&
+			    !EC_POINT_add(e->group, t->comb[m], t->comb[m],
+					  tooth[i], e->bnctx))
+				goto fail;
+		}
+
+		/* Affine coordinates allow cheaper mixed additions */
+		if (!EC_POINT_get_affine_coordinates(e->group, t->comb[m],
+						     x, y, e->bnctx) ||
+		    !EC_POINT_set_affine_coordinates(e->group, t->comb[m],
+						     x, y, e->bnctx))
+			goto fail;
+	}
+
+out:
+	for (i = 0; i < CRYPTO_EC_COMB_TEETH; i++)
+		EC_POINT_clear_free(tooth[i]);
+	BN_clear_free(x);
+	BN_clear_free(y);
+	return t;
+fail:
+	crypto_ec_point_table_deinit(t);
+	t = NULL;
+	goto out;
+}
+
+
+void crypto_ec_point_table_deinit(struct crypto_ec_point_table *t)
+{
+	int m;
+
+	if (!t)
+		return;
+	EC_POINT_clear_free(t->base);
+	for (m = 0; m < (1 << CRYPTO_EC_COMB_TEETH); m++)
+		EC_POINT_clear_free(t->comb[m]);
+	os_free(t);
+}
+
+
+int crypto_ec_point_table_mul(struct crypto_ec *e,
+			      const struct crypto_ec_point_table *t,
+			      const struct crypto_bignum *b,
+			      struct crypto_ec_point *res)
+{
+	const BIGNUM *bn = (const BIGNUM *) b;
+	EC_POINT *r = (EC_POINT *) res;
+	int i, j, m;
+
+	if (TEST_FAIL())
+		return -1;
+
+	if (!t->spacing || BN_is_negative(bn) ||
+	    BN_num_bits(bn) > t->spacing * CRYPTO_EC_COMB_TEETH)
+		return crypto_ec_point_mul(e, (const struct crypto_ec_point *)
+					   t->base, b, res);
+
+	if (!EC_POINT_set_to_infinity(e->group, r))
+		return -1;
+	for (j = t->spacing - 1; j >= 0; j--) {
+		if (!EC_POINT_dbl(e->group, r, r, e->bnctx))
+			return -1;
+		m = 0;
+		for (i = 0; i < CRYPTO_EC_COMB_TEETH; i++) {
+			if (BN_is_bit_set(bn, i * t->spacing + j))
+				m |= BIT(i);
+		}
+		if (m && !EC_POINT_add(e->group, r, r, t->comb[m], e->bnctx))
+			return -1;
+	}
+
+	return 0;
+}
+
+
 struct crypto_ecdh {
 	struct crypto_ec *ec;
 	EVP_PKEY *pkey;
@@ -1111,6 +1111,59 @@ void crypto_bignum_deinit(struct crypto_bignum *n, int clear)
 }
 
 
+#define CRYPTO_SCRATCH_MAX_POINTS 8
+
+struct crypto_scratch {
+	struct crypto_bignum **bn;
+	size_t num_bn;
+#ifdef CONFIG_ECC
+	struct crypto_ec_point *points[CRYPTO_SCRATCH_MAX_POINTS];
+	unsigned int num_points;
+#endif /* CONFIG_ECC */
+};
+
+
+struct crypto_scratch * crypto_scratch_init(void)
+{
+	if (TEST_FAIL())
+		return NULL;
+	return os_zalloc(sizeof(struct crypto_scratch));
+}
+
+
+void crypto_scratch_deinit(struct crypto_scratch *s)
+{
+	if (!s)
+		return;
+
+	while (s->num_bn)
+		crypto_bignum_deinit(s->bn[--s->num_bn], 1);
+	os_free(s->bn);
+#ifdef CONFIG_ECC
+	while (s->num_points)
+		crypto_ec_point_deinit(s->points[--s->num_points], 1);
+#endif /* CONFIG_ECC */
+	os_free(s);
+}
+
+
+struct crypto_bignum * crypto_scratch_bignum(struct crypto_scratch *s)
+{
+	struct crypto_bignum **bn, *a;
+
+	if (!s)
+		return NULL;
+	bn = os_realloc_array(s->bn, s->num_bn + 1, sizeof(*bn));
+	if (!bn)
+		return NULL;
+	s->bn = bn;
+	a = crypto_bignum_init();
+	if (a)
+		s->bn[s->num_bn++] = a;
+	return a;
+}
+
+
 int crypto_bignum_to_bin(const struct crypto_bignum *a,
 			 u8 *buf, size_t buflen, size_t padlen)
 {
@@ -1440,6 +1493,20 @@ struct crypto_ec_point * crypto_ec_point_init(struct crypto_ec *e)
 }
 
 
+struct crypto_ec_point * crypto_scratch_point(struct crypto_scratch *s,
+					      struct crypto_ec *e)
+{
+	struct crypto_ec_point *p;
+
+	if (!s || s->num_points == CRYPTO_SCRATCH_MAX_POINTS)
+		return NULL;
+	p = crypto_ec_point_init(e);
+	if (p)
+		s->points[s->num_points++] = p;
+	return p;
+}
+
+
 size_t crypto_ec_prime_len(struct crypto_ec *e)
 {
 	return (mp_count_bits(&e->prime) + 7) / 8;
@@ -1711,6 +1778,48 @@ int crypto_ec_point_cmp(const struct crypto_ec *e,
 }
 
 
+/* No precomputation; wc_ecc_mulmod() is used for each multiplication */
+struct crypto_ec_point_table {
+	ecc_point *base;
+};
+
+
+struct crypto_ec_point_table *
+crypto_ec_point_table_init(struct crypto_ec *e, const struct crypto_ec_point *p)
+{
+	struct crypto_ec_point_table *t;
+
+	t = os_zalloc(sizeof(*t));
+	if (!t)
+		return NULL;
+	t->base = wc_ecc_new_point();
+	if (!t->base || wc_ecc_copy_point((ecc_point *) p, t->base) != MP_OKAY) {
+		crypto_ec_point_table_deinit(t);
+		return NULL;
+	}
+	return t;
+}
+
+
+void crypto_ec_point_table_deinit(struct crypto_ec_point_table *t)
+{
+	if (!t)
+		return;
+	crypto_ec_point_deinit((struct crypto_ec_point *) t->base, 1);
+	os_free(t);
+}
+
+
+int crypto_ec_point_table_mul(struct crypto_ec *e,
+			      const struct crypto_ec_point_table *t,
+			      const struct crypto_bignum *b,
+			      struct crypto_ec_point *res)
+{
+	return crypto_ec_point_mul(e, (const struct crypto_ec_point *) t->base,
+				   b, res);
+}
+
+
 struct crypto_ecdh {
 	struct crypto_ec *ec;
 	WC_RNG rng;
@@ -2106,6 +2215,25 @@ int crypto_ec_key_verify_signature(struct crypto_ec_key *key, const u8 *data,
 #endif /* CONFIG_ECC */
 
 
+struct crypto_hmac_key * crypto_hmac_key_init(enum crypto_hash_alg alg,
+					      const u8 *key, size_t key_len)
+{
+	return NULL;
+}
+
+
+int crypto_hmac_key_vector(struct crypto_hmac_key *key, size_t num_elem,
+			   const u8 *addr[], const size_t *len, u8 *mac)
+{
+	return -1;
+}
+
+
+void crypto_hmac_key_deinit(struct crypto_hmac_key *key)
+{
+}
+
+
 void crypto_unload(void)
 {
 }
@@ -171,6 +171,102 @@ void SHAPrintContext(SHA1_CTX *context, char *msg)
 }
 #endif
 
+#ifdef CONFIG_INTERNAL_SHA_NI
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+int sha1_ni_disabled = 0;
+
+
+static int sha1_ni_available(void)
+{
+	static int available = -1;
+	unsigned int a, b, c, d;
+
+	if (available < 0) {
+		available = __get_cpuid(1, &a, &b, &c, &d) &&
+			(c & bit_SSSE3) && (c & bit_SSE4_1) &&
+			__get_cpuid_count(7, 0, &a, &b, &c, &d) &&
+			(b & bit_SHA);
+	}
+
+	return available && !sha1_ni_disabled;
+}
+
+
+/* Hash a single 512-bit block using the x86 SHA extensions */
+__attribute__((target("ssse3,sse4.1,sha")))
+static void sha1_ni_transform(u32 state[5], const unsigned char buffer[64])
+{
+	const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL,
+					    0x08090a0b0c0d0e0fULL);
+	__m128i abcd, abcd_save, e, e_save, e_prev, w[4];
+	int i;
+
+	abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) state),
+				 0x1b);
+	e_save = _mm_set_epi32(state[4], 0, 0, 0);
+	abcd_save = abcd;
+	e_prev = abcd;
+
+	/* 20 groups of four rounds */
+	for (i = 0; i < 20; i++) {
+		if (i < 4) {
+			w[i] = _mm_shuffle_epi8(
+				_mm_loadu_si128(
+					(const __m128i *) (buffer + 16 * i)),
+				mask);
+		} else {
+			/* W[t] from W[t-16], W[t-14], W[t-8], and W[t-3] */
+			w[i & 3] = _mm_sha1msg2_epu32(
+				_mm_xor_si128(
+					_mm_sha1msg1_epu32(w[i & 3],
+							   w[(i + 1) & 3]),
+					w[(i + 2) & 3]),
+				w[(i + 3) & 3]);
+		}
+
+		if (i == 0)
+			e = _mm_add_epi32(e_save, w[0]);
+		else
+			e = _mm_sha1nexte_epu32(e_prev, w[i & 3]);
+		e_prev = abcd;
+
+		switch (i / 5) {
+		case 0:
+			abcd = _mm_sha1rnds4_epu32(abcd, e, 0);
+			break;
+		case 1:
+			abcd = _mm_sha1rnds4_epu32(abcd, e, 1);
+			break;
+		case 2:
+			abcd = _mm_sha1rnds4_epu32(abcd, e, 2);
+			break;
+		default:
+			abcd = _mm_sha1rnds4_epu32(abcd, e, 3);
+			break;
+		}
+	}
+
+	e = _mm_sha1nexte_epu32(e_prev, e_save);
+	abcd = _mm_add_epi32(abcd, abcd_save);
+
+	_mm_storeu_si128((__m128i *) state, _mm_shuffle_epi32(abcd, 0x1b));
+	state[4] = _mm_extract_epi32(e, 3);
+}
+
+#else /* __x86_64__ || __i386__ */
+
+int sha1_ni_disabled = 0;
+
+#define sha1_ni_available() 0
+#define sha1_ni_transform(state, buffer) do { } while (0)
+
+#endif /* __x86_64__ || __i386__ */
+#endif /* CONFIG_INTERNAL_SHA_NI */
+
 /* Hash a single 512-bit block. This is the core of the algorithm. */
 
 void SHA1Transform(u32 state[5], const unsigned char buffer[64])
@@ -183,6 +279,16 @@ void SHA1Transform(u32 state[5], const unsigned char buffer[64])
 	CHAR64LONG16* block;
 #ifdef SHA1HANDSOFF
 	CHAR64LONG16 workspace;
+#endif
+
+#ifdef CONFIG_INTERNAL_SHA_NI
+	if (sha1_ni_available()) {
+		sha1_ni_transform(state, buffer);
+		return;
+	}
+#endif /* CONFIG_INTERNAL_SHA_NI */
+
+#ifdef SHA1HANDSOFF
 	block = &workspace;
 	os_memcpy(block, buffer, 64);
 #else
@@ -36,6 +36,8 @@ int sha1_prf(const u8 *key, size_t key_len, const char *label,
 	size_t label_len = os_strlen(label) + 1;
 	const unsigned char *addr[3];
 	size_t len[3];
+	struct crypto_hmac_key *hkey = NULL;
+	int res = 0;
 
 	addr[0] = (u8 *) label;
 	len[0] = label_len;
@@ -44,24 +46,29 @@ int sha1_prf(const u8 *key, size_t key_len, const char *label,
 	addr[2] = &counter;
 	len[2] = 1;
 
+	/* Process the padded key only once if more than one block is needed */
+	if (buf_len > SHA1_MAC_LEN)
+		hkey = crypto_hmac_key_init(CRYPTO_HASH_ALG_HMAC_SHA1, key,
+					    key_len);
+
 	pos = 0;
 	while (pos < buf_len) {
 		plen = buf_len - pos;
-		if (plen >= SHA1_MAC_LEN) {
-			if (hmac_sha1_vector(key, key_len, 3, addr, len,
-					     &buf[pos]))
-				return -1;
-			pos += SHA1_MAC_LEN;
-		} else {
-			if (hmac_sha1_vector(key, key_len, 3, addr, len,
-					     hash))
-				return -1;
-			os_memcpy(&buf[pos], hash, plen);
+		if (hkey)
+			res = crypto_hmac_key_vector(hkey, 3, addr, len, hash);
+		else
+			res = hmac_sha1_vector(key, key_len, 3, addr, len,
+					       hash);
+		if (res)
 			break;
-		}
+		if (plen > SHA1_MAC_LEN)
+			plen = SHA1_MAC_LEN;
+		os_memcpy(&buf[pos], hash, plen);
+		pos += plen;
 		counter++;
 	}
+	crypto_hmac_key_deinit(hkey);
 	forced_memzero(hash, sizeof(hash));
 
-	return 0;
+	return res ? -1 : 0;
 }
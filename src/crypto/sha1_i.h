@@ -20,4 +20,8 @@ void SHA1Update(struct SHA1Context *context, const void *data, u32 len);
 void SHA1Final(unsigned char digest[20], struct SHA1Context *context);
 void SHA1Transform(u32 state[5], const unsigned char buffer[64]);
 
+#ifdef CONFIG_INTERNAL_SHA_NI
+extern int sha1_ni_disabled;
+#endif /* CONFIG_INTERNAL_SHA_NI */
+
 #endif /* SHA1_I_H */
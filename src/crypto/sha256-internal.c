@@ -47,7 +47,7 @@ int sha256_vector(size_t num_elem, const u8 *addr[], const size_t *len,
  * public domain by Tom St Denis. */
 
 /* the K array */
-static const unsigned long K[64] = {
+static const u32 K[64] = {
 	0x428a2f98UL, 0x71374491UL, 0xb5c0fbcfUL, 0xe9b5dba5UL, 0x3956c25bUL,
 	0x59f111f1UL, 0x923f82a4UL, 0xab1c5ed5UL, 0xd807aa98UL, 0x12835b01UL,
 	0x243185beUL, 0x550c7dc3UL, 0x72be5d74UL, 0x80deb1feUL, 0x9bdc06a7UL,
@@ -80,6 +80,92 @@ static const unsigned long K[64] = {
 #define MIN(x, y) (((x) < (y)) ? (x) : (y))
 #endif
 
+#ifdef CONFIG_INTERNAL_SHA_NI
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+int sha256_ni_disabled = 0;
+
+
+static int sha256_ni_available(void)
+{
+	static int available = -1;
+	unsigned int a, b, c, d;
+
+	if (available < 0) {
+		available = __get_cpuid(1, &a, &b, &c, &d) &&
+			(c & bit_SSSE3) && (c & bit_SSE4_1) &&
+			__get_cpuid_count(7, 0, &a, &b, &c, &d) &&
+			(b & bit_SHA);
+	}
+
+	return available && !sha256_ni_disabled;
+}
+
+
+/* compress 512-bits using the x86 SHA extensions */
+__attribute__((target("ssse3,sse4.1,sha")))
+static void sha256_ni_compress(u32 state[8], const u8 *buf)
+{
+	const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+					    0x0405060700010203ULL);
+	__m128i state0, state1, abef, cdgh, msg, tmp, w[4];
+	int i;
+
+	/* Rearrange A..H into the ABEF/CDGH layout of SHA256RNDS2 */
+	tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) &state[0]),
+				0xb1);
+	state1 = _mm_shuffle_epi32(
+		_mm_loadu_si128((const __m128i *) &state[4]), 0x1b);
+	state0 = _mm_alignr_epi8(tmp, state1, 8);
+	state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+	abef = state0;
+	cdgh = state1;
+
+	for (i = 0; i < 16; i++) {
+		if (i < 4) {
+			w[i] = _mm_shuffle_epi8(
+				_mm_loadu_si128((const __m128i *) (buf + 16 * i)),
+				mask);
+		} else {
+			/* W[t] from W[t-16], W[t-15], W[t-7], and W[t-2] */
+			tmp = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+			tmp = _mm_add_epi32(tmp, _mm_alignr_epi8(w[(i + 3) & 3],
+								 w[(i + 2) & 3],
+								 4));
+			w[i & 3] = _mm_sha256msg2_epu32(tmp, w[(i + 3) & 3]);
+		}
+
+		msg = _mm_add_epi32(w[i & 3],
+				    _mm_loadu_si128((const __m128i *) &K[4 * i]));
+		state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+		msg = _mm_shuffle_epi32(msg, 0x0e);
+		state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+	}
+
+	state0 = _mm_add_epi32(state0, abef);
+	state1 = _mm_add_epi32(state1, cdgh);
+
+	tmp = _mm_shuffle_epi32(state0, 0x1b);
+	state1 = _mm_shuffle_epi32(state1, 0xb1);
+	state0 = _mm_blend_epi16(tmp, state1, 0xf0);
+	state1 = _mm_alignr_epi8(state1, tmp, 8);
+	_mm_storeu_si128((__m128i *) &state[0], state0);
+	_mm_storeu_si128((__m128i *) &state[4], state1);
+}
+
+#else /* __x86_64__ || __i386__ */
+
+int sha256_ni_disabled = 0;
+
+#define sha256_ni_available() 0
+#define sha256_ni_compress(state, buf) do { } while (0)
+
+#endif /* __x86_64__ || __i386__ */
+#endif /* CONFIG_INTERNAL_SHA_NI */
+
 /* compress 512-bits */
 static int sha256_compress(struct sha256_state *md, unsigned char *buf)
 {
@@ -87,6 +173,13 @@ static int sha256_compress(struct sha256_state *md, unsigned char *buf)
 	u32 t;
 	int i;
 
+#ifdef CONFIG_INTERNAL_SHA_NI
+	if (sha256_ni_available()) {
+		sha256_ni_compress(md->state, buf);
+		return 0;
+	}
+#endif /* CONFIG_INTERNAL_SHA_NI */
+
 	/* copy state into S */
 	for (i = 0; i < 8; i++) {
 		S[i] = md->state[i];
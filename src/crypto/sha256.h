@@ -11,6 +11,8 @@
 
 #define SHA256_MAC_LEN 32
 
+struct crypto_hmac_key;
+
 int hmac_sha256_vector(const u8 *key, size_t key_len, size_t num_elem,
 		       const u8 *addr[], const size_t *len, u8 *mac);
 int hmac_sha256(const u8 *key, size_t key_len, const u8 *data,
@@ -20,6 +22,9 @@ int sha256_prf(const u8 *key, size_t key_len, const char *label,
 int sha256_prf_bits(const u8 *key, size_t key_len, const char *label,
 		    const u8 *data, size_t data_len, u8 *buf,
 		    size_t buf_len_bits);
+int sha256_prf_key(struct crypto_hmac_key *hkey, const u8 *key,
+		   size_t key_len, const char *label, const u8 *data,
+		   size_t data_len, u8 *buf, size_t buf_len);
 int tls_prf_sha256(const u8 *secret, size_t secret_len,
 		   const char *label, const u8 *seed, size_t seed_len,
 		   u8 *out, size_t outlen);
@@ -22,4 +22,8 @@ int sha256_process(struct sha256_state *md, const unsigned char *in,
 		   unsigned long inlen);
 int sha256_done(struct sha256_state *md, unsigned char *out);
 
+#ifdef CONFIG_INTERNAL_SHA_NI
+extern int sha256_ni_disabled;
+#endif /* CONFIG_INTERNAL_SHA_NI */
+
 #endif /* SHA256_I_H */
@@ -10,6 +10,18 @@
 
 #include "common.h"
 #include "sha384.h"
+#include "crypto.h"
+
+
+static int sha384_kdf_hmac(struct crypto_hmac_key *hkey, const u8 *secret,
+			   size_t secret_len, size_t num_elem,
+			   const u8 *addr[], const size_t *len, u8 *mac)
+{
+	if (hkey)
+		return crypto_hmac_key_vector(hkey, num_elem, addr, len, mac);
+	return hmac_sha384_vector(secret, secret_len, num_elem, addr, len,
+				  mac);
+}
 
 
 /**
@@ -38,6 +50,8 @@ int hmac_sha384_kdf(const u8 *secret, size_t secret_len,
 	const unsigned char *addr[4];
 	size_t len[4];
 	size_t pos, clen;
+	struct crypto_hmac_key *hkey = NULL;
+	int ret = -1;
 
 	addr[0] = T;
 	len[0] = SHA384_MAC_LEN;
@@ -53,8 +67,14 @@ int hmac_sha384_kdf(const u8 *secret, size_t secret_len,
 	addr[3] = &iter;
 	len[3] = 1;
 
-	if (hmac_sha384_vector(secret, secret_len, 3, &addr[1], &len[1], T) < 0)
-		return -1;
+	/* Process the padded key only once if more than one block is needed */
+	if (outlen > SHA384_MAC_LEN)
+		hkey = crypto_hmac_key_init(CRYPTO_HASH_ALG_HMAC_SHA384, secret,
+					   secret_len);
+
+	if (sha384_kdf_hmac(hkey, secret, secret_len, 3, &addr[1], &len[1],
+			    T) < 0)
+		goto fail;
 
 	pos = 0;
 	for (;;) {
@@ -69,19 +89,20 @@ int hmac_sha384_kdf(const u8 *secret, size_t secret_len,
 
 		if (iter == 255) {
 			os_memset(out, 0, outlen);
-			forced_memzero(T, SHA384_MAC_LEN);
-			return -1;
+			goto fail;
 		}
 		iter++;
 
-		if (hmac_sha384_vector(secret, secret_len, 4, addr, len, T) < 0)
-		{
+		if (sha384_kdf_hmac(hkey, secret, secret_len, 4, addr, len,
+				    T) < 0) {
 			os_memset(out, 0, outlen);
-			forced_memzero(T, SHA384_MAC_LEN);
-			return -1;
+			goto fail;
 		}
 	}
 
+	ret = 0;
+fail:
+	crypto_hmac_key_deinit(hkey);
 	forced_memzero(T, SHA384_MAC_LEN);
-	return 0;
+	return ret;
 }
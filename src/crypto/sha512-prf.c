@@ -13,47 +13,20 @@
 #include "crypto.h"
 
 
-/**
- * sha512_prf - SHA512-based Key derivation function (IEEE 802.11ac, 11.6.1.7.2)
- * @key: Key for KDF
- * @key_len: Length of the key in bytes
- * @label: A unique label for each purpose of the PRF
- * @data: Extra data to bind into the key
- * @data_len: Length of the data
- * @buf: Buffer for the generated pseudo-random key
- * @buf_len: Number of bytes of key to generate
- * Returns: 0 on success, -1 on failure
- *
- * This function is used to derive new, cryptographically separate keys from a
- * given key.
- */
-int sha512_prf(const u8 *key, size_t key_len, const char *label,
-	       const u8 *data, size_t data_len, u8 *buf, size_t buf_len)
+static int sha512_prf_hmac(struct crypto_hmac_key *hkey, const u8 *key,
+			   size_t key_len, const u8 *addr[], const size_t *len,
+			   u8 *mac)
 {
-	return sha512_prf_bits(key, key_len, label, data, data_len, buf,
-			       buf_len * 8);
+	if (hkey)
+		return crypto_hmac_key_vector(hkey, 4, addr, len, mac);
+	return hmac_sha512_vector(key, key_len, 4, addr, len, mac);
 }
 
 
-/**
- * sha512_prf_bits - IEEE Std 802.11ac-2013, 11.6.1.7.2 Key derivation function
- * @key: Key for KDF
- * @key_len: Length of the key in bytes
- * @label: A unique label for each purpose of the PRF
- * @data: Extra data to bind into the key
- * @data_len: Length of the data
- * @buf: Buffer for the generated pseudo-random key
- * @buf_len: Number of bits of key to generate
- * Returns: 0 on success, -1 on failure
- *
- * This function is used to derive new, cryptographically separate keys from a
- * given key. If the requested buf_len is not divisible by eight, the least
- * significant 1-7 bits of the last octet in the output are not part of the
- * requested output.
- */
-int sha512_prf_bits(const u8 *key, size_t key_len, const char *label,
-		    const u8 *data, size_t data_len, u8 *buf,
-		    size_t buf_len_bits)
+static int sha512_prf_bits_key(struct crypto_hmac_key *hkey,
+			       const u8 *key, size_t key_len,
+			       const char *label, const u8 *data,
+			       size_t data_len, u8 *buf, size_t buf_len_bits)
 {
 	u16 counter = 1;
 	size_t pos, plen;
@@ -78,13 +51,13 @@ int sha512_prf_bits(const u8 *key, size_t key_len, const char *label,
 		plen = buf_len - pos;
 		WPA_PUT_LE16(counter_le, counter);
 		if (plen >= SHA512_MAC_LEN) {
-			if (hmac_sha512_vector(key, key_len, 4, addr, len,
-					       &buf[pos]) < 0)
+			if (sha512_prf_hmac(hkey, key, key_len, addr, len,
+					    &buf[pos]) < 0)
 				return -1;
 			pos += SHA512_MAC_LEN;
 		} else {
-			if (hmac_sha512_vector(key, key_len, 4, addr, len,
-					       hash) < 0)
+			if (sha512_prf_hmac(hkey, key, key_len, addr, len,
+					    hash) < 0)
 				return -1;
 			os_memcpy(&buf[pos], hash, plen);
 			pos += plen;
@@ -106,3 +79,84 @@ int sha512_prf_bits(const u8 *key, size_t key_len, const char *label,
 
 	return 0;
 }
+
+
+/**
+ * sha512_prf - SHA512-based Key derivation function (IEEE 802.11ac, 11.6.1.7.2)
+ * @key: Key for KDF
+ * @key_len: Length of the key in bytes
+ * @label: A unique label for each purpose of the PRF
+ * @data: Extra data to bind into the key
+ * @data_len: Length of the data
+ * @buf: Buffer for the generated pseudo-random key
+ * @buf_len: Number of bytes of key to generate
+ * Returns: 0 on success, -1 on failure
+ *
+ * This function is used to derive new, cryptographically separate keys from a
+ * given key.
+ */
+int sha512_prf(const u8 *key, size_t key_len, const char *label,
+	       const u8 *data, size_t data_len, u8 *buf, size_t buf_len)
+{
+	return sha512_prf_bits(key, key_len, label, data, data_len, buf,
+			       buf_len * 8);
+}
+
+
+/**
+ * sha512_prf_bits - IEEE Std 802.11ac-2013, 11.6.1.7.2 Key derivation function
+ * @key: Key for KDF
+ * @key_len: Length of the key in bytes
+ * @label: A unique label for each purpose of the PRF
+ * @data: Extra data to bind into the key
+ * @data_len: Length of the data
+ * @buf: Buffer for the generated pseudo-random key
+ * @buf_len: Number of bits of key to generate
+ * Returns: 0 on success, -1 on failure
+ *
+ * This function is used to derive new, cryptographically separate keys from a
+ * given key. If the requested buf_len is not divisible by eight, the least
+ * significant 1-7 bits of the last octet in the output are not part of the
+ * requested output.
+ */
+int sha512_prf_bits(const u8 *key, size_t key_len, const char *label,
+		    const u8 *data, size_t data_len, u8 *buf,
+		    size_t buf_len_bits)
+{
+	struct crypto_hmac_key *hkey = NULL;
+	int res;
+
+	/* Process the padded key only once if more than one block is needed */
+	if (buf_len_bits > SHA512_MAC_LEN * 8)
+		hkey = crypto_hmac_key_init(CRYPTO_HASH_ALG_HMAC_SHA512, key,
+					   key_len);
+	res = sha512_prf_bits_key(hkey, key, key_len, label, data, data_len,
+				  buf, buf_len_bits);
+	crypto_hmac_key_deinit(hkey);
+
+	return res;
+}
+
+
+/**
+ * sha512_prf_key - sha512_prf() with a precomputed HMAC key
+ * @hkey: HMAC-SHA512 key from crypto_hmac_key_init() or %NULL
+ * @key: Key for KDF; used only if hkey is %NULL
+ * @key_len: Length of the key in bytes
+ * @label: A unique label for each purpose of the PRF
+ * @data: Extra data to bind into the key
+ * @data_len: Length of the data
+ * @buf: Buffer for the generated pseudo-random key
+ * @buf_len: Number of bytes of key to generate
+ * Returns: 0 on success, -1 on failure
+ *
+ * This allows multiple keys to be derived from the same key without
+ * processing the padded key for each derivation.
+ */
+int sha512_prf_key(struct crypto_hmac_key *hkey, const u8 *key,
+		   size_t key_len, const char *label, const u8 *data,
+		   size_t data_len, u8 *buf, size_t buf_len)
+{
+	return sha512_prf_bits_key(hkey, key, key_len, label, data, data_len,
+				   buf, buf_len * 8);
+}
@@ -22,6 +22,7 @@ static int tls_ref_count = 0;
 struct tls_global {
 	int server;
 	struct tlsv1_credentials *server_cred;
+	struct tlsv1_server_session_cache *session_cache;
 	int check_crl;
 
 	void (*event_cb)(void *ctx, enum tls_event ev,
@@ -62,6 +63,17 @@ void * tls_init(const struct tls_config *conf)
 		global->cert_in_cb = conf->cert_in_cb;
 	}
 
+#ifdef CONFIG_TLS_INTERNAL_SERVER
+	if (conf && conf->tls_session_lifetime) {
+		global->session_cache = tlsv1_server_session_cache_init(
+			conf->tls_session_lifetime);
+		if (!global->session_cache) {
+			tls_deinit(global);
+			return NULL;
+		}
+	}
+#endif /* CONFIG_TLS_INTERNAL_SERVER */
+
 	return global;
 }
 
@@ -79,6 +91,7 @@ void tls_deinit(void *ssl_ctx)
 	}
 #ifdef CONFIG_TLS_INTERNAL_SERVER
 	tlsv1_cred_free(global->server_cred);
+	tlsv1_server_session_cache_deinit(global->session_cache);
 #endif /* CONFIG_TLS_INTERNAL_SERVER */
 	os_free(global);
 }
@@ -118,6 +131,8 @@ struct tls_connection * tls_connection_init(void *tls_ctx)
 			os_free(conn);
 			return NULL;
 		}
+		tlsv1_server_set_session_cache(conn->server,
+					       global->session_cache);
 	}
 #endif /* CONFIG_TLS_INTERNAL_SERVER */
 
@@ -367,8 +382,12 @@ int tls_connection_set_verify(void *tls_ctx, struct tls_connection *conn,
 			      const u8 *session_ctx, size_t session_ctx_len)
 {
 #ifdef CONFIG_TLS_INTERNAL_SERVER
-	if (conn->server)
+	if (conn->server) {
+		if (tlsv1_server_set_session_ctx(conn->server, session_ctx,
+						 session_ctx_len) < 0)
+			return -1;
 		return tlsv1_server_set_verify(conn->server, verify_peer);
+	}
 #endif /* CONFIG_TLS_INTERNAL_SERVER */
 	return -1;
 }
@@ -783,6 +802,12 @@ int tls_get_library_version(char *buf, size_t buf_len)
 void tls_connection_set_success_data(struct tls_connection *conn,
 				     struct wpabuf *data)
 {
+#ifdef CONFIG_TLS_INTERNAL_SERVER
+	if (conn->server) {
+		tlsv1_server_set_success_data(conn->server, data);
+		return;
+	}
+#endif /* CONFIG_TLS_INTERNAL_SERVER */
 	wpabuf_free(data);
 }
 
@@ -795,10 +820,18 @@ void tls_connection_set_success_data_resumed(struct tls_connection *conn)
 const struct wpabuf *
 tls_connection_get_success_data(struct tls_connection *conn)
 {
+#ifdef CONFIG_TLS_INTERNAL_SERVER
+	if (conn->server)
+		return tlsv1_server_get_success_data(conn->server);
+#endif /* CONFIG_TLS_INTERNAL_SERVER */
 	return NULL;
 }
 
 
 void tls_connection_remove_session(struct tls_connection *conn)
 {
+#ifdef CONFIG_TLS_INTERNAL_SERVER
+	if (conn->server)
+		tlsv1_server_remove_session(conn->server);
+#endif /* CONFIG_TLS_INTERNAL_SERVER */
 }
@@ -35,14 +35,41 @@
 #define IF_OPER_DORMANT 5
 #define IF_OPER_UP 6
 #endif
+#ifndef IFLA_LINK
+#define IFLA_LINK 5
+#endif
+#ifndef IFLA_MASTER
+#define IFLA_MASTER 10
+#endif
+#ifndef IFLA_LINKINFO
+#define IFLA_LINKINFO 18
+#define IFLA_INFO_KIND 1
+#define IFLA_INFO_DATA 2
+#endif
+#ifndef IFLA_BR_FORWARD_DELAY
+#define IFLA_BR_FORWARD_DELAY 1
+#endif
+#ifndef IFLA_VLAN_ID
+#define IFLA_VLAN_ID 1
+#endif
 
 #define NLM_F_REQUEST 1
+#define NLM_F_ACK 4
+#define NLM_F_ROOT 0x100
+#define NLM_F_MATCH 0x200
+#define NLM_F_DUMP (NLM_F_ROOT | NLM_F_MATCH)
+#define NLM_F_EXCL 0x200
+#define NLM_F_CREATE 0x400
+
+#define NLMSG_ERROR 0x2
+#define NLMSG_DONE 0x3
 
 #define NETLINK_ROUTE 0
 #define RTMGRP_LINK 1
 #define RTM_BASE 0x10
 #define RTM_NEWLINK (RTM_BASE + 0)
 #define RTM_DELLINK (RTM_BASE + 1)
+#define RTM_GETLINK (RTM_BASE + 2)
 #define RTM_SETLINK (RTM_BASE + 3)
 
 #define NLMSG_ALIGNTO 4
@@ -90,6 +117,12 @@ struct nlmsghdr
 	u32 nlmsg_pid;
 };
 
+struct nlmsgerr
+{
+	int error;
+	struct nlmsghdr msg;
+};
+
 struct ifinfomsg
 {
 	unsigned char ifi_family;
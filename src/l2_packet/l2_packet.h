@@ -114,6 +114,43 @@ int l2_packet_get_own_addr(struct l2_packet_data *l2, u8 *addr);
 int l2_packet_send(struct l2_packet_data *l2, const u8 *dst_addr, u16 proto,
 		   const u8 *buf, size_t len);
 
+/**
+ * l2_packet_send_multi - Send copies of a packet to multiple destinations
+ * @l2: Pointer to internal l2_packet data from l2_packet_init()
+ * @dst_addrs: Array of num_dst destination addresses (ETH_ALEN octets each)
+ * @num_dst: Number of destination addresses
+ * @buf: Packet contents to be sent including the layer 2 header
+ * @len: Length of the buffer
+ * Returns: Number of destinations to which the packet was sent or -1 on
+ * failure
+ *
+ * This function can only be used if l2_hdr was set to 1 in l2_packet_init()
+ * call. The destination address in the Ethernet header of each copy is
+ * replaced with the address from dst_addrs while buf itself is not modified.
+ * The packets are sent in order and the return value can be less than num_dst
+ * if sending fails for one of them. l2_packet implementations that do not
+ * support sending multiple packets at once return -1 and the caller is
+ * expected to use l2_packet_send() instead.
+ */
+int l2_packet_send_multi(struct l2_packet_data *l2, const u8 *dst_addrs,
+			 size_t num_dst, const u8 *buf, size_t len);
+
+/**
+ * l2_packet_get_mib - Get receive statistics in MIB text format
+ * @l2: Pointer to internal l2_packet data from l2_packet_init() or %NULL
+ * @prefix: Prefix for the variable names, e.g., "eapol"
+ * @buf: Buffer for the text
+ * @buflen: Maximum buffer length
+ * Returns: Number of bytes written into buf, 0 if statistics are not available
+ *
+ * The number of received frames (<prefix>RxFrames), the number of receive
+ * calls that returned at least one frame (<prefix>RxBatches), and the largest
+ * number of frames returned by a single receive call (<prefix>RxBatchMax) are
+ * written as name=value lines.
+ */
+int l2_packet_get_mib(struct l2_packet_data *l2, const char *prefix,
+		      char *buf, size_t buflen);
+
 /**
  * l2_packet_get_ip_addr - Get the current IP address from the interface
  * @l2: Pointer to internal l2_packet data from l2_packet_init()
@@ -6,6 +6,7 @@
  * See README for more details.
  */
 
+#define _GNU_SOURCE /* for recvmmsg() */
 #include "includes.h"
 #include <sys/ioctl.h>
 #include <netpacket/packet.h>
@@ -19,6 +20,15 @@
 #include "l2_packet.h"
 
 
+/* Maximum length of a received frame */
+#define L2_PACKET_RX_BUF_LEN 2300
+/* Maximum number of frames received with a single recvmmsg() call */
+#define L2_PACKET_RX_BATCH 16
+/* Maximum number of recvmmsg() calls per socket readiness event */
+#define L2_PACKET_RX_MAX_CALLS 4
+/* Maximum number of frames sent with a single sendmmsg() call */
+#define L2_PACKET_TX_BATCH 64
+
 struct l2_packet_data {
 	int fd; /* packet socket for EAPOL frames */
 	char ifname[IFNAMSIZ + 1];
@@ -30,6 +40,18 @@ struct l2_packet_data {
 	int l2_hdr; /* whether to include layer 2 (Ethernet) header data
 		     * buffers */
 
+	/*
+	 * L2_PACKET_RX_BATCH buffers for recvmmsg(); allocated on the first
+	 * batched receive, so NULL if batches have not been used
+	 */
+	u8 *rx_buf;
+	int rx_batch_disabled;
+	int in_rx; /* rx_callback may be called for more frames in the batch */
+	int deinit_pending; /* l2_packet_deinit() was called from rx_callback */
+	unsigned int rx_frames;
+	unsigned int rx_batches;
+	unsigned int rx_batch_max;
+
 #ifndef CONFIG_NO_LINUX_PACKET_SOCKET_WAR
 	/* For working around Linux packet socket behavior and regression. */
 	int fd_br_rx;
@@ -145,26 +167,77 @@ int l2_packet_send(struct l2_packet_data *l2, const u8 *dst_addr, u16 proto,
 }
 
 
-static void l2_packet_receive(int sock, void *eloop_ctx, void *sock_ctx)
+int l2_packet_send_multi(struct l2_packet_data *l2, const u8 *dst_addrs,
+			 size_t num_dst, const u8 *buf, size_t len)
 {
-	struct l2_packet_data *l2 = eloop_ctx;
-	u8 buf[2300];
+	struct mmsghdr msgs[L2_PACKET_TX_BATCH];
+	struct iovec iov[L2_PACKET_TX_BATCH][2];
+	size_t i, num, sent = 0;
 	int res;
-	struct sockaddr_ll ll;
-	socklen_t fromlen;
 
-	os_memset(&ll, 0, sizeof(ll));
-	fromlen = sizeof(ll);
-	res = recvfrom(sock, buf, sizeof(buf), 0, (struct sockaddr *) &ll,
-		       &fromlen);
-	if (res < 0) {
-		wpa_printf(MSG_DEBUG, "l2_packet_receive - recvfrom: %s",
-			   strerror(errno));
-		return;
+	if (TEST_FAIL())
+		return -1;
+	if (!l2 || !l2->l2_hdr || len < ETH_HLEN)
+		return -1;
+
+	while (sent < num_dst) {
+		num = num_dst - sent;
+		if (num > L2_PACKET_TX_BATCH)
+			num = L2_PACKET_TX_BATCH;
+
+		/* Only the destination address differs between the frames */
+		os_memset(msgs, 0, num * sizeof(msgs[0]));
+		for (i = 0; i < num; i++) {
+			iov[i][0].iov_base = (void *) &dst_addrs[(sent + i) *
+								 ETH_ALEN];
+			iov[i][0].iov_len = ETH_ALEN;
+			iov[i][1].iov_base = (void *) &buf[ETH_ALEN];
+			iov[i][1].iov_len = len - ETH_ALEN;
+			msgs[i].msg_hdr.msg_iov = iov[i];
+			msgs[i].msg_hdr.msg_iovlen = 2;
+		}
+
+		res = sendmmsg(l2->fd, msgs, num, 0);
+		if (res < 0) {
+			wpa_printf(MSG_ERROR,
+				   "l2_packet_send_multi - sendmmsg: %s",
+				   strerror(errno));
+			break;
+		}
+		sent += res;
+		if ((size_t) res < num)
+			break;
 	}
 
-	wpa_printf(MSG_DEBUG, "%s: src=" MACSTR " len=%d",
-		   __func__, MAC2STR(ll.sll_addr), (int) res);
+	return sent ? (int) sent : -1;
+}
+
+
+int l2_packet_get_mib(struct l2_packet_data *l2, const char *prefix,
+		      char *buf, size_t buflen)
+{
+	int ret;
+
+	if (!l2)
+		return 0;
+
+	ret = os_snprintf(buf, buflen,
+			  "%sRxFrames=%u\n"
+			  "%sRxBatches=%u\n"
+			  "%sRxBatchMax=%u\n",
+			  prefix, l2->rx_frames, prefix, l2->rx_batches,
+			  prefix, l2->rx_batch_max);
+	if (os_snprintf_error(buflen, ret))
+		return 0;
+	return ret;
+}
+
+
+static void l2_packet_rx_frame(struct l2_packet_data *l2, const u8 *src_addr,
+			      const u8 *buf, int res)
+{
+	wpa_printf(MSG_DEBUG, "l2_packet_receive: src=" MACSTR " len=%d",
+		   MAC2STR(src_addr), res);
 
 #ifndef CONFIG_NO_LINUX_PACKET_SOCKET_WAR
 	if (l2->fd_br_rx >= 0) {
@@ -194,14 +267,14 @@ static void l2_packet_receive(int sock, void *eloop_ctx, void *sock_ctx)
 		sha1_vector(1, addr, len, hash);
 		if (l2->last_from_br &&
 		    os_memcmp(hash, l2->last_hash, SHA1_MAC_LEN) == 0) {
-			wpa_printf(MSG_DEBUG, "%s: Drop duplicate RX",
-				   __func__);
+			wpa_printf(MSG_DEBUG,
+				   "l2_packet_receive: Drop duplicate RX");
 			return;
 		}
 		if (l2->last_from_br_prev &&
 		    os_memcmp(hash, l2->last_hash_prev, SHA1_MAC_LEN) == 0) {
-			wpa_printf(MSG_DEBUG, "%s: Drop duplicate RX(prev)",
-				   __func__);
+			wpa_printf(MSG_DEBUG,
+				   "l2_packet_receive: Drop duplicate RX(prev)");
 			return;
 		}
 		os_memcpy(l2->last_hash_prev, l2->last_hash, SHA1_MAC_LEN);
@@ -211,7 +284,129 @@ static void l2_packet_receive(int sock, void *eloop_ctx, void *sock_ctx)
 
 	l2->last_from_br = 0;
 #endif /* CONFIG_NO_LINUX_PACKET_SOCKET_WAR */
-	l2->rx_callback(l2->rx_callback_ctx, ll.sll_addr, buf, res);
+	l2->rx_callback(l2->rx_callback_ctx, src_addr, buf, res);
+}
+
+
+static void l2_packet_rx_stats(struct l2_packet_data *l2, int frames)
+{
+	l2->rx_frames += frames;
+	l2->rx_batches++;
+	if ((unsigned int) frames > l2->rx_batch_max)
+		l2->rx_batch_max = frames;
+}
+
+
+static void l2_packet_free(struct l2_packet_data *l2)
+{
+	os_free(l2->rx_buf);
+	os_free(l2);
+}
+
+
+/*
+ * Receive up to L2_PACKET_RX_BATCH frames per recvmmsg() call and continue
+ * until the socket has been drained or L2_PACKET_RX_MAX_CALLS calls have been
+ * made to avoid starving the other sockets.
+ */
+static void l2_packet_receive_batch(struct l2_packet_data *l2, int sock)
+{
+	struct mmsghdr msgs[L2_PACKET_RX_BATCH];
+	struct iovec iov[L2_PACKET_RX_BATCH];
+	struct sockaddr_ll ll[L2_PACKET_RX_BATCH];
+	int calls, i, res;
+
+	for (calls = 0; calls < L2_PACKET_RX_MAX_CALLS; calls++) {
+		os_memset(msgs, 0, sizeof(msgs));
+		os_memset(ll, 0, sizeof(ll));
+		for (i = 0; i < L2_PACKET_RX_BATCH; i++) {
+			iov[i].iov_base = l2->rx_buf + i * L2_PACKET_RX_BUF_LEN;
+			iov[i].iov_len = L2_PACKET_RX_BUF_LEN;
+			msgs[i].msg_hdr.msg_name = &ll[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(ll[i]);
+			msgs[i].msg_hdr.msg_iov = &iov[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		res = recvmmsg(sock, msgs, L2_PACKET_RX_BATCH, MSG_DONTWAIT,
+			       NULL);
+		if (res < 0) {
+			if (errno == ENOSYS) {
+				wpa_printf(MSG_DEBUG,
+					   "l2_packet_receive: recvmmsg() not supported - use single frame RX");
+				l2->rx_batch_disabled = 1;
+			} else if (calls == 0 ||
+				   (errno != EAGAIN && errno != EWOULDBLOCK)) {
+				wpa_printf(MSG_DEBUG,
+					   "l2_packet_receive - recvmmsg: %s",
+					   strerror(errno));
+			}
+			return;
+		}
+		if (res == 0)
+			return;
+
+		l2_packet_rx_stats(l2, res);
+		wpa_printf(MSG_EXCESSIVE,
+			   "l2_packet_receive: %d frame(s) in batch", res);
+
+		l2->in_rx = 1;
+		for (i = 0; i < res; i++) {
+			l2_packet_rx_frame(l2, ll[i].sll_addr, iov[i].iov_base,
+					   msgs[i].msg_len);
+			if (l2->deinit_pending) {
+				l2_packet_free(l2);
+				return;
+			}
+		}
+		l2->in_rx = 0;
+
+		if (res < L2_PACKET_RX_BATCH)
+			break;
+	}
+}
+
+
+static void l2_packet_receive(int sock, void *eloop_ctx, void *sock_ctx)
+{
+	struct l2_packet_data *l2 = eloop_ctx;
+	u8 buf[L2_PACKET_RX_BUF_LEN];
+	int res;
+	struct sockaddr_ll ll;
+	socklen_t fromlen;
+
+	/*
+	 * Duplicate detection with the bridge workaround socket depends on
+	 * frames from the two sockets being processed in the order they were
+	 * received, so do not use batches while that socket is open.
+	 */
+	if (!l2->rx_batch_disabled
+#ifndef CONFIG_NO_LINUX_PACKET_SOCKET_WAR
+	    && l2->fd_br_rx < 0
+#endif /* CONFIG_NO_LINUX_PACKET_SOCKET_WAR */
+		) {
+		/* Fall back to single frame RX if this allocation fails */
+		if (!l2->rx_buf)
+			l2->rx_buf = os_malloc(L2_PACKET_RX_BATCH *
+					       L2_PACKET_RX_BUF_LEN);
+		if (l2->rx_buf) {
+			l2_packet_receive_batch(l2, sock);
+			return;
+		}
+	}
+
+	os_memset(&ll, 0, sizeof(ll));
+	fromlen = sizeof(ll);
+	res = recvfrom(sock, buf, sizeof(buf), 0, (struct sockaddr *) &ll,
+		       &fromlen);
+	if (res < 0) {
+		wpa_printf(MSG_DEBUG, "l2_packet_receive - recvfrom: %s",
+			   strerror(errno));
+		return;
+	}
+
+	l2_packet_rx_stats(l2, 1);
+	l2_packet_rx_frame(l2, ll.sll_addr, buf, res);
 }
 
 
@@ -219,7 +414,7 @@ static void l2_packet_receive(int sock, void *eloop_ctx, void *sock_ctx)
 static void l2_packet_receive_br(int sock, void *eloop_ctx, void *sock_ctx)
 {
 	struct l2_packet_data *l2 = eloop_ctx;
-	u8 buf[2300];
+	u8 buf[L2_PACKET_RX_BUF_LEN];
 	int res;
 	struct sockaddr_ll ll;
 	socklen_t fromlen;
@@ -430,16 +625,24 @@ void l2_packet_deinit(struct l2_packet_data *l2)
 	if (l2->fd >= 0) {
 		eloop_unregister_read_sock(l2->fd);
 		close(l2->fd);
+		l2->fd = -1;
 	}
 
 #ifndef CONFIG_NO_LINUX_PACKET_SOCKET_WAR
 	if (l2->fd_br_rx >= 0) {
 		eloop_unregister_read_sock(l2->fd_br_rx);
 		close(l2->fd_br_rx);
+		l2->fd_br_rx = -1;
 	}
 #endif /* CONFIG_NO_LINUX_PACKET_SOCKET_WAR */
 
-	os_free(l2);
+	if (l2->in_rx) {
+		/* Freed once the rest of the batch has been skipped */
+		l2->deinit_pending = 1;
+		return;
+	}
+
+	l2_packet_free(l2);
 }
 
 
@@ -154,6 +154,20 @@ int l2_packet_send(struct l2_packet_data *l2, const u8 *dst_addr, u16 proto,
 }
 
 
+int l2_packet_send_multi(struct l2_packet_data *l2, const u8 *dst_addrs,
+			 size_t num_dst, const u8 *buf, size_t len)
+{
+	return -1;
+}
+
+
+int l2_packet_get_mib(struct l2_packet_data *l2, const char *prefix,
+		      char *buf, size_t buflen)
+{
+	return 0;
+}
+
+
 static void l2_packet_callback(struct l2_packet_data *l2);
 
 #ifdef _WIN32_WCE
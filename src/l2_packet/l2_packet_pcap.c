@@ -114,6 +114,20 @@ int l2_packet_send(struct l2_packet_data *l2, const u8 *dst_addr, u16 proto,
 }
 
 
+int l2_packet_send_multi(struct l2_packet_data *l2, const u8 *dst_addrs,
+			 size_t num_dst, const u8 *buf, size_t len)
+{
+	return -1;
+}
+
+
+int l2_packet_get_mib(struct l2_packet_data *l2, const char *prefix,
+		      char *buf, size_t buflen)
+{
+	return 0;
+}
+
+
 #ifndef CONFIG_WINPCAP
 static void l2_packet_receive(int sock, void *eloop_ctx, void *sock_ctx)
 {
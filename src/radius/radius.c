@@ -10,6 +10,7 @@
 
 #include "utils/common.h"
 #include "utils/wpabuf.h"
+#include "utils/obj_pool.h"
 #include "crypto/md5.h"
 #include "crypto/crypto.h"
 #include "radius.h"
@@ -48,6 +49,9 @@ struct radius_msg {
 	size_t attr_used;
 };
 
+static struct obj_pool radius_msg_pool =
+	OBJ_POOL_INIT("radius_msg", sizeof(struct radius_msg), 0);
+
 
 struct radius_hdr * radius_msg_get_hdr(struct radius_msg *msg)
 {
@@ -103,7 +107,7 @@ struct radius_msg * radius_msg_new(u8 code, u8 identifier)
 {
 	struct radius_msg *msg;
 
-	msg = os_zalloc(sizeof(*msg));
+	msg = obj_pool_zalloc(&radius_msg_pool);
 	if (msg == NULL)
 		return NULL;
 
@@ -131,7 +135,7 @@ void radius_msg_free(struct radius_msg *msg)
 
 	wpabuf_free(msg->buf);
 	os_free(msg->attr_pos);
-	os_free(msg);
+	obj_pool_free(&radius_msg_pool, msg);
 }
 
 
@@ -454,8 +458,54 @@ int radius_msg_finish(struct radius_msg *msg, const u8 *secret,
 }
 
 
+static int radius_hmac_md5(const u8 *secret, size_t secret_len,
+			   struct crypto_hmac_key *hmac_key,
+			   const u8 *data, size_t data_len, u8 *mac)
+{
+	if (hmac_key)
+		return crypto_hmac_key_vector(hmac_key, 1, &data, &data_len,
+					      mac);
+	return hmac_md5(secret, secret_len, data, data_len, mac);
+}
+
+
+/**
+ * radius_hmac_key_init - Precompute Message-Authenticator key for a secret
+ * @secret: RADIUS shared secret
+ * @secret_len: Length of the shared secret in octets
+ * Returns: HMAC-MD5 key context or %NULL if not supported by the crypto library
+ *
+ * The returned key can be used with radius_msg_finish_srv_key() and
+ * radius_msg_verify_msg_auth_key() to avoid processing the padded shared
+ * secret for each message. The callers fall back to using the shared secret
+ * directly when %NULL is returned.
+ */
+struct crypto_hmac_key * radius_hmac_key_init(const u8 *secret,
+					      size_t secret_len)
+{
+	return crypto_hmac_key_init(CRYPTO_HASH_ALG_HMAC_MD5, secret,
+				    secret_len);
+}
+
+
+void radius_hmac_key_deinit(struct crypto_hmac_key *hmac_key)
+{
+	crypto_hmac_key_deinit(hmac_key);
+}
+
+
 int radius_msg_finish_srv(struct radius_msg *msg, const u8 *secret,
 			  size_t secret_len, const u8 *req_authenticator)
+{
+	return radius_msg_finish_srv_key(msg, secret, secret_len, NULL,
+					 req_authenticator);
+}
+
+
+int radius_msg_finish_srv_key(struct radius_msg *msg, const u8 *secret,
+			      size_t secret_len,
+			      struct crypto_hmac_key *hmac_key,
+			      const u8 *req_authenticator)
 {
 	u8 auth[MD5_MAC_LEN];
 	struct radius_attr_hdr *attr;
@@ -472,8 +522,8 @@ int radius_msg_finish_srv(struct radius_msg *msg, const u8 *secret,
 	msg->hdr->length = host_to_be16(wpabuf_len(msg->buf));
 	os_memcpy(msg->hdr->authenticator, req_authenticator,
 		  sizeof(msg->hdr->authenticator));
-	hmac_md5(secret, secret_len, wpabuf_head(msg->buf),
-		 wpabuf_len(msg->buf), (u8 *) (attr + 1));
+	radius_hmac_md5(secret, secret_len, hmac_key, wpabuf_head(msg->buf),
+			wpabuf_len(msg->buf), (u8 *) (attr + 1));
 
 	/* ResponseAuth = MD5(Code+ID+Length+RequestAuth+Attributes+Secret) */
 	addr[0] = (u8 *) msg->hdr;
@@ -818,7 +868,7 @@ struct radius_msg * radius_msg_parse(const u8 *data, size_t len)
 			   "RADIUS message", (unsigned long) len - msg_len);
 	}
 
-	msg = os_zalloc(sizeof(*msg));
+	msg = obj_pool_zalloc(&radius_msg_pool);
 	if (msg == NULL)
 		return NULL;
 
@@ -920,6 +970,16 @@ struct wpabuf * radius_msg_get_eap(struct radius_msg *msg)
 
 int radius_msg_verify_msg_auth(struct radius_msg *msg, const u8 *secret,
 			       size_t secret_len, const u8 *req_auth)
+{
+	return radius_msg_verify_msg_auth_key(msg, secret, secret_len, NULL,
+					      req_auth);
+}
+
+
+int radius_msg_verify_msg_auth_key(struct radius_msg *msg, const u8 *secret,
+				   size_t secret_len,
+				   struct crypto_hmac_key *hmac_key,
+				   const u8 *req_auth)
 {
 	u8 auth[MD5_MAC_LEN], orig[MD5_MAC_LEN];
 	u8 orig_authenticator[16];
@@ -950,8 +1010,9 @@ int radius_msg_verify_msg_auth(struct radius_msg *msg, const u8 *secret,
 		os_memcpy(msg->hdr->authenticator, req_auth,
 			  sizeof(msg->hdr->authenticator));
 	}
-	if (hmac_md5(secret, secret_len, wpabuf_head(msg->buf),
-		     wpabuf_len(msg->buf), auth) < 0)
+	if (radius_hmac_md5(secret, secret_len, hmac_key,
+			    wpabuf_head(msg->buf), wpabuf_len(msg->buf),
+			    auth) < 0)
 		return 1;
 	os_memcpy(attr + 1, orig, MD5_MAC_LEN);
 	if (req_auth) {
@@ -246,6 +246,7 @@ struct radius_ms_mppe_keys {
 
 
 struct radius_msg;
+struct crypto_hmac_key;
 
 /* Default size to be allocated for new RADIUS messages */
 #define RADIUS_DEFAULT_MSG_SIZE 1024
@@ -272,6 +273,10 @@ int radius_msg_finish(struct radius_msg *msg, const u8 *secret,
 		      size_t secret_len);
 int radius_msg_finish_srv(struct radius_msg *msg, const u8 *secret,
 			  size_t secret_len, const u8 *req_authenticator);
+int radius_msg_finish_srv_key(struct radius_msg *msg, const u8 *secret,
+			      size_t secret_len,
+			      struct crypto_hmac_key *hmac_key,
+			      const u8 *req_authenticator);
 int radius_msg_finish_das_resp(struct radius_msg *msg, const u8 *secret,
 			       size_t secret_len,
 			       const struct radius_hdr *req_hdr);
@@ -296,6 +301,13 @@ int radius_msg_verify(struct radius_msg *msg, const u8 *secret,
 		      int auth);
 int radius_msg_verify_msg_auth(struct radius_msg *msg, const u8 *secret,
 			       size_t secret_len, const u8 *req_auth);
+int radius_msg_verify_msg_auth_key(struct radius_msg *msg, const u8 *secret,
+				   size_t secret_len,
+				   struct crypto_hmac_key *hmac_key,
+				   const u8 *req_auth);
+struct crypto_hmac_key * radius_hmac_key_init(const u8 *secret,
+					      size_t secret_len);
+void radius_hmac_key_deinit(struct crypto_hmac_key *hmac_key);
 int radius_msg_copy_attr(struct radius_msg *dst, struct radius_msg *src,
 			 u8 type);
 int radius_msg_make_authenticator(struct radius_msg *msg);
@@ -108,6 +108,7 @@ struct radius_client {
 #endif /* CONFIG_IPV6 */
 	char *shared_secret;
 	int shared_secret_len;
+	struct crypto_hmac_key *hmac_key;
 	struct radius_session *sessions;
 	struct radius_server_counters counters;
 
@@ -1139,9 +1140,10 @@ radius_server_encapsulate_eap(struct radius_server_data *data,
 		}
 	}
 
-	if (radius_msg_finish_srv(msg, (u8 *) client->shared_secret,
-				  client->shared_secret_len,
-				  hdr->authenticator) < 0) {
+	if (radius_msg_finish_srv_key(msg, (u8 *) client->shared_secret,
+				      client->shared_secret_len,
+				      client->hmac_key,
+				      hdr->authenticator) < 0) {
 		RADIUS_DEBUG("Failed to add Message-Authenticator attribute");
 	}
 
@@ -1223,9 +1225,10 @@ radius_server_macacl(struct radius_server_data *data,
 		}
 	}
 
-	if (radius_msg_finish_srv(msg, (u8 *) client->shared_secret,
-				  client->shared_secret_len,
-				  hdr->authenticator) < 0) {
+	if (radius_msg_finish_srv_key(msg, (u8 *) client->shared_secret,
+				      client->shared_secret_len,
+				      client->hmac_key,
+				      hdr->authenticator) < 0) {
 		RADIUS_DEBUG("Failed to add Message-Authenticator attribute");
 	}
 
@@ -1268,10 +1271,10 @@ static int radius_server_reject(struct radius_server_data *data,
 		return -1;
 	}
 
-	if (radius_msg_finish_srv(msg, (u8 *) client->shared_secret,
-				  client->shared_secret_len,
-				  hdr->authenticator) <
-	    0) {
+	if (radius_msg_finish_srv_key(msg, (u8 *) client->shared_secret,
+				      client->shared_secret_len,
+				      client->hmac_key,
+				      hdr->authenticator) < 0) {
 		RADIUS_DEBUG("Failed to add Message-Authenticator attribute");
 	}
 
@@ -1761,8 +1764,9 @@ static void radius_server_receive_auth(int sock, void *eloop_ctx,
 	data->counters.access_requests++;
 	client->counters.access_requests++;
 
-	if (radius_msg_verify_msg_auth(msg, (u8 *) client->shared_secret,
-				       client->shared_secret_len, NULL)) {
+	if (radius_msg_verify_msg_auth_key(msg, (u8 *) client->shared_secret,
+					   client->shared_secret_len,
+					   client->hmac_key, NULL)) {
 		RADIUS_DEBUG("Invalid Message-Authenticator from %s", abuf);
 		data->counters.bad_authenticators++;
 		client->counters.bad_authenticators++;
@@ -2010,6 +2014,7 @@ static void radius_server_free_clients(struct radius_server_data *data,
 
 		radius_server_free_sessions(data, prev->sessions);
 		os_free(prev->shared_secret);
+		radius_hmac_key_deinit(prev->hmac_key);
 		radius_msg_free(prev->pending_dac_coa_req);
 		radius_msg_free(prev->pending_dac_disconnect_req);
 		os_free(prev);
@@ -2129,6 +2134,8 @@ radius_server_read_clients(const char *client_file, int ipv6)
 			break;
 		}
 		entry->shared_secret_len = os_strlen(entry->shared_secret);
+		entry->hmac_key = radius_hmac_key_init(
+			(u8 *) entry->shared_secret, entry->shared_secret_len);
 		if (!ipv6) {
 			entry->addr.s_addr = addr.s_addr;
 			val = 0;
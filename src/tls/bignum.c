@@ -222,3 +222,99 @@ int bignum_exptmod(const struct bignum *a, const struct bignum *b,
 	}
 	return 0;
 }
+
+
+#if defined(CONFIG_INTERNAL_LIBTOMMATH) && defined(BN_MP_EXPTMOD_FAST_C)
+#define BIGNUM_MONT
+#endif /* CONFIG_INTERNAL_LIBTOMMATH && BN_MP_EXPTMOD_FAST_C */
+
+struct bignum_mont {
+#ifdef BIGNUM_MONT
+	mp_mont mont;
+#else /* BIGNUM_MONT */
+	mp_int m;
+#endif /* BIGNUM_MONT */
+};
+
+
+/**
+ * bignum_mont_init - Prepare a modulus for repeated exponentiations
+ * @m: Bignum from bignum_init(); odd modulus
+ * Returns: Pointer to the allocated context or %NULL on failure
+ *
+ * The context is independent of m after this call. It is used with
+ * bignum_exptmod_mont() for a fixed modulus, e.g., the primes of an RSA
+ * private key.
+ */
+struct bignum_mont * bignum_mont_init(const struct bignum *m)
+{
+	struct bignum_mont *ctx;
+
+	ctx = os_zalloc(sizeof(*ctx));
+	if (!ctx)
+		return NULL;
+#ifdef BIGNUM_MONT
+	if (mp_mont_init(&ctx->mont, (mp_int *) m) != MP_OKAY) {
+		os_free(ctx);
+		return NULL;
+	}
+#else /* BIGNUM_MONT */
+	if (mp_init(&ctx->m) != MP_OKAY) {
+		os_free(ctx);
+		return NULL;
+	}
+	if (mp_copy((mp_int *) m, &ctx->m) != MP_OKAY) {
+		mp_clear(&ctx->m);
+		os_free(ctx);
+		return NULL;
+	}
+#endif /* BIGNUM_MONT */
+	return ctx;
+}
+
+
+/**
+ * bignum_mont_deinit - Free a context from bignum_mont_init()
+ * @ctx: Context from bignum_mont_init() or %NULL
+ */
+void bignum_mont_deinit(struct bignum_mont *ctx)
+{
+	if (!ctx)
+		return;
+#ifdef BIGNUM_MONT
+	mp_mont_clear(&ctx->mont);
+#else /* BIGNUM_MONT */
+	mp_clear(&ctx->m);
+#endif /* BIGNUM_MONT */
+	os_free(ctx);
+}
+
+
+/**
+ * bignum_exptmod_mont - Modular exponentiation with a secret exponent
+ * @a: Bignum from bignum_init(); base
+ * @b: Bignum from bignum_init(); exponent
+ * @ctx: Context from bignum_mont_init() for the modulus
+ * @d: Bignum from bignum_init(); used to store the result of a^b (mod m)
+ * Returns: 0 on success, -1 on failure
+ *
+ * With the internal LibTomMath in the LTM_FAST build, this uses a fixed
+ * window and reads all precomputed table entries for each window, so the
+ * sequence of operations does not depend on the value of the exponent.
+ * Otherwise, this is equivalent to bignum_exptmod().
+ */
+int bignum_exptmod_mont(const struct bignum *a, const struct bignum *b,
+			struct bignum_mont *ctx, struct bignum *d)
+{
+#ifdef BIGNUM_MONT
+	if (mp_exptmod_mont((mp_int *) a, (mp_int *) b, &ctx->mont,
+			    (mp_int *) d) != MP_OKAY) {
+#else /* BIGNUM_MONT */
+	if (mp_exptmod((mp_int *) a, (mp_int *) b, &ctx->m, (mp_int *) d)
+	    != MP_OKAY) {
+#endif /* BIGNUM_MONT */
+		wpa_printf(MSG_DEBUG, "BIGNUM: %s failed", __func__);
+		return -1;
+	}
+	return 0;
+}
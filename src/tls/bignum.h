@@ -10,6 +10,7 @@
 #define BIGNUM_H
 
 struct bignum;
+struct bignum_mont;
 
 struct bignum * bignum_init(void);
 void bignum_deinit(struct bignum *n);
@@ -28,5 +29,9 @@ int bignum_mulmod(const struct bignum *a, const struct bignum *b,
 		  const struct bignum *c, struct bignum *d);
 int bignum_exptmod(const struct bignum *a, const struct bignum *b,
 		   const struct bignum *c, struct bignum *d);
+struct bignum_mont * bignum_mont_init(const struct bignum *m);
+void bignum_mont_deinit(struct bignum_mont *ctx);
+int bignum_exptmod_mont(const struct bignum *a, const struct bignum *b,
+			struct bignum_mont *ctx, struct bignum *d);
 
 #endif /* BIGNUM_H */
@@ -3244,6 +3244,219 @@ LBL_M:
 #endif
 
 
+#ifdef BN_MP_EXPTMOD_FAST_C
+/* Montgomery context for repeated exponentiations with the same odd modulus.
+ * This avoids redoing the setup and replaces the division used for the
+ * conversion into the Montgomery domain with a multiplication by R^2.
+ */
+typedef struct {
+  mp_int   P;    /* modulus */
+  mp_int   RR;   /* R^2 mod P */
+  mp_int   one;  /* R mod P, i.e., 1 in the Montgomery domain */
+  mp_digit rho;
+} mp_mont;
+
+#define MP_MONT_WINSIZE 5
+
+static void mp_mont_clear (mp_mont * ctx)
+{
+  mp_clear (&ctx->P);
+  mp_clear (&ctx->RR);
+  mp_clear (&ctx->one);
+}
+
+
+static int mp_mont_init (mp_mont * ctx, mp_int * P)
+{
+  int err;
+
+  /* only the comba reduction is available in the LTM_FAST build */
+  if (mp_isodd (P) == MP_NO || P->sign == MP_NEG ||
+      (P->used * 2 + 1) >= MP_WARRAY ||
+      P->used >= (1 << ((CHAR_BIT * sizeof (mp_word)) - (2 * DIGIT_BIT)))) {
+    return MP_VAL;
+  }
+
+  if ((err = mp_init (&ctx->P)) != MP_OKAY) {
+    return err;
+  }
+  if ((err = mp_init (&ctx->RR)) != MP_OKAY) {
+    mp_clear (&ctx->P);
+    return err;
+  }
+  if ((err = mp_init (&ctx->one)) != MP_OKAY) {
+    mp_clear (&ctx->P);
+    mp_clear (&ctx->RR);
+    return err;
+  }
+
+  if ((err = mp_copy (P, &ctx->P)) != MP_OKAY ||
+      (err = mp_montgomery_setup (P, &ctx->rho)) != MP_OKAY ||
+      (err = mp_montgomery_calc_normalization (&ctx->one, P)) != MP_OKAY ||
+      (err = mp_sqr (&ctx->one, &ctx->RR)) != MP_OKAY ||
+      (err = mp_mod (&ctx->RR, P, &ctx->RR)) != MP_OKAY) {
+    mp_mont_clear (ctx);
+    return err;
+  }
+
+  return MP_OKAY;
+}
+
+
+/* pad a to exactly digs digits with the excess digits cleared */
+static int mp_mont_pad (mp_int * a, int digs)
+{
+  int err, i;
+
+  if ((err = mp_grow (a, digs)) != MP_OKAY) {
+    return err;
+  }
+  for (i = a->used; i < a->alloc; i++) {
+    a->dp[i] = 0;
+  }
+  return MP_OKAY;
+}
+
+
+/* r = tab[idx] without a memory access pattern that depends on idx */
+static void mp_mont_select (mp_int * r, mp_int * tab, int num, int idx,
+                            int digs)
+{
+  mp_digit mask;
+  unsigned int d;
+  int i, j;
+
+  for (j = 0; j < digs; j++) {
+    r->dp[j] = 0;
+  }
+  for (i = 0; i < num; i++) {
+    d    = (unsigned int) (i ^ idx);
+    mask = (mp_digit) 0 - (mp_digit) ((d - 1U) >> (sizeof (d) * CHAR_BIT - 1));
+    for (j = 0; j < digs; j++) {
+      r->dp[j] |= tab[i].dp[j] & mask;
+    }
+  }
+  r->used = digs;
+  r->sign = MP_ZPOS;
+  mp_clamp (r);
+}
+
+
+/* get n bits of a starting from bit position pos */
+static int mp_mont_get_bits (mp_int * a, int pos, int n)
+{
+  int b, ret = 0;
+
+  for (b = pos + n - 1; b >= pos; b--) {
+    ret <<= 1;
+    if (b / DIGIT_BIT < a->used) {
+      ret |= (int) ((a->dp[b / DIGIT_BIT] >> (b % DIGIT_BIT)) & 1);
+    }
+  }
+  return ret;
+}
+
+
+/* computes Y == G**X mod P with a fixed window
+ *
+ * Unlike mp_exptmod_fast(), the sequence of squarings and multiplications
+ * depends only on the number of digits in X and every table entry is read
+ * for each window, so this is suitable for secret exponents.
+ */
+static int mp_exptmod_mont (mp_int * G, mp_int * X, mp_mont * ctx, mp_int * Y)
+{
+  mp_int  M[1 << MP_MONT_WINSIZE], res, tmp;
+  int     err, x, y, bitpos, digs;
+
+  digs = ctx->P.used;
+
+  for (x = 0; x < (1 << MP_MONT_WINSIZE); x++) {
+    if ((err = mp_init_size (&M[x], digs)) != MP_OKAY) {
+      for (y = 0; y < x; y++) {
+        mp_clear (&M[y]);
+      }
+      return err;
+    }
+  }
+  if ((err = mp_init_size (&res, digs)) != MP_OKAY) {
+    goto LBL_M;
+  }
+  if ((err = mp_init_size (&tmp, digs)) != MP_OKAY) {
+    goto LBL_RES;
+  }
+
+  /* M[0] = R mod P, M[1] = G * R mod P */
+  if ((err = mp_copy (&ctx->one, &M[0])) != MP_OKAY) {
+    goto LBL_TMP;
+  }
+  if (G->sign == MP_NEG || mp_cmp_mag (G, &ctx->P) != MP_LT) {
+    if ((err = mp_mod (G, &ctx->P, &tmp)) != MP_OKAY) {
+      goto LBL_TMP;
+    }
+    err = mp_mul (&tmp, &ctx->RR, &M[1]);
+  } else {
+    err = mp_mul (G, &ctx->RR, &M[1]);
+  }
+  if (err != MP_OKAY ||
+      (err = fast_mp_montgomery_reduce (&M[1], &ctx->P, ctx->rho)) != MP_OKAY) {
+    goto LBL_TMP;
+  }
+
+  for (x = 2; x < (1 << MP_MONT_WINSIZE); x++) {
+    if ((err = mp_mul (&M[x - 1], &M[1], &M[x])) != MP_OKAY ||
+        (err = fast_mp_montgomery_reduce (&M[x], &ctx->P, ctx->rho)) != MP_OKAY) {
+      goto LBL_TMP;
+    }
+  }
+
+  for (x = 0; x < (1 << MP_MONT_WINSIZE); x++) {
+    if ((err = mp_mont_pad (&M[x], digs)) != MP_OKAY) {
+      goto LBL_TMP;
+    }
+  }
+  if ((err = mp_mont_pad (&tmp, digs)) != MP_OKAY ||
+      (err = mp_copy (&ctx->one, &res)) != MP_OKAY) {
+    goto LBL_TMP;
+  }
+
+  /* the exponent is processed as if it had all bits of its used digits */
+  bitpos = X->used * DIGIT_BIT;
+  bitpos = ((bitpos + MP_MONT_WINSIZE - 1) / MP_MONT_WINSIZE) * MP_MONT_WINSIZE;
+  for (bitpos -= MP_MONT_WINSIZE; bitpos >= 0; bitpos -= MP_MONT_WINSIZE) {
+    for (x = 0; x < MP_MONT_WINSIZE; x++) {
+      if ((err = mp_sqr (&res, &res)) != MP_OKAY ||
+          (err = fast_mp_montgomery_reduce (&res, &ctx->P, ctx->rho)) != MP_OKAY) {
+        goto LBL_TMP;
+      }
+    }
+
+    mp_mont_select (&tmp, M, 1 << MP_MONT_WINSIZE,
+                    mp_mont_get_bits (X, bitpos, MP_MONT_WINSIZE), digs);
+    if ((err = mp_mul (&res, &tmp, &res)) != MP_OKAY ||
+        (err = fast_mp_montgomery_reduce (&res, &ctx->P, ctx->rho)) != MP_OKAY) {
+      goto LBL_TMP;
+    }
+  }
+
+  /* leave the Montgomery domain */
+  if ((err = fast_mp_montgomery_reduce (&res, &ctx->P, ctx->rho)) != MP_OKAY) {
+    goto LBL_TMP;
+  }
+
+  mp_exch (&res, Y);
+  err = MP_OKAY;
+
+LBL_TMP:mp_clear (&tmp);
+LBL_RES:mp_clear (&res);
+LBL_M:
+  for (x = 0; x < (1 << MP_MONT_WINSIZE); x++) {
+    mp_clear (&M[x]);
+  }
+  return err;
+}
+#endif
+
+
 #ifdef BN_FAST_S_MP_SQR_C
 /* the jist of squaring...
  * you do like mult except the offset of the tmpx [one that
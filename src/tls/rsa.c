@@ -25,6 +25,9 @@ struct crypto_rsa_key {
 	struct bignum *dmp1; /* d mod (p - 1); CRT exponent */
 	struct bignum *dmq1; /* d mod (q - 1); CRT exponent */
 	struct bignum *iqmp; /* 1 / q mod p; CRT coefficient */
+	/* Montgomery contexts for p and q; NULL if not available */
+	struct bignum_mont *mont_p;
+	struct bignum_mont *mont_q;
 };
 
 
@@ -224,6 +227,11 @@ crypto_rsa_import_private_key(const u8 *buf, size_t len)
 		goto error;
 	}
 
+	/* Prepare the CRT moduli once since they are used for every private
+	 * key operation; failure here only disables the optimization. */
+	key->mont_p = bignum_mont_init(key->p);
+	key->mont_q = bignum_mont_init(key->q);
+
 	return key;
 
 error:
@@ -294,11 +302,15 @@ int crypto_rsa_exptmod(const u8 *in, size_t inlen, u8 *out, size_t *outlen,
 			goto error;
 
 		/* a = tmp^dmp1 mod p */
-		if (bignum_exptmod(tmp, key->dmp1, key->p, a) < 0)
+		if ((key->mont_p ?
+		     bignum_exptmod_mont(tmp, key->dmp1, key->mont_p, a) :
+		     bignum_exptmod(tmp, key->dmp1, key->p, a)) < 0)
 			goto error;
 
 		/* b = tmp^dmq1 mod q */
-		if (bignum_exptmod(tmp, key->dmq1, key->q, b) < 0)
+		if ((key->mont_q ?
+		     bignum_exptmod_mont(tmp, key->dmq1, key->mont_q, b) :
+		     bignum_exptmod(tmp, key->dmq1, key->q, b)) < 0)
 			goto error;
 
 		/* tmp = (a - b) * (1/q mod p) (mod p) */
@@ -361,6 +373,8 @@ void crypto_rsa_free(struct crypto_rsa_key *key)
 		bignum_deinit(key->dmp1);
 		bignum_deinit(key->dmq1);
 		bignum_deinit(key->iqmp);
+		bignum_mont_deinit(key->mont_p);
+		bignum_mont_deinit(key->mont_q);
 		os_free(key);
 	}
 }
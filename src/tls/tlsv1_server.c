@@ -9,6 +9,7 @@
 #include "includes.h"
 
 #include "common.h"
+#include "utils/list.h"
 #include "crypto/sha1.h"
 #include "crypto/tls.h"
 #include "tlsv1_common.h"
@@ -20,6 +21,32 @@
  * Support for a message fragmented across several records (RFC 2246, 6.2.1)
  */
 
+/* Maximum number of cached sessions; least recently used entry is dropped */
+#define TLSV1_SERVER_SESSION_CACHE_SIZE 1000
+#define TLSV1_SERVER_SESSION_HASH_SIZE 256
+/* Session IDs are generated randomly, so the first octet is a good hash */
+#define TLSV1_SERVER_SESSION_HASH(id) ((id)[0])
+
+struct tlsv1_server_session {
+	struct dl_list list; /* LRU order; most recently used first */
+	struct tlsv1_server_session *hnext; /* next entry in hash table list */
+	struct os_reltime added;
+	u8 session_id[TLS_SESSION_ID_MAX_LEN];
+	u8 session_ctx[TLS_SESSION_ID_MAX_LEN];
+	size_t session_ctx_len;
+	u8 master_secret[TLS_MASTER_SECRET_LEN];
+	u16 tls_version;
+	u16 cipher_suite;
+	struct wpabuf *success_data;
+};
+
+struct tlsv1_server_session_cache {
+	struct dl_list sessions;
+	struct tlsv1_server_session *hash[TLSV1_SERVER_SESSION_HASH_SIZE];
+	unsigned int num_sessions;
+	unsigned int lifetime;
+};
+
 
 void tlsv1_server_log(struct tlsv1_server *conn, const char *fmt, ...)
 {
@@ -429,6 +456,7 @@ static void tlsv1_server_clear_data(struct tlsv1_server *conn)
 	conn->session_ticket = NULL;
 	conn->session_ticket_len = 0;
 	conn->use_session_ticket = 0;
+	conn->session_resumed = 0;
 
 	os_free(conn->dh_secret);
 	conn->dh_secret = NULL;
@@ -632,7 +660,7 @@ int tlsv1_server_shutdown(struct tlsv1_server *conn)
  */
 int tlsv1_server_resumed(struct tlsv1_server *conn)
 {
-	return 0;
+	return conn->session_resumed;
 }
 
 
@@ -716,6 +744,271 @@ int tlsv1_server_set_verify(struct tlsv1_server *conn, int verify_peer)
 }
 
 
+/**
+ * tlsv1_server_set_session_ctx - Set session context for session resumption
+ * @conn: TLSv1 server connection data from tlsv1_server_init()
+ * @session_ctx: Session context (e.g., application and EAP method identifier)
+ * @session_ctx_len: Length of session_ctx in octets
+ * Returns: 0 on success, -1 on failure
+ *
+ * Cached sessions are resumed only by connections using the same session
+ * context.
+ */
+int tlsv1_server_set_session_ctx(struct tlsv1_server *conn,
+				 const u8 *session_ctx, size_t session_ctx_len)
+{
+	if (session_ctx_len > sizeof(conn->session_ctx))
+		return -1;
+	if (session_ctx_len)
+		os_memcpy(conn->session_ctx, session_ctx, session_ctx_len);
+	conn->session_ctx_len = session_ctx_len;
+	return 0;
+}
+
+
+/**
+ * tlsv1_server_session_cache_init - Initialize TLS session cache
+ * @lifetime: Session lifetime in seconds
+ * Returns: Pointer to the session cache or %NULL on failure
+ *
+ * The session cache can be shared by all server connections that use the
+ * same credentials. It maps session IDs to the master secret of sessions
+ * that were completed successfully to allow abbreviated handshakes.
+ */
+struct tlsv1_server_session_cache *
+tlsv1_server_session_cache_init(unsigned int lifetime)
+{
+	struct tlsv1_server_session_cache *cache;
+
+	cache = os_zalloc(sizeof(*cache));
+	if (!cache)
+		return NULL;
+	dl_list_init(&cache->sessions);
+	cache->lifetime = lifetime;
+	return cache;
+}
+
+
+static struct tlsv1_server_session *
+tlsv1_server_session_get(struct tlsv1_server_session_cache *cache,
+			 const u8 *session_id, size_t session_id_len)
+{
+	struct tlsv1_server_session *sess;
+
+	if (!cache || session_id_len != TLS_SESSION_ID_MAX_LEN)
+		return NULL;
+
+	sess = cache->hash[TLSV1_SERVER_SESSION_HASH(session_id)];
+	while (sess && os_memcmp(sess->session_id, session_id,
+				 TLS_SESSION_ID_MAX_LEN) != 0)
+		sess = sess->hnext;
+	return sess;
+}
+
+
+static void tlsv1_server_session_free(struct tlsv1_server_session_cache *cache,
+				      struct tlsv1_server_session *sess)
+{
+	struct tlsv1_server_session **prev;
+
+	prev = &cache->hash[TLSV1_SERVER_SESSION_HASH(sess->session_id)];
+	while (*prev && *prev != sess)
+		prev = &(*prev)->hnext;
+	if (*prev)
+		*prev = sess->hnext;
+
+	dl_list_del(&sess->list);
+	cache->num_sessions--;
+	wpabuf_free(sess->success_data);
+	bin_clear_free(sess, sizeof(*sess));
+}
+
+
+/**
+ * tlsv1_server_session_cache_deinit - Deinitialize TLS session cache
+ * @cache: Session cache from tlsv1_server_session_cache_init()
+ */
+void tlsv1_server_session_cache_deinit(struct tlsv1_server_session_cache *cache)
+{
+	struct tlsv1_server_session *sess, *tmp;
+
+	if (!cache)
+		return;
+	dl_list_for_each_safe(sess, tmp, &cache->sessions,
+			      struct tlsv1_server_session, list)
+		tlsv1_server_session_free(cache, sess);
+	os_free(cache);
+}
+
+
+/**
+ * tlsv1_server_set_session_cache - Enable session resumption for a connection
+ * @conn: TLSv1 server connection data from tlsv1_server_init()
+ * @cache: Session cache from tlsv1_server_session_cache_init() or %NULL to
+ * disable session resumption
+ */
+void tlsv1_server_set_session_cache(struct tlsv1_server *conn,
+				    struct tlsv1_server_session_cache *cache)
+{
+	conn->session_cache = cache;
+}
+
+
+int tlsv1_server_session_resume(struct tlsv1_server *conn,
+				const u8 *session_id, size_t session_id_len,
+				const u8 *suites, size_t num_suites,
+				u16 *cipher_suite)
+{
+	struct tlsv1_server_session_cache *cache = conn->session_cache;
+	struct tlsv1_server_session *sess;
+	struct os_reltime now;
+	size_t i;
+
+	sess = tlsv1_server_session_get(cache, session_id, session_id_len);
+	if (!sess)
+		return -1;
+
+	os_get_reltime(&now);
+	if (os_reltime_expired(&now, &sess->added, cache->lifetime)) {
+		tlsv1_server_log(conn, "Cached session has expired");
+		tlsv1_server_session_free(cache, sess);
+		return -1;
+	}
+
+	if (sess->session_ctx_len != conn->session_ctx_len ||
+	    os_memcmp(sess->session_ctx, conn->session_ctx,
+		      conn->session_ctx_len) != 0 ||
+	    sess->tls_version != conn->rl.tls_version) {
+		tlsv1_server_log(conn,
+				 "Cached session does not match the connection parameters");
+		return -1;
+	}
+
+	for (i = 0; i < conn->num_cipher_suites; i++) {
+		if (conn->cipher_suites[i] == sess->cipher_suite)
+			break;
+	}
+	if (i == conn->num_cipher_suites)
+		return -1;
+	for (i = 0; i < num_suites; i++) {
+		if (WPA_GET_BE16(&suites[2 * i]) == sess->cipher_suite)
+			break;
+	}
+	if (i == num_suites) {
+		tlsv1_server_log(conn,
+				 "Client did not offer the cipher suite of the cached session");
+		return -1;
+	}
+
+	tlsv1_server_log(conn, "Resuming cached session");
+	os_memcpy(conn->session_id, sess->session_id, TLS_SESSION_ID_MAX_LEN);
+	conn->session_id_len = TLS_SESSION_ID_MAX_LEN;
+	os_memcpy(conn->master_secret, sess->master_secret,
+		  TLS_MASTER_SECRET_LEN);
+	*cipher_suite = sess->cipher_suite;
+	conn->session_resumed = 1;
+
+	dl_list_del(&sess->list);
+	dl_list_add(&cache->sessions, &sess->list);
+
+	return 0;
+}
+
+
+/**
+ * tlsv1_server_set_success_data - Store application data for the session
+ * @conn: TLSv1 server connection data from tlsv1_server_init()
+ * @data: Application data; this is freed by the TLSv1 server
+ *
+ * This is used to mark the established session as successfully authenticated
+ * and to make it available for resumption. The data is stored in the session
+ * cache and can be fetched with tlsv1_server_get_success_data() when the
+ * session is resumed.
+ */
+void tlsv1_server_set_success_data(struct tlsv1_server *conn,
+				   struct wpabuf *data)
+{
+	struct tlsv1_server_session_cache *cache = conn->session_cache;
+	struct tlsv1_server_session *sess;
+
+	if (!cache || conn->state != ESTABLISHED ||
+	    conn->session_id_len != TLS_SESSION_ID_MAX_LEN) {
+		wpabuf_free(data);
+		return;
+	}
+
+	sess = tlsv1_server_session_get(cache, conn->session_id,
+					conn->session_id_len);
+	if (sess) {
+		wpabuf_free(sess->success_data);
+		sess->success_data = data;
+		return;
+	}
+
+	if (cache->num_sessions >= TLSV1_SERVER_SESSION_CACHE_SIZE)
+		tlsv1_server_session_free(
+			cache, dl_list_last(&cache->sessions,
+					    struct tlsv1_server_session, list));
+
+	sess = os_zalloc(sizeof(*sess));
+	if (!sess) {
+		wpabuf_free(data);
+		return;
+	}
+	os_get_reltime(&sess->added);
+	os_memcpy(sess->session_id, conn->session_id, TLS_SESSION_ID_MAX_LEN);
+	os_memcpy(sess->session_ctx, conn->session_ctx, conn->session_ctx_len);
+	sess->session_ctx_len = conn->session_ctx_len;
+	os_memcpy(sess->master_secret, conn->master_secret,
+		  TLS_MASTER_SECRET_LEN);
+	sess->tls_version = conn->rl.tls_version;
+	sess->cipher_suite = conn->cipher_suite;
+	sess->success_data = data;
+
+	sess->hnext = cache->hash[TLSV1_SERVER_SESSION_HASH(sess->session_id)];
+	cache->hash[TLSV1_SERVER_SESSION_HASH(sess->session_id)] = sess;
+	dl_list_add(&cache->sessions, &sess->list);
+	cache->num_sessions++;
+	tlsv1_server_log(conn, "Added session to cache (%u cached sessions)",
+			 cache->num_sessions);
+}
+
+
+/**
+ * tlsv1_server_get_success_data - Get application data for the session
+ * @conn: TLSv1 server connection data from tlsv1_server_init()
+ * Returns: Data stored with tlsv1_server_set_success_data() for the current
+ * session or %NULL if not available
+ */
+const struct wpabuf *
+tlsv1_server_get_success_data(struct tlsv1_server *conn)
+{
+	struct tlsv1_server_session *sess;
+
+	sess = tlsv1_server_session_get(conn->session_cache, conn->session_id,
+					conn->session_id_len);
+	return sess ? sess->success_data : NULL;
+}
+
+
+/**
+ * tlsv1_server_remove_session - Remove the current session from the cache
+ * @conn: TLSv1 server connection data from tlsv1_server_init()
+ */
+void tlsv1_server_remove_session(struct tlsv1_server *conn)
+{
+	struct tlsv1_server_session *sess;
+
+	sess = tlsv1_server_session_get(conn->session_cache, conn->session_id,
+					conn->session_id_len);
+	if (!sess)
+		return;
+	tlsv1_server_log(conn,
+			 "Removed cached session to disable session resumption");
+	tlsv1_server_session_free(conn->session_cache, sess);
+}
+
+
 void tlsv1_server_set_session_ticket_cb(struct tlsv1_server *conn,
 					tlsv1_server_session_ticket_cb cb,
 					void *ctx)
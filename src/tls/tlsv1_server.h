@@ -12,6 +12,7 @@
 #include "tlsv1_cred.h"
 
 struct tlsv1_server;
+struct tlsv1_server_session_cache;
 
 int tlsv1_server_global_init(void);
 void tlsv1_server_global_deinit(void);
@@ -37,6 +38,19 @@ int tlsv1_server_get_random(struct tlsv1_server *conn, struct tls_random *data);
 int tlsv1_server_get_keyblock_size(struct tlsv1_server *conn);
 int tlsv1_server_set_cipher_list(struct tlsv1_server *conn, u8 *ciphers);
 int tlsv1_server_set_verify(struct tlsv1_server *conn, int verify_peer);
+int tlsv1_server_set_session_ctx(struct tlsv1_server *conn,
+				 const u8 *session_ctx, size_t session_ctx_len);
+
+struct tlsv1_server_session_cache *
+tlsv1_server_session_cache_init(unsigned int lifetime);
+void tlsv1_server_session_cache_deinit(struct tlsv1_server_session_cache *cache);
+void tlsv1_server_set_session_cache(struct tlsv1_server *conn,
+				    struct tlsv1_server_session_cache *cache);
+void tlsv1_server_set_success_data(struct tlsv1_server *conn,
+				   struct wpabuf *data);
+const struct wpabuf *
+tlsv1_server_get_success_data(struct tlsv1_server *conn);
+void tlsv1_server_remove_session(struct tlsv1_server *conn);
 
 typedef int (*tlsv1_server_session_ticket_cb)
 (void *ctx, const u8 *ticket, size_t len, const u8 *client_random,
@@ -27,6 +27,10 @@ struct tlsv1_server {
 	u8 server_random[TLS_RANDOM_LEN];
 	u8 master_secret[TLS_MASTER_SECRET_LEN];
 
+	struct tlsv1_server_session_cache *session_cache;
+	u8 session_ctx[TLS_SESSION_ID_MAX_LEN];
+	size_t session_ctx_len;
+
 	u8 alert_level;
 	u8 alert_description;
 
@@ -57,6 +61,7 @@ struct tlsv1_server {
 	void *log_cb_ctx;
 
 	int use_session_ticket;
+	unsigned int session_resumed:1;
 	unsigned int status_request:1;
 	unsigned int status_request_v2:1;
 	unsigned int status_request_multi:1;
@@ -83,6 +88,10 @@ u8 * tlsv1_server_send_alert(struct tlsv1_server *conn, u8 level,
 			     u8 description, size_t *out_len);
 int tlsv1_server_process_handshake(struct tlsv1_server *conn, u8 ct,
 				   const u8 *buf, size_t *len);
+int tlsv1_server_session_resume(struct tlsv1_server *conn,
+				const u8 *session_id, size_t session_id_len,
+				const u8 *suites, size_t num_suites,
+				u16 *cipher_suite);
 void tlsv1_server_get_dh_p(struct tlsv1_server *conn, const u8 **dh_p,
 			   size_t *dh_p_len);
 
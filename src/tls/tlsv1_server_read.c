@@ -121,8 +121,8 @@ static void tls_process_status_request_v2(struct tlsv1_server *conn,
 static int tls_process_client_hello(struct tlsv1_server *conn, u8 ct,
 				    const u8 *in_data, size_t *in_len)
 {
-	const u8 *pos, *end, *c;
-	size_t left, len, i, j;
+	const u8 *pos, *end, *c, *session_id;
+	size_t left, len, i, j, session_id_len;
 	u16 cipher_suite;
 	u16 num_suites;
 	int compr_null_found;
@@ -225,8 +225,9 @@ static int tls_process_client_hello(struct tlsv1_server *conn, u8 ct,
 		goto decode_error;
 	}
 	wpa_hexdump(MSG_MSGDUMP, "TLSv1: client session_id", pos + 1, *pos);
-	pos += 1 + *pos;
-	/* TODO: add support for session resumption */
+	session_id_len = *pos++;
+	session_id = pos;
+	pos += session_id_len;
 
 	/* CipherSuite cipher_suites<2..2^16-1> */
 	if (end - pos < 2) {
@@ -262,6 +263,9 @@ static int tls_process_client_hello(struct tlsv1_server *conn, u8 ct,
 			}
 		}
 	}
+	if (cipher_suite && session_id_len)
+		tlsv1_server_session_resume(conn, session_id, session_id_len,
+					    pos, num_suites, &cipher_suite);
 	pos += num_suites * 2;
 	if (!cipher_suite) {
 		tlsv1_server_log(conn, "No supported cipher suite available");
@@ -1253,8 +1257,11 @@ static int tls_process_client_finished(struct tlsv1_server *conn, u8 ct,
 
 	*in_len = end - in_data;
 
-	if (conn->use_session_ticket) {
-		/* Abbreviated handshake using session ticket; RFC 4507 */
+	if (conn->use_session_ticket || conn->session_resumed) {
+		/*
+		 * Abbreviated handshake using session ticket (RFC 4507) or a
+		 * cached session
+		 */
 		tlsv1_server_log(conn, "Abbreviated handshake completed successfully");
 		conn->state = ESTABLISHED;
 	} else {
@@ -65,11 +65,13 @@ static int tls_write_server_hello(struct tlsv1_server *conn,
 	wpa_hexdump(MSG_MSGDUMP, "TLSv1: server_random",
 		    conn->server_random, TLS_RANDOM_LEN);
 
-	conn->session_id_len = TLS_SESSION_ID_MAX_LEN;
-	if (random_get_bytes(conn->session_id, conn->session_id_len)) {
-		wpa_printf(MSG_ERROR, "TLSv1: Could not generate "
-			   "session_id");
-		return -1;
+	if (!conn->session_resumed) {
+		conn->session_id_len = TLS_SESSION_ID_MAX_LEN;
+		if (random_get_bytes(conn->session_id, conn->session_id_len)) {
+			wpa_printf(MSG_ERROR, "TLSv1: Could not generate "
+				   "session_id");
+			return -1;
+		}
 	}
 	wpa_hexdump(MSG_MSGDUMP, "TLSv1: session_id",
 		    conn->session_id, conn->session_id_len);
@@ -126,7 +128,15 @@ static int tls_write_server_hello(struct tlsv1_server *conn,
 		pos += 2;
 	}
 
-	if (conn->session_ticket && conn->session_ticket_cb) {
+	if (conn->session_resumed) {
+		/* Abbreviated handshake using the cached master secret */
+		if (tlsv1_server_derive_keys(conn, NULL, 0) < 0) {
+			wpa_printf(MSG_DEBUG, "TLSv1: Failed to derive keys");
+			tlsv1_server_alert(conn, TLS_ALERT_LEVEL_FATAL,
+					   TLS_ALERT_INTERNAL_ERROR);
+			return -1;
+		}
+	} else if (conn->session_ticket && conn->session_ticket_cb) {
 		int res = conn->session_ticket_cb(
 			conn->session_ticket_cb_ctx,
 			conn->session_ticket, conn->session_ticket_len,
@@ -968,10 +978,13 @@ static u8 * tls_send_server_hello(struct tlsv1_server *conn, size_t *out_len)
 		return NULL;
 	}
 
-	if (conn->use_session_ticket) {
+	if (conn->use_session_ticket || conn->session_resumed) {
 		os_free(ocsp_resp);
 
-		/* Abbreviated handshake using session ticket; RFC 4507 */
+		/*
+		 * Abbreviated handshake using session ticket (RFC 4507) or a
+		 * cached session
+		 */
 		if (tls_write_server_change_cipher_spec(conn, &pos, end) < 0 ||
 		    tls_write_server_finished(conn, &pos, end) < 0) {
 			os_free(msg);
@@ -1043,7 +1056,8 @@ u8 * tlsv1_server_handshake_write(struct tlsv1_server *conn, size_t *out_len)
 	case SERVER_CHANGE_CIPHER_SPEC:
 		return tls_send_change_cipher_spec(conn, out_len);
 	default:
-		if (conn->state == ESTABLISHED && conn->use_session_ticket) {
+		if (conn->state == ESTABLISHED &&
+		    (conn->use_session_ticket || conn->session_resumed)) {
 			/* Abbreviated handshake was already completed. */
 			return NULL;
 		}
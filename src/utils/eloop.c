@@ -6,12 +6,20 @@
  * See README for more details.
  */
 
+#ifdef CONFIG_ELOOP_STATS
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif /* _GNU_SOURCE */
+#include <dlfcn.h>
+#endif /* CONFIG_ELOOP_STATS */
+
 #include "includes.h"
 #include <assert.h>
 
 #include "common.h"
 #include "trace.h"
 #include "list.h"
+#include "obj_pool.h"
 #include "eloop.h"
 
 #if defined(CONFIG_ELOOP_POLL) && defined(CONFIG_ELOOP_EPOLL)
@@ -31,6 +39,13 @@
 #include <poll.h>
 #endif /* CONFIG_ELOOP_POLL */
 
+#ifdef CONFIG_ELOOP_TIMERFD
+#if !defined(CONFIG_ELOOP_POLL) && !defined(CONFIG_ELOOP_EPOLL)
+#error CONFIG_ELOOP_TIMERFD requires poll or epoll
+#endif
+#include <sys/timerfd.h>
+#endif /* CONFIG_ELOOP_TIMERFD */
+
 #ifdef CONFIG_ELOOP_EPOLL
 #include <sys/epoll.h>
 #endif /* CONFIG_ELOOP_EPOLL */
@@ -52,6 +67,8 @@ struct eloop_sock {
 struct eloop_timeout {
 	struct dl_list list;
 	struct os_reltime time;
+	struct os_reltime latest; /* time + slack */
+	unsigned int slack; /* usec */
 	void *eloop_data;
 	void *user_data;
 	eloop_timeout_handler handler;
@@ -74,6 +91,46 @@ struct eloop_sock_table {
 	int changed;
 };
 
+#ifdef CONFIG_ELOOP_STATS
+
+/* Histogram buckets: <10 us, <100 us, <1 ms, <10 ms, <100 ms, <1 s, >=1 s */
+#define ELOOP_STATS_BUCKETS 7
+/* Size of the per-handler hash table; must be a power of two */
+#define ELOOP_STATS_HANDLERS 256
+
+enum eloop_stats_type {
+	ELOOP_STATS_SOCK,
+	ELOOP_STATS_TIMEOUT,
+	ELOOP_STATS_SIGNAL,
+};
+
+struct eloop_handler_stats {
+	const void *handler;
+	enum eloop_stats_type type;
+	unsigned int calls;
+	unsigned int max_us;
+	u64 total_us;
+	unsigned int hist[ELOOP_STATS_BUCKETS];
+};
+
+struct eloop_stats {
+	struct os_reltime start;
+	struct eloop_handler_stats *handlers; /* open addressing on handler */
+	size_t num_handlers;
+	unsigned int dropped; /* calls not accounted due to a full table */
+	u64 iterations;
+	unsigned int timeouts; /* currently registered timeouts */
+	unsigned int max_timeouts;
+	unsigned int max_ready; /* most sockets ready in one iteration */
+	unsigned int max_coalesced; /* most timeouts run in one iteration */
+	u64 total_ready;
+	unsigned int late_max_us;
+	u64 late_total_us;
+	unsigned int late_hist[ELOOP_STATS_BUCKETS];
+};
+
+#endif /* CONFIG_ELOOP_STATS */
+
 struct eloop_data {
 	int max_sock;
 
@@ -110,10 +167,323 @@ struct eloop_data {
 	int pending_terminate;
 
 	int terminate;
+#ifdef CONFIG_ELOOP_TIMERFD
+	int timerfd;
+	int timerfd_armed;
+	struct os_reltime timerfd_time;
+#endif /* CONFIG_ELOOP_TIMERFD */
+#ifdef CONFIG_ELOOP_STATS
+	struct eloop_stats stats;
+#endif /* CONFIG_ELOOP_STATS */
 };
 
 static struct eloop_data eloop;
 
+/* Shared by all eloop timeouts */
+static struct obj_pool eloop_timeout_pool =
+	OBJ_POOL_INIT("eloop_timeout", sizeof(struct eloop_timeout), 0);
+
+#ifdef CONFIG_ELOOP_TIMERFD
+/* The timerfd is registered as a reader, but does not keep eloop_run() going */
+#define ELOOP_INTERNAL_READERS (eloop.timerfd >= 0 ? 1 : 0)
+#else /* CONFIG_ELOOP_TIMERFD */
+#define ELOOP_INTERNAL_READERS 0
+#endif /* CONFIG_ELOOP_TIMERFD */
+
+
+#ifdef CONFIG_ELOOP_STATS
+
+static unsigned int eloop_stats_us(struct os_reltime *start,
+				   struct os_reltime *end)
+{
+	struct os_reltime diff;
+
+	if (os_reltime_before(end, start))
+		return 0;
+	os_reltime_sub(end, start, &diff);
+	if (diff.sec >= 4000)
+		return 4000000000U;
+	return (u64) diff.sec * 1000000 + diff.usec;
+}
+
+
+static unsigned int eloop_stats_bucket(unsigned int us)
+{
+	unsigned int bucket = 0, limit = 10;
+
+	while (bucket < ELOOP_STATS_BUCKETS - 1 && us >= limit) {
+		bucket++;
+		limit *= 10;
+	}
+	return bucket;
+}
+
+
+static struct eloop_handler_stats *
+eloop_stats_get(const void *handler, enum eloop_stats_type type)
+{
+	struct eloop_handler_stats *h;
+	unsigned int i, idx;
+
+	if (!eloop.stats.handlers) {
+		eloop.stats.handlers = os_calloc(ELOOP_STATS_HANDLERS,
+						 sizeof(*h));
+		if (!eloop.stats.handlers)
+			return NULL;
+	}
+
+	idx = (((uintptr_t) handler) >> 3) * 2654435761U;
+	for (i = 0; i < ELOOP_STATS_HANDLERS; i++) {
+		h = &eloop.stats.handlers[(idx + i) &
+					  (ELOOP_STATS_HANDLERS - 1)];
+		if (h->handler == handler && h->type == type)
+			return h;
+		if (!h->handler) {
+			h->handler = handler;
+			h->type = type;
+			eloop.stats.num_handlers++;
+			return h;
+		}
+	}
+	return NULL;
+}
+
+
+static void eloop_stats_handler(const void *handler,
+				enum eloop_stats_type type,
+				struct os_reltime *start)
+{
+	struct eloop_handler_stats *h;
+	struct os_reltime now;
+	unsigned int us;
+
+	os_get_reltime(&now);
+	us = eloop_stats_us(start, &now);
+	h = eloop_stats_get(handler, type);
+	if (!h) {
+		eloop.stats.dropped++;
+		return;
+	}
+	h->calls++;
+	h->total_us += us;
+	if (us > h->max_us)
+		h->max_us = us;
+	h->hist[eloop_stats_bucket(us)]++;
+}
+
+
+static void eloop_stats_timeout_late(struct os_reltime *expected,
+				     struct os_reltime *now)
+{
+	unsigned int us = eloop_stats_us(expected, now);
+
+	eloop.stats.late_total_us += us;
+	if (us > eloop.stats.late_max_us)
+		eloop.stats.late_max_us = us;
+	eloop.stats.late_hist[eloop_stats_bucket(us)]++;
+}
+
+
+static void eloop_stats_coalesced(unsigned int run)
+{
+	if (run > eloop.stats.max_coalesced)
+		eloop.stats.max_coalesced = run;
+}
+
+
+static void eloop_stats_ready(int ready)
+{
+	eloop.stats.iterations++;
+	if (ready <= 0)
+		return;
+	eloop.stats.total_ready += ready;
+	if ((unsigned int) ready > eloop.stats.max_ready)
+		eloop.stats.max_ready = ready;
+}
+
+
+void eloop_stats_reset(void)
+{
+	unsigned int timeouts = eloop.stats.timeouts;
+	struct eloop_handler_stats *handlers = eloop.stats.handlers;
+
+	/* Keep the handler table since this may be called from a handler
+	 * whose own call is accounted once it returns. */
+	if (handlers)
+		os_memset(handlers, 0,
+			  ELOOP_STATS_HANDLERS * sizeof(*handlers));
+	os_memset(&eloop.stats, 0, sizeof(eloop.stats));
+	eloop.stats.handlers = handlers;
+	eloop.stats.timeouts = timeouts;
+	eloop.stats.max_timeouts = timeouts;
+	os_get_reltime(&eloop.stats.start);
+}
+
+
+static int eloop_stats_cmp(const void *a, const void *b)
+{
+	const struct eloop_handler_stats *ha, *hb;
+
+	ha = *(const struct eloop_handler_stats * const *) a;
+	hb = *(const struct eloop_handler_stats * const *) b;
+	if (ha->total_us != hb->total_us)
+		return ha->total_us < hb->total_us ? 1 : -1;
+	return 0;
+}
+
+
+static char * eloop_stats_hist(char *pos, char *end, const char *name,
+			       const unsigned int *hist)
+{
+	int i, ret;
+
+	ret = os_snprintf(pos, end - pos, "%s=", name);
+	if (os_snprintf_error(end - pos, ret))
+		return NULL;
+	pos += ret;
+	for (i = 0; i < ELOOP_STATS_BUCKETS; i++) {
+		ret = os_snprintf(pos, end - pos, "%s%u", i ? "," : "",
+				  hist[i]);
+		if (os_snprintf_error(end - pos, ret))
+			return NULL;
+		pos += ret;
+	}
+	return pos;
+}
+
+
+/*
+ * Handlers are mostly static functions, so a raw pointer is not useful with
+ * ASLR. Use the function name when it is known and otherwise the offset from
+ * the load address of the object (usable with addr2line -e <object>).
+ */
+static void eloop_stats_handler_name(const void *handler, char *buf,
+				     size_t len)
+{
+	const char *name;
+	Dl_info info;
+
+	name = wpa_trace_func_name(handler);
+	if (name) {
+		os_strlcpy(buf, name, len);
+		return;
+	}
+
+	os_memset(&info, 0, sizeof(info));
+	if (!dladdr(handler, &info) || !info.dli_fname) {
+		os_snprintf(buf, len, "%p", handler);
+		return;
+	}
+	if (info.dli_sname && info.dli_saddr == handler) {
+		os_strlcpy(buf, info.dli_sname, len);
+		return;
+	}
+	name = os_strrchr(info.dli_fname, '/');
+	os_snprintf(buf, len, "%s+0x%lx", name ? name + 1 : info.dli_fname,
+		    (unsigned long) ((const u8 *) handler -
+				     (const u8 *) info.dli_fbase));
+}
+
+
+int eloop_stats_dump(char *buf, size_t buflen)
+{
+	static const char * const types[] = { "sock", "timeout", "signal" };
+	struct eloop_stats *st = &eloop.stats;
+	struct eloop_handler_stats **sorted = NULL;
+	struct os_reltime now, uptime;
+	char *pos = buf, *end = buf + buflen;
+	size_t i, num = 0;
+	int ret;
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, &st->start, &uptime);
+	ret = os_snprintf(pos, end - pos,
+			  "uptime=%ld.%06ld\n"
+			  "iterations=%llu\n"
+			  "timeouts=%u\n"
+			  "max_timeouts=%u\n"
+			  "max_ready=%u\n"
+			  "max_coalesced=%u\n"
+			  "total_ready=%llu\n"
+			  "timeout_late_max_us=%u\n"
+			  "timeout_late_total_us=%llu\n",
+			  (long) uptime.sec, (long) uptime.usec,
+			  (unsigned long long) st->iterations,
+			  st->timeouts, st->max_timeouts, st->max_ready,
+			  st->max_coalesced,
+			  (unsigned long long) st->total_ready,
+			  st->late_max_us,
+			  (unsigned long long) st->late_total_us);
+	if (os_snprintf_error(end - pos, ret))
+		return pos - buf;
+	pos += ret;
+	pos = eloop_stats_hist(pos, end, "timeout_late_hist", st->late_hist);
+	if (!pos || end - pos < 2)
+		return end - buf - 1;
+	*pos++ = '\n';
+	*pos = '\0';
+	if (st->dropped) {
+		ret = os_snprintf(pos, end - pos, "dropped=%u\n", st->dropped);
+		if (os_snprintf_error(end - pos, ret))
+			return pos - buf;
+		pos += ret;
+	}
+
+	if (st->num_handlers)
+		sorted = os_calloc(st->num_handlers, sizeof(*sorted));
+	for (i = 0; sorted && i < ELOOP_STATS_HANDLERS; i++) {
+		if (st->handlers[i].handler)
+			sorted[num++] = &st->handlers[i];
+	}
+	if (sorted)
+		qsort(sorted, num, sizeof(*sorted), eloop_stats_cmp);
+
+	/* Most expensive handlers first so that a truncated reply still
+	 * contains the interesting part */
+	for (i = 0; i < num; i++) {
+		struct eloop_handler_stats *h = sorted[i];
+		char *prev = pos;
+		char name[100];
+
+		eloop_stats_handler_name(h->handler, name, sizeof(name));
+		ret = os_snprintf(pos, end - pos,
+				  "handler=%s type=%s calls=%u total_us=%llu max_us=%u ",
+				  name, types[h->type], h->calls,
+				  (unsigned long long) h->total_us, h->max_us);
+		if (os_snprintf_error(end - pos, ret))
+			break;
+		pos += ret;
+		pos = eloop_stats_hist(pos, end, "hist", h->hist);
+		if (!pos || end - pos < 2) {
+			pos = prev;
+			*pos = '\0';
+			break;
+		}
+		*pos++ = '\n';
+		*pos = '\0';
+	}
+	os_free(sorted);
+
+	return pos - buf;
+}
+
+#endif /* CONFIG_ELOOP_STATS */
+
+
+static void eloop_sock_call(struct eloop_sock *s)
+{
+#ifdef CONFIG_ELOOP_STATS
+	eloop_sock_handler handler = s->handler;
+	struct os_reltime start;
+
+	os_get_reltime(&start);
+	handler(s->sock, s->eloop_data, s->user_data);
+	eloop_stats_handler(handler, ELOOP_STATS_SOCK, &start);
+#else /* CONFIG_ELOOP_STATS */
+	s->handler(s->sock, s->eloop_data, s->user_data);
+#endif /* CONFIG_ELOOP_STATS */
+}
+
 
 #ifdef WPA_TRACE
 
@@ -160,10 +530,108 @@ static void eloop_trace_sock_remove_ref(struct eloop_sock_table *table)
 #endif /* WPA_TRACE */
 
 
+#ifdef CONFIG_ELOOP_TIMERFD
+
+static void eloop_timerfd_receive(int sock, void *eloop_ctx, void *sock_ctx)
+{
+	u64 expirations;
+
+	if (read(sock, &expirations, sizeof(expirations)) < 0 &&
+	    errno != EAGAIN)
+		wpa_printf(MSG_DEBUG, "eloop: timerfd read: %s",
+			   strerror(errno));
+	eloop.timerfd_armed = 0;
+}
+
+
+static void eloop_timerfd_init(void)
+{
+#ifdef CLOCK_BOOTTIME
+	/* Same clock as os_get_reltime() */
+	eloop.timerfd = timerfd_create(CLOCK_BOOTTIME,
+				       TFD_NONBLOCK | TFD_CLOEXEC);
+	if (eloop.timerfd < 0)
+#endif /* CLOCK_BOOTTIME */
+		eloop.timerfd = timerfd_create(CLOCK_MONOTONIC,
+					       TFD_NONBLOCK | TFD_CLOEXEC);
+	if (eloop.timerfd < 0) {
+		wpa_printf(MSG_INFO,
+			   "eloop: timerfd not available (%s) - use wait timeout",
+			   strerror(errno));
+		return;
+	}
+	if (eloop_register_read_sock(eloop.timerfd, eloop_timerfd_receive,
+				     NULL, NULL) < 0) {
+		close(eloop.timerfd);
+		eloop.timerfd = -1;
+	}
+}
+
+
+static void eloop_timerfd_deinit(void)
+{
+	if (eloop.timerfd < 0)
+		return;
+	eloop_unregister_read_sock(eloop.timerfd);
+	close(eloop.timerfd);
+	eloop.timerfd = -1;
+}
+
+
+/*
+ * Arm the timerfd for the next wakeup. The timerfd has nanosecond resolution
+ * while the poll()/epoll_wait() timeout is in milliseconds and would wake up
+ * early and spin until a sub-millisecond timeout is due.
+ */
+static int eloop_timerfd_arm(struct os_reltime *wake, struct os_reltime *tv)
+{
+	struct itimerspec its;
+
+	if (eloop.timerfd < 0)
+		return -1;
+	if (eloop.timerfd_armed && wake->sec == eloop.timerfd_time.sec &&
+	    wake->usec == eloop.timerfd_time.usec)
+		return 0;
+
+	os_memset(&its, 0, sizeof(its));
+	its.it_value.tv_sec = tv->sec;
+	its.it_value.tv_nsec = tv->usec * 1000L;
+	if (timerfd_settime(eloop.timerfd, 0, &its, NULL) < 0) {
+		wpa_printf(MSG_DEBUG, "eloop: timerfd_settime: %s",
+			   strerror(errno));
+		eloop.timerfd_armed = 0;
+		return -1;
+	}
+	eloop.timerfd_time = *wake;
+	eloop.timerfd_armed = 1;
+	return 0;
+}
+
+
+static void eloop_timerfd_disarm(void)
+{
+	struct itimerspec its;
+
+	if (eloop.timerfd < 0 || !eloop.timerfd_armed)
+		return;
+	os_memset(&its, 0, sizeof(its));
+	timerfd_settime(eloop.timerfd, 0, &its, NULL);
+	eloop.timerfd_armed = 0;
+}
+
+#endif /* CONFIG_ELOOP_TIMERFD */
+
+
 int eloop_init(void)
 {
 	os_memset(&eloop, 0, sizeof(eloop));
 	dl_list_init(&eloop.timeout);
+#ifdef CONFIG_ELOOP_TIMERFD
+	eloop.timerfd = -1;
+#endif /* CONFIG_ELOOP_TIMERFD */
+#ifdef CONFIG_ELOOP_STATS
+	os_get_reltime(&eloop.stats.start);
+#endif /* CONFIG_ELOOP_STATS */
 #ifdef CONFIG_ELOOP_EPOLL
 	eloop.epollfd = epoll_create1(0);
 	if (eloop.epollfd < 0) {
@@ -185,6 +653,9 @@ int eloop_init(void)
 	eloop.writers.type = EVENT_TYPE_WRITE;
 	eloop.exceptions.type = EVENT_TYPE_EXCEPTION;
 #endif /* CONFIG_ELOOP_EPOLL || CONFIG_ELOOP_KQUEUE */
+#ifdef CONFIG_ELOOP_TIMERFD
+	eloop_timerfd_init();
+#endif /* CONFIG_ELOOP_TIMERFD */
 #ifdef WPA_TRACE
 	signal(SIGSEGV, eloop_sigsegv_handler);
 #endif /* WPA_TRACE */
@@ -538,9 +1009,7 @@ static int eloop_sock_table_dispatch_table(struct eloop_sock_table *table,
 		if (!(pfd->revents & revents))
 			continue;
 
-		table->table[i].handler(table->table[i].sock,
-					table->table[i].eloop_data,
-					table->table[i].user_data);
+		eloop_sock_call(&table->table[i]);
 		if (table->changed)
 			return 1;
 	}
@@ -600,9 +1069,7 @@ static void eloop_sock_table_dispatch(struct eloop_sock_table *table,
 	table->changed = 0;
 	for (i = 0; i < table->count; i++) {
 		if (FD_ISSET(table->table[i].sock, fds)) {
-			table->table[i].handler(table->table[i].sock,
-						table->table[i].eloop_data,
-						table->table[i].user_data);
+			eloop_sock_call(&table->table[i]);
 			if (table->changed)
 				break;
 		}
@@ -622,8 +1089,7 @@ static void eloop_sock_table_dispatch(struct epoll_event *events, int nfds)
 		table = &eloop.fd_table[events[i].data.fd];
 		if (table->handler == NULL)
 			continue;
-		table->handler(table->sock, table->eloop_data,
-			       table->user_data);
+		eloop_sock_call(table);
 		if (eloop.readers.changed ||
 		    eloop.writers.changed ||
 		    eloop.exceptions.changed)
@@ -644,8 +1110,7 @@ static void eloop_sock_table_dispatch(struct kevent *events, int nfds)
 		table = &eloop.fd_table[events[i].ident];
 		if (table->handler == NULL)
 			continue;
-		table->handler(table->sock, table->eloop_data,
-			       table->user_data);
+		eloop_sock_call(table);
 		if (eloop.readers.changed ||
 		    eloop.writers.changed ||
 		    eloop.exceptions.changed)
@@ -772,15 +1237,25 @@ void eloop_unregister_sock(int sock, eloop_event_type type)
 int eloop_register_timeout(unsigned int secs, unsigned int usecs,
 			   eloop_timeout_handler handler,
 			   void *eloop_data, void *user_data)
+{
+	return eloop_register_timeout_slack(secs, usecs, 0, handler,
+					    eloop_data, user_data);
+}
+
+
+int eloop_register_timeout_slack(unsigned int secs, unsigned int usecs,
+				 unsigned int slack_usecs,
+				 eloop_timeout_handler handler,
+				 void *eloop_data, void *user_data)
 {
 	struct eloop_timeout *timeout, *tmp;
 	os_time_t now_sec;
 
-	timeout = os_zalloc(sizeof(*timeout));
+	timeout = obj_pool_zalloc(&eloop_timeout_pool);
 	if (timeout == NULL)
 		return -1;
 	if (os_get_reltime(&timeout->time) < 0) {
-		os_free(timeout);
+		obj_pool_free(&eloop_timeout_pool, timeout);
 		return -1;
 	}
 	now_sec = timeout->time.sec;
@@ -794,6 +1269,14 @@ int eloop_register_timeout(unsigned int secs, unsigned int usecs,
 	}
 	if (timeout->time.sec < now_sec)
 		goto overflow;
+	timeout->slack = slack_usecs;
+	timeout->latest = timeout->time;
+	timeout->latest.usec += slack_usecs % 1000000;
+	timeout->latest.sec += slack_usecs / 1000000 +
+		timeout->latest.usec / 1000000;
+	timeout->latest.usec %= 1000000;
+	if (timeout->latest.sec < timeout->time.sec)
+		timeout->latest = timeout->time;
 	timeout->eloop_data = eloop_data;
 	timeout->user_data = user_data;
 	timeout->handler = handler;
@@ -801,6 +1284,11 @@ int eloop_register_timeout(unsigned int secs, unsigned int usecs,
 	wpa_trace_add_ref(timeout, user, user_data);
 	wpa_trace_record(timeout);
 
+#ifdef CONFIG_ELOOP_STATS
+	if (++eloop.stats.timeouts > eloop.stats.max_timeouts)
+		eloop.stats.max_timeouts = eloop.stats.timeouts;
+#endif /* CONFIG_ELOOP_STATS */
+
 	/* Maintain timeouts in order of increasing time */
 	dl_list_for_each(tmp, &eloop.timeout, struct eloop_timeout, list) {
 		if (os_reltime_before(&timeout->time, &tmp->time)) {
@@ -820,7 +1308,7 @@ overflow:
 	wpa_printf(MSG_DEBUG,
 		   "ELOOP: Too long timeout (secs=%u usecs=%u) to ever happen - ignore it",
 		   secs,usecs);
-	os_free(timeout);
+	obj_pool_free(&eloop_timeout_pool, timeout);
 	return 0;
 }
 
@@ -828,9 +1316,12 @@ overflow:
 static void eloop_remove_timeout(struct eloop_timeout *timeout)
 {
 	dl_list_del(&timeout->list);
+#ifdef CONFIG_ELOOP_STATS
+	eloop.stats.timeouts--;
+#endif /* CONFIG_ELOOP_STATS */
 	wpa_trace_remove_ref(timeout, eloop, timeout->eloop_data);
 	wpa_trace_remove_ref(timeout, user, timeout->user_data);
-	os_free(timeout);
+	obj_pool_free(&eloop_timeout_pool, timeout);
 }
 
 
@@ -915,12 +1406,15 @@ int eloop_deplete_timeout(unsigned int req_secs, unsigned int req_usecs,
 			os_get_reltime(&now);
 			os_reltime_sub(&tmp->time, &now, &remaining);
 			if (os_reltime_before(&requested, &remaining)) {
+				unsigned int slack = tmp->slack;
+
 				eloop_cancel_timeout(handler, eloop_data,
 						     user_data);
-				eloop_register_timeout(requested.sec,
-						       requested.usec,
-						       handler, eloop_data,
-						       user_data);
+				eloop_register_timeout_slack(requested.sec,
+							     requested.usec,
+							     slack, handler,
+							     eloop_data,
+							     user_data);
 				return 1;
 			}
 			return 0;
@@ -947,12 +1441,15 @@ int eloop_replenish_timeout(unsigned int req_secs, unsigned int req_usecs,
 			os_get_reltime(&now);
 			os_reltime_sub(&tmp->time, &now, &remaining);
 			if (os_reltime_before(&remaining, &requested)) {
+				unsigned int slack = tmp->slack;
+
 				eloop_cancel_timeout(handler, eloop_data,
 						     user_data);
-				eloop_register_timeout(requested.sec,
-						       requested.usec,
-						       handler, eloop_data,
-						       user_data);
+				eloop_register_timeout_slack(requested.sec,
+							     requested.usec,
+							     slack, handler,
+							     eloop_data,
+							     user_data);
 				return 1;
 			}
 			return 0;
@@ -1017,9 +1514,18 @@ static void eloop_process_pending_signals(void)
 
 	for (i = 0; i < eloop.signal_count; i++) {
 		if (eloop.signals[i].signaled) {
+#ifdef CONFIG_ELOOP_STATS
+			struct os_reltime start;
+
+			os_get_reltime(&start);
+#endif /* CONFIG_ELOOP_STATS */
 			eloop.signals[i].signaled = 0;
 			eloop.signals[i].handler(eloop.signals[i].sig,
 						 eloop.signals[i].user_data);
+#ifdef CONFIG_ELOOP_STATS
+			eloop_stats_handler(eloop.signals[i].handler,
+					    ELOOP_STATS_SIGNAL, &start);
+#endif /* CONFIG_ELOOP_STATS */
 		}
 	}
 }
@@ -1068,6 +1574,28 @@ int eloop_register_signal_reconfig(eloop_signal_handler handler,
 }
 
 
+/*
+ * Find the time for the next wakeup: the latest time that is still within the
+ * slack of every pending timeout. All timeouts that have expired by then are
+ * run in the same wakeup.
+ */
+static void eloop_next_wakeup(struct eloop_timeout *first,
+			      struct os_reltime *wake)
+{
+	struct eloop_timeout *tmp;
+
+	*wake = first->latest;
+	for (tmp = dl_list_entry(first->list.next, struct eloop_timeout, list);
+	     &tmp->list != &eloop.timeout;
+	     tmp = dl_list_entry(tmp->list.next, struct eloop_timeout, list)) {
+		if (!os_reltime_before(&tmp->time, wake))
+			break;
+		if (os_reltime_before(&tmp->latest, wake))
+			*wake = tmp->latest;
+	}
+}
+
+
 void eloop_run(void)
 {
 #ifdef CONFIG_ELOOP_POLL
@@ -1085,7 +1613,7 @@ void eloop_run(void)
 	struct timespec ts;
 #endif /* CONFIG_ELOOP_KQUEUE */
 	int res;
-	struct os_reltime tv, now;
+	struct os_reltime tv, now, wake;
 
 #ifdef CONFIG_ELOOP_SELECT
 	rfds = os_malloc(sizeof(*rfds));
@@ -1096,9 +1624,13 @@ void eloop_run(void)
 #endif /* CONFIG_ELOOP_SELECT */
 
 	while (!eloop.terminate &&
-	       (!dl_list_empty(&eloop.timeout) || eloop.readers.count > 0 ||
+	       (!dl_list_empty(&eloop.timeout) ||
+		eloop.readers.count > ELOOP_INTERNAL_READERS ||
 		eloop.writers.count > 0 || eloop.exceptions.count > 0)) {
 		struct eloop_timeout *timeout;
+#ifdef CONFIG_ELOOP_STATS
+		unsigned int run = 0;
+#endif /* CONFIG_ELOOP_STATS */
 
 		if (eloop.pending_terminate) {
 			/*
@@ -1116,13 +1648,19 @@ void eloop_run(void)
 		timeout = dl_list_first(&eloop.timeout, struct eloop_timeout,
 					list);
 		if (timeout) {
+			eloop_next_wakeup(timeout, &wake);
 			os_get_reltime(&now);
-			if (os_reltime_before(&now, &timeout->time))
-				os_reltime_sub(&timeout->time, &now, &tv);
+			if (os_reltime_before(&now, &wake))
+				os_reltime_sub(&wake, &now, &tv);
 			else
 				tv.sec = tv.usec = 0;
 #if defined(CONFIG_ELOOP_POLL) || defined(CONFIG_ELOOP_EPOLL)
 			timeout_ms = tv.sec * 1000 + tv.usec / 1000;
+#ifdef CONFIG_ELOOP_TIMERFD
+			if ((tv.sec || tv.usec) &&
+			    eloop_timerfd_arm(&wake, &tv) == 0)
+				timeout_ms = -1;
+#endif /* CONFIG_ELOOP_TIMERFD */
 #endif /* defined(CONFIG_ELOOP_POLL) || defined(CONFIG_ELOOP_EPOLL) */
 #ifdef CONFIG_ELOOP_SELECT
 			_tv.tv_sec = tv.sec;
@@ -1132,6 +1670,15 @@ void eloop_run(void)
 			ts.tv_sec = tv.sec;
 			ts.tv_nsec = tv.usec * 1000L;
 #endif /* CONFIG_ELOOP_KQUEUE */
+		} else {
+			/* Timeouts added by handlers are not batched */
+			wake.sec = wake.usec = 0;
+#ifdef CONFIG_ELOOP_EPOLL
+			timeout_ms = -1;
+#endif /* CONFIG_ELOOP_EPOLL */
+#ifdef CONFIG_ELOOP_TIMERFD
+			eloop_timerfd_disarm();
+#endif /* CONFIG_ELOOP_TIMERFD */
 		}
 
 #ifdef CONFIG_ELOOP_POLL
@@ -1151,6 +1698,11 @@ void eloop_run(void)
 #endif /* CONFIG_ELOOP_SELECT */
 #ifdef CONFIG_ELOOP_EPOLL
 		if (eloop.count == 0) {
+			/* Only timeouts pending; do not spin until they are
+			 * due */
+			if (timeout_ms > 0)
+				os_sleep(timeout_ms / 1000,
+					 (timeout_ms % 1000) * 1000);
 			res = 0;
 		} else {
 			res = epoll_wait(eloop.epollfd, eloop.epoll_events,
@@ -1188,25 +1740,54 @@ void eloop_run(void)
 		eloop.readers.changed = 0;
 		eloop.writers.changed = 0;
 		eloop.exceptions.changed = 0;
+#ifdef CONFIG_ELOOP_STATS
+		eloop_stats_ready(res);
+#endif /* CONFIG_ELOOP_STATS */
 
 		eloop_process_pending_signals();
 
 
-		/* check if some registered timeouts have occurred */
-		timeout = dl_list_first(&eloop.timeout, struct eloop_timeout,
-					list);
-		if (timeout) {
+		/*
+		 * Run the first timeout if it has occurred. If it has a slack,
+		 * also run the other timeouts that have occurred by now and
+		 * fall within the wakeup window computed above, so that
+		 * timeouts coalesced into this wakeup do not need a wakeup
+		 * each. Timeouts without a slack are run one per iteration.
+		 */
+		if (!dl_list_empty(&eloop.timeout))
 			os_get_reltime(&now);
-			if (!os_reltime_before(&now, &timeout->time)) {
-				void *eloop_data = timeout->eloop_data;
-				void *user_data = timeout->user_data;
-				eloop_timeout_handler handler =
-					timeout->handler;
-				eloop_remove_timeout(timeout);
-				handler(eloop_data, user_data);
-			}
-
+		while (!eloop.terminate &&
+		       (timeout = dl_list_first(&eloop.timeout,
+						struct eloop_timeout, list)) &&
+		       !os_reltime_before(&now, &timeout->time)) {
+			void *eloop_data = timeout->eloop_data;
+			void *user_data = timeout->user_data;
+			eloop_timeout_handler handler = timeout->handler;
+			int batch = timeout->slack > 0;
+#ifdef CONFIG_ELOOP_STATS
+			struct os_reltime start;
+
+			os_get_reltime(&start);
+			eloop_stats_timeout_late(&timeout->time, &start);
+#endif /* CONFIG_ELOOP_STATS */
+			eloop_remove_timeout(timeout);
+			handler(eloop_data, user_data);
+#ifdef CONFIG_ELOOP_STATS
+			run++;
+			eloop_stats_handler(handler, ELOOP_STATS_TIMEOUT,
+					    &start);
+#endif /* CONFIG_ELOOP_STATS */
+			if (!batch)
+				break;
+			eloop_process_pending_signals();
+			timeout = dl_list_first(&eloop.timeout,
+						struct eloop_timeout, list);
+			if (!timeout || os_reltime_before(&wake, &timeout->time))
+				break;
 		}
+#ifdef CONFIG_ELOOP_STATS
+		eloop_stats_coalesced(run);
+#endif /* CONFIG_ELOOP_STATS */
 
 		if (res <= 0)
 			continue;
@@ -1264,6 +1845,9 @@ void eloop_destroy(void)
 	struct eloop_timeout *timeout, *prev;
 	struct os_reltime now;
 
+#ifdef CONFIG_ELOOP_TIMERFD
+	eloop_timerfd_deinit();
+#endif /* CONFIG_ELOOP_TIMERFD */
 	os_get_reltime(&now);
 	dl_list_for_each_safe(timeout, prev, &eloop.timeout,
 			      struct eloop_timeout, list) {
@@ -1287,6 +1871,10 @@ void eloop_destroy(void)
 	eloop_sock_table_destroy(&eloop.writers);
 	eloop_sock_table_destroy(&eloop.exceptions);
 	os_free(eloop.signals);
+#ifdef CONFIG_ELOOP_STATS
+	os_free(eloop.stats.handlers);
+	eloop.stats.handlers = NULL;
+#endif /* CONFIG_ELOOP_STATS */
 
 #ifdef CONFIG_ELOOP_POLL
 	os_free(eloop.pollfds);
@@ -180,6 +180,27 @@ int eloop_register_timeout(unsigned int secs, unsigned int usecs,
 			   eloop_timeout_handler handler,
 			   void *eloop_data, void *user_data);
 
+/**
+ * eloop_register_timeout_slack - Register timeout that may be delayed
+ * @secs: Number of seconds to the timeout
+ * @usecs: Number of microseconds to the timeout
+ * @slack_usecs: Maximum delay in microseconds
+ * @handler: Callback function to be called when timeout occurs
+ * @eloop_data: Callback context data (eloop_ctx)
+ * @user_data: Callback context data (sock_ctx)
+ * Returns: 0 on success, -1 on failure
+ *
+ * Like eloop_register_timeout(), but the handler may be called up to
+ * slack_usecs after the given time so that timeouts that expire close to each
+ * other can be run in a single wakeup. This is meant for periodic maintenance
+ * (e.g., inactivity polling and cleanup). eloop_register_timeout() registers
+ * timeouts with zero slack.
+ */
+int eloop_register_timeout_slack(unsigned int secs, unsigned int usecs,
+				 unsigned int slack_usecs,
+				 eloop_timeout_handler handler,
+				 void *eloop_data, void *user_data);
+
 /**
  * eloop_cancel_timeout - Cancel timeouts
  * @handler: Matching callback function
@@ -364,4 +385,30 @@ int eloop_terminated(void);
  */
 void eloop_wait_for_read_sock(int sock);
 
+#ifdef CONFIG_ELOOP_STATS
+
+/**
+ * eloop_stats_dump - Write event loop statistics into a text buffer
+ * @buf: Buffer for the statistics
+ * @buflen: Length of the buffer
+ * Returns: Number of characters written
+ *
+ * The output has one line per value. The per-handler lines are sorted by
+ * cumulative execution time and contain the handler name, call count,
+ * cumulative and maximum execution time, and a histogram of the execution
+ * times. The handler name is the symbol name if dladdr() finds one, the
+ * object file name and offset if not, or the function address. Histograms
+ * have seven buckets: <10 us, <100 us, <1 ms, <10 ms, <100 ms, <1 s, and
+ * >=1 s. timeout_late_hist uses the same buckets for the time between the
+ * expiration of a timeout and the call to its handler.
+ */
+int eloop_stats_dump(char *buf, size_t buflen);
+
+/**
+ * eloop_stats_reset - Clear event loop statistics
+ */
+void eloop_stats_reset(void);
+
+#endif /* CONFIG_ELOOP_STATS */
+
 #endif /* ELOOP_H */
@@ -234,6 +234,17 @@ void eloop_unregister_event(void *event, size_t event_size)
 }
 
 
+int eloop_register_timeout_slack(unsigned int secs, unsigned int usecs,
+				 unsigned int slack_usecs,
+				 eloop_timeout_handler handler,
+				 void *eloop_data, void *user_data)
+{
+	/* Timeouts are not coalesced */
+	return eloop_register_timeout(secs, usecs, handler, eloop_data,
+				      user_data);
+}
+
+
 int eloop_register_timeout(unsigned int secs, unsigned int usecs,
 			   eloop_timeout_handler handler,
 			   void *eloop_data, void *user_data)
@@ -0,0 +1,265 @@
+/*
+ * Fixed-size object pools
+ * Copyright (c) 2026, The hostapd contributors
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "obj_pool.h"
+
+/*
+ * Objects are allocated from slabs of per_slab objects. Each object is
+ * preceded by a small header that points to its slab. Free objects of a slab
+ * are linked through their first octets. A slab that becomes fully unused is
+ * kept for reuse if the pool does not have one already and freed otherwise to
+ * return memory to the heap after a peak.
+ */
+
+#define OBJ_POOL_ALIGN (2 * sizeof(void *))
+#define OBJ_POOL_ROUND(len) \
+	(((len) + OBJ_POOL_ALIGN - 1) & ~(OBJ_POOL_ALIGN - 1))
+#define OBJ_POOL_SLAB_SIZE 16384
+#define OBJ_POOL_MIN_PER_SLAB 4
+#define OBJ_POOL_MAX_PER_SLAB 64
+
+#define OBJ_POOL_USED 0x5a3c9e71
+#define OBJ_POOL_FREE 0x2b8d04f6
+
+struct obj_pool_slab {
+	struct dl_list list;
+	struct obj_pool *pool;
+	struct obj_pool_hdr *free;
+	unsigned int used;
+};
+
+struct obj_pool_hdr {
+	struct obj_pool_slab *slab;
+	unsigned int magic;
+};
+
+#define OBJ_POOL_SLAB_LEN OBJ_POOL_ROUND(sizeof(struct obj_pool_slab))
+#define OBJ_POOL_HDR_LEN OBJ_POOL_ROUND(sizeof(struct obj_pool_hdr))
+
+static struct dl_list obj_pools = DL_LIST_HEAD_INIT(obj_pools);
+
+
+static size_t obj_pool_stride(struct obj_pool *pool)
+{
+	return OBJ_POOL_HDR_LEN +
+		OBJ_POOL_ROUND(pool->size > sizeof(void *) ?
+			       pool->size : sizeof(void *));
+}
+
+
+static void obj_pool_setup(struct obj_pool *pool)
+{
+	size_t per_slab;
+
+	if (pool->per_slab)
+		return;
+
+	per_slab = OBJ_POOL_SLAB_SIZE / obj_pool_stride(pool);
+	if (per_slab < OBJ_POOL_MIN_PER_SLAB)
+		per_slab = OBJ_POOL_MIN_PER_SLAB;
+	if (per_slab > OBJ_POOL_MAX_PER_SLAB)
+		per_slab = OBJ_POOL_MAX_PER_SLAB;
+	pool->per_slab = per_slab;
+	dl_list_init(&pool->partial);
+	dl_list_init(&pool->full);
+	dl_list_add_tail(&obj_pools, &pool->list);
+}
+
+
+static struct obj_pool_slab * obj_pool_slab_alloc(struct obj_pool *pool)
+{
+	struct obj_pool_slab *slab;
+	struct obj_pool_hdr *hdr, *next = NULL;
+	size_t stride = obj_pool_stride(pool);
+	unsigned int i;
+	u8 *pos;
+
+	slab = os_malloc(OBJ_POOL_SLAB_LEN + pool->per_slab * stride);
+	if (!slab)
+		return NULL;
+	slab->pool = pool;
+	slab->used = 0;
+
+	/* Build the free list so that objects are used in address order */
+	pos = (u8 *) slab + OBJ_POOL_SLAB_LEN + pool->per_slab * stride;
+	for (i = 0; i < pool->per_slab; i++) {
+		pos -= stride;
+		hdr = (struct obj_pool_hdr *) pos;
+		hdr->slab = slab;
+		hdr->magic = OBJ_POOL_FREE;
+		os_memcpy(pos + OBJ_POOL_HDR_LEN, &next, sizeof(next));
+		next = hdr;
+	}
+	slab->free = next;
+
+	if (++pool->slabs > pool->max_slabs)
+		pool->max_slabs = pool->slabs;
+	return slab;
+}
+
+
+static void obj_pool_slab_free(struct obj_pool_slab *slab)
+{
+	slab->pool->slabs--;
+	os_free(slab);
+}
+
+
+static void obj_pool_count_alloc(struct obj_pool *pool)
+{
+	pool->allocs++;
+	if (++pool->in_use > pool->max_in_use)
+		pool->max_in_use = pool->in_use;
+}
+
+
+void * obj_pool_get(struct obj_pool *pool)
+{
+	struct obj_pool_slab *slab;
+	struct obj_pool_hdr *hdr;
+	u8 *obj;
+
+	obj_pool_setup(pool);
+
+	slab = dl_list_first(&pool->partial, struct obj_pool_slab, list);
+	if (!slab) {
+		slab = pool->empty;
+		pool->empty = NULL;
+		if (!slab)
+			slab = obj_pool_slab_alloc(pool);
+		if (!slab) {
+			pool->failures++;
+			return NULL;
+		}
+		dl_list_add(&pool->partial, &slab->list);
+	}
+
+	hdr = slab->free;
+	obj = (u8 *) hdr + OBJ_POOL_HDR_LEN;
+	os_memcpy(&slab->free, obj, sizeof(slab->free));
+	hdr->magic = OBJ_POOL_USED;
+	slab->used++;
+	if (!slab->free) {
+		dl_list_del(&slab->list);
+		dl_list_add(&pool->full, &slab->list);
+	}
+	obj_pool_count_alloc(pool);
+
+	os_memset(obj, 0, pool->size);
+	return obj;
+}
+
+
+void obj_pool_put(struct obj_pool *pool, void *obj)
+{
+	struct obj_pool_slab *slab;
+	struct obj_pool_hdr *hdr;
+
+	if (!obj)
+		return;
+
+	hdr = (struct obj_pool_hdr *) ((u8 *) obj - OBJ_POOL_HDR_LEN);
+	if (hdr->magic != OBJ_POOL_USED || hdr->slab->pool != pool) {
+		wpa_printf(MSG_ERROR,
+			   "obj_pool: Invalid free of %p to pool %s (magic 0x%x)",
+			   obj, pool->name, hdr->magic);
+		return;
+	}
+
+	if (pool->flags & OBJ_POOL_CLEAR)
+		forced_memzero(obj, pool->size);
+	slab = hdr->slab;
+	hdr->magic = OBJ_POOL_FREE;
+	os_memcpy(obj, &slab->free, sizeof(slab->free));
+	if (!slab->free) {
+		dl_list_del(&slab->list);
+		dl_list_add(&pool->partial, &slab->list);
+	}
+	slab->free = hdr;
+	slab->used--;
+	pool->frees++;
+	pool->in_use--;
+
+	if (slab->used == 0) {
+		dl_list_del(&slab->list);
+		if (pool->empty)
+			obj_pool_slab_free(slab);
+		else
+			pool->empty = slab;
+	}
+}
+
+
+void * obj_pool_tracked_alloc(struct obj_pool *pool, void *obj)
+{
+	obj_pool_setup(pool);
+	if (obj)
+		obj_pool_count_alloc(pool);
+	else
+		pool->failures++;
+	return obj;
+}
+
+
+void obj_pool_tracked_free(struct obj_pool *pool, void *obj)
+{
+	if (!obj)
+		return;
+
+	pool->frees++;
+	pool->in_use--;
+
+	if (pool->flags & OBJ_POOL_CLEAR)
+		bin_clear_free(obj, pool->size);
+	else
+		os_free(obj);
+}
+
+
+void obj_pool_deinit_all(void)
+{
+	struct obj_pool *pool;
+
+	dl_list_for_each(pool, &obj_pools, struct obj_pool, list) {
+		if (pool->empty) {
+			obj_pool_slab_free(pool->empty);
+			pool->empty = NULL;
+		}
+		if (pool->in_use)
+			wpa_printf(MSG_DEBUG,
+				   "obj_pool: %u %s object(s) still in use",
+				   pool->in_use, pool->name);
+	}
+}
+
+
+int obj_pool_stats_dump(char *buf, size_t buflen)
+{
+	struct obj_pool *pool;
+	char *pos = buf, *end = buf + buflen;
+	int ret;
+
+	if (buflen)
+		*buf = '\0';
+	dl_list_for_each(pool, &obj_pools, struct obj_pool, list) {
+		ret = os_snprintf(pos, end - pos,
+				  "%s size=%zu in_use=%u max_in_use=%u allocs=%u frees=%u failures=%u slabs=%u max_slabs=%u per_slab=%u\n",
+				  pool->name, pool->size, pool->in_use,
+				  pool->max_in_use, pool->allocs, pool->frees,
+				  pool->failures, pool->slabs, pool->max_slabs,
+				  pool->per_slab);
+		if (os_snprintf_error(end - pos, ret))
+			break;
+		pos += ret;
+	}
+
+	return pos - buf;
+}
@@ -0,0 +1,115 @@
+/*
+ * Fixed-size object pools
+ * Copyright (c) 2026, The hostapd contributors
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef OBJ_POOL_H
+#define OBJ_POOL_H
+
+#include "list.h"
+
+/* Clear objects when they are freed, e.g., for key material */
+#define OBJ_POOL_CLEAR BIT(0)
+
+/*
+ * Object pool for a single object size. Pools are normally defined as static
+ * variables with OBJ_POOL_INIT() next to the code using them. The remaining
+ * fields are internal to obj_pool.c.
+ */
+struct obj_pool {
+	const char *name;
+	size_t size;
+	unsigned int flags;
+
+	struct dl_list list; /* in the list of all pools */
+	struct dl_list partial; /* slabs with free objects */
+	struct dl_list full; /* slabs without free objects */
+	struct obj_pool_slab *empty; /* one fully unused slab kept for reuse */
+	unsigned int per_slab;
+
+	unsigned int in_use;
+	unsigned int max_in_use;
+	unsigned int allocs;
+	unsigned int frees;
+	unsigned int failures;
+	unsigned int slabs;
+	unsigned int max_slabs;
+};
+
+#define OBJ_POOL_INIT(_name, _size, _flags) \
+	{ .name = (_name), .size = (_size), .flags = (_flags) }
+
+#ifdef CONFIG_OBJ_POOL
+
+/**
+ * obj_pool_get - Allocate a zeroed object from pool slabs
+ * @pool: Object pool
+ * Returns: Pointer to the object or %NULL on failure
+ *
+ * This is normally used through obj_pool_zalloc().
+ */
+void * obj_pool_get(struct obj_pool *pool);
+
+/**
+ * obj_pool_put - Return an object from obj_pool_get() to its pool
+ * @pool: Object pool
+ * @obj: Object or %NULL
+ *
+ * This is normally used through obj_pool_free().
+ */
+void obj_pool_put(struct obj_pool *pool, void *obj);
+
+void * obj_pool_tracked_alloc(struct obj_pool *pool, void *obj);
+void obj_pool_tracked_free(struct obj_pool *pool, void *obj);
+
+/**
+ * obj_pool_deinit_all - Free unused slabs of all pools
+ *
+ * This is called at process exit. Slabs with objects still in use are not
+ * freed.
+ */
+void obj_pool_deinit_all(void);
+
+/**
+ * obj_pool_stats_dump - Write object pool statistics into a text buffer
+ * @buf: Buffer for the text
+ * @buflen: Length of the buffer
+ * Returns: Number of octets written
+ *
+ * One line is written for each pool that has been used: the name followed by
+ * space separated name=value pairs.
+ */
+int obj_pool_stats_dump(char *buf, size_t buflen);
+
+#ifdef WPA_TRACE
+/*
+ * Allocate objects individually with WPA_TRACE so that allocation tracking and
+ * allocation failure testing see the actual caller. Pool statistics are still
+ * maintained.
+ */
+#define obj_pool_zalloc(pool) \
+	obj_pool_tracked_alloc((pool), os_zalloc((pool)->size))
+#define obj_pool_free(pool, obj) obj_pool_tracked_free((pool), (obj))
+#else /* WPA_TRACE */
+#define obj_pool_zalloc(pool) obj_pool_get(pool)
+#define obj_pool_free(pool, obj) obj_pool_put((pool), (obj))
+#endif /* WPA_TRACE */
+
+#else /* CONFIG_OBJ_POOL */
+
+#define obj_pool_zalloc(pool) os_zalloc((pool)->size)
+
+static inline void obj_pool_free(struct obj_pool *pool, void *obj)
+{
+	if (obj && (pool->flags & OBJ_POOL_CLEAR))
+		bin_clear_free(obj, pool->size);
+	else
+		os_free(obj);
+}
+
+#endif /* CONFIG_OBJ_POOL */
+
+#endif /* OBJ_POOL_H */
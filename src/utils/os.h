@@ -480,6 +480,8 @@ void * os_malloc(size_t size);
 void * os_realloc(void *ptr, size_t size);
 void os_free(void *ptr);
 char * os_strdup(const char *s);
+/* Number of successful os_malloc() calls, e.g., for benchmarks */
+extern unsigned int wpa_trace_alloc_count;
 #else /* WPA_TRACE */
 #ifndef os_malloc
 #define os_malloc(s) malloc((s))
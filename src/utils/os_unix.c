@@ -33,6 +33,7 @@
 #include "list.h"
 
 static struct dl_list alloc_list = DL_LIST_HEAD_INIT(alloc_list);
+unsigned int wpa_trace_alloc_count;
 
 #define ALLOC_MAGIC 0xa84ef1b2
 #define FREED_MAGIC 0x67fd487a
@@ -715,6 +716,7 @@ void * os_malloc(size_t size)
 	a = malloc(sizeof(*a) + size);
 	if (a == NULL)
 		return NULL;
+	wpa_trace_alloc_count++;
 	a->magic = ALLOC_MAGIC;
 	dl_list_add(&alloc_list, &a->list);
 	a->len = size;
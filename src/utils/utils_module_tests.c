@@ -18,6 +18,7 @@
 #include "utils/ip_addr.h"
 #include "utils/eloop.h"
 #include "utils/json.h"
+#include "utils/obj_pool.h"
 #include "utils/module_tests.h"
 
 
@@ -1209,6 +1210,81 @@ static int const_time_tests(void)
 }
 
 
+#ifdef CONFIG_OBJ_POOL
+static int obj_pool_tests(void)
+{
+	static struct obj_pool pool =
+		OBJ_POOL_INIT("obj_pool_test", 100, OBJ_POOL_CLEAR);
+	u8 *obj[70];
+	char *buf;
+	unsigned int i, j;
+	int ret = -1;
+
+	wpa_printf(MSG_INFO, "obj_pool tests");
+
+	for (i = 0; i < ARRAY_SIZE(obj); i++) {
+		obj[i] = obj_pool_get(&pool);
+		if (!obj[i])
+			goto fail;
+		for (j = 0; j < pool.size; j++) {
+			if (obj[i][j])
+				goto fail;
+		}
+		for (j = 0; j < i; j++) {
+			if (obj[i] + pool.size > obj[j] &&
+			    obj[j] + pool.size > obj[i])
+				goto fail;
+		}
+		os_memset(obj[i], 0xa5, pool.size);
+	}
+	if (pool.in_use != ARRAY_SIZE(obj) || pool.slabs < 2)
+		goto fail;
+
+	obj_pool_put(&pool, obj[0]);
+	for (j = sizeof(void *); j < pool.size; j++) {
+		if (obj[0][j])
+			goto fail;
+	}
+
+	/* Double free is detected and ignored */
+	obj_pool_put(&pool, obj[0]);
+	if (pool.frees != 1 || pool.in_use != ARRAY_SIZE(obj) - 1)
+		goto fail;
+
+	/* The freed object is reused */
+	if (obj_pool_get(&pool) != obj[0] || obj[0][0])
+		goto fail;
+
+	for (i = 0; i < ARRAY_SIZE(obj); i++)
+		obj_pool_put(&pool, obj[i]);
+	if (pool.in_use != 0 || pool.slabs != 1 ||
+	    pool.allocs != ARRAY_SIZE(obj) + 1 ||
+	    pool.frees != ARRAY_SIZE(obj) + 1 ||
+	    pool.max_in_use != ARRAY_SIZE(obj))
+		goto fail;
+
+	buf = os_malloc(4096);
+	if (!buf)
+		goto fail;
+	obj_pool_stats_dump(buf, 4096);
+	if (!os_strstr(buf, "obj_pool_test size=100 in_use=0 max_in_use=70 ")) {
+		os_free(buf);
+		goto fail;
+	}
+	os_free(buf);
+
+	ret = 0;
+fail:
+	if (ret) {
+		wpa_printf(MSG_ERROR, "obj_pool test failed");
+		return ret;
+	}
+	obj_pool_deinit_all();
+	return ret;
+}
+#endif /* CONFIG_OBJ_POOL */
+
+
 int utils_module_tests(void)
 {
 	int ret = 0;
@@ -1229,6 +1305,10 @@ int utils_module_tests(void)
 	    const_time_tests() < 0 ||
 	    int_array_tests() < 0)
 		ret = -1;
+#ifdef CONFIG_OBJ_POOL
+	if (obj_pool_tests() < 0)
+		ret = -1;
+#endif /* CONFIG_OBJ_POOL */
 
 	return ret;
 }
@@ -10,6 +10,7 @@
 
 #include "common.h"
 #include "trace.h"
+#include "obj_pool.h"
 #include "wpabuf.h"
 
 #ifdef WPA_TRACE
@@ -26,6 +27,30 @@ static struct wpabuf_trace * wpabuf_get_trace(const struct wpabuf *buf)
 }
 #endif /* WPA_TRACE */
 
+#if defined(CONFIG_OBJ_POOL) && !defined(WPA_TRACE)
+/*
+ * Small buffers are allocated from size class pools. The size of a pooled
+ * buffer is never changed, so the size class can be determined from it.
+ */
+#define WPABUF_POOL(len) \
+	OBJ_POOL_INIT("wpabuf" #len, sizeof(struct wpabuf) + (len), 0)
+
+static struct obj_pool wpabuf_pools[] = {
+	WPABUF_POOL(64), WPABUF_POOL(256), WPABUF_POOL(1024)
+};
+
+static struct obj_pool * wpabuf_pool(size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(wpabuf_pools); i++) {
+		if (len <= wpabuf_pools[i].size - sizeof(struct wpabuf))
+			return &wpabuf_pools[i];
+	}
+	return NULL;
+}
+#endif /* CONFIG_OBJ_POOL && !WPA_TRACE */
+
 
 static void wpabuf_overflow(const struct wpabuf *buf, size_t len)
 {
@@ -68,6 +93,18 @@ int wpabuf_resize(struct wpabuf **_buf, size_t add_len)
 
 	if (buf->used + add_len > buf->size) {
 		unsigned char *nbuf;
+#if defined(CONFIG_OBJ_POOL) && !defined(WPA_TRACE)
+		if (buf->flags & WPABUF_FLAG_POOL) {
+			struct wpabuf *n = wpabuf_alloc(buf->used + add_len);
+
+			if (!n)
+				return -1;
+			wpabuf_put_buf(n, buf);
+			wpabuf_free(buf);
+			*_buf = n;
+			return 0;
+		}
+#endif /* CONFIG_OBJ_POOL && !WPA_TRACE */
 		if (buf->flags & WPABUF_FLAG_EXT_DATA) {
 			nbuf = os_realloc(buf->buf, buf->used + add_len);
 			if (nbuf == NULL)
@@ -121,7 +158,20 @@ struct wpabuf * wpabuf_alloc(size_t len)
 	trace->magic = WPABUF_MAGIC;
 	buf = (struct wpabuf *) (trace + 1);
 #else /* WPA_TRACE */
-	struct wpabuf *buf = os_zalloc(sizeof(struct wpabuf) + len);
+	struct wpabuf *buf;
+#ifdef CONFIG_OBJ_POOL
+	struct obj_pool *pool = wpabuf_pool(len);
+
+	if (pool) {
+		buf = obj_pool_zalloc(pool);
+		if (buf)
+			buf->flags = WPABUF_FLAG_POOL;
+	} else {
+		buf = os_zalloc(sizeof(struct wpabuf) + len);
+	}
+#else /* CONFIG_OBJ_POOL */
+	buf = os_zalloc(sizeof(struct wpabuf) + len);
+#endif /* CONFIG_OBJ_POOL */
 	if (buf == NULL)
 		return NULL;
 #endif /* WPA_TRACE */
@@ -198,6 +248,12 @@ void wpabuf_free(struct wpabuf *buf)
 #else /* WPA_TRACE */
 	if (buf == NULL)
 		return;
+#ifdef CONFIG_OBJ_POOL
+	if (buf->flags & WPABUF_FLAG_POOL) {
+		obj_pool_free(wpabuf_pool(buf->size), buf);
+		return;
+	}
+#endif /* CONFIG_OBJ_POOL */
 	if (buf->flags & WPABUF_FLAG_EXT_DATA)
 		os_free(buf->buf);
 	os_free(buf);
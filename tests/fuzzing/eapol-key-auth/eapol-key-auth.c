@@ -83,11 +83,15 @@ static u8 * read_msg(struct wpa *wpa, size_t *ret_len)
 static void auth_eapol_rx(void *eloop_data, void *user_ctx)
 {
 	struct wpa *wpa = eloop_data;
+	u8 *eapol = wpa->supp_eapol;
 
 	wpa_printf(MSG_DEBUG, "AUTH: RX EAPOL frame");
 	wpa->auth_sent = 0;
-	wpa_receive(wpa->auth_group, wpa->auth, wpa->supp_eapol,
-		    wpa->supp_eapol_len);
+	/* The frame buffer needs to remain valid during wpa_receive() even if
+	 * the next message is read from auth_send_eapol(). */
+	wpa->supp_eapol = NULL;
+	wpa_receive(wpa->auth_group, wpa->auth, eapol, wpa->supp_eapol_len);
+	os_free(eapol);
 	if (!wpa->auth_sent) {
 		/* Speed up process by not going through retransmit timeout */
 		wpa_printf(MSG_DEBUG,
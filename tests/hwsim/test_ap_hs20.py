@@ -4349,10 +4349,33 @@ def _test_ap_hs20_proxyarp(dev, apdev):
         raise Exception("dev1 addr(1) missing")
     if 'aaaa:bbbb:eeee::2 dev ap-br0 lladdr 02:00:00:00:01:00 PERMANENT' not in matches:
         raise Exception("dev1 addr(2) missing")
-    dev[0].request("DISCONNECT")
+
+    # Address claimed by another STA moves to that STA
+    hapd.dump_monitor()
+    pkt = build_ns(src_ll=addr0, ip_src="aaaa:bbbb:eeee::2",
+                   ip_dst="ff02::1:ff00:2", target="aaaa:bbbb:eeee::2",
+                   opt=src_ll_opt0)
+    if "OK" not in dev[0].request("DATA_TEST_FRAME " + binascii.hexlify(pkt).decode()):
+        raise Exception("DATA_TEST_FRAME failed")
+    ev = hapd.wait_event(["AP-STA-IP-CONFLICT"], timeout=5)
+    if ev is None:
+        raise Exception("IP address conflict not reported")
+    if addr0 not in ev or "ip=aaaa:bbbb:eeee::2" not in ev or \
+       "prev_sta=" + addr1 not in ev:
+        raise Exception("Unexpected conflict event: " + ev)
+
     dev[1].request("DISCONNECT")
     time.sleep(0.5)
     matches = get_permanent_neighbors("ap-br0")
+    logger.info("After dev1 disconnect: " + str(matches))
+    if len(matches) != 2:
+        raise Exception("Unexpected number of neighbor entries after dev1 disconnect")
+    if 'aaaa:bbbb:eeee::2 dev ap-br0 lladdr 02:00:00:00:00:00 PERMANENT' not in matches:
+        raise Exception("dev0 addr(2) missing")
+
+    dev[0].request("DISCONNECT")
+    time.sleep(0.5)
+    matches = get_permanent_neighbors("ap-br0")
     logger.info("After disconnect: " + str(matches))
     if len(matches) > 0:
         raise Exception("Unexpected neighbor entries after disconnect")
@@ -5456,10 +5479,25 @@ def run_proxyarp_errors(dev, apdev, params):
 
     pkt = build_ra(src_ll=apdev[0]['bssid'], ip_src="aaaa:bbbb:cccc::33",
                    ip_dst="ff01::1")
-    with fail_test(hapd, 1, "x_snoop_mcast_to_ucast_convert_send"):
+    # A single STA is sent to without batching
+    with fail_test(hapd, 1, "l2_packet_send;x_snoop_ucast_send;x_snoop_mcast_to_ucast_fanout"):
         if "OK" not in hapd.request("DATA_TEST_FRAME ifname=ap-br0 " + binascii.hexlify(pkt).decode()):
             raise Exception("DATA_TEST_FRAME failed")
-        wait_fail_trigger(dev[0], "GET_FAIL")
+        wait_fail_trigger(hapd, "GET_FAIL")
+    mib = hapd.get_mib("x_snoop")
+    if mib['mcastToUcastUnicastFailures'] != '1':
+        raise Exception("Unicast send failure not counted: " + str(mib))
+
+    # Frames not sent in a batch are sent one by one
+    dev[1].connect("open", key_mgmt="NONE", scan_freq="2412")
+    with fail_test(hapd, 1, "l2_packet_send_multi;x_snoop_mcast_to_ucast_fanout"):
+        if "OK" not in hapd.request("DATA_TEST_FRAME ifname=ap-br0 " + binascii.hexlify(pkt).decode()):
+            raise Exception("DATA_TEST_FRAME failed")
+        wait_fail_trigger(hapd, "GET_FAIL")
+    mib2 = hapd.get_mib("x_snoop")
+    if int(mib2['mcastToUcastUnicastFrames']) != int(mib['mcastToUcastUnicastFrames']) + 2 or \
+       mib2['mcastToUcastUnicastBatched'] != mib['mcastToUcastUnicastBatched']:
+        raise Exception("Unexpected unicast fallback counters: " + str(mib2))
 
     with alloc_fail(hapd, 1, "sta_ip6addr_add"):
         src_ll_opt0 = b"\x01\x01" + binascii.unhexlify(addr0.replace(':', ''))
@@ -5470,6 +5508,70 @@ def run_proxyarp_errors(dev, apdev, params):
             raise Exception("DATA_TEST_FRAME failed")
         wait_fail_trigger(dev[0], "GET_ALLOC_FAIL")
 
+def test_proxyarp_mcast_to_ucast_mib(dev, apdev, params):
+    """ProxyARP multicast-to-unicast conversion MIB counters"""
+    try:
+        run_proxyarp_mcast_to_ucast_mib(dev, apdev, params)
+    finally:
+        subprocess.call(['ip', 'link', 'set', 'dev', 'ap-br0', 'down'],
+                        stderr=open('/dev/null', 'w'))
+        subprocess.call(['brctl', 'delbr', 'ap-br0'],
+                        stderr=open('/dev/null', 'w'))
+
+def run_proxyarp_mcast_to_ucast_mib(dev, apdev, params):
+    params = {'ssid': 'open',
+              'proxy_arp': '1',
+              'ap_isolate': '1',
+              'bridge': 'ap-br0',
+              'disable_dgaf': '1',
+              'proxy_arp_mcast_to_ucast_limit': '2'}
+    hapd = hostapd.add_ap(apdev[0], params, no_enable=True)
+    try:
+        hapd.enable()
+    except:
+        # For now, do not report failures due to missing kernel support
+        raise HwsimSkip("Could not start hostapd - assume proxyarp not supported in kernel version")
+    ev = hapd.wait_event(["AP-ENABLED", "AP-DISABLED"], timeout=10)
+    if ev is None:
+        raise Exception("AP startup timed out")
+    if "AP-ENABLED" not in ev:
+        raise Exception("AP startup failed")
+
+    subprocess.call(['brctl', 'setfd', 'ap-br0', '0'])
+    subprocess.call(['ip', 'link', 'set', 'dev', 'ap-br0', 'up'])
+
+    mib = hapd.get_mib("x_snoop")
+    for name in ["mcastToUcastFrames", "mcastToUcastRateLimited",
+                 "mcastToUcastUnicastFrames", "mcastToUcastUnicastBatched",
+                 "mcastToUcastUnicastFailures"]:
+        if mib.get(name) != '0':
+            raise Exception("Unexpected initial %s: %s" % (name, str(mib)))
+
+    dev[0].connect("open", key_mgmt="NONE", scan_freq="2412")
+    dev[1].connect("open", key_mgmt="NONE", scan_freq="2412")
+
+    # Three RAs within one second with a limit of two converted frames per
+    # second
+    pkt = build_ra(src_ll=apdev[0]['bssid'], ip_src="aaaa:bbbb:cccc::33",
+                   ip_dst="ff01::1")
+    for i in range(3):
+        if "OK" not in hapd.request("DATA_TEST_FRAME ifname=ap-br0 " + binascii.hexlify(pkt).decode()):
+            raise Exception("DATA_TEST_FRAME failed")
+    for i in range(20):
+        mib = hapd.get_mib("x_snoop")
+        if int(mib['mcastToUcastFrames']) + \
+           int(mib['mcastToUcastRateLimited']) >= 3:
+            break
+        time.sleep(0.1)
+    logger.info("x_snoop MIB: " + str(mib))
+    if mib['mcastToUcastFrames'] != '2' or \
+       mib['mcastToUcastRateLimited'] != '1':
+        raise Exception("Unexpected rate limit counters: " + str(mib))
+    if mib['mcastToUcastUnicastFrames'] != '4' or \
+       mib['mcastToUcastUnicastBatched'] != '4' or \
+       mib['mcastToUcastUnicastFailures'] != '0':
+        raise Exception("Unexpected unicast counters: " + str(mib))
+
 def test_ap_hs20_connect_deinit(dev, apdev):
     """Hotspot 2.0 connection interrupted with deinit"""
     check_eap_capa(dev[0], "MSCHAPV2")
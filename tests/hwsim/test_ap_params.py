@@ -473,6 +473,56 @@ def test_ap_inactivity_disconnect(dev, apdev):
     if ev is None:
         raise Exception("STA disconnection on inactivity was not reported")
 
+def test_ap_inactivity_timer_slack(dev, apdev):
+    """AP using inactivity disconnect with housekeeping timer slack"""
+    ssid = "test-wpa2-psk"
+    passphrase = 'qwertyuiop'
+    params = hostapd.wpa2_params(ssid=ssid, passphrase=passphrase)
+    params['ap_max_inactivity'] = "3"
+    params['skip_inactivity_poll'] = "1"
+    params['housekeeping_timer_slack'] = "3000"
+    hapd = hostapd.add_ap(apdev[0], params)
+    dev[0].connect(ssid, psk=passphrase, scan_freq="2412")
+    start = time.time()
+    dev[1].connect(ssid, psk=passphrase, scan_freq="2412")
+    hapd.set("ext_mgmt_frame_handling", "1")
+    for i in range(2):
+        dev[i].request("DISCONNECT")
+        ev = hapd.wait_event(["MGMT-RX"], timeout=5)
+        if ev is None:
+            raise Exception("MGMT RX wait timed out for Deauth")
+    hapd.set("ext_mgmt_frame_handling", "0")
+    # The inactivity timers of the two stations expire less than the slack
+    # apart and hostapd is idle in between, so they must run in one wakeup.
+    stats = "OK" in hapd.request("ELOOP_STATS RESET")
+    if stats and time.time() - start > 2.5:
+        raise Exception("Stations connected too far apart")
+    for i in range(2):
+        ev = hapd.wait_event(["AP-STA-DISCONNECTED"], timeout=30)
+        if ev is None:
+            raise Exception("STA disconnection on inactivity was not reported")
+    if not stats:
+        logger.info("ELOOP_STATS not supported - timer coalescing not checked")
+        return
+    res = hapd.request("ELOOP_STATS")
+    vals = {}
+    for line in res.splitlines():
+        if line.startswith("handler="):
+            continue
+        name, val = line.split('=', 1)
+        vals[name] = val
+    if int(vals["max_coalesced"]) < 2:
+        raise Exception("Inactivity timers were not coalesced: " + res)
+
+def test_ap_invalid_timer_slack(dev, apdev):
+    """AP with invalid housekeeping_timer_slack"""
+    hapd = hostapd.add_ap(apdev[0], {"ssid": "test"}, no_enable=True)
+    for val in ["-1", "60001"]:
+        if "FAIL" not in hapd.request("SET housekeeping_timer_slack " + val):
+            raise Exception("Invalid housekeeping_timer_slack accepted: " + val)
+    if "OK" not in hapd.request("SET housekeeping_timer_slack 500"):
+        raise Exception("Valid housekeeping_timer_slack rejected")
+
 @remote_compatible
 def test_ap_basic_rates(dev, apdev):
     """Open AP with lots of basic rates"""
@@ -112,6 +112,80 @@ def check_disconnect(dev, expected):
             dev[i].request("REMOVE_NETWORK all")
             dev[i].wait_disconnected()
 
+def test_ap_wpa2_psk_file_scale(dev, apdev, params):
+    """WPA2-PSK AP with 10000 PSKs in wpa_psk_file"""
+    psk_file = os.path.join(params['logdir'], 'ap_wpa2_psk_file_scale.wpa_psk')
+    num = 10000
+    with open(psk_file, 'w') as f:
+        for i in range(num):
+            f.write('00:00:00:00:00:00 %064x\n' % i)
+        f.write('%s %064x\n' % (dev[0].own_addr(), num))
+    ssid = "test-wpa2-psk"
+    params = hostapd.wpa2_params(ssid=ssid, passphrase='qwertyuiop')
+    params['wpa_psk_file'] = psk_file
+    hapd = hostapd.add_ap(apdev[0], params)
+
+    # Station specific PSK after all the group PSKs
+    start = time.time()
+    dev[0].connect(ssid, raw_psk="%064x" % num, scan_freq="2412")
+    logger.info("Station specific PSK connection: %.3f s" %
+                (time.time() - start))
+
+    # One of the last group PSKs to be tried
+    start = time.time()
+    dev[1].connect(ssid, raw_psk="%064x" % 0, scan_freq="2412")
+    logger.info("Group PSK connection with %d candidates: %.3f s" %
+                (num, time.time() - start))
+
+    dev[2].connect(ssid, raw_psk="%064x" % num, scan_freq="2412",
+                   wait_connect=False)
+    ev = dev[2].wait_event(["CTRL-EVENT-CONNECTED",
+                            "WPA: 4-Way Handshake failed"], timeout=20)
+    if ev is None or "CTRL-EVENT-CONNECTED" in ev:
+        raise Exception("Station specific PSK accepted for another STA")
+    dev[2].request("REMOVE_NETWORK all")
+
+def test_ap_wpa2_psk_file_cache(dev, apdev, params):
+    """WPA2-PSK AP with PSKs from a file and PSK cache"""
+    psk_file = os.path.join(params['logdir'], 'ap_wpa2_psk_file_cache.wpa_psk')
+    cache = os.path.join(params['logdir'], 'ap_wpa2_psk_file_cache.cache')
+    with open(psk_file, 'w') as f:
+        for i in range(100):
+            f.write('00:00:00:00:00:00 passphrase %d\n' % i)
+    ssid = "test-wpa2-psk"
+    params = hostapd.wpa2_params(ssid=ssid, passphrase='qwertyuiop')
+    params['wpa_psk_file'] = psk_file
+    params['wpa_psk_cache'] = cache
+    hapd = hostapd.add_ap(apdev[0], params)
+
+    with open(cache, 'r') as f:
+        lines = f.read().splitlines()
+    if len(lines) != 1 + 101 or lines[0] != "hostapd-wpa-psk-cache":
+        raise Exception("Unexpected PSK cache contents")
+    dev[0].connect(ssid, psk="passphrase 42", scan_freq="2412")
+
+    with open(psk_file, 'w') as f:
+        for i in range(100):
+            f.write('00:00:00:00:00:00 passphrase %d\n' % (i + 50))
+    start = time.time()
+    if "OK" not in hapd.request("RELOAD_WPA_PSK"):
+        raise Exception("RELOAD_WPA_PSK failed")
+    logger.info("RELOAD_WPA_PSK with 50 cached PSKs: %.3f s" %
+                (time.time() - start))
+
+    with open(cache, 'r') as f:
+        lines = f.read().splitlines()
+    if len(lines) != 1 + 101:
+        raise Exception("Unused PSK cache entries not removed")
+    dev[1].connect(ssid, psk="passphrase 149", scan_freq="2412")
+    dev[2].connect(ssid, psk="passphrase 42", scan_freq="2412",
+                   wait_connect=False)
+    ev = dev[2].wait_event(["CTRL-EVENT-CONNECTED",
+                            "WPA: 4-Way Handshake failed"], timeout=20)
+    if ev is None or "CTRL-EVENT-CONNECTED" in ev:
+        raise Exception("Removed passphrase accepted")
+    dev[2].request("REMOVE_NETWORK all")
+
 def test_ap_wpa2_psk_file_keyid(dev, apdev, params):
     """WPA2-PSK AP with PSK from a file (keyid and reload)"""
     psk_file = os.path.join(params['logdir'], 'ap_wpa2_psk_file_keyid.wpa_psk')
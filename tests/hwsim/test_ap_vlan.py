@@ -377,6 +377,44 @@ def test_ap_vlan_tagged(dev, apdev):
     if filename.startswith('/tmp/'):
         os.unlink(filename)
 
+def test_ap_vlan_pool(dev, apdev):
+    """AP VLAN with pre-provisioned VLAN bridges"""
+    filename = hostapd.acl_file(dev, apdev, 'hostapd.accept')
+    hostapd.send_file(apdev[0], filename, filename)
+    params = {"ssid": "test-vlan-open",
+              "dynamic_vlan": "1",
+              "vlan_tagged_interface": "lo",
+              "vlan_pool": "1-3",
+              "accept_mac_file": filename}
+    hapd = hostapd.add_ap(apdev[0], params)
+    try:
+        for vlan_id in range(1, 4):
+            if not iface_is_in_bridge("brlo.%d" % vlan_id,
+                                      "vlan%d" % vlan_id):
+                raise Exception("VLAN %d not pre-provisioned" % vlan_id)
+
+        dev[0].connect("test-vlan-open", key_mgmt="NONE", scan_freq="2412")
+        dev[1].connect("test-vlan-open", key_mgmt="NONE", scan_freq="2412")
+        hwsim_utils.test_connectivity_iface(dev[0], hapd, "brlo.1")
+        hwsim_utils.test_connectivity_iface(dev[1], hapd, "brlo.2")
+
+        dev[0].request("DISCONNECT")
+        dev[0].wait_disconnected()
+        ev = hapd.wait_event(["AP-STA-DISCONNECTED"], timeout=5)
+        if ev is None:
+            raise Exception("No disconnection event on AP")
+        time.sleep(0.5)
+        if not iface_is_in_bridge("brlo.1", "vlan1"):
+            raise Exception("Pre-provisioned VLAN removed with the last STA")
+
+        hapd.disable()
+        for vlan_id in range(1, 4):
+            if os.path.exists("/sys/class/net/brlo.%d" % vlan_id):
+                raise Exception("Bridge for VLAN %d not removed" % vlan_id)
+    finally:
+        if filename.startswith('/tmp/'):
+            os.unlink(filename)
+
 def ap_vlan_iface_cleanup_multibss_cleanup():
     subprocess.call(['ifconfig', 'stub0', 'down'],
                     stderr=open('/dev/null', 'w'))
@@ -226,6 +226,8 @@ def test_bgscan_learn(dev, apdev):
             raise Exception("Missing BSS1->BSS2 neighbor entry")
         if 'NEIGHBOR 02:00:00:00:04:00 02:00:00:00:03:00' not in lines:
             raise Exception("Missing BSS2->BSS1 neighbor entry")
+        if not any(l.startswith("CHAN 2412 ") for l in lines):
+            raise Exception("Missing channel statistics entry")
 
         dev[1].set_network(id, "scan_freq", "")
         dev[1].connect_network(id)
@@ -245,6 +247,50 @@ def test_bgscan_learn(dev, apdev):
         except:
             pass
 
+def test_bgscan_learn_plan(dev, apdev, params):
+    """bgscan_learn planned per-channel scan frequencies"""
+    hostapd.add_ap(apdev[0], {"ssid": "bgscan"})
+    bssid = apdev[0]['bssid']
+    fname = params['prefix'] + ".bgscan"
+    with open(fname, "w") as f:
+        f.write("wpa_supplicant-bgscan-learn\n")
+        f.write("BSS %s 2412\n" % bssid)
+        f.write("BSS 02:11:22:33:44:01 2437\n")
+        f.write("BSS 02:11:22:33:44:02 2462\n")
+        f.write("NEIGHBOR %s 02:11:22:33:44:01\n" % bssid)
+        f.write("NEIGHBOR %s 02:11:22:33:44:02\n" % bssid)
+        f.write("CHAN 2437 2560\n")
+        f.write("CHAN 2462 16\n")
+
+    dev[0].connect("bgscan", key_mgmt="NONE",
+                   bgscan="learn:1:-20:2:" + fname)
+    for i in range(2):
+        ev = dev[0].wait_event(["CTRL-EVENT-SCAN-RESULTS"], timeout=10)
+        if ev is None:
+            raise Exception("Background scan did not complete")
+    dev[0].request("REMOVE_NETWORK all")
+    dev[0].wait_disconnected()
+
+    dev[0].relog()
+    scans = []
+    with open(os.path.join(params['logdir'], 'log0'), 'r') as f:
+        for l in f.readlines():
+            if "bgscan learn: Scanning frequencies:" in l:
+                scans.append(l.strip().split(':')[-1].split())
+    if len(scans) < 2:
+        raise Exception("Background scan frequencies not found in debug log")
+
+    # The first background scan covers all learned channels and the next one
+    # only the channel that has most of the hit score, both with one probe.
+    logger.info("Background scans: " + str(scans[0:2]))
+    for freq in ["2412", "2437", "2462"]:
+        if freq not in scans[0]:
+            raise Exception("Learned channel %s not scanned: %s" % (freq, str(scans[0])))
+    if len(scans[0]) != 4:
+        raise Exception("Unexpected full scan frequencies: " + str(scans[0]))
+    if len(scans[1]) != 2 or scans[1][0] != "2437":
+        raise Exception("Unexpected planned scan frequencies: " + str(scans[1]))
+
 def test_bgscan_learn_beacon_loss(dev, apdev):
     """bgscan_simple and beacon loss"""
     params = hostapd.wpa2_params(ssid="bgscan", passphrase="12345678")
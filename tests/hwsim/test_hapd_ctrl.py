@@ -684,6 +684,60 @@ def test_hapd_ctrl_log_level(dev, apdev):
     if "Timestamp: 1" not in level:
         raise Exception("Unexpected timestamp(3): " + level)
 
+def test_hapd_ctrl_eloop_stats(dev, apdev):
+    """hostapd ctrl_iface ELOOP_STATS"""
+    hapd = hostapd.add_ap(apdev[0], {"ssid": "open"})
+    if "OK" not in hapd.request("ELOOP_STATS RESET"):
+        raise HwsimSkip("ELOOP_STATS not supported")
+    dev[0].connect("open", key_mgmt="NONE", scan_freq="2412")
+    res = hapd.request("ELOOP_STATS")
+    vals = {}
+    for line in res.splitlines():
+        if line.startswith("handler="):
+            continue
+        name, val = line.split('=', 1)
+        vals[name] = val
+    for name in ["uptime", "iterations", "timeouts", "max_timeouts",
+                 "max_ready", "max_coalesced", "timeout_late_hist"]:
+        if name not in vals:
+            raise Exception("Missing %s in ELOOP_STATS: %s" % (name, res))
+    if int(vals["iterations"]) == 0:
+        raise Exception("No event loop iterations reported")
+    if "type=sock" not in res:
+        raise Exception("No socket handlers reported")
+    if len(vals["timeout_late_hist"].split(',')) != 7:
+        raise Exception("Unexpected timeout lateness histogram: " + res)
+
+def pool_stats(hapd):
+    res = hapd.request("POOL_STATS")
+    pools = {}
+    for line in res.splitlines():
+        name, vals = line.split(' ', 1)
+        pools[name] = dict(v.split('=') for v in vals.split())
+    return pools
+
+def test_hapd_ctrl_pool_stats(dev, apdev):
+    """hostapd ctrl_iface POOL_STATS"""
+    hapd = hostapd.add_ap(apdev[0], {"ssid": "open"})
+    if "UNKNOWN COMMAND" in hapd.request("POOL_STATS"):
+        raise HwsimSkip("POOL_STATS not supported")
+    dev[0].connect("open", key_mgmt="NONE", scan_freq="2412")
+    hapd.wait_sta()
+    pools = pool_stats(hapd)
+    if "sta_info" not in pools or "eloop_timeout" not in pools:
+        raise Exception("Missing pools: " + str(pools))
+    sta = pools["sta_info"]
+    if int(sta["in_use"]) != 1 or int(sta["allocs"]) < 1:
+        raise Exception("Unexpected sta_info pool state: " + str(sta))
+    dev[0].request("DISCONNECT")
+    dev[0].wait_disconnected()
+    ev = hapd.wait_event(["AP-STA-DISCONNECTED"], timeout=5)
+    if ev is None:
+        raise Exception("No AP-STA-DISCONNECTED event")
+    sta = pool_stats(hapd)["sta_info"]
+    if int(sta["in_use"]) != 0 or sta["allocs"] != sta["frees"]:
+        raise Exception("sta_info not returned to pool: " + str(sta))
+
 @remote_compatible
 def test_hapd_ctrl_disconnect_no_tx(dev, apdev):
     """hostapd disconnecting STA without transmitting Deauth/Disassoc"""
@@ -4,6 +4,8 @@
 # This software may be distributed under the terms of the BSD license.
 # See README for more details.
 
+import logging
+logger = logging.getLogger()
 import os
 import time
 
@@ -20,6 +22,9 @@ def test_module_wpa_supplicant(dev, apdev, params):
         res = f.read()
         if "FAIL - should not have called this function" in res:
             raise Exception("eloop test failed")
+    for line in res.splitlines():
+        if "scan sort: " in line:
+            logger.info("Scan sort benchmark: " + line.split("scan sort: ")[1])
 
 def test_module_hostapd(dev):
     """hostapd module tests"""
@@ -1562,14 +1562,17 @@ def test_sae_bignum_failure(dev, apdev):
              (1, "crypto_ec_point_mul;sae_derive_commit_element_ecc"),
              (1, "crypto_ec_point_invert;sae_derive_commit_element_ecc"),
              (1, "crypto_bignum_init;=sae_derive_commit"),
-             (1, "crypto_ec_point_init;sae_derive_k_ecc"),
+             (1, "crypto_scratch_bignum;=sae_derive_commit"),
+             (1, "crypto_scratch_init;sae_prepare_commit"),
+             (1, "crypto_scratch_point;sae_derive_k_ecc"),
              (1, "crypto_ec_point_mul;sae_derive_k_ecc"),
              (1, "crypto_ec_point_add;sae_derive_k_ecc"),
              (2, "crypto_ec_point_mul;sae_derive_k_ecc"),
              (1, "crypto_ec_point_to_bin;sae_derive_k_ecc"),
              (1, "crypto_bignum_legendre;dragonfly_get_random_qr_qnr"),
              (1, "sha256_prf;sae_derive_keys"),
-             (1, "crypto_bignum_init;sae_derive_keys"),
+             (1, "crypto_scratch_bignum;sae_derive_keys"),
+             (1, "crypto_scratch_init;sae_process_commit"),
              (1, "crypto_bignum_init_set;sae_parse_commit_scalar"),
              (1, "crypto_bignum_to_bin;sae_parse_commit_element_ecc"),
              (1, "crypto_ec_point_from_bin;sae_parse_commit_element_ecc")]
@@ -1594,7 +1597,7 @@ def test_sae_bignum_failure(dev, apdev):
              (1, "crypto_bignum_init;sae_derive_commit_element_ffc"),
              (1, "crypto_bignum_exptmod;sae_derive_commit_element_ffc"),
              (1, "crypto_bignum_inverse;sae_derive_commit_element_ffc"),
-             (1, "crypto_bignum_init;sae_derive_k_ffc"),
+             (1, "crypto_scratch_bignum;sae_derive_k_ffc"),
              (1, "crypto_bignum_exptmod;sae_derive_k_ffc"),
              (1, "crypto_bignum_mulmod;sae_derive_k_ffc"),
              (2, "crypto_bignum_exptmod;sae_derive_k_ffc"),
@@ -206,6 +206,56 @@ def test_scan_bss_expiration_age(dev, apdev):
     finally:
         dev[0].request("BSS_EXPIRE_AGE 180")
 
+def write_bss_cache_config(config, cache, disabled, max_age=None):
+    with open(config, "w") as f:
+        f.write("bss_cache_file=" + cache + "\n")
+        if max_age is not None:
+            f.write("bss_cache_max_age=%d\n" % max_age)
+        f.write("network={\n")
+        f.write("\tssid=\"test-scan\"\n")
+        f.write("\tkey_mgmt=NONE\n")
+        f.write("\tdisabled=%d\n" % disabled)
+        f.write("}\n")
+
+def test_scan_bss_cache_file(dev, apdev, params):
+    """BSS table stored over interface removal with bss_cache_file"""
+    cache = params['prefix'] + ".bss"
+    config = params['prefix'] + ".conf.wlan5"
+    write_bss_cache_config(config, cache, 1)
+
+    hapd = hostapd.add_ap(apdev[0], {"ssid": "test-scan"})
+    bssid = apdev[0]['bssid']
+    wpas = WpaSupplicant(global_iface='/tmp/wpas-wlan5')
+    wpas.interface_add("wlan5", config=config)
+    if os.path.exists(cache + ".wlan5"):
+        raise Exception("BSS cache file written for an empty BSS table")
+    wpas.scan_for_bss(bssid, freq="2412")
+    wpas.interface_remove("wlan5")
+    if not os.path.exists(cache + ".wlan5"):
+        raise Exception("BSS cache file not written")
+
+    hapd2 = hostapd.add_ap(apdev[1], {"ssid": "test-scan2", "channel": "11"})
+    bssid2 = apdev[1]['bssid']
+    write_bss_cache_config(config, cache, 0)
+    wpas.interface_add("wlan5", config=config)
+    bss = wpas.get_bss(bssid)
+    if bss is None or bss['ssid'] != "test-scan" or bss['freq'] != "2412":
+        raise Exception("BSS entry not loaded from cache: " + str(bss))
+    ev = wpas.wait_event(["CTRL-EVENT-SCAN-RESULTS"], timeout=15)
+    if ev is None:
+        raise Exception("First scan did not complete")
+    if wpas.get_bss(bssid2) is not None:
+        raise Exception("First scan not limited to the cached channels")
+    wpas.wait_connected()
+    wpas.scan_for_bss(bssid2, freq="2462")
+    wpas.interface_remove("wlan5")
+
+    write_bss_cache_config(config, cache, 1, max_age=0)
+    time.sleep(1.1)
+    wpas.interface_add("wlan5", config=config)
+    if wpas.get_bss(bssid) is not None:
+        raise Exception("Too old BSS entry loaded from cache")
+
 @remote_compatible
 def test_scan_filter(dev, apdev):
     """Filter scan results based on SSID"""
@@ -1198,6 +1248,16 @@ def test_scan_fail_type_only(dev, apdev):
     hapd = hostapd.add_ap(apdev[0], {"ssid": "open"})
     dev[0].connect("open", key_mgmt="NONE", scan_freq="2412")
 
+def test_scan_sort_alloc_fail(dev, apdev):
+    """Scan result sorting with allocation failure"""
+    hostapd.add_ap(apdev[0], {"ssid": "open"})
+    params = hostapd.wpa2_params(ssid="test-wpa2", passphrase="12345678")
+    hostapd.add_ap(apdev[1], params)
+    with alloc_fail(dev[0], 1, "wpa_scan_results_sort"):
+        dev[0].scan_for_bss(apdev[0]['bssid'], freq="2412", force_scan=True)
+        dev[0].scan_for_bss(apdev[1]['bssid'], freq="2412")
+    dev[0].connect("test-wpa2", psk="12345678", scan_freq="2412")
+
 @remote_compatible
 def test_scan_freq_list(dev, apdev):
     """Scan with SET freq_list and scan_cur_freq"""
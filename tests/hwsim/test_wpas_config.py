@@ -7,6 +7,7 @@
 import logging
 logger = logging.getLogger()
 import os
+import time
 
 from wpasupplicant import WpaSupplicant
 import hostapd
@@ -661,3 +662,119 @@ def test_wpas_config_update_without_file(dev, apdev):
     wpas.set("update_config", "1")
     if "FAIL" not in wpas.request("SAVE_CONFIG"):
         raise Exception("SAVE_CONFIG accepted unexpectedly")
+
+def test_wpas_config_file_incremental(dev):
+    """wpa_supplicant config file incremental update"""
+    config = "/tmp/test_wpas_config_file.conf"
+    if os.path.exists(config):
+        os.remove(config)
+
+    wpas = WpaSupplicant(global_iface='/tmp/wpas-wlan5')
+
+    try:
+        with open(config, "w") as f:
+            f.write("update_config=1\n")
+            f.write("update_config_incremental=1\n")
+
+        wpas.interface_add("wlan5", config=config)
+
+        id0 = wpas.add_network()
+        wpas.set_network_quoted(id0, "ssid", "test0")
+        wpas.set_network(id0, "key_mgmt", "NONE")
+        wpas.save_config()
+        inode = os.stat(config).st_ino
+
+        id1 = wpas.add_network()
+        wpas.set_network_quoted(id1, "ssid", "test1")
+        wpas.set_network(id1, "key_mgmt", "NONE")
+        wpas.save_config()
+        if os.stat(config).st_ino != inode:
+            raise Exception("Configuration file not appended")
+        wpas.save_config()
+        if os.stat(config).st_ino != inode:
+            raise Exception("Unchanged configuration file rewritten")
+
+        # Any other change needs a full rewrite
+        wpas.set_network_quoted(id0, "ssid", "test0b")
+        wpas.save_config()
+        if os.stat(config).st_ino == inode:
+            raise Exception("Modified configuration file not rewritten")
+        inode = os.stat(config).st_ino
+
+        # So does an external modification of the file
+        with open(config, "a") as f:
+            f.write("\n")
+        id2 = wpas.add_network()
+        wpas.set_network_quoted(id2, "ssid", "test2")
+        wpas.set_network(id2, "key_mgmt", "NONE")
+        wpas.save_config()
+        if os.stat(config).st_ino == inode:
+            raise Exception("Externally modified file not rewritten")
+
+        wpas.interface_remove("wlan5")
+        wpas.interface_add("wlan5", config=config)
+        for id, ssid in [(id0, "test0b"), (id1, "test1"), (id2, "test2")]:
+            if wpas.get_network(id, "ssid") != '"%s"' % ssid:
+                raise Exception("Unexpected network %d after reload" % id)
+    finally:
+        try:
+            os.remove(config)
+        except:
+            pass
+        try:
+            os.remove(config + ".tmp")
+        except:
+            pass
+
+def test_wpas_config_file_scale(dev):
+    """wpa_supplicant config file with 5000 networks"""
+    config = "/tmp/test_wpas_config_file.conf"
+    num = 5000
+    wpas = WpaSupplicant(global_iface='/tmp/wpas-wlan5')
+
+    try:
+        with open(config, "w") as f:
+            f.write("update_config=1\n")
+            for i in range(num):
+                # Open networks to avoid measuring PSK derivation
+                f.write("\nnetwork={\n\tssid=\"scale-%d\"\n\tkey_mgmt=NONE\n}\n" % i)
+
+        start = time.time()
+        wpas.interface_add("wlan5", config=config)
+        logger.info("Load %d networks: %.3f s" % (num, time.time() - start))
+
+        # Network ids from configuration files are allocated process-wide
+        first = int(wpas.request("LIST_NETWORKS").splitlines()[1].split()[0])
+        start = time.time()
+        for i in range(0, num, 7):
+            if wpas.get_network(first + i, "ssid") != '"scale-%d"' % i:
+                raise Exception("Unexpected SSID for network %d" % i)
+        logger.info("Lookup %d networks: %.3f s" % (len(range(0, num, 7)),
+                                                     time.time() - start))
+
+        for incr in ["0", "1"]:
+            wpas.set("update_config_incremental", incr)
+            wpas.save_config()
+            start = time.time()
+            for i in range(10):
+                id = wpas.add_network()
+                wpas.set_network_quoted(id, "ssid", "added-%d" % id)
+                wpas.set_network(id, "key_mgmt", "NONE")
+                wpas.save_config()
+            logger.info("Add and save 10 networks (incremental=%s): %.3f s" %
+                        (incr, time.time() - start))
+
+        start = time.time()
+        wpas.request("REMOVE_NETWORK all")
+        logger.info("Remove %d networks: %.3f s" % (num + 20,
+                                                    time.time() - start))
+    finally:
+        wpas.interface_remove("wlan5")
+        try:
+            os.remove(config)
+        except:
+            pass
+        try:
+            os.remove(config + ".tmp")
+        except:
+            pass
@@ -1126,6 +1126,16 @@ def test_wpas_ctrl_bssid_ignore(dev):
     b = get_bssid_ignore_list(dev[0])
     if "00:11:22:33:44:55" not in b or "00:11:22:33:44:56" not in b or len(b) != 2:
         raise Exception("Unexpected BSSID ignore list contents: " + str(b))
+    if "OK" not in dev[0].request("BSSID_IGNORE 00:11:22:33:44:57 00:11:22:33:44:58"):
+        raise Exception("BSSID_IGNORE add list failed")
+    b = get_bssid_ignore_list(dev[0])
+    if "00:11:22:33:44:57" not in b or "00:11:22:33:44:58" not in b or len(b) != 4:
+        raise Exception("Unexpected BSSID ignore list contents: " + str(b))
+    if "FAIL" not in dev[0].request("BSSID_IGNORE 00:11:22:33:44:59 00:11"):
+        raise Exception("Invalid BSSID_IGNORE list accepted")
+    stats = dev[0].request("BSSID_IGNORE stats")
+    if "entries=4" not in stats or "active=4" not in stats:
+        raise Exception("Unexpected BSSID_IGNORE stats: " + stats)
 
     if "OK" not in dev[0].request("BSSID_IGNORE clear"):
         raise Exception("BSSID_IGNORE clear failed")
@@ -1135,7 +1145,7 @@ def test_wpas_ctrl_bssid_ignore(dev):
 @remote_compatible
 def test_wpas_ctrl_bssid_ignore_oom(dev):
     """wpa_supplicant ctrl_iface BSSID_IGNORE and out-of-memory"""
-    with alloc_fail(dev[0], 1, "wpa_bssid_ignore_add"):
+    with alloc_fail(dev[0], 1, "wpa_bssid_ignore_add_list"):
         if "FAIL" not in dev[0].request("BSSID_IGNORE aa:bb:cc:dd:ee:ff"):
             raise Exception("Unexpected success with allocation failure")
 
@@ -1181,6 +1191,25 @@ def test_wpas_ctrl_log_level(dev):
     if "Timestamp: 1" not in level:
         raise Exception("Unexpected timestamp(3): " + level)
 
+def test_wpas_ctrl_eloop_stats(dev, apdev):
+    """wpa_supplicant ctrl_iface ELOOP_STATS"""
+    if "OK" not in dev[0].request("ELOOP_STATS RESET"):
+        raise HwsimSkip("ELOOP_STATS not supported")
+    hapd = hostapd.add_ap(apdev[0], {"ssid": "open"})
+    dev[0].connect("open", key_mgmt="NONE", scan_freq="2412")
+    res = dev[0].request("ELOOP_STATS")
+    if "iterations=" not in res or "type=sock" not in res:
+        raise Exception("Unexpected ELOOP_STATS response: " + res)
+    if "type=timeout" not in res:
+        raise Exception("No timeout handlers reported: " + res)
+    before = int(res.split("iterations=")[1].splitlines()[0])
+    if "OK" not in dev[0].request("ELOOP_STATS RESET"):
+        raise Exception("ELOOP_STATS RESET failed")
+    res = dev[0].request("ELOOP_STATS")
+    after = int(res.split("iterations=")[1].splitlines()[0])
+    if after >= before:
+        raise Exception("Statistics not cleared: %d -> %d" % (before, after))
+
 @remote_compatible
 def test_wpas_ctrl_enable_disable_network(dev, apdev):
     """wpa_supplicant ctrl_iface ENABLE/DISABLE_NETWORK"""
@@ -11,43 +11,76 @@
 #include "common.h"
 #include "crypto/crypto.h"
 #include "crypto/aes_wrap.h"
+#ifdef CONFIG_INTERNAL_AES_NI
+#include "crypto/aes_i.h"
+#endif /* CONFIG_INTERNAL_AES_NI */
 
 #define BLOCK_SIZE 16
 
-static void test_aes_perf(void)
+static void test_aes_perf_run(const char *impl)
 {
-#if 0 /* this did not seem to work with new compiler?! */
-#ifdef __i386__
-#define rdtscll(val) \
-     __asm__ __volatile__("rdtsc" : "=A" (val))
-	const int num_iters = 10;
-	int i;
-	unsigned int start, end;
-	u8 key[16], pt[16], ct[16];
+	const size_t len = 16 * 1024 * 1024;
+	const int num_blocks = 1000000;
+	struct os_reltime start, end, diff;
+	u8 key[16], iv[12], tag[16], *buf;
 	void *ctx;
-
-	printf("keySetupEnc:");
-	for (i = 0; i < num_iters; i++) {
-		rdtscll(start);
-		ctx = aes_encrypt_init(key, 16);
-		rdtscll(end);
-		aes_encrypt_deinit(ctx);
-		printf(" %d", end - start);
-	}
-	printf("\n");
-
-	printf("Encrypt:");
-	ctx = aes_encrypt_init(key, 16);
-	for (i = 0; i < num_iters; i++) {
-		rdtscll(start);
-		aes_encrypt(ctx, pt, ct);
-		rdtscll(end);
-		printf(" %d", end - start);
+	int i;
+	double t;
+
+	buf = os_zalloc(len);
+	if (!buf)
+		return;
+	os_memset(key, 0x11, sizeof(key));
+	os_memset(iv, 0x22, sizeof(iv));
+
+	ctx = aes_encrypt_init(key, sizeof(key));
+	if (!ctx) {
+		os_free(buf);
+		return;
 	}
+	os_get_reltime(&start);
+	for (i = 0; i < num_blocks; i++)
+		aes_encrypt(ctx, buf, buf);
+	os_get_reltime(&end);
 	aes_encrypt_deinit(ctx);
-	printf("\n");
-#endif /* __i386__ */
-#endif
+	os_reltime_sub(&end, &start, &diff);
+	t = diff.sec + diff.usec / 1000000.0;
+	printf("%s: AES-128 block: %.1f MB/s\n", impl,
+	       t > 0 ? num_blocks * 16.0 / t / 1000000 : 0);
+
+	os_get_reltime(&start);
+	if (aes_ctr_encrypt(key, sizeof(key), buf, buf, len) < 0)
+		printf("%s: aes_ctr_encrypt() failed\n", impl);
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	t = diff.sec + diff.usec / 1000000.0;
+	printf("%s: AES-128-CTR: %.1f MB/s\n", impl,
+	       t > 0 ? len / t / 1000000 : 0);
+
+	os_get_reltime(&start);
+	if (aes_gcm_ae(key, sizeof(key), iv, sizeof(iv), buf, len, NULL, 0,
+		       buf, tag) < 0)
+		printf("%s: aes_gcm_ae() failed\n", impl);
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	t = diff.sec + diff.usec / 1000000.0;
+	printf("%s: AES-128-GCM: %.1f MB/s\n", impl,
+	       t > 0 ? len / t / 1000000 : 0);
+
+	os_free(buf);
+}
+
+
+static void test_aes_perf(void)
+{
+#ifdef CONFIG_INTERNAL_AES_NI
+	aes_ni_disabled = 1;
+	test_aes_perf_run("table");
+	aes_ni_disabled = 0;
+	test_aes_perf_run("AES-NI");
+#else /* CONFIG_INTERNAL_AES_NI */
+	test_aes_perf_run("table");
+#endif /* CONFIG_INTERNAL_AES_NI */
 }
 
 
@@ -613,9 +646,16 @@ int main(int argc, char *argv[])
 	else if (argc >= 3 && os_strcmp(argv[1], "NIST-KW-AD") == 0)
 		ret += test_nist_key_wrap_ad(argv[2]);
 
-	test_aes_perf();
+	else if (argc >= 2 && os_strcmp(argv[1], "perf") == 0)
+		test_aes_perf();
 
 	ret += test_gcm();
+#ifdef CONFIG_INTERNAL_AES_NI
+	/* Table based implementation */
+	aes_ni_disabled = 1;
+	ret += test_gcm();
+	aes_ni_disabled = 0;
+#endif /* CONFIG_INTERNAL_AES_NI */
 
 	if (ret)
 		printf("FAILED!\n");
@@ -0,0 +1,244 @@
+/*
+ * Test program for internal bignum modular exponentiation
+ * Copyright (c) 2026, The hostapd contributors
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "utils/base64.h"
+#include "crypto/crypto.h"
+#include "crypto/dh_groups.h"
+#include "tls/bignum.h"
+
+
+static u32 test_rand_state = 0x12345678;
+
+static void test_rand(u8 *buf, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		test_rand_state = test_rand_state * 1103515245 + 12345;
+		buf[i] = test_rand_state >> 16;
+	}
+}
+
+
+static int test_exptmod(size_t mod_len, size_t exp_len, size_t base_len)
+{
+	struct bignum *a, *b, *m, *r1, *r2;
+	struct bignum_mont *mont = NULL;
+	u8 buf[512];
+	int ret = -1;
+
+	a = bignum_init();
+	b = bignum_init();
+	m = bignum_init();
+	r1 = bignum_init();
+	r2 = bignum_init();
+	if (!a || !b || !m || !r1 || !r2)
+		goto fail;
+
+	test_rand(buf, mod_len);
+	buf[0] |= 0x80;
+	buf[mod_len - 1] |= 0x01;
+	if (bignum_set_unsigned_bin(m, buf, mod_len) < 0)
+		goto fail;
+	test_rand(buf, exp_len);
+	if (bignum_set_unsigned_bin(b, buf, exp_len) < 0)
+		goto fail;
+	test_rand(buf, base_len);
+	if (bignum_set_unsigned_bin(a, buf, base_len) < 0)
+		goto fail;
+
+	mont = bignum_mont_init(m);
+	if (!mont ||
+	    bignum_exptmod(a, b, m, r1) < 0 ||
+	    bignum_exptmod_mont(a, b, mont, r2) < 0)
+		goto fail;
+
+	if (bignum_cmp(r1, r2) != 0) {
+		printf("exptmod mismatch: mod_len=%zu exp_len=%zu base_len=%zu\n",
+		       mod_len, exp_len, base_len);
+		goto fail;
+	}
+
+	ret = 0;
+fail:
+	bignum_mont_deinit(mont);
+	bignum_deinit(a);
+	bignum_deinit(b);
+	bignum_deinit(m);
+	bignum_deinit(r1);
+	bignum_deinit(r2);
+	return ret;
+}
+
+
+static int test_bignum_exptmod(void)
+{
+	static const size_t mod_lens[] = { 1, 2, 8, 15, 16, 33, 128, 256, 384 };
+	size_t i, exp_len;
+	int errors = 0;
+
+	printf("bignum_exptmod_mont() vs. bignum_exptmod()\n");
+
+	for (i = 0; i < ARRAY_SIZE(mod_lens); i++) {
+		size_t mod_len = mod_lens[i];
+
+		for (exp_len = 0; exp_len <= mod_len + 1;
+		     exp_len += exp_len < 9 ? 1 : mod_len / 3) {
+			if (test_exptmod(mod_len, exp_len, mod_len) < 0 ||
+			    test_exptmod(mod_len, exp_len, mod_len + 3) < 0 ||
+			    test_exptmod(mod_len, exp_len, 1) < 0)
+				errors++;
+		}
+	}
+
+	return errors;
+}
+
+
+static double perf_time(struct os_reltime *start)
+{
+	struct os_reltime now, diff;
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, start, &diff);
+	return diff.sec + diff.usec / 1000000.0;
+}
+
+
+static void test_dh_perf(int id, int num)
+{
+	const struct dh_group *dh;
+	struct bignum *g, *x, *p, *y;
+	struct bignum_mont *mont = NULL;
+	struct os_reltime start;
+	u8 priv[512];
+	int i;
+	double t;
+
+	dh = dh_groups_get(id);
+	if (!dh) {
+		printf("DH group %d: not included in the build\n", id);
+		return;
+	}
+
+	g = bignum_init();
+	x = bignum_init();
+	p = bignum_init();
+	y = bignum_init();
+	test_rand(priv, dh->prime_len);
+	priv[0] &= 0x7f;
+	if (!g || !x || !p || !y ||
+	    bignum_set_unsigned_bin(g, dh->generator, dh->generator_len) < 0 ||
+	    bignum_set_unsigned_bin(x, priv, dh->prime_len) < 0 ||
+	    bignum_set_unsigned_bin(p, dh->prime, dh->prime_len) < 0)
+		goto fail;
+
+	os_get_reltime(&start);
+	for (i = 0; i < num; i++) {
+		if (bignum_exptmod(g, x, p, y) < 0)
+			goto fail;
+	}
+	t = perf_time(&start);
+	printf("DH group %d: bignum_exptmod: %.2f ms\n",
+	       id, t * 1000 / num);
+
+	os_get_reltime(&start);
+	for (i = 0; i < num; i++) {
+		mont = bignum_mont_init(p);
+		if (!mont || bignum_exptmod_mont(g, x, mont, y) < 0)
+			goto fail;
+		bignum_mont_deinit(mont);
+		mont = NULL;
+	}
+	t = perf_time(&start);
+	printf("DH group %d: bignum_exptmod_mont: %.2f ms\n",
+	       id, t * 1000 / num);
+
+fail:
+	bignum_mont_deinit(mont);
+	bignum_deinit(g);
+	bignum_deinit(x);
+	bignum_deinit(p);
+	bignum_deinit(y);
+}
+
+
+static void test_rsa_perf(const char *fname, int num)
+{
+	struct crypto_private_key *key = NULL;
+	struct os_reltime start;
+	char *data, *pos, *end;
+	u8 *der = NULL, hash[32], sig[1024];
+	size_t len, der_len, sig_len;
+	int i;
+	double t;
+
+	data = os_readfile(fname, &len);
+	if (!data) {
+		printf("Could not read %s\n", fname);
+		return;
+	}
+
+	/* Accept both DER and PEM encoded keys */
+	pos = os_strstr(data, "-----BEGIN");
+	if (pos && (pos = os_strchr(pos, '\n')) &&
+	    (end = os_strstr(pos, "-----END"))) {
+		der = base64_decode(pos, end - pos, &der_len);
+		if (der)
+			key = crypto_private_key_import(der, der_len, NULL);
+	} else {
+		key = crypto_private_key_import((u8 *) data, len, NULL);
+	}
+	if (!key) {
+		printf("Could not import the private key from %s\n", fname);
+		goto fail;
+	}
+
+	os_memset(hash, 0x55, sizeof(hash));
+	os_get_reltime(&start);
+	for (i = 0; i < num; i++) {
+		sig_len = sizeof(sig);
+		if (crypto_private_key_sign_pkcs1(key, hash, sizeof(hash),
+						  sig, &sig_len) < 0) {
+			printf("RSA signing failed\n");
+			goto fail;
+		}
+	}
+	t = perf_time(&start);
+	printf("RSA-%zu sign: %.2f ms\n", sig_len * 8, t * 1000 / num);
+
+fail:
+	crypto_private_key_free(key);
+	os_free(der);
+	os_free(data);
+}
+
+
+int main(int argc, char *argv[])
+{
+	int errors = 0;
+
+	if (argc >= 2 && os_strcmp(argv[1], "perf") == 0) {
+		test_dh_perf(5, 50);
+		test_dh_perf(14, 20);
+		test_dh_perf(15, 10);
+		if (argc >= 3)
+			test_rsa_perf(argv[2], 50);
+		return 0;
+	}
+
+	errors += test_bignum_exptmod();
+
+	if (errors)
+		printf("%d test(s) failed\n", errors);
+
+	return errors;
+}
@@ -0,0 +1,575 @@
+/*
+ * Test program for eloop socket handling
+ * Copyright (c) 2026, The hostapd contributors
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "includes.h"
+#include <fcntl.h>
+#include <sys/socket.h>
+
+#include "common.h"
+#include "eloop.h"
+
+
+static const char * eloop_backend(void)
+{
+#if defined(CONFIG_ELOOP_POLL)
+	return "poll";
+#elif defined(CONFIG_ELOOP_EPOLL) && defined(CONFIG_ELOOP_TIMERFD)
+	return "epoll+timerfd";
+#elif defined(CONFIG_ELOOP_EPOLL)
+	return "epoll";
+#elif defined(CONFIG_ELOOP_KQUEUE)
+	return "kqueue";
+#else
+	return "select";
+#endif
+}
+
+
+struct test_pair {
+	int s[2];
+	unsigned int received;
+	unsigned int expected;
+	int unexpected;
+};
+
+static int test_timed_out;
+
+
+static int test_pair_open(struct test_pair *p)
+{
+	os_memset(p, 0, sizeof(*p));
+	if (socketpair(AF_UNIX, SOCK_DGRAM, 0, p->s) < 0) {
+		perror("socketpair");
+		return -1;
+	}
+	if (fcntl(p->s[0], F_SETFL, O_NONBLOCK) < 0 ||
+	    fcntl(p->s[1], F_SETFL, O_NONBLOCK) < 0) {
+		perror("fcntl");
+		close(p->s[0]);
+		close(p->s[1]);
+		return -1;
+	}
+	return 0;
+}
+
+
+static void test_pair_close(struct test_pair *p)
+{
+	if (p->s[0] >= 0)
+		close(p->s[0]);
+	if (p->s[1] >= 0)
+		close(p->s[1]);
+	p->s[0] = p->s[1] = -1;
+}
+
+
+static int test_send_burst(struct test_pair *p, unsigned int count)
+{
+	u8 buf[64];
+	unsigned int i;
+
+	os_memset(buf, 0x11, sizeof(buf));
+	for (i = 0; i < count; i++) {
+		if (send(p->s[1], buf, sizeof(buf), 0) < 0) {
+			perror("send");
+			return -1;
+		}
+	}
+	p->expected += count;
+	return 0;
+}
+
+
+static int test_recv_one(int sock)
+{
+	u8 buf[2300];
+
+	return recv(sock, buf, sizeof(buf), 0);
+}
+
+
+static void test_timeout(void *eloop_ctx, void *user_ctx)
+{
+	test_timed_out = 1;
+	eloop_terminate();
+}
+
+
+/* Read one frame per callback and stop once all frames have been received */
+static void test_burst_receive(int sock, void *eloop_ctx, void *sock_ctx)
+{
+	struct test_pair *p = sock_ctx;
+
+	if (test_recv_one(sock) < 0) {
+		p->unexpected++;
+		return;
+	}
+	p->received++;
+	if (p->received == p->expected)
+		eloop_terminate();
+}
+
+
+static int test_burst(void)
+{
+	struct test_pair p;
+	int ret = -1;
+
+	printf("eloop: burst of frames on one socket\n");
+	if (test_pair_open(&p) < 0)
+		return -1;
+	if (eloop_register_read_sock(p.s[0], test_burst_receive, NULL, &p) < 0)
+		goto fail;
+	if (test_send_burst(&p, 100) < 0)
+		goto fail;
+	test_timed_out = 0;
+	eloop_register_timeout(5, 0, test_timeout, NULL, NULL);
+	eloop_run();
+	eloop_cancel_timeout(test_timeout, NULL, NULL);
+	eloop_unregister_read_sock(p.s[0]);
+	if (test_timed_out || p.unexpected || p.received != p.expected) {
+		printf("burst failed: received %u/%u unexpected=%d\n",
+		       p.received, p.expected, p.unexpected);
+		goto fail;
+	}
+	ret = 0;
+fail:
+	test_pair_close(&p);
+	return ret;
+}
+
+
+static struct test_pair unreg_pairs[2];
+
+
+/* Unregister and close the other socket even though it is readable */
+static void test_unreg_receive(int sock, void *eloop_ctx, void *sock_ctx)
+{
+	struct test_pair *p = sock_ctx;
+	struct test_pair *other;
+
+	p->received++;
+	test_recv_one(sock);
+	other = p == &unreg_pairs[0] ? &unreg_pairs[1] : &unreg_pairs[0];
+	if (other->s[0] >= 0) {
+		eloop_unregister_read_sock(other->s[0]);
+		test_pair_close(other);
+	}
+	eloop_register_timeout(0, 100000, test_timeout, NULL, NULL);
+}
+
+
+static int test_unregister_in_handler(void)
+{
+	int ret = -1;
+	int i;
+
+	printf("eloop: unregister socket from another socket's handler\n");
+	if (test_pair_open(&unreg_pairs[0]) < 0)
+		return -1;
+	if (test_pair_open(&unreg_pairs[1]) < 0) {
+		test_pair_close(&unreg_pairs[0]);
+		return -1;
+	}
+	for (i = 0; i < 2; i++) {
+		if (eloop_register_read_sock(unreg_pairs[i].s[0],
+					     test_unreg_receive, NULL,
+					     &unreg_pairs[i]) < 0 ||
+		    test_send_burst(&unreg_pairs[i], 1) < 0)
+			goto fail;
+	}
+	eloop_run();
+	for (i = 0; i < 2; i++) {
+		if (unreg_pairs[i].s[0] >= 0)
+			eloop_unregister_read_sock(unreg_pairs[i].s[0]);
+	}
+	if (unreg_pairs[0].received + unreg_pairs[1].received != 1) {
+		printf("unregister failed: handlers called %u+%u times\n",
+		       unreg_pairs[0].received, unreg_pairs[1].received);
+		goto fail;
+	}
+	ret = 0;
+fail:
+	test_pair_close(&unreg_pairs[0]);
+	test_pair_close(&unreg_pairs[1]);
+	return ret;
+}
+
+
+static struct test_pair reopen_pairs[2];
+static int reopen_same_fd;
+
+
+static void test_reopen_new_receive(int sock, void *eloop_ctx,
+				    void *sock_ctx)
+{
+	struct test_pair *p = sock_ctx;
+
+	if (p != &reopen_pairs[1] || test_recv_one(sock) < 0) {
+		reopen_pairs[1].unexpected++;
+		return;
+	}
+	p->received++;
+	eloop_terminate();
+}
+
+
+/*
+ * Close the socket with a frame still pending and register a new socket with
+ * the same file descriptor number from within the handler.
+ */
+static void test_reopen_old_receive(int sock, void *eloop_ctx,
+				    void *sock_ctx)
+{
+	struct test_pair *p = sock_ctx;
+	int old = p->s[0];
+
+	p->received++;
+	if (p->received > 1) {
+		p->unexpected++;
+		return;
+	}
+	test_recv_one(sock);
+	eloop_unregister_read_sock(old);
+	test_pair_close(p);
+	if (test_pair_open(&reopen_pairs[1]) < 0) {
+		eloop_terminate();
+		return;
+	}
+	reopen_same_fd = reopen_pairs[1].s[0] == old ||
+		reopen_pairs[1].s[1] == old;
+	if (eloop_register_read_sock(reopen_pairs[1].s[0],
+				     test_reopen_new_receive, NULL,
+				     &reopen_pairs[1]) < 0 ||
+	    test_send_burst(&reopen_pairs[1], 1) < 0)
+		eloop_terminate();
+}
+
+
+static int test_reopen_in_handler(void)
+{
+	int ret = -1;
+
+	printf("eloop: close and reopen socket from its handler\n");
+	reopen_pairs[1].s[0] = reopen_pairs[1].s[1] = -1;
+	if (test_pair_open(&reopen_pairs[0]) < 0)
+		return -1;
+	if (eloop_register_read_sock(reopen_pairs[0].s[0],
+				     test_reopen_old_receive, NULL,
+				     &reopen_pairs[0]) < 0 ||
+	    test_send_burst(&reopen_pairs[0], 2) < 0)
+		goto fail;
+	test_timed_out = 0;
+	eloop_register_timeout(5, 0, test_timeout, NULL, NULL);
+	eloop_run();
+	eloop_cancel_timeout(test_timeout, NULL, NULL);
+	if (reopen_pairs[1].s[0] >= 0)
+		eloop_unregister_read_sock(reopen_pairs[1].s[0]);
+	if (test_timed_out || !reopen_same_fd ||
+	    reopen_pairs[0].unexpected || reopen_pairs[1].unexpected ||
+	    reopen_pairs[1].received != 1) {
+		printf("reopen failed: timed_out=%d same_fd=%d received=%u unexpected=%d/%d\n",
+		       test_timed_out, reopen_same_fd,
+		       reopen_pairs[1].received, reopen_pairs[0].unexpected,
+		       reopen_pairs[1].unexpected);
+		goto fail;
+	}
+	ret = 0;
+fail:
+	test_pair_close(&reopen_pairs[0]);
+	test_pair_close(&reopen_pairs[1]);
+	return ret;
+}
+
+
+static int writer_calls;
+
+
+static void test_writer(int sock, void *eloop_ctx, void *sock_ctx)
+{
+	writer_calls++;
+	eloop_unregister_sock(sock, EVENT_TYPE_WRITE);
+	eloop_terminate();
+}
+
+
+static int test_write_sock(void)
+{
+	struct test_pair p;
+	int ret = -1;
+
+	printf("eloop: writable socket\n");
+	if (test_pair_open(&p) < 0)
+		return -1;
+	writer_calls = 0;
+	if (eloop_register_sock(p.s[1], EVENT_TYPE_WRITE, test_writer,
+				NULL, NULL) < 0)
+		goto fail;
+	test_timed_out = 0;
+	eloop_register_timeout(5, 0, test_timeout, NULL, NULL);
+	eloop_run();
+	eloop_cancel_timeout(test_timeout, NULL, NULL);
+	if (test_timed_out || writer_calls != 1) {
+		printf("writer failed: calls=%d\n", writer_calls);
+		goto fail;
+	}
+	ret = 0;
+fail:
+	test_pair_close(&p);
+	return ret;
+}
+
+
+#define COALESCE_TIMERS 10
+
+static struct os_reltime coalesce_fired[COALESCE_TIMERS + 1];
+static unsigned int coalesce_count;
+
+
+static void test_coalesce_timeout(void *eloop_ctx, void *user_ctx)
+{
+	unsigned int idx = (uintptr_t) user_ctx;
+
+	os_get_reltime(&coalesce_fired[idx]);
+	if (++coalesce_count == COALESCE_TIMERS + 1)
+		eloop_terminate();
+}
+
+
+static int test_reltime_us(struct os_reltime *a, struct os_reltime *b)
+{
+	struct os_reltime diff;
+
+	os_reltime_sub(a, b, &diff);
+	return diff.sec * 1000000 + diff.usec;
+}
+
+
+/*
+ * Timeouts spread over 18 ms with 50 ms slack must all run in the same wakeup
+ * while the earlier timeout without slack is not delayed.
+ */
+static int test_timeout_coalescing(void)
+{
+	struct os_reltime start;
+	unsigned int i;
+	int first, last, proto;
+	int ret = -1;
+#ifdef CONFIG_ELOOP_STATS
+	char buf[4096];
+	const char *pos;
+#endif /* CONFIG_ELOOP_STATS */
+
+	printf("eloop: timeout coalescing\n");
+	coalesce_count = 0;
+	os_memset(coalesce_fired, 0, sizeof(coalesce_fired));
+#ifdef CONFIG_ELOOP_STATS
+	eloop_stats_reset();
+#endif /* CONFIG_ELOOP_STATS */
+	os_get_reltime(&start);
+	for (i = 0; i < COALESCE_TIMERS; i++)
+		eloop_register_timeout_slack(0, 10000 + i * 2000, 50000,
+					     test_coalesce_timeout, NULL,
+					     (void *) (uintptr_t) i);
+	eloop_register_timeout(0, 5000, test_coalesce_timeout, NULL,
+			       (void *) (uintptr_t) COALESCE_TIMERS);
+	test_timed_out = 0;
+	eloop_register_timeout(5, 0, test_timeout, NULL, NULL);
+	eloop_run();
+	eloop_cancel_timeout(test_timeout, NULL, NULL);
+	eloop_cancel_timeout(test_coalesce_timeout, ELOOP_ALL_CTX,
+			     ELOOP_ALL_CTX);
+
+	first = last = test_reltime_us(&coalesce_fired[0], &start);
+	for (i = 1; i < COALESCE_TIMERS; i++) {
+		int t = test_reltime_us(&coalesce_fired[i], &start);
+
+		if (t < first)
+			first = t;
+		if (t > last)
+			last = t;
+	}
+	proto = test_reltime_us(&coalesce_fired[COALESCE_TIMERS], &start);
+	if (test_timed_out || coalesce_count != COALESCE_TIMERS + 1 ||
+	    first < 28000 || last - first > 5000 || proto < 5000 ||
+	    proto >= first) {
+		printf("coalescing failed: count=%u first=%d last=%d protocol=%d us\n",
+		       coalesce_count, first, last, proto);
+		goto fail;
+	}
+#ifdef CONFIG_ELOOP_STATS
+	if (eloop_stats_dump(buf, sizeof(buf)) <= 0 ||
+	    !(pos = os_strstr(buf, "\nmax_coalesced=")) ||
+	    atoi(pos + 15) != COALESCE_TIMERS) {
+		printf("coalescing not reported in statistics\n%s", buf);
+		goto fail;
+	}
+#endif /* CONFIG_ELOOP_STATS */
+	ret = 0;
+fail:
+	return ret;
+}
+
+
+static unsigned int order_timeouts, order_sock_since, order_batched;
+
+
+static void test_order_timeout(void *eloop_ctx, void *user_ctx)
+{
+	if (order_timeouts > 0 && order_sock_since == 0)
+		order_batched++;
+	order_sock_since = 0;
+	if (++order_timeouts == 3)
+		eloop_terminate();
+}
+
+
+static void test_order_receive(int sock, void *eloop_ctx, void *sock_ctx)
+{
+	/* The socket is left readable to see when sockets are checked */
+	order_sock_since++;
+}
+
+
+/*
+ * Timeouts that have all expired are run one per iteration with socket
+ * processing in between unless they have a slack.
+ */
+static int test_timeout_order(unsigned int slack)
+{
+	int sv[2];
+	unsigned int i;
+	int ret = -1;
+
+	printf("eloop: timeout order with slack %u us\n", slack);
+	if (socketpair(AF_UNIX, SOCK_DGRAM, 0, sv) < 0 ||
+	    send(sv[1], "x", 1, 0) != 1)
+		return -1;
+	order_timeouts = order_sock_since = order_batched = 0;
+	eloop_register_read_sock(sv[0], test_order_receive, NULL, NULL);
+	for (i = 0; i < 3; i++)
+		eloop_register_timeout_slack(0, 0, slack,
+					     test_order_timeout, NULL,
+					     (void *) (uintptr_t) i);
+	test_timed_out = 0;
+	eloop_register_timeout(5, 0, test_timeout, NULL, NULL);
+	eloop_run();
+	eloop_cancel_timeout(test_timeout, NULL, NULL);
+	eloop_cancel_timeout(test_order_timeout, ELOOP_ALL_CTX, ELOOP_ALL_CTX);
+	eloop_unregister_read_sock(sv[0]);
+	close(sv[0]);
+	close(sv[1]);
+
+	if (test_timed_out || order_timeouts != 3 ||
+	    order_batched != (slack ? 2 : 0)) {
+		printf("timeout order failed: timeouts=%u batched=%u\n",
+		       order_timeouts, order_batched);
+		goto fail;
+	}
+	ret = 0;
+fail:
+	return ret;
+}
+
+
+#ifdef CONFIG_ELOOP_STATS
+
+/* Not static and linked with -rdynamic so that dladdr() finds the names */
+void test_stats_timeout(void *eloop_ctx, void *user_ctx);
+void test_stats_receive(int sock, void *eloop_ctx, void *sock_ctx);
+
+void test_stats_timeout(void *eloop_ctx, void *user_ctx)
+{
+	os_sleep(0, 20000);
+}
+
+
+void test_stats_receive(int sock, void *eloop_ctx, void *sock_ctx)
+{
+	test_recv_one(sock);
+	eloop_terminate();
+}
+
+
+static int test_stats(void)
+{
+	struct test_pair p;
+	char buf[4096], line[100];
+	int ret = -1, len;
+
+	printf("eloop: handler statistics\n");
+	if (test_pair_open(&p) < 0)
+		return -1;
+	eloop_stats_reset();
+	if (eloop_register_timeout(0, 0, test_stats_timeout, NULL, NULL) < 0 ||
+	    eloop_register_read_sock(p.s[0], test_stats_receive, NULL, NULL) <
+	    0 ||
+	    test_send_burst(&p, 1) < 0)
+		goto fail;
+	eloop_run();
+	eloop_unregister_read_sock(p.s[0]);
+
+	len = eloop_stats_dump(buf, sizeof(buf));
+	if (len <= 0 || (size_t) len >= sizeof(buf))
+		goto fail;
+	printf("%s", buf);
+
+	/* The 20 ms timeout must be first and in the 10-100 ms bucket */
+	os_strlcpy(line, "handler=test_stats_timeout type=timeout calls=1 ",
+		   sizeof(line));
+	if (!os_strstr(buf, line) ||
+	    os_strstr(buf, "handler=") != os_strstr(buf, line) ||
+	    !os_strstr(os_strstr(buf, line), "hist=0,0,0,0,1,0,0\n"))
+		goto fail;
+	if (!os_strstr(buf, "handler=test_stats_receive type=sock calls=1 ") ||
+	    !os_strstr(buf, "\ntimeouts=0\n"))
+		goto fail;
+	ret = 0;
+fail:
+	if (ret)
+		printf("statistics failed\n");
+	test_pair_close(&p);
+	return ret;
+}
+
+#endif /* CONFIG_ELOOP_STATS */
+
+int main(int argc, char *argv[])
+{
+	int errors = 0;
+
+	if (eloop_init() < 0) {
+		printf("eloop_init failed\n");
+		return 1;
+	}
+
+	printf("eloop backend: %s\n", eloop_backend());
+	if (test_burst() < 0)
+		errors++;
+	if (test_unregister_in_handler() < 0)
+		errors++;
+	if (test_reopen_in_handler() < 0)
+		errors++;
+	if (test_write_sock() < 0)
+		errors++;
+	if (test_timeout_coalescing() < 0)
+		errors++;
+	if (test_timeout_order(0) < 0 || test_timeout_order(5000) < 0)
+		errors++;
+#ifdef CONFIG_ELOOP_STATS
+	if (test_stats() < 0)
+		errors++;
+#endif /* CONFIG_ELOOP_STATS */
+
+	eloop_destroy();
+
+	if (errors)
+		printf("%d test(s) failed\n", errors);
+
+	return errors;
+}
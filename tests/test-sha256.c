@@ -10,6 +10,12 @@
 
 #include "common.h"
 #include "crypto/crypto.h"
+#include "crypto/sha1.h"
+#include "crypto/sha256.h"
+#ifdef CONFIG_INTERNAL_SHA_NI
+#include "crypto/sha1_i.h"
+#include "crypto/sha256_i.h"
+#endif /* CONFIG_INTERNAL_SHA_NI */
 
 
 static int cavp_shavs(const char *fname)
@@ -106,10 +112,124 @@ static int cavp_shavs(const char *fname)
 }
 
 
+static double perf_time(struct os_reltime *start)
+{
+	struct os_reltime now, diff;
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, start, &diff);
+	return diff.sec + diff.usec / 1000000.0;
+}
+
+
+static void test_sha_perf_run(const char *impl)
+{
+	const size_t len = 16 * 1024 * 1024;
+	const int num_pbkdf2 = 100, num_ptk = 50000, num_r1 = 5000;
+	struct os_reltime start;
+	u8 *buf, hash[32], pmk[32], ptk[48], mic[32];
+	const u8 *addr[1];
+	size_t alen[1];
+	int i, j;
+	double t;
+
+	buf = os_zalloc(len);
+	if (!buf)
+		return;
+	addr[0] = buf;
+	alen[0] = len;
+
+	os_get_reltime(&start);
+	sha1_vector(1, addr, alen, hash);
+	t = perf_time(&start);
+	printf("%s: SHA-1: %.1f MB/s\n", impl, t > 0 ? len / t / 1000000 : 0);
+
+	os_get_reltime(&start);
+	sha256_vector(1, addr, alen, hash);
+	t = perf_time(&start);
+	printf("%s: SHA-256: %.1f MB/s\n", impl,
+	       t > 0 ? len / t / 1000000 : 0);
+
+	/* Passphrase to PMK (PBKDF2-SHA1, 4096 iterations) */
+	os_get_reltime(&start);
+	for (i = 0; i < num_pbkdf2; i++)
+		pbkdf2_sha1("passphrase", (const u8 *) "ssid", 4, 4096,
+			    pmk, sizeof(pmk));
+	t = perf_time(&start);
+	printf("%s: PBKDF2-SHA1: %.1f PMKs/s\n", impl,
+	       t > 0 ? num_pbkdf2 / t : 0);
+
+	/* PTK derivation and two EAPOL-Key MICs per 4-way handshake */
+	os_get_reltime(&start);
+	for (i = 0; i < num_ptk; i++) {
+		sha256_prf(pmk, sizeof(pmk), "Pairwise key expansion",
+			   buf, 76, ptk, sizeof(ptk));
+		hmac_sha256(ptk, 16, buf, 121, mic);
+		hmac_sha256(ptk, 16, buf + 128, 121, mic);
+	}
+	t = perf_time(&start);
+	printf("%s: SHA-256 PTK+MIC: %.1f handshakes/s\n", impl,
+	       t > 0 ? num_ptk / t : 0);
+
+	/*
+	 * FT PMK-R1 push to 16 R1KHs: HMAC key processed for every derivation
+	 * vs. once per PMK-R0
+	 */
+	os_get_reltime(&start);
+	for (i = 0; i < num_r1; i++) {
+		for (j = 0; j < 16; j++) {
+			buf[0] = j;
+			sha256_prf(pmk, sizeof(pmk), "FT-R1", buf, 12,
+				   ptk, 32);
+		}
+	}
+	t = perf_time(&start);
+	printf("%s: FT PMK-R1 x 16: %.1f pushes/s\n", impl,
+	       t > 0 ? num_r1 / t : 0);
+
+	os_get_reltime(&start);
+	for (i = 0; i < num_r1; i++) {
+		struct crypto_hmac_key *key;
+
+		key = crypto_hmac_key_init(CRYPTO_HASH_ALG_HMAC_SHA256,
+					   pmk, sizeof(pmk));
+		for (j = 0; j < 16; j++) {
+			buf[0] = j;
+			sha256_prf_key(key, pmk, sizeof(pmk), "FT-R1", buf, 12,
+				       ptk, 32);
+		}
+		crypto_hmac_key_deinit(key);
+	}
+	t = perf_time(&start);
+	printf("%s: FT PMK-R1 x 16 (PMK-R0 key): %.1f pushes/s\n", impl,
+	       t > 0 ? num_r1 / t : 0);
+
+	os_free(buf);
+}
+
+
+static void test_sha_perf(void)
+{
+#ifdef CONFIG_INTERNAL_SHA_NI
+	sha1_ni_disabled = sha256_ni_disabled = 1;
+	test_sha_perf_run("C");
+	sha1_ni_disabled = sha256_ni_disabled = 0;
+	test_sha_perf_run("SHA-NI");
+#else /* CONFIG_INTERNAL_SHA_NI */
+	test_sha_perf_run("C");
+#endif /* CONFIG_INTERNAL_SHA_NI */
+}
+
+
 int main(int argc, char *argv[])
 {
 	int errors = 0;
 
+	if (argc >= 2 && os_strcmp(argv[1], "perf") == 0) {
+		test_sha_perf();
+		return 0;
+	}
+
 	if (cavp_shavs("CAVP/SHA256ShortMsg.rsp"))
 		errors++;
 	if (cavp_shavs("CAVP/SHA256LongMsg.rsp"))
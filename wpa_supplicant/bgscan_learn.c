@@ -27,6 +27,25 @@ struct bgscan_learn_bss {
 	size_t num_neigh;
 };
 
+/*
+ * Per-channel statistics for the scan planner. The score is increased by
+ * BGSCAN_LEARN_HIT whenever a BSS in the ESS is found on the channel and it
+ * decays by 1/2^BGSCAN_LEARN_DECAY_SHIFT each time the channel is scanned by
+ * bgscan, so channels that have not had hits recently fall out of the plan.
+ */
+struct bgscan_learn_chan {
+	int freq;
+	unsigned int score;
+	unsigned int hit:1;
+};
+
+#define BGSCAN_LEARN_HIT 256
+#define BGSCAN_LEARN_DECAY_SHIFT 3
+/* Percentage of the candidate channel score that a planned scan covers */
+#define BGSCAN_LEARN_COVERAGE 90
+/* Every Nth background scan covers all learned channels */
+#define BGSCAN_LEARN_FULL_INTERVAL 5
+
 struct bgscan_learn_data {
 	struct wpa_supplicant *wpa_s;
 	const struct wpa_ssid *ssid;
@@ -39,6 +58,12 @@ struct bgscan_learn_data {
 	struct dl_list bss;
 	int *supp_freqs;
 	int probe_idx;
+	struct bgscan_learn_chan *chans;
+	size_t num_chans;
+	int *scan_freqs; /* frequencies of the pending bgscan */
+	unsigned int num_scans;
+	unsigned int chan_time_ms; /* average scan time per channel */
+	unsigned int saved_ms; /* estimated savings against full sweeps */
 };
 
 
@@ -98,6 +123,32 @@ static struct bgscan_learn_bss * bgscan_learn_get_bss(
 }
 
 
+static struct bgscan_learn_chan * bgscan_learn_get_chan(
+	struct bgscan_learn_data *data, int freq, int add)
+{
+	struct bgscan_learn_chan *chan;
+	size_t i;
+
+	for (i = 0; i < data->num_chans; i++) {
+		if (data->chans[i].freq == freq)
+			return &data->chans[i];
+	}
+
+	if (!add)
+		return NULL;
+
+	chan = os_realloc_array(data->chans, data->num_chans + 1,
+				sizeof(*chan));
+	if (!chan)
+		return NULL;
+	data->chans = chan;
+	chan = &data->chans[data->num_chans++];
+	os_memset(chan, 0, sizeof(*chan));
+	chan->freq = freq;
+	return chan;
+}
+
+
 static int bgscan_learn_load(struct bgscan_learn_data *data)
 {
 	FILE *f;
@@ -151,6 +202,18 @@ static int bgscan_learn_load(struct bgscan_learn_data *data)
 
 			bgscan_learn_add_neighbor(bss, addr);
 		}
+
+		if (os_strncmp(buf, "CHAN ", 5) == 0) {
+			struct bgscan_learn_chan *chan;
+			char *pos;
+
+			pos = os_strchr(buf + 5, ' ');
+			if (!pos)
+				continue;
+			chan = bgscan_learn_get_chan(data, atoi(buf + 5), 1);
+			if (chan)
+				chan->score = atoi(pos + 1);
+		}
 	}
 
 	fclose(f);
@@ -162,6 +225,7 @@ static void bgscan_learn_save(struct bgscan_learn_data *data)
 {
 	FILE *f;
 	struct bgscan_learn_bss *bss;
+	size_t i;
 
 	if (data->fname == NULL)
 		return;
@@ -180,7 +244,6 @@ static void bgscan_learn_save(struct bgscan_learn_data *data)
 	}
 
 	dl_list_for_each(bss, &data->bss, struct bgscan_learn_bss, list) {
-		size_t i;
 		for (i = 0; i < bss->num_neigh; i++) {
 			fprintf(f, "NEIGHBOR " MACSTR " " MACSTR "\n",
 				MAC2STR(bss->bssid),
@@ -188,6 +251,12 @@ static void bgscan_learn_save(struct bgscan_learn_data *data)
 		}
 	}
 
+	for (i = 0; i < data->num_chans; i++) {
+		if (data->chans[i].score)
+			fprintf(f, "CHAN %d %u\n", data->chans[i].freq,
+				data->chans[i].score);
+	}
+
 	fclose(f);
 }
 
@@ -208,27 +277,114 @@ static int in_array(int *array, int val)
 }
 
 
+static int * bgscan_learn_add_freq(int *freqs, size_t *count, int freq)
+{
+	int *n;
+
+	if (in_array(freqs, freq))
+		return freqs;
+	n = os_realloc_array(freqs, *count + 2, sizeof(int));
+	if (n == NULL)
+		return freqs;
+	freqs = n;
+	freqs[*count] = freq;
+	(*count)++;
+	freqs[*count] = 0;
+	return freqs;
+}
+
+
 static int * bgscan_learn_get_freqs(struct bgscan_learn_data *data,
 				    size_t *count)
 {
 	struct bgscan_learn_bss *bss;
-	int *freqs = NULL, *n;
+	int *freqs = NULL;
 
 	*count = 0;
 
-	dl_list_for_each(bss, &data->bss, struct bgscan_learn_bss, list) {
-		if (in_array(freqs, bss->freq))
+	dl_list_for_each(bss, &data->bss, struct bgscan_learn_bss, list)
+		freqs = bgscan_learn_add_freq(freqs, count, bss->freq);
+
+	return freqs;
+}
+
+
+static int bgscan_learn_chan_compar(const void *a, const void *b)
+{
+	const struct bgscan_learn_chan *ca = a, *cb = b;
+
+	if (ca->score == cb->score)
+		return 0;
+	return ca->score < cb->score ? 1 : -1;
+}
+
+
+/*
+ * Select the smallest set of channels that covers BGSCAN_LEARN_COVERAGE
+ * percent of the hit score of the channels on which roaming candidates,
+ * i.e., neighbors of the current BSS, have been seen. All learned channels
+ * are returned periodically and whenever there is not enough information for
+ * planning.
+ */
+static int * bgscan_learn_plan_freqs(struct bgscan_learn_data *data,
+				     size_t *count)
+{
+	struct bgscan_learn_bss *cur, *bss;
+	struct bgscan_learn_chan *cand = NULL, *chan, *n;
+	size_t num_cand = 0, i, j;
+	unsigned int total = 0, covered = 0;
+	int *freqs = NULL;
+
+	if (data->num_scans++ % BGSCAN_LEARN_FULL_INTERVAL == 0)
+		goto full;
+
+	cur = bgscan_learn_get_bss(data, data->wpa_s->bssid);
+	if (!cur || cur->num_neigh == 0)
+		goto full;
+
+	for (i = 0; i < cur->num_neigh; i++) {
+		bss = bgscan_learn_get_bss(data, cur->neigh + i * ETH_ALEN);
+		if (!bss)
+			continue;
+		for (j = 0; j < num_cand; j++) {
+			if (cand[j].freq == bss->freq)
+				break;
+		}
+		if (j < num_cand)
 			continue;
-		n = os_realloc_array(freqs, *count + 2, sizeof(int));
-		if (n == NULL)
-			return freqs;
-		freqs = n;
-		freqs[*count] = bss->freq;
-		(*count)++;
-		freqs[*count] = 0;
+		chan = bgscan_learn_get_chan(data, bss->freq, 0);
+		if (!chan || chan->score == 0)
+			continue;
+		n = os_realloc_array(cand, num_cand + 1, sizeof(*cand));
+		if (!n)
+			break;
+		cand = n;
+		cand[num_cand++] = *chan;
+		total += chan->score;
+	}
+
+	if (total == 0) {
+		os_free(cand);
+		goto full;
 	}
 
+	qsort(cand, num_cand, sizeof(*cand), bgscan_learn_chan_compar);
+	*count = 0;
+	for (i = 0; i < num_cand; i++) {
+		if (covered * 100 >= total * BGSCAN_LEARN_COVERAGE)
+			break;
+		freqs = bgscan_learn_add_freq(freqs, count, cand[i].freq);
+		covered += cand[i].score;
+	}
+	os_free(cand);
+
+	wpa_printf(MSG_DEBUG,
+		   "bgscan learn: Planned %u of %u candidate channels",
+		   (unsigned int) *count, (unsigned int) num_cand);
 	return freqs;
+
+full:
+	return bgscan_learn_get_freqs(data, count);
 }
 
 
@@ -275,6 +431,7 @@ static void bgscan_learn_timeout(void *eloop_ctx, void *timeout_ctx)
 	int *freqs = NULL;
 	size_t count, i;
 	char msg[100], *pos;
+	struct os_reltime req;
 
 	os_memset(&params, 0, sizeof(params));
 	params.num_ssids = 1;
@@ -283,9 +440,10 @@ static void bgscan_learn_timeout(void *eloop_ctx, void *timeout_ctx)
 	if (data->ssid->scan_freq)
 		params.freqs = data->ssid->scan_freq;
 	else {
-		freqs = bgscan_learn_get_freqs(data, &count);
-		wpa_printf(MSG_DEBUG, "bgscan learn: BSSes in this ESS have "
-			   "been seen on %u channels", (unsigned int) count);
+		freqs = bgscan_learn_plan_freqs(data, &count);
+		wpa_printf(MSG_DEBUG, "bgscan learn: Scanning %u of the "
+			   "channels on which BSSes in this ESS have been seen",
+			   (unsigned int) count);
 		freqs = bgscan_learn_get_probe_freq(data, freqs, count);
 
 		msg[0] = '\0';
@@ -305,13 +463,17 @@ static void bgscan_learn_timeout(void *eloop_ctx, void *timeout_ctx)
 	}
 
 	wpa_printf(MSG_DEBUG, "bgscan learn: Request a background scan");
+	os_get_reltime(&req);
 	if (wpa_supplicant_trigger_scan(wpa_s, &params)) {
 		wpa_printf(MSG_DEBUG, "bgscan learn: Failed to trigger scan");
 		eloop_register_timeout(data->scan_interval, 0,
 				       bgscan_learn_timeout, data, NULL);
-	} else
-		os_get_reltime(&data->last_bgscan);
-	os_free(freqs);
+		os_free(freqs);
+	} else {
+		data->last_bgscan = req;
+		os_free(data->scan_freqs);
+		data->scan_freqs = freqs;
+	}
 }
 
 
@@ -457,6 +619,8 @@ static void bgscan_learn_deinit(void *priv)
 		bss_free(bss);
 	}
 	os_free(data->supp_freqs);
+	os_free(data->chans);
+	os_free(data->scan_freqs);
 	os_free(data);
 }
 
@@ -478,6 +642,80 @@ static int bgscan_learn_bss_match(struct bgscan_learn_data *data,
 }
 
 
+/*
+ * Scans requested by other components may complete while the background scan
+ * is still pending, so only an own scan that was started after the bgscan
+ * request was issued is considered to be the background scan.
+ */
+static int bgscan_learn_own_scan(struct bgscan_learn_data *data)
+{
+	struct wpa_supplicant *wpa_s = data->wpa_s;
+
+	return data->scan_freqs && wpa_s->scan_work &&
+		!os_reltime_before(&wpa_s->scan_trigger_time,
+				   &data->last_bgscan);
+}
+
+
+static void bgscan_learn_update_chans(struct bgscan_learn_data *data,
+				      struct wpa_scan_results *scan_res,
+				      int own_scan)
+{
+	struct bgscan_learn_chan *chan;
+	size_t i;
+
+	/* Decay the channels scanned by bgscan and credit the hits */
+	for (i = 0; own_scan && data->scan_freqs[i]; i++) {
+		chan = bgscan_learn_get_chan(data, data->scan_freqs[i], 1);
+		if (chan)
+			chan->score -= chan->score >> BGSCAN_LEARN_DECAY_SHIFT;
+	}
+
+	for (i = 0; i < scan_res->num; i++) {
+		struct wpa_scan_res *res = scan_res->res[i];
+
+		if (!bgscan_learn_bss_match(data, res))
+			continue;
+		chan = bgscan_learn_get_chan(data, res->freq, 1);
+		if (chan && !chan->hit) {
+			chan->hit = 1;
+			chan->score += BGSCAN_LEARN_HIT;
+		}
+	}
+
+	for (i = 0; i < data->num_chans; i++)
+		data->chans[i].hit = 0;
+}
+
+
+static void bgscan_learn_update_scan_time(struct bgscan_learn_data *data)
+{
+	struct os_reltime now, diff;
+	unsigned int ms, count = 0, full = 0;
+
+	while (data->scan_freqs[count])
+		count++;
+	while (data->supp_freqs && data->supp_freqs[full])
+		full++;
+	if (count == 0)
+		return;
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, &data->wpa_s->scan_trigger_time, &diff);
+	ms = diff.sec * 1000 + diff.usec / 1000;
+	if (data->chan_time_ms)
+		data->chan_time_ms = (3 * data->chan_time_ms + ms / count) / 4;
+	else
+		data->chan_time_ms = ms / count;
+	if (full > count)
+		data->saved_ms += (full - count) * data->chan_time_ms;
+
+	wpa_printf(MSG_DEBUG, "bgscan learn: Scanned %u/%u channels in %u ms "
+		   "(%u ms per channel; estimated total savings %u ms)",
+		   count, full, ms, data->chan_time_ms, data->saved_ms);
+}
+
+
 static int bgscan_learn_notify_scan(void *priv,
 				    struct wpa_scan_results *scan_res)
 {
@@ -486,6 +724,7 @@ static int bgscan_learn_notify_scan(void *priv,
 #define MAX_BSS 50
 	u8 bssid[MAX_BSS * ETH_ALEN];
 	size_t num_bssid = 0;
+	int own_scan;
 
 	wpa_printf(MSG_DEBUG, "bgscan learn: scan result notification");
 
@@ -507,6 +746,15 @@ static int bgscan_learn_notify_scan(void *priv,
 	wpa_printf(MSG_DEBUG, "bgscan learn: %u matching BSSes in scan "
 		   "results", (unsigned int) num_bssid);
 
+	own_scan = bgscan_learn_own_scan(data);
+	if (own_scan)
+		bgscan_learn_update_scan_time(data);
+	bgscan_learn_update_chans(data, scan_res, own_scan);
+	if (own_scan) {
+		os_free(data->scan_freqs);
+		data->scan_freqs = NULL;
+	}
+
 	for (i = 0; i < scan_res->num; i++) {
 		struct wpa_scan_res *res = scan_res->res[i];
 		struct bgscan_learn_bss *bss;
@@ -7,6 +7,10 @@
  */
 
 #include "utils/includes.h"
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif /* _WIN32 */
 
 #include "utils/common.h"
 #include "utils/eloop.h"
@@ -360,20 +364,11 @@ static bool is_p2p_pending_bss(struct wpa_supplicant *wpa_s,
 
 static int wpa_bss_known(struct wpa_supplicant *wpa_s, struct wpa_bss *bss)
 {
-	struct wpa_ssid *ssid;
-
 	if (is_p2p_pending_bss(wpa_s, bss))
 		return 1;
 
-	for (ssid = wpa_s->conf->ssid; ssid; ssid = ssid->next) {
-		if (ssid->ssid == NULL || ssid->ssid_len == 0)
-			continue;
-		if (ssid->ssid_len == bss->ssid_len &&
-		    os_memcmp(ssid->ssid, bss->ssid, ssid->ssid_len) == 0)
-			return 1;
-	}
-
-	return 0;
+	return wpa_config_get_network_ssid(wpa_s->conf, bss->ssid,
+					   bss->ssid_len) != NULL;
 }
 
 
@@ -967,6 +962,16 @@ void wpa_bss_update_end(struct wpa_supplicant *wpa_s, struct scan_info *info,
 
 	wpa_printf(MSG_DEBUG, "BSS: last_scan_res_used=%zu/%zu",
 		   wpa_s->last_scan_res_used, wpa_s->last_scan_res_size);
+
+	if (wpa_s->conf->bss_cache_file) {
+		struct os_reltime now;
+
+		os_get_reltime(&now);
+		if (wpa_s->bss_cache_saved.sec == 0 ||
+		    os_reltime_expired(&now, &wpa_s->bss_cache_saved,
+				       WPA_BSS_CACHE_SAVE_INTERVAL))
+			wpa_bss_cache_save(wpa_s);
+	}
 }
 
 
@@ -1008,6 +1013,309 @@ void wpa_bss_flush_by_age(struct wpa_supplicant *wpa_s, int age)
 }
 
 
+/*
+ * BSS table cache file format (all integers in little endian byte order):
+ * File header:
+ *   magic "WBSC" (4), version (2), reserved (2), save time in seconds since
+ *   the Epoch (8), number of entries (4)
+ * Followed by the entries:
+ *   BSSID (6), Beacon interval (2), capabilities (2), flags (4), frequency (4),
+ *   quality (4), noise (4), level (4), SNR (4), estimated throughput (4),
+ *   TSF (8), age of the entry at save time in ms (4), ie_len (4),
+ *   beacon_ie_len (4), IEs (ie_len + beacon_ie_len)
+ */
+#define WPA_BSS_CACHE_MAGIC "WBSC"
+#define WPA_BSS_CACHE_VERSION 1
+#define WPA_BSS_CACHE_HDR_LEN 20
+#define WPA_BSS_CACHE_ENTRY_LEN 58
+#define WPA_BSS_CACHE_FLAGS (WPA_BSS_QUAL_INVALID | WPA_BSS_NOISE_INVALID | \
+			     WPA_BSS_LEVEL_INVALID | WPA_BSS_LEVEL_DBM)
+
+static char * wpa_bss_cache_fname(struct wpa_supplicant *wpa_s)
+{
+	char *fname;
+	size_t len;
+
+	/* Interfaces can share a configuration file, so use separate files */
+	len = os_strlen(wpa_s->conf->bss_cache_file) + 1 +
+		os_strlen(wpa_s->ifname) + 1;
+	fname = os_malloc(len);
+	if (fname)
+		os_snprintf(fname, len, "%s.%s", wpa_s->conf->bss_cache_file,
+			    wpa_s->ifname);
+	return fname;
+}
+
+
+/**
+ * wpa_bss_cache_save - Write the BSS table into a file
+ * @wpa_s: Pointer to wpa_supplicant data
+ * Returns: 0 on success, -1 on failure
+ *
+ * The table is written into the file named by the bss_cache_file
+ * configuration parameter followed by a period and the interface name. The
+ * file is written into a temporary file first and then renamed to replace the
+ * old version to avoid leaving behind a partially written cache file. Nothing
+ * is written if the BSS table is empty.
+ */
+int wpa_bss_cache_save(struct wpa_supplicant *wpa_s)
+{
+	struct wpa_bss *bss;
+	struct wpabuf *buf;
+	struct os_time now_time;
+	struct os_reltime now, age;
+	size_t len = WPA_BSS_CACHE_HDR_LEN, tmp_len;
+	unsigned int num = 0;
+	char *fname, *tmp_name;
+	FILE *f;
+	int ret = 0;
+#ifndef _WIN32
+	int fd;
+#endif /* _WIN32 */
+
+	if (dl_list_empty(&wpa_s->bss))
+		return 0;
+
+	dl_list_for_each(bss, &wpa_s->bss, struct wpa_bss, list)
+		len += WPA_BSS_CACHE_ENTRY_LEN + bss->ie_len +
+			bss->beacon_ie_len;
+	buf = wpabuf_alloc(len);
+	if (!buf)
+		return -1;
+
+	os_get_time(&now_time);
+	os_get_reltime(&now);
+	wpabuf_put_data(buf, WPA_BSS_CACHE_MAGIC, 4);
+	wpabuf_put_le16(buf, WPA_BSS_CACHE_VERSION);
+	wpabuf_put_le16(buf, 0);
+	wpabuf_put_le64(buf, now_time.sec);
+	wpabuf_put_le32(buf, wpa_s->num_bss);
+
+	dl_list_for_each(bss, &wpa_s->bss, struct wpa_bss, list) {
+		os_reltime_sub(&now, &bss->last_update, &age);
+		if (age.sec < 0)
+			age.sec = age.usec = 0;
+		wpabuf_put_data(buf, bss->bssid, ETH_ALEN);
+		wpabuf_put_le16(buf, bss->beacon_int);
+		wpabuf_put_le16(buf, bss->caps);
+		wpabuf_put_le32(buf, bss->flags & WPA_BSS_CACHE_FLAGS);
+		wpabuf_put_le32(buf, bss->freq);
+		wpabuf_put_le32(buf, bss->qual);
+		wpabuf_put_le32(buf, bss->noise);
+		wpabuf_put_le32(buf, bss->level);
+		wpabuf_put_le32(buf, bss->snr);
+		wpabuf_put_le32(buf, bss->est_throughput);
+		wpabuf_put_le64(buf, bss->tsf);
+		wpabuf_put_le32(buf, age.sec > 0x7fffffff / 1000 ? 0xffffffff :
+				age.sec * 1000 + age.usec / 1000);
+		wpabuf_put_le32(buf, bss->ie_len);
+		wpabuf_put_le32(buf, bss->beacon_ie_len);
+		wpabuf_put_data(buf, bss->ies, bss->ie_len + bss->beacon_ie_len);
+		num++;
+	}
+
+	fname = wpa_bss_cache_fname(wpa_s);
+	if (!fname) {
+		wpabuf_free(buf);
+		return -1;
+	}
+	tmp_len = os_strlen(fname) + 5;
+	tmp_name = os_malloc(tmp_len);
+	if (!tmp_name) {
+		os_free(fname);
+		wpabuf_free(buf);
+		return -1;
+	}
+	os_snprintf(tmp_name, tmp_len, "%s.tmp", fname);
+
+#ifndef _WIN32
+	/*
+	 * Create the file with restrictive permissions and do not follow a
+	 * symlink left at the temporary file name. A stale file from an earlier
+	 * failure is removed first.
+	 */
+	unlink(tmp_name);
+	fd = open(tmp_name, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW,
+		  S_IRUSR | S_IWUSR);
+	f = fd >= 0 ? fdopen(fd, "wb") : NULL;
+	if (!f && fd >= 0)
+		close(fd);
+#else /* _WIN32 */
+	f = fopen(tmp_name, "wb");
+#endif /* _WIN32 */
+	if (!f) {
+		wpa_printf(MSG_DEBUG, "BSS: Failed to open '%s' for writing",
+			   tmp_name);
+		os_free(tmp_name);
+		os_free(fname);
+		wpabuf_free(buf);
+		return -1;
+	}
+	if (fwrite(wpabuf_head(buf), wpabuf_len(buf), 1, f) != 1)
+		ret = -1;
+	os_fdatasync(f);
+	fclose(f);
+	if (ret == 0 && rename(tmp_name, fname) != 0)
+		ret = -1;
+
+	wpa_dbg(wpa_s, MSG_DEBUG,
+		"BSS: Wrote %u entries (%zu octets) into cache file '%s'%s",
+		num, wpabuf_len(buf), fname, ret ? " - failed" : "");
+	os_free(tmp_name);
+	os_free(fname);
+	wpabuf_free(buf);
+	os_get_reltime(&wpa_s->bss_cache_saved);
+	return ret;
+}
+
+
+/**
+ * wpa_bss_cache_load - Load BSS table entries from a file
+ * @wpa_s: Pointer to wpa_supplicant data
+ * Returns: Number of loaded entries or -1 on failure
+ *
+ * The file written by wpa_bss_cache_save() for this interface is used. Entries that are older than the bss_cache_max_age configuration parameter
+ * are skipped. The age of the loaded entries includes the time the cache file
+ * has been stored, so they expire normally based on bss_expiration_age. The
+ * next scan is limited to the channels on which the loaded entries for the
+ * enabled networks were seen.
+ */
+int wpa_bss_cache_load(struct wpa_supplicant *wpa_s)
+{
+	char *fname, *data;
+	const u8 *pos, *end;
+	size_t len;
+	struct os_time now_time;
+	struct os_reltime now;
+	u64 saved, max_age_ms, total_age;
+	unsigned int i, num, loaded = 0;
+	struct wpa_scan_res *res = NULL;
+	size_t res_len = 0;
+	struct wpa_bss *bss;
+	struct wpa_ssid *ssid;
+	int *freqs = NULL;
+
+	fname = wpa_bss_cache_fname(wpa_s);
+	if (!fname)
+		return -1;
+	data = os_readfile(fname, &len);
+	if (!data) {
+		wpa_dbg(wpa_s, MSG_DEBUG, "BSS: No cache file '%s'", fname);
+		os_free(fname);
+		return -1;
+	}
+
+	pos = (const u8 *) data;
+	end = pos + len;
+	if (len < WPA_BSS_CACHE_HDR_LEN ||
+	    os_memcmp(pos, WPA_BSS_CACHE_MAGIC, 4) != 0 ||
+	    WPA_GET_LE16(pos + 4) != WPA_BSS_CACHE_VERSION) {
+		wpa_printf(MSG_INFO, "BSS: Unsupported cache file '%s'", fname);
+		os_free(data);
+		os_free(fname);
+		return -1;
+	}
+
+	os_get_time(&now_time);
+	os_get_reltime(&now);
+	saved = WPA_GET_LE64(pos + 8);
+	num = WPA_GET_LE32(pos + 16);
+	pos += WPA_BSS_CACHE_HDR_LEN;
+	if (saved > (u64) now_time.sec ||
+	    now_time.sec - saved > wpa_s->conf->bss_cache_max_age) {
+		wpa_dbg(wpa_s, MSG_DEBUG,
+			"BSS: Ignore cache file '%s' saved %lld seconds ago",
+			fname, (long long) (now_time.sec - (os_time_t) saved));
+		os_free(data);
+		os_free(fname);
+		return 0;
+	}
+	/* bss_cache_max_age is not bounded, so avoid unsigned int overflow */
+	max_age_ms = ((u64) wpa_s->conf->bss_cache_max_age -
+		      (now_time.sec - saved)) * 1000;
+
+	for (i = 0; i < num; i++) {
+		u32 ie_len, beacon_ie_len, age;
+
+		if (end - pos < WPA_BSS_CACHE_ENTRY_LEN)
+			break;
+		ie_len = WPA_GET_LE32(pos + 50);
+		beacon_ie_len = WPA_GET_LE32(pos + 54);
+		if (ie_len > (size_t) (end - pos) ||
+		    beacon_ie_len > (size_t) (end - pos) ||
+		    (size_t) (end - pos) < WPA_BSS_CACHE_ENTRY_LEN + ie_len +
+		    beacon_ie_len)
+			break;
+
+		age = WPA_GET_LE32(pos + 46);
+		if (age > max_age_ms) {
+			pos += WPA_BSS_CACHE_ENTRY_LEN + ie_len + beacon_ie_len;
+			continue;
+		}
+
+		if (res_len < sizeof(*res) + ie_len + beacon_ie_len) {
+			os_free(res);
+			res_len = sizeof(*res) + ie_len + beacon_ie_len;
+			res = os_malloc(res_len);
+			if (!res)
+				break;
+		}
+		os_memset(res, 0, sizeof(*res));
+		os_memcpy(res->bssid, pos, ETH_ALEN);
+		res->beacon_int = WPA_GET_LE16(pos + 6);
+		res->caps = WPA_GET_LE16(pos + 8);
+		res->flags = WPA_GET_LE32(pos + 10) & WPA_BSS_CACHE_FLAGS;
+		res->freq = (int) WPA_GET_LE32(pos + 14);
+		res->qual = (int) WPA_GET_LE32(pos + 18);
+		res->noise = (int) WPA_GET_LE32(pos + 22);
+		res->level = (int) WPA_GET_LE32(pos + 26);
+		res->snr = (int) WPA_GET_LE32(pos + 30);
+		res->est_throughput = WPA_GET_LE32(pos + 34);
+		res->tsf = WPA_GET_LE64(pos + 38);
+		total_age = age + (now_time.sec - saved) * 1000;
+		res->age = total_age > 0xffffffff ? 0xffffffff : total_age;
+		res->ie_len = ie_len;
+		res->beacon_ie_len = beacon_ie_len;
+		pos += WPA_BSS_CACHE_ENTRY_LEN;
+		os_memcpy(res + 1, pos, ie_len + beacon_ie_len);
+		pos += ie_len + beacon_ie_len;
+
+		if (wpa_s->num_bss >= wpa_s->conf->bss_max_count)
+			break;
+		wpa_bss_update_scan_res(wpa_s, res, &now);
+		loaded++;
+	}
+	os_free(res);
+	os_free(data);
+
+	/* Loaded entries are not results of a scan */
+	wpa_s->last_scan_res_used = 0;
+
+	dl_list_for_each(bss, &wpa_s->bss, struct wpa_bss, list) {
+		for (ssid = wpa_s->conf->ssid; ssid; ssid = ssid->next) {
+			if (wpas_network_disabled(wpa_s, ssid) ||
+			    ssid->ssid_len != bss->ssid_len ||
+			    os_memcmp(ssid->ssid, bss->ssid,
+				      bss->ssid_len) != 0)
+				continue;
+			int_array_add_unique(&freqs, bss->freq);
+			break;
+		}
+	}
+	if (freqs) {
+		os_free(wpa_s->next_scan_freqs);
+		wpa_s->next_scan_freqs = freqs;
+	}
+
+	wpa_dbg(wpa_s, MSG_DEBUG,
+		"BSS: Loaded %u/%u entries from cache file '%s'%s",
+		loaded, num, fname,
+		freqs ? " - limit next scan to cached channels" : "");
+	os_free(fname);
+	return loaded;
+}
+
+
 /**
  * wpa_bss_init - Initialize BSS table
  * @wpa_s: Pointer to wpa_supplicant data
@@ -1051,6 +1359,9 @@ void wpa_bss_flush(struct wpa_supplicant *wpa_s)
  */
 void wpa_bss_deinit(struct wpa_supplicant *wpa_s)
 {
+	if (wpa_s->conf && wpa_s->conf->bss_cache_file &&
+	    wpa_s->bss.next)
+		wpa_bss_cache_save(wpa_s);
 	wpa_bss_flush(wpa_s);
 }
 
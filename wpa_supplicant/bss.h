@@ -30,6 +30,9 @@ struct wpa_scan_res;
 #define WPA_BSS_RATES_CHANGED_FLAG	BIT(7)
 #define WPA_BSS_IES_CHANGED_FLAG	BIT(8)
 
+/* Minimum interval in seconds between BSS table cache file updates */
+#define WPA_BSS_CACHE_SAVE_INTERVAL 60
+
 struct wpa_bss_anqp_elem {
 	struct dl_list list;
 	u16 infoid;
@@ -148,6 +151,8 @@ int wpa_bss_init(struct wpa_supplicant *wpa_s);
 void wpa_bss_deinit(struct wpa_supplicant *wpa_s);
 void wpa_bss_flush(struct wpa_supplicant *wpa_s);
 void wpa_bss_flush_by_age(struct wpa_supplicant *wpa_s, int age);
+int wpa_bss_cache_save(struct wpa_supplicant *wpa_s);
+int wpa_bss_cache_load(struct wpa_supplicant *wpa_s);
 struct wpa_bss * wpa_bss_get(struct wpa_supplicant *wpa_s, const u8 *bssid,
 			     const u8 *ssid, size_t ssid_len);
 struct wpa_bss * wpa_bss_get_bssid(struct wpa_supplicant *wpa_s,
@@ -12,6 +12,103 @@
 #include "wpa_supplicant_i.h"
 #include "bssid_ignore.h"
 
+/*
+ * Expired entries are removed in batches. The removal time of each entry is
+ * rounded up to this many seconds so that entries expiring close to each
+ * other get removed with a single pass over the list and the list does not
+ * need to be walked on every lookup.
+ */
+#define BSSID_IGNORE_PURGE_BUCKET 60
+
+
+static struct wpa_bssid_ignore *
+wpa_bssid_ignore_hash_get(struct wpa_supplicant *wpa_s, const u8 *bssid)
+{
+	struct wpa_bssid_ignore *e;
+
+	e = wpa_s->bssid_ignore_hash[BSSID_IGNORE_HASH(bssid)];
+	while (e && os_memcmp(e->bssid, bssid, ETH_ALEN) != 0)
+		e = e->hnext;
+	return e;
+}
+
+
+static void wpa_bssid_ignore_hash_del(struct wpa_supplicant *wpa_s,
+				      struct wpa_bssid_ignore *e)
+{
+	struct wpa_bssid_ignore **pos;
+
+	pos = &wpa_s->bssid_ignore_hash[BSSID_IGNORE_HASH(e->bssid)];
+	while (*pos && *pos != e)
+		pos = &(*pos)->hnext;
+	if (*pos)
+		*pos = e->hnext;
+}
+
+
+static void wpa_bssid_ignore_schedule_purge(struct wpa_supplicant *wpa_s,
+					    struct wpa_bssid_ignore *e)
+{
+	os_time_t purge;
+
+	purge = e->start.sec + e->timeout_secs + 3600;
+	purge = (purge / BSSID_IGNORE_PURGE_BUCKET + 1) *
+		BSSID_IGNORE_PURGE_BUCKET;
+	if (wpa_s->bssid_ignore_purge.sec == 0 ||
+	    purge < wpa_s->bssid_ignore_purge.sec) {
+		wpa_s->bssid_ignore_purge.sec = purge;
+		wpa_s->bssid_ignore_purge.usec = 0;
+	}
+}
+
+
+static int wpa_bssid_ignore_add_entry(struct wpa_supplicant *wpa_s,
+				      const u8 *bssid,
+				      struct os_reltime *now)
+{
+	struct wpa_bssid_ignore *e;
+
+	e = wpa_bssid_ignore_hash_get(wpa_s, bssid);
+	if (e) {
+		e->start = *now;
+		e->count++;
+		if (e->count > 5)
+			e->timeout_secs = 1800;
+		else if (e->count == 5)
+			e->timeout_secs = 600;
+		else if (e->count == 4)
+			e->timeout_secs = 120;
+		else if (e->count == 3)
+			e->timeout_secs = 60;
+		else
+			e->timeout_secs = 10;
+		wpa_printf(MSG_INFO, "BSSID " MACSTR
+			   " ignore list count incremented to %d, ignoring for %d seconds",
+			   MAC2STR(bssid), e->count, e->timeout_secs);
+		wpa_bssid_ignore_schedule_purge(wpa_s, e);
+		return e->count;
+	}
+
+	e = os_zalloc(sizeof(*e));
+	if (e == NULL)
+		return -1;
+	os_memcpy(e->bssid, bssid, ETH_ALEN);
+	e->count = 1;
+	e->timeout_secs = 10;
+	e->start = *now;
+	e->next = wpa_s->bssid_ignore;
+	wpa_s->bssid_ignore = e;
+	e->hnext = wpa_s->bssid_ignore_hash[BSSID_IGNORE_HASH(bssid)];
+	wpa_s->bssid_ignore_hash[BSSID_IGNORE_HASH(bssid)] = e;
+	wpa_s->num_bssid_ignore++;
+	wpa_bssid_ignore_schedule_purge(wpa_s, e);
+	wpa_printf(MSG_DEBUG, "Added BSSID " MACSTR
+		   " into ignore list, ignoring for %d seconds",
+		   MAC2STR(bssid), e->timeout_secs);
+
+	return e->count;
+}
+
 /**
  * wpa_bssid_ignore_get - Get the ignore list entry for a BSSID
  * @wpa_s: Pointer to wpa_supplicant data
@@ -21,8 +118,6 @@
 struct wpa_bssid_ignore * wpa_bssid_ignore_get(struct wpa_supplicant *wpa_s,
 					       const u8 *bssid)
 {
-	struct wpa_bssid_ignore *e;
-
 	if (wpa_s == NULL || bssid == NULL)
 		return NULL;
 
@@ -35,14 +130,7 @@ struct wpa_bssid_ignore * wpa_bssid_ignore_get(struct wpa_supplicant *wpa_s,
 
 	wpa_bssid_ignore_update(wpa_s);
 
-	e = wpa_s->bssid_ignore;
-	while (e) {
-		if (os_memcmp(e->bssid, bssid, ETH_ALEN) == 0)
-			return e;
-		e = e->next;
-	}
-
-	return NULL;
+	return wpa_bssid_ignore_hash_get(wpa_s, bssid);
 }
 
 
@@ -64,47 +152,50 @@ struct wpa_bssid_ignore * wpa_bssid_ignore_get(struct wpa_supplicant *wpa_s,
  */
 int wpa_bssid_ignore_add(struct wpa_supplicant *wpa_s, const u8 *bssid)
 {
-	struct wpa_bssid_ignore *e;
 	struct os_reltime now;
 
 	if (wpa_s == NULL || bssid == NULL)
 		return -1;
 
-	e = wpa_bssid_ignore_get(wpa_s, bssid);
+	/* Drop stale entries and handle network reconfiguration */
+	wpa_bssid_ignore_get(wpa_s, bssid);
 	os_get_reltime(&now);
-	if (e) {
-		e->start = now;
-		e->count++;
-		if (e->count > 5)
-			e->timeout_secs = 1800;
-		else if (e->count == 5)
-			e->timeout_secs = 600;
-		else if (e->count == 4)
-			e->timeout_secs = 120;
-		else if (e->count == 3)
-			e->timeout_secs = 60;
-		else
-			e->timeout_secs = 10;
-		wpa_printf(MSG_INFO, "BSSID " MACSTR
-			   " ignore list count incremented to %d, ignoring for %d seconds",
-			   MAC2STR(bssid), e->count, e->timeout_secs);
-		return e->count;
-	}
+	return wpa_bssid_ignore_add_entry(wpa_s, bssid, &now);
+}
 
-	e = os_zalloc(sizeof(*e));
-	if (e == NULL)
+
+/**
+ * wpa_bssid_ignore_add_list - Add a set of BSSIDs to the ignore list
+ * @wpa_s: Pointer to wpa_supplicant data
+ * @bssids: Array of num_bssids * ETH_ALEN octets
+ * @num_bssids: Number of BSSIDs in bssids
+ * Returns: Current number of entries in the ignore list on success, -1 on
+ * failure
+ *
+ * This is equivalent to calling wpa_bssid_ignore_add() for each BSSID, but
+ * the list is updated only once and all the entries share the same start
+ * time.
+ */
+int wpa_bssid_ignore_add_list(struct wpa_supplicant *wpa_s, const u8 *bssids,
+			      size_t num_bssids)
+{
+	struct os_reltime now;
+	size_t i;
+
+	if (wpa_s == NULL || bssids == NULL)
 		return -1;
-	os_memcpy(e->bssid, bssid, ETH_ALEN);
-	e->count = 1;
-	e->timeout_secs = 10;
-	e->start = now;
-	e->next = wpa_s->bssid_ignore;
-	wpa_s->bssid_ignore = e;
-	wpa_printf(MSG_DEBUG, "Added BSSID " MACSTR
-		   " into ignore list, ignoring for %d seconds",
-		   MAC2STR(bssid), e->timeout_secs);
+	if (num_bssids == 0)
+		return wpa_s->num_bssid_ignore;
 
-	return e->count;
+	wpa_bssid_ignore_get(wpa_s, bssids);
+	os_get_reltime(&now);
+	for (i = 0; i < num_bssids; i++) {
+		if (wpa_bssid_ignore_add_entry(wpa_s, &bssids[i * ETH_ALEN],
+					       &now) < 0)
+			return -1;
+	}
+
+	return wpa_s->num_bssid_ignore;
 }
 
 
@@ -121,6 +212,9 @@ int wpa_bssid_ignore_del(struct wpa_supplicant *wpa_s, const u8 *bssid)
 	if (wpa_s == NULL || bssid == NULL)
 		return -1;
 
+	if (!wpa_bssid_ignore_hash_get(wpa_s, bssid))
+		return -1;
+
 	e = wpa_s->bssid_ignore;
 	while (e) {
 		if (os_memcmp(e->bssid, bssid, ETH_ALEN) == 0) {
@@ -129,6 +223,8 @@ int wpa_bssid_ignore_del(struct wpa_supplicant *wpa_s, const u8 *bssid)
 			} else {
 				prev->next = e->next;
 			}
+			wpa_bssid_ignore_hash_del(wpa_s, e);
+			wpa_s->num_bssid_ignore--;
 			wpa_printf(MSG_DEBUG, "Removed BSSID " MACSTR
 				   " from ignore list", MAC2STR(bssid));
 			os_free(e);
@@ -172,6 +268,11 @@ void wpa_bssid_ignore_clear(struct wpa_supplicant *wpa_s)
 
 	e = wpa_s->bssid_ignore;
 	wpa_s->bssid_ignore = NULL;
+	os_memset(wpa_s->bssid_ignore_hash, 0,
+		  sizeof(wpa_s->bssid_ignore_hash));
+	wpa_s->num_bssid_ignore = 0;
+	os_memset(&wpa_s->bssid_ignore_purge, 0,
+		  sizeof(wpa_s->bssid_ignore_purge));
 	while (e) {
 		prev = e;
 		e = e->next;
@@ -186,17 +287,26 @@ void wpa_bssid_ignore_clear(struct wpa_supplicant *wpa_s)
  * wpa_bssid_ignore_update - Update the entries in the ignore list,
  * deleting entries that have been expired for over an hour.
  * @wpa_s: Pointer to wpa_supplicant data
+ *
+ * The list is walked only when at least one entry has become due for removal
+ * (see BSSID_IGNORE_PURGE_BUCKET), so this is cheap to call for each lookup.
  */
 void wpa_bssid_ignore_update(struct wpa_supplicant *wpa_s)
 {
 	struct wpa_bssid_ignore *e, *prev = NULL;
 	struct os_reltime now;
 
-	if (!wpa_s)
+	if (!wpa_s || !wpa_s->bssid_ignore)
 		return;
 
-	e = wpa_s->bssid_ignore;
 	os_get_reltime(&now);
+	if (wpa_s->bssid_ignore_purge.sec &&
+	    os_reltime_before(&now, &wpa_s->bssid_ignore_purge))
+		return;
+
+	os_memset(&wpa_s->bssid_ignore_purge, 0,
+		  sizeof(wpa_s->bssid_ignore_purge));
+	e = wpa_s->bssid_ignore;
 	while (e) {
 		if (os_reltime_expired(&now, &e->start,
 				       e->timeout_secs + 3600)) {
@@ -209,13 +319,43 @@ void wpa_bssid_ignore_update(struct wpa_supplicant *wpa_s)
 				wpa_s->bssid_ignore = e->next;
 				e = wpa_s->bssid_ignore;
 			}
+			wpa_bssid_ignore_hash_del(wpa_s, to_delete);
+			wpa_s->num_bssid_ignore--;
 			wpa_printf(MSG_INFO, "Removed BSSID " MACSTR
 				   " from ignore list (expired)",
 				   MAC2STR(to_delete->bssid));
 			os_free(to_delete);
 		} else {
+			wpa_bssid_ignore_schedule_purge(wpa_s, e);
 			prev = e;
 			e = e->next;
 		}
 	}
 }
+
+
+/**
+ * wpa_bssid_ignore_count - Get the number of entries in the ignore list
+ * @wpa_s: Pointer to wpa_supplicant data
+ * @active: Buffer for returning the number of entries that are currently
+ *	within their ignore timeout or %NULL if not needed
+ * Returns: Total number of entries in the ignore list
+ */
+unsigned int wpa_bssid_ignore_count(struct wpa_supplicant *wpa_s,
+				    unsigned int *active)
+{
+	struct wpa_bssid_ignore *e;
+	struct os_reltime now;
+
+	if (active) {
+		*active = 0;
+		os_get_reltime(&now);
+		for (e = wpa_s->bssid_ignore; e; e = e->next) {
+			if (!os_reltime_expired(&now, &e->start,
+						e->timeout_secs))
+				(*active)++;
+		}
+	}
+
+	return wpa_s->num_bssid_ignore;
+}
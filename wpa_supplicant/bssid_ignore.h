@@ -11,6 +11,7 @@
 
 struct wpa_bssid_ignore {
 	struct wpa_bssid_ignore *next;
+	struct wpa_bssid_ignore *hnext; /* next entry in hash table list */
 	u8 bssid[ETH_ALEN];
 	int count;
 	/* Time of the most recent trigger to ignore this BSSID. */
@@ -29,5 +30,9 @@ int wpa_bssid_ignore_del(struct wpa_supplicant *wpa_s, const u8 *bssid);
 int wpa_bssid_ignore_is_listed(struct wpa_supplicant *wpa_s, const u8 *bssid);
 void wpa_bssid_ignore_clear(struct wpa_supplicant *wpa_s);
 void wpa_bssid_ignore_update(struct wpa_supplicant *wpa_s);
+int wpa_bssid_ignore_add_list(struct wpa_supplicant *wpa_s, const u8 *bssids,
+			      size_t num_bssids);
+unsigned int wpa_bssid_ignore_count(struct wpa_supplicant *wpa_s,
+				    unsigned int *active);
 
 #endif /* BSSID_IGNORE_H */
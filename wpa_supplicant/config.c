@@ -2785,6 +2785,40 @@ int wpa_config_add_prio_network(struct wpa_config *config,
 }
 
 
+static int wpa_config_del_prio_network(struct wpa_config *config,
+				       struct wpa_ssid *ssid)
+{
+	size_t prio;
+	struct wpa_ssid **pos;
+
+	for (prio = 0; prio < config->num_prio; prio++) {
+		if (config->pssid[prio]->priority == ssid->priority)
+			break;
+	}
+	if (prio == config->num_prio)
+		return -1;
+
+	for (pos = &config->pssid[prio]; *pos; pos = &(*pos)->pnext) {
+		if (*pos == ssid)
+			break;
+	}
+	if (!*pos)
+		return -1;
+	*pos = ssid->pnext;
+	ssid->pnext = NULL;
+
+	if (!config->pssid[prio]) {
+		/* Last network for this priority - remove the priority list */
+		os_memmove(&config->pssid[prio], &config->pssid[prio + 1],
+			   (config->num_prio - prio - 1) *
+			   sizeof(struct wpa_ssid *));
+		config->num_prio--;
+	}
+
+	return 0;
+}
+
+
 /**
  * wpa_config_update_prio_list - Update network priority list
  * @config: Configuration data from wpa_config_read()
@@ -2796,19 +2830,43 @@ int wpa_config_add_prio_network(struct wpa_config *config,
  */
 int wpa_config_update_prio_list(struct wpa_config *config)
 {
-	struct wpa_ssid *ssid;
+	struct wpa_ssid *ssid, *prev, *next;
+	size_t prio;
 	int ret = 0;
 
 	os_free(config->pssid);
 	config->pssid = NULL;
 	config->num_prio = 0;
 
-	ssid = config->ssid;
-	while (ssid) {
+	/*
+	 * Prepend each network to its priority list to avoid walking the list
+	 * for every network and reverse the lists afterwards to maintain the
+	 * configuration order within each priority.
+	 */
+	for (ssid = config->ssid; ssid; ssid = ssid->next) {
 		ssid->pnext = NULL;
-		if (wpa_config_add_prio_network(config, ssid) < 0)
+		for (prio = 0; prio < config->num_prio; prio++) {
+			if (config->pssid[prio]->priority == ssid->priority) {
+				ssid->pnext = config->pssid[prio];
+				config->pssid[prio] = ssid;
+				break;
+			}
+		}
+		if (prio == config->num_prio &&
+		    wpa_config_add_prio_network(config, ssid) < 0)
 			ret = -1;
-		ssid = ssid->next;
+	}
+
+	for (prio = 0; prio < config->num_prio; prio++) {
+		prev = NULL;
+		ssid = config->pssid[prio];
+		while (ssid) {
+			next = ssid->pnext;
+			ssid->pnext = prev;
+			prev = ssid;
+			ssid = next;
+		}
+		config->pssid[prio] = prev;
 	}
 
 	return ret;
@@ -2998,6 +3056,7 @@ void wpa_config_free(struct wpa_config *config)
 	}
 
 	wpa_config_flush_blobs(config);
+	bin_clear_free(config->written_conf, config->written_conf_len);
 
 	wpabuf_free(config->wps_vendor_ext_m1);
 	for (i = 0; i < MAX_WPS_VENDOR_EXT; i++)
@@ -3024,6 +3083,7 @@ void wpa_config_free(struct wpa_config *config)
 	os_free(config->autoscan);
 	os_free(config->freq_list);
 	os_free(config->initial_freq_list);
+	os_free(config->bss_cache_file);
 	wpabuf_free(config->wps_nfc_dh_pubkey);
 	wpabuf_free(config->wps_nfc_dh_privkey);
 	wpabuf_free(config->wps_nfc_dev_pw);
@@ -3073,6 +3133,96 @@ void wpa_config_foreach_network(struct wpa_config *config,
 }
 
 
+#define WPA_CONFIG_ID_HASH(id) \
+	((unsigned int) (id) % WPA_CONFIG_NETWORK_HASH_SIZE)
+
+static unsigned int wpa_config_ssid_hash(const u8 *ssid, size_t ssid_len)
+{
+	unsigned int hash = 0;
+	size_t i;
+
+	for (i = 0; i < ssid_len; i++)
+		hash = hash * 31 + ssid[i];
+
+	return hash % WPA_CONFIG_NETWORK_HASH_SIZE;
+}
+
+
+static void wpa_config_build_id_index(struct wpa_config *config)
+{
+	struct wpa_ssid *ssid;
+	unsigned int hash;
+
+	os_memset(config->network_id_hash, 0,
+		  sizeof(config->network_id_hash));
+	config->network_tail = NULL;
+	config->network_max_id = -1;
+
+	for (ssid = config->ssid; ssid; ssid = ssid->next) {
+		hash = WPA_CONFIG_ID_HASH(ssid->id);
+		ssid->id_hnext = config->network_id_hash[hash];
+		config->network_id_hash[hash] = ssid;
+		if (ssid->id > config->network_max_id)
+			config->network_max_id = ssid->id;
+		config->network_tail = ssid;
+	}
+
+	config->network_id_index_valid = 1;
+}
+
+
+static void wpa_config_build_ssid_index(struct wpa_config *config)
+{
+	struct wpa_ssid *ssid;
+	unsigned int hash;
+
+	os_memset(config->network_ssid_hash, 0,
+		  sizeof(config->network_ssid_hash));
+	config->network_ssid_unset = NULL;
+
+	for (ssid = config->ssid; ssid; ssid = ssid->next) {
+		if (!ssid->ssid || !ssid->ssid_len) {
+			ssid->ssid_hnext = config->network_ssid_unset;
+			config->network_ssid_unset = ssid;
+			continue;
+		}
+		hash = wpa_config_ssid_hash(ssid->ssid, ssid->ssid_len);
+		ssid->ssid_hnext = config->network_ssid_hash[hash];
+		config->network_ssid_hash[hash] = ssid;
+	}
+
+	config->network_ssid_index_valid = 1;
+}
+
+
+/**
+ * wpa_config_network_index_reset - Invalidate network lookup indexes
+ * @config: Configuration data from wpa_config_read()
+ *
+ * This function needs to be called whenever the network list (config->ssid)
+ * is modified without using wpa_config_add_network() and
+ * wpa_config_remove_network(). The indexes are rebuilt on the next lookup.
+ */
+void wpa_config_network_index_reset(struct wpa_config *config)
+{
+	config->network_id_index_valid = 0;
+	config->network_ssid_index_valid = 0;
+}
+
+
+/**
+ * wpa_config_network_ssid_changed - Note SSID change in an existing network
+ * @config: Configuration data from wpa_config_read()
+ *
+ * This function needs to be called when the SSID of a network that already
+ * had an SSID configured is changed.
+ */
+void wpa_config_network_ssid_changed(struct wpa_config *config)
+{
+	config->network_ssid_index_valid = 0;
+}
+
+
 /**
  * wpa_config_get_network - Get configured network based on id
  * @config: Configuration data from wpa_config_read()
@@ -3083,17 +3233,56 @@ struct wpa_ssid * wpa_config_get_network(struct wpa_config *config, int id)
 {
 	struct wpa_ssid *ssid;
 
-	ssid = config->ssid;
+	if (!config->network_id_index_valid)
+		wpa_config_build_id_index(config);
+
+	ssid = config->network_id_hash[WPA_CONFIG_ID_HASH(id)];
 	while (ssid) {
 		if (id == ssid->id)
 			break;
-		ssid = ssid->next;
+		ssid = ssid->id_hnext;
 	}
 
 	return ssid;
 }
 
 
+/**
+ * wpa_config_get_network_ssid - Get a configured network based on SSID
+ * @config: Configuration data from wpa_config_read()
+ * @ssid: SSID to search for
+ * @ssid_len: Length of the SSID in octets
+ * Returns: A network configured with the SSID or %NULL if not found
+ */
+struct wpa_ssid * wpa_config_get_network_ssid(struct wpa_config *config,
+					      const u8 *ssid, size_t ssid_len)
+{
+	struct wpa_ssid *s;
+
+	if (!ssid || !ssid_len)
+		return NULL;
+
+	if (!config->network_ssid_index_valid)
+		wpa_config_build_ssid_index(config);
+
+	s = config->network_ssid_hash[wpa_config_ssid_hash(ssid, ssid_len)];
+	for (; s; s = s->ssid_hnext) {
+		if (s->ssid && s->ssid_len == ssid_len &&
+		    os_memcmp(s->ssid, ssid, ssid_len) == 0)
+			return s;
+	}
+
+	/* Networks that did not have an SSID when the index was built */
+	for (s = config->network_ssid_unset; s; s = s->ssid_hnext) {
+		if (s->ssid && s->ssid_len == ssid_len &&
+		    os_memcmp(s->ssid, ssid, ssid_len) == 0)
+			return s;
+	}
+
+	return NULL;
+}
+
+
 /**
  * wpa_config_add_network - Add a new network with empty configuration
  * @config: Configuration data from wpa_config_read()
@@ -3101,30 +3290,34 @@ struct wpa_ssid * wpa_config_get_network(struct wpa_config *config, int id)
  */
 struct wpa_ssid * wpa_config_add_network(struct wpa_config *config)
 {
-	int id;
-	struct wpa_ssid *ssid, *last = NULL;
+	unsigned int hash;
+	struct wpa_ssid *ssid;
 
-	id = -1;
-	ssid = config->ssid;
-	while (ssid) {
-		if (ssid->id > id)
-			id = ssid->id;
-		last = ssid;
-		ssid = ssid->next;
-	}
-	id++;
+	if (!config->network_id_index_valid)
+		wpa_config_build_id_index(config);
 
 	ssid = os_zalloc(sizeof(*ssid));
 	if (ssid == NULL)
 		return NULL;
-	ssid->id = id;
+	ssid->id = config->network_max_id + 1;
 	dl_list_init(&ssid->psk_list);
-	if (last)
-		last->next = ssid;
+	if (config->network_tail)
+		config->network_tail->next = ssid;
 	else
 		config->ssid = ssid;
+	config->network_tail = ssid;
+	config->network_max_id = ssid->id;
+
+	hash = WPA_CONFIG_ID_HASH(ssid->id);
+	ssid->id_hnext = config->network_id_hash[hash];
+	config->network_id_hash[hash] = ssid;
+
+	if (config->network_ssid_index_valid) {
+		ssid->ssid_hnext = config->network_ssid_unset;
+		config->network_ssid_unset = ssid;
+	}
 
-	wpa_config_update_prio_list(config);
+	wpa_config_add_prio_network(config, ssid);
 
 	return ssid;
 }
@@ -3138,25 +3331,60 @@ struct wpa_ssid * wpa_config_add_network(struct wpa_config *config)
  */
 int wpa_config_remove_network(struct wpa_config *config, int id)
 {
-	struct wpa_ssid *ssid, *prev = NULL;
-
-	ssid = config->ssid;
-	while (ssid) {
-		if (id == ssid->id)
-			break;
-		prev = ssid;
-		ssid = ssid->next;
-	}
+	struct wpa_ssid *ssid, *prev = NULL, **pos;
 
+	ssid = wpa_config_get_network(config, id);
 	if (ssid == NULL)
 		return -1;
 
+	if (ssid != config->ssid) {
+		prev = config->ssid;
+		while (prev->next != ssid)
+			prev = prev->next;
+	}
+
 	if (prev)
 		prev->next = ssid->next;
 	else
 		config->ssid = ssid->next;
 
-	wpa_config_update_prio_list(config);
+	for (pos = &config->network_id_hash[WPA_CONFIG_ID_HASH(id)]; *pos;
+	     pos = &(*pos)->id_hnext) {
+		if (*pos == ssid) {
+			*pos = ssid->id_hnext;
+			break;
+		}
+	}
+	if (config->network_tail == ssid)
+		config->network_tail = prev;
+	if (ssid->id == config->network_max_id)
+		config->network_id_index_valid = 0;
+
+	if (config->network_ssid_index_valid) {
+		pos = &config->network_ssid_unset;
+		if (ssid->ssid && ssid->ssid_len) {
+			pos = &config->network_ssid_hash[
+				wpa_config_ssid_hash(ssid->ssid,
+						     ssid->ssid_len)];
+			while (*pos && *pos != ssid)
+				pos = &(*pos)->ssid_hnext;
+			if (!*pos)
+				pos = &config->network_ssid_unset;
+		}
+		while (*pos && *pos != ssid)
+			pos = &(*pos)->ssid_hnext;
+		if (*pos)
+			*pos = ssid->ssid_hnext;
+		else
+			config->network_ssid_index_valid = 0;
+	}
+
+	/*
+	 * Priority may have been modified without updating the priority lists,
+	 * so rebuild them if the network is not where it is expected to be.
+	 */
+	if (wpa_config_del_prio_network(config, ssid) < 0)
+		wpa_config_update_prio_list(config);
 	wpa_config_free_ssid(ssid);
 	return 0;
 }
@@ -4612,6 +4840,7 @@ struct wpa_config * wpa_config_alloc_empty(const char *ctrl_interface,
 	config->p2p_go_ctwindow = DEFAULT_P2P_GO_CTWINDOW;
 	config->bss_max_count = DEFAULT_BSS_MAX_COUNT;
 	config->bss_expiration_age = DEFAULT_BSS_EXPIRATION_AGE;
+	config->bss_cache_max_age = DEFAULT_BSS_CACHE_MAX_AGE;
 	config->bss_expiration_scan_count = DEFAULT_BSS_EXPIRATION_SCAN_COUNT;
 	config->max_num_sta = DEFAULT_MAX_NUM_STA;
 	config->ap_isolate = DEFAULT_AP_ISOLATE;
@@ -5332,6 +5561,7 @@ static const struct global_parse_data global_fields[] = {
 	{ INT(dot11RSNAConfigSATimeout), 0 },
 #ifndef CONFIG_NO_CONFIG_WRITE
 	{ INT(update_config), 0 },
+	{ INT_RANGE(update_config_incremental, 0, 1), 0 },
 #endif /* CONFIG_NO_CONFIG_WRITE */
 	{ FUNC_NO_VAR(load_dynamic_eap), 0 },
 #ifdef CONFIG_WPS
@@ -5390,6 +5620,8 @@ static const struct global_parse_data global_fields[] = {
 	{ INT(bss_max_count), 0 },
 	{ INT(bss_expiration_age), 0 },
 	{ INT(bss_expiration_scan_count), 0 },
+	{ STR(bss_cache_file), 0 },
+	{ INT(bss_cache_max_age), 0 },
 	{ INT_RANGE(filter_ssids, 0, 1), 0 },
 	{ INT_RANGE(filter_rssi, -100, 0), 0 },
 	{ INT(max_num_sta), 0 },
@@ -32,6 +32,7 @@
 #define DEFAULT_BSS_MAX_COUNT 200
 #define DEFAULT_BSS_EXPIRATION_AGE 180
 #define DEFAULT_BSS_EXPIRATION_SCAN_COUNT 2
+#define DEFAULT_BSS_CACHE_MAX_AGE 300
 #define DEFAULT_MAX_NUM_STA 128
 #define DEFAULT_AP_ISOLATE 0
 #define DEFAULT_ACCESS_NETWORK_TYPE 15
@@ -468,6 +469,40 @@ struct wpa_config {
 	 */
 	size_t num_prio;
 
+#define WPA_CONFIG_NETWORK_HASH_SIZE 256
+
+	/**
+	 * network_id_hash - Network lookup index keyed by network id
+	 *
+	 * This index and the other network_* fields below are maintained by
+	 * config.c. They are rebuilt on demand after
+	 * wpa_config_network_index_reset() has been called, so code that
+	 * replaces the ssid list directly must call that function.
+	 */
+	struct wpa_ssid *network_id_hash[WPA_CONFIG_NETWORK_HASH_SIZE];
+
+	/**
+	 * network_ssid_hash - Network lookup index keyed by SSID
+	 *
+	 * Networks without an SSID are kept in network_ssid_unset instead,
+	 * so that an SSID assigned to a newly added network is still found.
+	 */
+	struct wpa_ssid *network_ssid_hash[WPA_CONFIG_NETWORK_HASH_SIZE];
+	struct wpa_ssid *network_ssid_unset;
+
+	/**
+	 * network_tail - Last network in the ssid list
+	 */
+	struct wpa_ssid *network_tail;
+
+	/**
+	 * network_max_id - Largest network id in the ssid list or -1
+	 */
+	int network_max_id;
+
+	unsigned int network_id_index_valid:1;
+	unsigned int network_ssid_index_valid:1;
+
 	/**
 	 * cred - Head of the credential list
 	 *
@@ -718,6 +753,27 @@ struct wpa_config {
 	 */
 	int update_config;
 
+	/**
+	 * update_config_incremental - Update configuration file incrementally
+	 *
+	 * If this is non-zero, the serialized configuration is compared to
+	 * the contents written previously by this process. When the earlier
+	 * contents are unchanged and only new data has been added to the end
+	 * (e.g., new network blocks), only the new data is appended to the
+	 * file instead of rewriting it. Otherwise, the file is fully rewritten
+	 * as usual.
+	 */
+	int update_config_incremental;
+
+	/**
+	 * written_conf - Configuration file contents from the last write
+	 *
+	 * This is maintained by wpa_config_write() when
+	 * update_config_incremental is enabled.
+	 */
+	char *written_conf;
+	size_t written_conf_len;
+
 	/**
 	 * blobs - Configuration blobs
 	 */
@@ -934,6 +990,27 @@ struct wpa_config {
 	 */
 	unsigned int bss_expiration_scan_count;
 
+	/**
+	 * bss_cache_file - File for storing the BSS table over restarts
+	 *
+	 * If set, the BSS table is written in binary format when the
+	 * interface is deinitialized and periodically after new scan results.
+	 * The file name is this value followed by a period and the interface
+	 * name so that interfaces sharing a configuration do not overwrite
+	 * each other's entries. The stored entries are loaded back into the
+	 * BSS table when the interface is initialized and used to limit the
+	 * first scan to the channels on which enabled networks were last seen.
+	 */
+	char *bss_cache_file;
+
+	/**
+	 * bss_cache_max_age - Maximum age of BSS entries loaded from cache
+	 *
+	 * Entries in bss_cache_file that were last updated more than this
+	 * many seconds ago are not loaded into the BSS table.
+	 */
+	unsigned int bss_cache_max_age;
+
 	/**
 	 * filter_ssids - SSID-based scan result filtering
 	 *
@@ -1782,6 +1859,10 @@ void wpa_config_foreach_network(struct wpa_config *config,
 				void (*func)(void *, struct wpa_ssid *),
 				void *arg);
 struct wpa_ssid * wpa_config_get_network(struct wpa_config *config, int id);
+struct wpa_ssid * wpa_config_get_network_ssid(struct wpa_config *config,
+					      const u8 *ssid, size_t ssid_len);
+void wpa_config_network_index_reset(struct wpa_config *config);
+void wpa_config_network_ssid_changed(struct wpa_config *config);
 struct wpa_ssid * wpa_config_add_network(struct wpa_config *config);
 int wpa_config_remove_network(struct wpa_config *config, int id);
 void wpa_config_set_network_defaults(struct wpa_ssid *ssid);
@@ -11,9 +11,9 @@
  */
 
 #include "includes.h"
-#ifdef ANDROID
+#if defined(ANDROID) || !defined(_WIN32)
 #include <sys/stat.h>
-#endif /* ANDROID */
+#endif /* ANDROID || !_WIN32 */
 
 #include "common.h"
 #include "config.h"
@@ -352,13 +352,6 @@ struct wpa_config * wpa_config_read(const char *name, struct wpa_config *cfgp,
 				tail->next = ssid;
 				tail = ssid;
 			}
-			if (wpa_config_add_prio_network(config, ssid)) {
-				wpa_printf(MSG_ERROR, "Line %d: failed to add "
-					   "network block to priority list.",
-					   line);
-				errors++;
-				continue;
-			}
 		} else if (os_strcmp(pos, "cred={") == 0) {
 			cred = wpa_config_read_cred(f, &line, cred_id++);
 			if (cred == NULL) {
@@ -394,6 +387,12 @@ struct wpa_config * wpa_config_read(const char *name, struct wpa_config *cfgp,
 	fclose(f);
 
 	config->ssid = head;
+	wpa_config_network_index_reset(config);
+	if (wpa_config_update_prio_list(config)) {
+		wpa_printf(MSG_ERROR, "Failed to add network blocks to "
+			   "priority list.");
+		errors++;
+	}
 	wpa_config_debug_dump_networks(config);
 	config->cred = cred_head;
 
@@ -1150,6 +1149,9 @@ static void wpa_config_write_global(FILE *f, struct wpa_config *config)
 			config->dot11RSNAConfigSATimeout);
 	if (config->update_config)
 		fprintf(f, "update_config=%d\n", config->update_config);
+	if (config->update_config_incremental)
+		fprintf(f, "update_config_incremental=%d\n",
+			config->update_config_incremental);
 #ifdef CONFIG_WPS
 	if (!is_nil_uuid(config->uuid)) {
 		char buf[40];
@@ -1314,6 +1316,10 @@ static void wpa_config_write_global(FILE *f, struct wpa_config *config)
 	    DEFAULT_BSS_EXPIRATION_SCAN_COUNT)
 		fprintf(f, "bss_expiration_scan_count=%u\n",
 			config->bss_expiration_scan_count);
+	if (config->bss_cache_file)
+		fprintf(f, "bss_cache_file=%s\n", config->bss_cache_file);
+	if (config->bss_cache_max_age != DEFAULT_BSS_CACHE_MAX_AGE)
+		fprintf(f, "bss_cache_max_age=%u\n", config->bss_cache_max_age);
 	if (config->filter_ssids)
 		fprintf(f, "filter_ssids=%d\n", config->filter_ssids);
 	if (config->filter_rssi)
@@ -1606,43 +1612,19 @@ static void wpa_config_write_global(FILE *f, struct wpa_config *config)
 			config->wowlan_disconnect_on_deinit);
 }
 
-#endif /* CONFIG_NO_CONFIG_WRITE */
 
+#ifndef _WIN32
+#define WPA_CONFIG_INCREMENTAL_WRITE
+#endif /* _WIN32 */
 
-int wpa_config_write(const char *name, struct wpa_config *config)
+static int wpa_config_write_contents(FILE *f, struct wpa_config *config)
 {
-#ifndef CONFIG_NO_CONFIG_WRITE
-	FILE *f;
 	struct wpa_ssid *ssid;
 	struct wpa_cred *cred;
 #ifndef CONFIG_NO_CONFIG_BLOBS
 	struct wpa_config_blob *blob;
 #endif /* CONFIG_NO_CONFIG_BLOBS */
 	int ret = 0;
-	const char *orig_name = name;
-	int tmp_len;
-	char *tmp_name;
-
-	if (!name) {
-		wpa_printf(MSG_ERROR, "No configuration file for writing");
-		return -1;
-	}
-
-	tmp_len = os_strlen(name) + 5; /* allow space for .tmp suffix */
-	tmp_name = os_malloc(tmp_len);
-	if (tmp_name) {
-		os_snprintf(tmp_name, tmp_len, "%s.tmp", name);
-		name = tmp_name;
-	}
-
-	wpa_printf(MSG_DEBUG, "Writing configuration file '%s'", name);
-
-	f = fopen(name, "w");
-	if (f == NULL) {
-		wpa_printf(MSG_DEBUG, "Failed to open '%s' for writing", name);
-		os_free(tmp_name);
-		return -1;
-	}
 
 	wpa_config_write_global(f, config);
 
@@ -1677,6 +1659,142 @@ int wpa_config_write(const char *name, struct wpa_config *config)
 	}
 #endif /* CONFIG_NO_CONFIG_BLOBS */
 
+	return ret;
+}
+
+
+#ifdef WPA_CONFIG_INCREMENTAL_WRITE
+
+static char * wpa_config_serialize(struct wpa_config *config, size_t *len)
+{
+	FILE *f;
+	char *mbuf = NULL, *buf;
+	size_t mlen = 0;
+	int ret;
+
+	f = open_memstream(&mbuf, &mlen);
+	if (!f)
+		return NULL;
+	ret = wpa_config_write_contents(f, config);
+	if (fclose(f) != 0 || !mbuf)
+		ret = -1;
+
+	/* open_memstream() buffer is from libc; move it to os_malloc() */
+	buf = ret ? NULL : os_memdup(mbuf, mlen + 1);
+	if (mbuf) {
+		forced_memzero(mbuf, mlen);
+		free(mbuf);
+	}
+	if (buf)
+		*len = mlen;
+	return buf;
+}
+
+
+/*
+ * Returns 0 if the file on disk now matches buf (either it was unchanged or
+ * the new data was appended) or -1 if a full rewrite is needed.
+ */
+static int wpa_config_append(const char *name, struct wpa_config *config,
+			     const char *buf, size_t len)
+{
+	struct stat st;
+	FILE *f;
+	size_t old_len = config->written_conf_len;
+	int ret = 0;
+
+	if (!config->written_conf || len < old_len ||
+	    os_memcmp(buf, config->written_conf, old_len) != 0)
+		return -1;
+
+	/* Do not append to a file that was modified by something else */
+	if (stat(name, &st) != 0 || st.st_size < 0 ||
+	    (size_t) st.st_size != old_len)
+		return -1;
+
+	if (len == old_len) {
+		wpa_printf(MSG_DEBUG, "Configuration file '%s' unchanged",
+			   name);
+		return 0;
+	}
+
+	wpa_printf(MSG_DEBUG, "Appending %zu octets to configuration file '%s'",
+		   len - old_len, name);
+	f = fopen(name, "a");
+	if (!f)
+		return -1;
+	if (fwrite(buf + old_len, 1, len - old_len, f) != len - old_len)
+		ret = -1;
+	os_fdatasync(f);
+	if (fclose(f) != 0)
+		ret = -1;
+
+	return ret;
+}
+
+#endif /* WPA_CONFIG_INCREMENTAL_WRITE */
+
+#endif /* CONFIG_NO_CONFIG_WRITE */
+
+
+int wpa_config_write(const char *name, struct wpa_config *config)
+{
+#ifndef CONFIG_NO_CONFIG_WRITE
+	FILE *f;
+	int ret = 0;
+	const char *orig_name = name;
+	int tmp_len;
+	char *tmp_name;
+#ifdef WPA_CONFIG_INCREMENTAL_WRITE
+	char *buf = NULL;
+	size_t len = 0;
+#endif /* WPA_CONFIG_INCREMENTAL_WRITE */
+
+	if (!name) {
+		wpa_printf(MSG_ERROR, "No configuration file for writing");
+		return -1;
+	}
+
+#ifdef WPA_CONFIG_INCREMENTAL_WRITE
+	if (config->update_config_incremental) {
+		buf = wpa_config_serialize(config, &len);
+		if (buf && wpa_config_append(name, config, buf, len) == 0) {
+			bin_clear_free(config->written_conf,
+				       config->written_conf_len);
+			config->written_conf = buf;
+			config->written_conf_len = len;
+			return 0;
+		}
+	}
+#endif /* WPA_CONFIG_INCREMENTAL_WRITE */
+
+	tmp_len = os_strlen(name) + 5; /* allow space for .tmp suffix */
+	tmp_name = os_malloc(tmp_len);
+	if (tmp_name) {
+		os_snprintf(tmp_name, tmp_len, "%s.tmp", name);
+		name = tmp_name;
+	}
+
+	wpa_printf(MSG_DEBUG, "Writing configuration file '%s'", name);
+
+	f = fopen(name, "w");
+	if (f == NULL) {
+		wpa_printf(MSG_DEBUG, "Failed to open '%s' for writing", name);
+		os_free(tmp_name);
+#ifdef WPA_CONFIG_INCREMENTAL_WRITE
+		bin_clear_free(buf, len);
+#endif /* WPA_CONFIG_INCREMENTAL_WRITE */
+		return -1;
+	}
+
+#ifdef WPA_CONFIG_INCREMENTAL_WRITE
+	if (buf) {
+		if (fwrite(buf, 1, len, f) != len)
+			ret = -1;
+	} else
+#endif /* WPA_CONFIG_INCREMENTAL_WRITE */
+	ret = wpa_config_write_contents(f, config);
+
 	os_fdatasync(f);
 
 	fclose(f);
@@ -1694,6 +1812,18 @@ int wpa_config_write(const char *name, struct wpa_config *config)
 		os_free(tmp_name);
 	}
 
+#ifdef WPA_CONFIG_INCREMENTAL_WRITE
+	bin_clear_free(config->written_conf, config->written_conf_len);
+	config->written_conf = NULL;
+	config->written_conf_len = 0;
+	if (buf && ret == 0) {
+		config->written_conf = buf;
+		config->written_conf_len = len;
+	} else {
+		bin_clear_free(buf, len);
+	}
+#endif /* WPA_CONFIG_INCREMENTAL_WRITE */
+
 	wpa_printf(MSG_DEBUG, "Configuration file '%s' written %ssuccessfully",
 		   orig_name, ret ? "un" : "");
 	return ret;
@@ -105,6 +105,22 @@ struct wpa_ssid {
 	 */
 	struct wpa_ssid *pnext;
 
+	/**
+	 * id_hnext - Next network in the same network id hash bucket
+	 *
+	 * This is used internally by config.c to maintain the id index of
+	 * struct wpa_config and is not valid outside of it.
+	 */
+	struct wpa_ssid *id_hnext;
+
+	/**
+	 * ssid_hnext - Next network in the same SSID hash bucket
+	 *
+	 * This is used internally by config.c to maintain the SSID index of
+	 * struct wpa_config and is not valid outside of it.
+	 */
+	struct wpa_ssid *ssid_hnext;
+
 	/**
 	 * id - Unique id for the network
 	 *
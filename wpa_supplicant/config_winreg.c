@@ -441,6 +441,7 @@ static int wpa_config_read_networks(struct wpa_config *config, HKEY hk)
 	RegCloseKey(nhk);
 
 	config->ssid = head;
+	wpa_config_network_index_reset(config);
 
 	return errors ? -1 : 0;
 }
@@ -13,6 +13,7 @@
 
 #include "utils/common.h"
 #include "utils/eloop.h"
+#include "utils/obj_pool.h"
 #include "utils/uuid.h"
 #include "utils/module_tests.h"
 #include "common/version.h"
@@ -2607,12 +2608,13 @@ static int wpa_supplicant_ctrl_iface_bssid_ignore(struct wpa_supplicant *wpa_s,
 						  char *cmd, char *buf,
 						  size_t buflen)
 {
-	u8 bssid[ETH_ALEN];
+	u8 *bssids;
+	size_t count;
 	struct wpa_bssid_ignore *e;
 	char *pos, *end;
 	int ret;
 
-	/* cmd: "BSSID_IGNORE [<BSSID>]" */
+	/* cmd: "BSSID_IGNORE [<BSSID>...|clear|stats]" */
 	if (*cmd == '\0') {
 		pos = buf;
 		end = buf + buflen;
@@ -2635,22 +2637,53 @@ static int wpa_supplicant_ctrl_iface_bssid_ignore(struct wpa_supplicant *wpa_s,
 		return 3;
 	}
 
+	if (os_strcmp(cmd, "stats") == 0) {
+		unsigned int entries, active;
+
+		entries = wpa_bssid_ignore_count(wpa_s, &active);
+		ret = os_snprintf(buf, buflen, "entries=%u\nactive=%u\n",
+				  entries, active);
+		if (os_snprintf_error(buflen, ret))
+			return -1;
+		return ret;
+	}
+
+	/* cmd: "BSSID_IGNORE <BSSID> [<BSSID>...]" */
 	wpa_printf(MSG_DEBUG, "CTRL_IFACE: BSSID_IGNORE bssid='%s'", cmd);
-	if (hwaddr_aton(cmd, bssid)) {
-		wpa_printf(MSG_DEBUG, "CTRL_IFACE: invalid BSSID '%s'", cmd);
+	count = 1;
+	for (pos = cmd; *pos; pos++) {
+		if (*pos == ' ')
+			count++;
+	}
+	bssids = os_calloc(count, ETH_ALEN);
+	if (!bssids)
 		return -1;
+	count = 0;
+	pos = cmd;
+	while (*pos) {
+		if (hwaddr_aton(pos, &bssids[count * ETH_ALEN]) ||
+		    (pos[17] != '\0' && pos[17] != ' ')) {
+			wpa_printf(MSG_DEBUG, "CTRL_IFACE: invalid BSSID '%s'",
+				   pos);
+			os_free(bssids);
+			return -1;
+		}
+		count++;
+		pos += 17;
+		while (*pos == ' ')
+			pos++;
 	}
 
 	/*
-	 * Add the BSSID twice, so its count will be 2, causing it to be
+	 * Add the BSSIDs twice, so their count will be 2, causing them to be
 	 * skipped when processing scan results.
 	 */
-	ret = wpa_bssid_ignore_add(wpa_s, bssid);
-	if (ret < 0)
-		return -1;
-	ret = wpa_bssid_ignore_add(wpa_s, bssid);
-	if (ret < 0)
+	if (wpa_bssid_ignore_add_list(wpa_s, bssids, count) < 0 ||
+	    wpa_bssid_ignore_add_list(wpa_s, bssids, count) < 0) {
+		os_free(bssids);
 		return -1;
+	}
+	os_free(bssids);
 	os_memcpy(buf, "OK\n", 3);
 	return 3;
 }
@@ -3593,6 +3626,9 @@ static int wpa_supplicant_ctrl_iface_update_network(
 	if (ret == 1)
 		return 0; /* No change to the previously configured value */
 
+	if (os_strcmp(name, "ssid") == 0)
+		wpa_config_network_ssid_changed(wpa_s->conf);
+
 #ifdef CONFIG_BGSCAN
 	if (os_strcmp(name, "bgscan") == 0) {
 		/*
@@ -11956,6 +11992,16 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 			reply_len = -1;
 	} else if (os_strncmp(buf, "NOTE ", 5) == 0) {
 		wpa_printf(MSG_INFO, "NOTE: %s", buf + 5);
+#ifdef CONFIG_ELOOP_STATS
+	} else if (os_strcmp(buf, "ELOOP_STATS") == 0) {
+		reply_len = eloop_stats_dump(reply, reply_size);
+	} else if (os_strcmp(buf, "ELOOP_STATS RESET") == 0) {
+		eloop_stats_reset();
+#endif /* CONFIG_ELOOP_STATS */
+#ifdef CONFIG_OBJ_POOL
+	} else if (os_strcmp(buf, "POOL_STATS") == 0) {
+		reply_len = obj_pool_stats_dump(reply, reply_size);
+#endif /* CONFIG_OBJ_POOL */
 	} else if (os_strcmp(buf, "MIB") == 0) {
 		reply_len = wpa_sm_get_mib(wpa_s->wpa, reply, reply_size);
 		if (reply_len >= 0) {
@@ -11967,6 +12013,12 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 				wpa_s->kay, reply + reply_len,
 				reply_size - reply_len);
 #endif /* CONFIG_MACSEC */
+			reply_len += l2_packet_get_mib(
+				wpa_s->l2, "eapol", reply + reply_len,
+				reply_size - reply_len);
+			reply_len += l2_packet_get_mib(
+				wpa_s->l2_br, "eapolBridge", reply + reply_len,
+				reply_size - reply_len);
 		}
 	} else if (os_strncmp(buf, "STATUS", 6) == 0) {
 		reply_len = wpa_supplicant_ctrl_iface_status(
@@ -13638,6 +13690,16 @@ char * wpa_supplicant_global_ctrl_iface_process(struct wpa_global *global,
 	} else if (os_strncmp(buf, "RELOG", 5) == 0) {
 		if (wpa_debug_reopen_file() < 0)
 			reply_len = -1;
+#ifdef CONFIG_ELOOP_STATS
+	} else if (os_strcmp(buf, "ELOOP_STATS") == 0) {
+		reply_len = eloop_stats_dump(reply, reply_size);
+	} else if (os_strcmp(buf, "ELOOP_STATS RESET") == 0) {
+		eloop_stats_reset();
+#endif /* CONFIG_ELOOP_STATS */
+#ifdef CONFIG_OBJ_POOL
+	} else if (os_strcmp(buf, "POOL_STATS") == 0) {
+		reply_len = obj_pool_stats_dump(reply, reply_size);
+#endif /* CONFIG_OBJ_POOL */
 	} else {
 		os_memcpy(reply, "UNKNOWN COMMAND\n", 16);
 		reply_len = 16;
@@ -280,6 +280,9 @@ dbus_bool_t set_network_properties(struct wpa_supplicant *wpa_s,
 		if (ret == 1)
 			goto skip_update;
 
+		if (os_strcmp(entry.key, "ssid") == 0)
+			wpa_config_network_ssid_changed(wpa_s->conf);
+
 #ifdef CONFIG_BGSCAN
 		if (os_strcmp(entry.key, "bgscan") == 0) {
 			/*
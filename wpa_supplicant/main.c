@@ -12,6 +12,7 @@
 #endif /* __linux__ */
 
 #include "common.h"
+#include "utils/obj_pool.h"
 #include "crypto/crypto.h"
 #include "fst/fst.h"
 #include "wpa_supplicant_i.h"
@@ -404,6 +405,9 @@ out:
 #endif /* CONFIG_MATCH_IFACE */
 	os_free(params.pid_file);
 
+#ifdef CONFIG_OBJ_POOL
+	obj_pool_deinit_all();
+#endif /* CONFIG_OBJ_POOL */
 	crypto_unload();
 	os_program_deinit();
 
@@ -1795,8 +1795,7 @@ static void wpas_p2p_add_psk_list(struct wpa_supplicant *wpa_s,
 			os_memcpy(hpsk->p2p_dev_addr, psk->addr, ETH_ALEN);
 		else
 			os_memcpy(hpsk->addr, psk->addr, ETH_ALEN);
-		hpsk->next = hapd->conf->ssid.wpa_psk;
-		hapd->conf->ssid.wpa_psk = hpsk;
+		hostapd_wpa_psk_add(&hapd->conf->ssid, hpsk);
 	}
 }
 
@@ -8883,7 +8882,6 @@ static void wpas_p2p_remove_client_go(struct wpa_supplicant *wpa_s,
 				      const u8 *peer, int iface_addr)
 {
 	struct hostapd_data *hapd;
-	struct hostapd_wpa_psk *psk, *prev, *rem;
 	struct sta_info *sta;
 
 	if (wpa_s->ap_iface == NULL || wpa_s->current_ssid == NULL ||
@@ -8892,27 +8890,11 @@ static void wpas_p2p_remove_client_go(struct wpa_supplicant *wpa_s,
 
 	/* Remove per-station PSK entry */
 	hapd = wpa_s->ap_iface->bss[0];
-	prev = NULL;
-	psk = hapd->conf->ssid.wpa_psk;
-	while (psk) {
-		if ((iface_addr && os_memcmp(peer, psk->addr, ETH_ALEN) == 0) ||
-		    (!iface_addr &&
-		     os_memcmp(peer, psk->p2p_dev_addr, ETH_ALEN) == 0)) {
-			wpa_dbg(wpa_s, MSG_DEBUG, "P2P: Remove operating group PSK entry for "
-				MACSTR " iface_addr=%d",
-				MAC2STR(peer), iface_addr);
-			if (prev)
-				prev->next = psk->next;
-			else
-				hapd->conf->ssid.wpa_psk = psk->next;
-			rem = psk;
-			psk = psk->next;
-			bin_clear_free(rem, sizeof(*rem));
-		} else {
-			prev = psk;
-			psk = psk->next;
-		}
-	}
+	if (hostapd_wpa_psk_remove_sta(&hapd->conf->ssid,
+				       iface_addr ? peer : NULL, peer) > 0)
+		wpa_dbg(wpa_s, MSG_DEBUG, "P2P: Remove operating group PSK entry for "
+			MACSTR " iface_addr=%d",
+			MAC2STR(peer), iface_addr);
 
 	/* Disconnect from group */
 	if (iface_addr)
@@ -2086,42 +2086,69 @@ struct wpabuf * wpa_scan_get_vendor_ie_multi(const struct wpa_scan_res *res,
 }
 
 
+/*
+ * Sort key for scan results. This is filled in once per result so that the
+ * comparison function does not need to parse IEs or derive values from the
+ * scan result on every comparison.
+ */
+struct wpa_scan_res_key {
+	struct wpa_scan_res *res;
+	unsigned int est_throughput;
+	int snr; /* SNR capped at GREAT_SNR */
+	int snr_full; /* SNR */
+	int level;
+	int qual;
+	unsigned int wpa:1;
+	unsigned int privacy:1;
+	unsigned int level_dbm:1;
+	unsigned int band_6ghz:1;
+	unsigned int band_5ghz:1;
+};
+
+
+static void wpa_scan_res_key_init(struct wpa_scan_res_key *key,
+				  struct wpa_scan_res *res)
+{
+	key->res = res;
+	key->est_throughput = res->est_throughput;
+	key->level = res->level;
+	key->qual = res->qual;
+	key->wpa = wpa_scan_get_vendor_ie(res, WPA_IE_VENDOR_TYPE) != NULL ||
+		wpa_scan_get_ie(res, WLAN_EID_RSN) != NULL;
+	key->privacy = !!(res->caps & IEEE80211_CAP_PRIVACY);
+	key->level_dbm = !!(res->flags & WPA_SCAN_LEVEL_DBM);
+	key->band_6ghz = is_6ghz_freq(res->freq);
+	key->band_5ghz = IS_5GHZ(res->freq);
+	key->snr_full = res->snr;
+	key->snr = res->snr < GREAT_SNR ? res->snr : GREAT_SNR;
+}
+
+
 /* Compare function for sorting scan results. Return >0 if @b is considered
  * better. */
 static int wpa_scan_result_compar(const void *a, const void *b)
 {
-#define MIN(a,b) a < b ? a : b
-	struct wpa_scan_res **_wa = (void *) a;
-	struct wpa_scan_res **_wb = (void *) b;
-	struct wpa_scan_res *wa = *_wa;
-	struct wpa_scan_res *wb = *_wb;
-	int wpa_a, wpa_b;
+	const struct wpa_scan_res_key *wa = a;
+	const struct wpa_scan_res_key *wb = b;
 	int snr_a, snr_b, snr_a_full, snr_b_full;
 
 	/* WPA/WPA2 support preferred */
-	wpa_a = wpa_scan_get_vendor_ie(wa, WPA_IE_VENDOR_TYPE) != NULL ||
-		wpa_scan_get_ie(wa, WLAN_EID_RSN) != NULL;
-	wpa_b = wpa_scan_get_vendor_ie(wb, WPA_IE_VENDOR_TYPE) != NULL ||
-		wpa_scan_get_ie(wb, WLAN_EID_RSN) != NULL;
-
-	if (wpa_b && !wpa_a)
+	if (wb->wpa && !wa->wpa)
 		return 1;
-	if (!wpa_b && wpa_a)
+	if (!wb->wpa && wa->wpa)
 		return -1;
 
 	/* privacy support preferred */
-	if ((wa->caps & IEEE80211_CAP_PRIVACY) == 0 &&
-	    (wb->caps & IEEE80211_CAP_PRIVACY))
+	if (!wa->privacy && wb->privacy)
 		return 1;
-	if ((wa->caps & IEEE80211_CAP_PRIVACY) &&
-	    (wb->caps & IEEE80211_CAP_PRIVACY) == 0)
+	if (wa->privacy && !wb->privacy)
 		return -1;
 
-	if (wa->flags & wb->flags & WPA_SCAN_LEVEL_DBM) {
-		snr_a_full = wa->snr;
-		snr_a = MIN(wa->snr, GREAT_SNR);
-		snr_b_full = wb->snr;
-		snr_b = MIN(wb->snr, GREAT_SNR);
+	if (wa->level_dbm && wb->level_dbm) {
+		snr_a_full = wa->snr_full;
+		snr_a = wa->snr;
+		snr_b_full = wb->snr_full;
+		snr_b = wb->snr;
 	} else {
 		/* Level is not in dBm, so we can't calculate
 		 * SNR. Just use raw level (units unknown). */
@@ -2135,18 +2162,17 @@ static int wpa_scan_result_compar(const void *a, const void *b)
 	 * significant differences in SNR for cases where the estimated
 	 * throughput can be considerably higher with the lower SNR. */
 	if (snr_a && snr_b && (abs(snr_b - snr_a) < 7 ||
-			       is_6ghz_freq(wa->freq) ||
-			       is_6ghz_freq(wb->freq))) {
+			       wa->band_6ghz || wb->band_6ghz)) {
 		if (wa->est_throughput != wb->est_throughput)
 			return (int) wb->est_throughput -
 				(int) wa->est_throughput;
 	}
 	if ((snr_a && snr_b && abs(snr_b - snr_a) < 5) ||
 	    (wa->qual && wb->qual && abs(wb->qual - wa->qual) < 10)) {
-		if (is_6ghz_freq(wa->freq) ^ is_6ghz_freq(wb->freq))
-			return is_6ghz_freq(wa->freq) ? -1 : 1;
-		if (IS_5GHZ(wa->freq) ^ IS_5GHZ(wb->freq))
-			return IS_5GHZ(wa->freq) ? -1 : 1;
+		if (wa->band_6ghz ^ wb->band_6ghz)
+			return wa->band_6ghz ? -1 : 1;
+		if (wa->band_5ghz ^ wb->band_5ghz)
+			return wa->band_5ghz ? -1 : 1;
 	}
 
 	/* all things being equal, use SNR; if SNRs are
@@ -2155,7 +2181,69 @@ static int wpa_scan_result_compar(const void *a, const void *b)
 	if (snr_b_full == snr_a_full)
 		return wb->qual - wa->qual;
 	return snr_b_full - snr_a_full;
-#undef MIN
+}
+
+
+/* Compare function for sorting scan result pointers without a precomputed
+ * key array */
+static int wpa_scan_result_ptr_compar(const void *a, const void *b)
+{
+	struct wpa_scan_res **_wa = (void *) a;
+	struct wpa_scan_res **_wb = (void *) b;
+	struct wpa_scan_res_key ka, kb;
+
+	wpa_scan_res_key_init(&ka, *_wa);
+	wpa_scan_res_key_init(&kb, *_wb);
+	return wpa_scan_result_compar(&ka, &kb);
+}
+
+
+/**
+ * wpa_scan_results_sort_unkeyed - Sort scan results without a key array
+ * @scan_res: Scan results
+ *
+ * This gives the same order as wpa_scan_results_sort(), but computes the sort
+ * keys for each comparison. It does not allocate memory.
+ */
+void wpa_scan_results_sort_unkeyed(struct wpa_scan_results *scan_res)
+{
+	if (!scan_res->res || scan_res->num < 2)
+		return;
+
+	qsort(scan_res->res, scan_res->num, sizeof(struct wpa_scan_res *),
+	      wpa_scan_result_ptr_compar);
+}
+
+
+/**
+ * wpa_scan_results_sort - Sort scan results in preference order
+ * @scan_res: Scan results
+ *
+ * The sort keys are computed once for each result and the results are then
+ * reordered based on the sorted key array. If memory for the keys cannot be
+ * allocated, the keys are computed for each comparison instead.
+ */
+void wpa_scan_results_sort(struct wpa_scan_results *scan_res)
+{
+	struct wpa_scan_res_key *keys;
+	size_t i;
+
+	if (!scan_res->res || scan_res->num < 2)
+		return;
+
+	keys = os_calloc(scan_res->num, sizeof(*keys));
+	if (!keys) {
+		wpa_scan_results_sort_unkeyed(scan_res);
+		return;
+	}
+
+	for (i = 0; i < scan_res->num; i++)
+		wpa_scan_res_key_init(&keys[i], scan_res->res[i]);
+	qsort(keys, scan_res->num, sizeof(*keys), wpa_scan_result_compar);
+	for (i = 0; i < scan_res->num; i++)
+		scan_res->res[i] = keys[i].res;
+
+	os_free(keys);
 }
 
 
@@ -2813,7 +2901,6 @@ wpa_supplicant_get_scan_results(struct wpa_supplicant *wpa_s,
 {
 	struct wpa_scan_results *scan_res;
 	size_t i;
-	int (*compar)(const void *, const void *) = wpa_scan_result_compar;
 
 	scan_res = wpa_drv_get_scan_results2(wpa_s);
 	if (scan_res == NULL) {
@@ -2840,14 +2927,16 @@ wpa_supplicant_get_scan_results(struct wpa_supplicant *wpa_s,
 	if (wpas_wps_searching(wpa_s)) {
 		wpa_dbg(wpa_s, MSG_DEBUG, "WPS: Order scan results with WPS "
 			"provisioning rules");
-		compar = wpa_scan_result_wps_compar;
+		if (scan_res->res)
+			qsort(scan_res->res, scan_res->num,
+			      sizeof(struct wpa_scan_res *),
+			      wpa_scan_result_wps_compar);
+	} else {
+		wpa_scan_results_sort(scan_res);
 	}
+#else /* CONFIG_WPS */
+	wpa_scan_results_sort(scan_res);
 #endif /* CONFIG_WPS */
-
-	if (scan_res->res) {
-		qsort(scan_res->res, scan_res->num,
-		      sizeof(struct wpa_scan_res *), compar);
-	}
 	dump_scan_res(scan_res);
 
 	if (wpa_s->ignore_post_flush_scan_res) {
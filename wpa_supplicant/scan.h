@@ -85,6 +85,8 @@ void filter_scan_res(struct wpa_supplicant *wpa_s,
 void scan_snr(struct wpa_scan_res *res);
 void scan_est_throughput(struct wpa_supplicant *wpa_s,
 			 struct wpa_scan_res *res);
+void wpa_scan_results_sort(struct wpa_scan_results *scan_res);
+void wpa_scan_results_sort_unkeyed(struct wpa_scan_results *scan_res);
 unsigned int wpas_get_est_tpt(const struct wpa_supplicant *wpa_s,
 			      const u8 *ies, size_t ies_len, int rate,
 			      int snr, int freq);
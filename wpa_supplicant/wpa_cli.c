@@ -317,6 +317,20 @@ static int wpa_cli_cmd_relog(struct wpa_ctrl *ctrl, int argc, char *argv[])
 }
 
 
+static int wpa_cli_cmd_eloop_stats(struct wpa_ctrl *ctrl, int argc,
+				   char *argv[])
+{
+	return wpa_cli_cmd(ctrl, "ELOOP_STATS", 0, argc, argv);
+}
+
+
+static int wpa_cli_cmd_pool_stats(struct wpa_ctrl *ctrl, int argc,
+				  char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "POOL_STATS");
+}
+
+
 static int wpa_cli_cmd_note(struct wpa_ctrl *ctrl, int argc, char *argv[])
 {
 	return wpa_cli_cmd(ctrl, "NOTE", 1, argc, argv);
@@ -3340,6 +3354,12 @@ static const struct wpa_cli_cmd wpa_cli_commands[] = {
 	{ "relog", wpa_cli_cmd_relog, NULL,
 	  cli_cmd_flag_none,
 	  "= re-open log-file (allow rolling logs)" },
+	{ "eloop_stats", wpa_cli_cmd_eloop_stats, NULL,
+	  cli_cmd_flag_none,
+	  "[RESET] = show or clear event loop statistics" },
+	{ "pool_stats", wpa_cli_cmd_pool_stats, NULL,
+	  cli_cmd_flag_none,
+	  "= show object pool statistics" },
 	{ "note", wpa_cli_cmd_note, NULL,
 	  cli_cmd_flag_none,
 	  "<text> = add a note to wpa_supplicant debug log" },
@@ -3442,8 +3462,10 @@ static const struct wpa_cli_cmd wpa_cli_commands[] = {
 	  "<network id> <BSSID> = set preferred BSSID for an SSID" },
 	{ "bssid_ignore", wpa_cli_cmd_bssid_ignore, wpa_cli_complete_bss,
 	  cli_cmd_flag_none,
-	  "<BSSID> = add a BSSID to the list of temporarily ignored BSSs\n"
+	  "<BSSID> [<BSSID>...] = add BSSIDs to the list of temporarily ignored\n"
+	  "  BSSs\n"
 	  "bssid_ignore clear = clear the list of temporarily ignored BSSIDs\n"
+	  "bssid_ignore stats = show the number of ignored BSSIDs\n"
 	  "bssid_ignore = display the list of temporarily ignored BSSIDs" },
 	{ "blacklist", /* deprecated alias for bssid_ignore */
 	  wpa_cli_cmd_bssid_ignore, wpa_cli_complete_bss,
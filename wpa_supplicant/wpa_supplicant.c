@@ -1251,6 +1251,21 @@ static void wpa_supplicant_reconfig(int sig, void *signal_ctx)
 }
 
 
+#ifdef CONFIG_ELOOP_STATS
+static void wpa_supplicant_dump_eloop_stats(int sig, void *signal_ctx)
+{
+	char *buf;
+
+	buf = os_malloc(16384);
+	if (!buf)
+		return;
+	eloop_stats_dump(buf, 16384);
+	wpa_printf(MSG_INFO, "eloop statistics:\n%s", buf);
+	os_free(buf);
+}
+#endif /* CONFIG_ELOOP_STATS */
+
+
 static int wpa_supplicant_suites_from_ai(struct wpa_supplicant *wpa_s,
 					 struct wpa_ssid *ssid,
 					 struct wpa_ie_data *ie)
@@ -7403,6 +7418,11 @@ struct wpa_supplicant * wpa_supplicant_add_iface(struct wpa_global *global,
 			wpas_notify_network_added(wpa_s, ssid);
 	}
 
+	/* After the notifiers know the interface so that the loaded entries
+	 * are announced like any other new BSS */
+	if (wpa_s->conf->bss_cache_file)
+		wpa_bss_cache_load(wpa_s);
+
 	wpa_s->next = global->ifaces;
 	global->ifaces = wpa_s;
 
@@ -7790,6 +7810,9 @@ int wpa_supplicant_run(struct wpa_global *global)
 
 	eloop_register_signal_terminate(wpa_supplicant_terminate, global);
 	eloop_register_signal_reconfig(wpa_supplicant_reconfig, global);
+#ifdef CONFIG_ELOOP_STATS
+	eloop_register_signal(SIGUSR1, wpa_supplicant_dump_eloop_stats, NULL);
+#endif /* CONFIG_ELOOP_STATS */
 
 	eloop_run();
 
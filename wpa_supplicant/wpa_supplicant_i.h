@@ -761,6 +761,7 @@ struct wpa_supplicant {
 	size_t last_scan_res_used;
 	size_t last_scan_res_size;
 	struct os_reltime last_scan;
+	struct os_reltime bss_cache_saved;
 
 	const struct wpa_driver_ops *driver;
 	int interface_removed; /* whether the network interface has been
@@ -795,6 +796,12 @@ struct wpa_supplicant {
 				    * known not to be configured with a key */
 
 	struct wpa_bssid_ignore *bssid_ignore;
+#define BSSID_IGNORE_HASH_SIZE 256
+#define BSSID_IGNORE_HASH(bssid) ((bssid)[5])
+	struct wpa_bssid_ignore *bssid_ignore_hash[BSSID_IGNORE_HASH_SIZE];
+	unsigned int num_bssid_ignore;
+	/* Time at which the next ignore list entry becomes due for removal */
+	struct os_reltime bssid_ignore_purge;
 
 	/* Number of connection failures since last successful connection */
 	unsigned int consecutive_conn_failures;
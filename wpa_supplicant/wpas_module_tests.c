@@ -10,13 +10,18 @@
 
 #include "utils/common.h"
 #include "utils/module_tests.h"
+#include "common/ieee802_11_defs.h"
+#include "drivers/driver.h"
 #include "wpa_supplicant_i.h"
 #include "bssid_ignore.h"
+#include "config.h"
+#include "scan.h"
 
 
 static int wpas_bssid_ignore_module_tests(void)
 {
 	struct wpa_supplicant wpa_s;
+	unsigned int active;
 	int ret = -1;
 
 	os_memset(&wpa_s, 0, sizeof(wpa_s));
@@ -76,6 +81,23 @@ static int wpas_bssid_ignore_module_tests(void)
 	if (!wpa_bssid_ignore_is_listed(&wpa_s, (u8 *) "111111"))
 		goto fail;
 
+	wpa_bssid_ignore_clear(&wpa_s);
+
+	/* Entries sharing a hash bucket */
+	if (wpa_bssid_ignore_add_list(&wpa_s, (u8 *) "111111211111311111",
+				      3) != 3 ||
+	    wpa_bssid_ignore_count(&wpa_s, &active) != 3 || active != 3 ||
+	    wpa_bssid_ignore_add_list(&wpa_s, (u8 *) "211111411111", 2) != 4 ||
+	    wpa_bssid_ignore_is_listed(&wpa_s, (u8 *) "211111") != 2 ||
+	    wpa_bssid_ignore_is_listed(&wpa_s, (u8 *) "311111") != 1 ||
+	    wpa_bssid_ignore_del(&wpa_s, (u8 *) "211111") < 0 ||
+	    wpa_bssid_ignore_get(&wpa_s, (u8 *) "211111") != NULL ||
+	    wpa_bssid_ignore_get(&wpa_s, (u8 *) "111111") == NULL ||
+	    wpa_bssid_ignore_get(&wpa_s, (u8 *) "311111") == NULL ||
+	    wpa_bssid_ignore_get(&wpa_s, (u8 *) "411111") == NULL ||
+	    wpa_bssid_ignore_count(&wpa_s, NULL) != 3)
+		goto fail;
+
 	ret = 0;
 fail:
 	wpa_bssid_ignore_clear(&wpa_s);
@@ -87,6 +109,166 @@ fail:
 }
 
 
+static int wpas_config_network_index_module_tests(void)
+{
+	struct wpa_config *config;
+	struct wpa_ssid *ssid;
+	int i, ret = -1;
+
+	config = wpa_config_alloc_empty(NULL, NULL);
+	if (!config)
+		return -1;
+
+	/* Ids sharing hash buckets */
+	for (i = 0; i < 2 * WPA_CONFIG_NETWORK_HASH_SIZE + 1; i++) {
+		ssid = wpa_config_add_network(config);
+		if (!ssid || ssid->id != i)
+			goto fail;
+	}
+
+	if (wpa_config_get_network(config, -1) ||
+	    wpa_config_get_network(config, i) ||
+	    !wpa_config_get_network(config, WPA_CONFIG_NETWORK_HASH_SIZE) ||
+	    wpa_config_remove_network(config, WPA_CONFIG_NETWORK_HASH_SIZE) ||
+	    wpa_config_get_network(config, WPA_CONFIG_NETWORK_HASH_SIZE) ||
+	    !wpa_config_get_network(config, 0) ||
+	    !wpa_config_get_network(config, 2 * WPA_CONFIG_NETWORK_HASH_SIZE) ||
+	    wpa_config_remove_network(config, WPA_CONFIG_NETWORK_HASH_SIZE) == 0)
+		goto fail;
+
+	/* Removing the largest id allows it to be reused */
+	if (wpa_config_remove_network(config, i - 1) ||
+	    !(ssid = wpa_config_add_network(config)) || ssid->id != i - 1)
+		goto fail;
+
+	/* SSID assigned after the network was added */
+	if (wpa_config_get_network_ssid(config, (u8 *) "test", 4) ||
+	    wpa_config_set(ssid, "ssid", "\"test\"", 0) < 0 ||
+	    wpa_config_get_network_ssid(config, (u8 *) "test", 4) != ssid ||
+	    wpa_config_set(ssid, "ssid", "\"other\"", 0) < 0)
+		goto fail;
+	wpa_config_network_ssid_changed(config);
+	if (wpa_config_get_network_ssid(config, (u8 *) "test", 4) ||
+	    wpa_config_get_network_ssid(config, (u8 *) "other", 5) != ssid ||
+	    wpa_config_remove_network(config, ssid->id) ||
+	    wpa_config_get_network_ssid(config, (u8 *) "other", 5))
+		goto fail;
+
+	/* Priority lists maintain the configuration order */
+	ssid = wpa_config_get_network(config, 3);
+	if (!ssid)
+		goto fail;
+	ssid->priority = 5;
+	if (wpa_config_update_prio_list(config) || config->num_prio != 2 ||
+	    config->pssid[0] != ssid || config->pssid[0]->pnext ||
+	    config->pssid[1] != config->ssid ||
+	    config->pssid[1]->pnext != config->ssid->next ||
+	    wpa_config_remove_network(config, 3) || config->num_prio != 1)
+		goto fail;
+
+	ret = 0;
+fail:
+	wpa_config_free(config);
+
+	if (ret)
+		wpa_printf(MSG_ERROR,
+			   "config network index module test failure");
+
+	return ret;
+}
+
+
+static int wpas_scan_sort_module_tests(void)
+{
+	struct wpa_scan_results *scan_res;
+	struct wpa_scan_res *r, **orig = NULL, **unkeyed = NULL;
+	struct os_reltime start, end, t_unkeyed, t_keyed;
+	const size_t num = 1000;
+	size_t i;
+	int ret = -1;
+	u8 *pos;
+
+	scan_res = os_zalloc(sizeof(*scan_res));
+	if (!scan_res)
+		return -1;
+	scan_res->res = os_calloc(num, sizeof(struct wpa_scan_res *));
+	orig = os_calloc(num, sizeof(struct wpa_scan_res *));
+	unkeyed = os_calloc(num, sizeof(struct wpa_scan_res *));
+	if (!scan_res->res || !orig || !unkeyed)
+		goto fail;
+
+	/* Mix of open and RSN results on 2.4, 5, and 6 GHz */
+	for (i = 0; i < num; i++) {
+		r = os_zalloc(sizeof(*r) + 2 + 32 + 2 + 20);
+		if (!r)
+			goto fail;
+		scan_res->res[scan_res->num++] = r;
+		r->bssid[4] = i >> 8;
+		r->bssid[5] = i & 0xff;
+		r->freq = i % 3 == 0 ? 2412 : (i % 3 == 1 ? 5180 : 5975);
+		r->flags = WPA_SCAN_LEVEL_DBM;
+		r->level = -40 - (int) (i * 7 % 50);
+		r->noise = -92;
+		r->snr = r->level - r->noise;
+		r->est_throughput = 1000 * (i % 13);
+		pos = (u8 *) (r + 1);
+		*pos++ = WLAN_EID_SSID;
+		*pos++ = 32;
+		os_memset(pos, 'a', 32);
+		pos += 32;
+		if (i % 4) {
+			r->caps = IEEE80211_CAP_PRIVACY;
+			*pos++ = WLAN_EID_RSN;
+			*pos++ = 20;
+			pos += 20;
+		}
+		r->ie_len = pos - (u8 *) (r + 1);
+	}
+
+	os_memcpy(orig, scan_res->res, num * sizeof(struct wpa_scan_res *));
+
+	/* Compare against computing the keys for each comparison */
+	os_get_reltime(&start);
+	wpa_scan_results_sort_unkeyed(scan_res);
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &t_unkeyed);
+	os_memcpy(unkeyed, scan_res->res, num * sizeof(struct wpa_scan_res *));
+
+	os_memcpy(scan_res->res, orig, num * sizeof(struct wpa_scan_res *));
+	os_get_reltime(&start);
+	wpa_scan_results_sort(scan_res);
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &t_keyed);
+
+	wpa_printf(MSG_INFO,
+		   "scan sort: %zu results unkeyed %ld.%06ld s keyed %ld.%06ld s",
+		   num, (long) t_unkeyed.sec, (long) t_unkeyed.usec,
+		   (long) t_keyed.sec, (long) t_keyed.usec);
+
+	/* RSN results are preferred over open ones */
+	for (i = 0; i < num; i++) {
+		int rsn = wpa_scan_get_ie(scan_res->res[i], WLAN_EID_RSN) !=
+			NULL;
+		int rsn_unkeyed = wpa_scan_get_ie(unkeyed[i], WLAN_EID_RSN) !=
+			NULL;
+
+		if (rsn != (i < num - (num + 3) / 4) || rsn_unkeyed != rsn)
+			goto fail;
+	}
+
+	ret = 0;
+fail:
+	os_free(orig);
+	os_free(unkeyed);
+	wpa_scan_results_free(scan_res);
+
+	if (ret)
+		wpa_printf(MSG_ERROR, "scan sort module test failure");
+
+	return ret;
+}
+
+
 int wpas_module_tests(void)
 {
 	int ret = 0;
@@ -96,6 +278,12 @@ int wpas_module_tests(void)
 	if (wpas_bssid_ignore_module_tests() < 0)
 		ret = -1;
 
+	if (wpas_config_network_index_module_tests() < 0)
+		ret = -1;
+
+	if (wpas_scan_sort_module_tests() < 0)
+		ret = -1;
+
 #ifdef CONFIG_WPS
 	if (wps_module_tests() < 0)
 		ret = -1;
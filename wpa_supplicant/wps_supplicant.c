@@ -493,6 +493,7 @@ static int wpa_supplicant_wps_cred(void *ctx,
 		os_memcpy(ssid->ssid, cred->ssid, cred->ssid_len);
 		ssid->ssid_len = cred->ssid_len;
 	}
+	wpa_config_network_ssid_changed(wpa_s->conf);
 
 	switch (cred->encr_type) {
 	case WPS_ENCR_NONE: